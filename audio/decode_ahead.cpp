@@ -0,0 +1,331 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/decode_ahead.h"
+
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/singleton.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+namespace Audio {
+
+#ifdef SCUMMVM_HAVE_ATOMICS
+
+enum {
+	DECODE_CHUNK_SIZE = 4096,  // Samples, the most the timer decodes at once per stream
+	DECODE_INTERVAL = 10000    // Microseconds
+};
+
+class DecodeAheadAudioStreamImpl : public DecodeAheadAudioStream {
+public:
+	DecodeAheadAudioStreamImpl(SeekableAudioStream *parent, uint32 bufferTime, DisposeAfterUse::Flag disposeAfterUse);
+	~DecodeAheadAudioStreamImpl();
+
+	// AudioStream API
+	int readBuffer(int16 *buffer, const int numSamples);
+	bool isStereo() const { return _parent->isStereo(); }
+	int getRate() const { return _parent->getRate(); }
+	bool endOfData() const;
+	bool endOfStream() const;
+
+	// SeekableAudioStream API
+	bool seek(const Timestamp &where);
+	Timestamp getLength() const { return _parent->getLength(); }
+
+	// DecodeAheadAudioStream API
+	void decodeAhead();
+	uint32 getBufferedSamples() const;
+
+	/**
+	 * Decode at most DECODE_CHUNK_SIZE samples into the buffer.
+	 *
+	 * @return true if any samples were decoded
+	 */
+	bool decodeChunk();
+
+private:
+	uint32 consume(int16 *buffer, uint32 numSamples);
+	void lockSource();
+	void unlockSource();
+	void updateSourceState();
+
+	Common::DisposablePtr<SeekableAudioStream> _parent;
+	bool _registered;
+
+	// The ring buffer is filled by whoever holds _decodeLock, which also
+	// grants access to the source stream, and only emptied by readBuffer().
+	// _head and _tail count samples and wrap around freely. _dataEnded and
+	// _streamEnded mirror the state of the source stream.
+	int16 *_buffer;
+	uint32 _bufferSize; // Samples, a power of two
+	volatile uint32 _head;
+	volatile uint32 _tail;
+	volatile uint32 _decodeLock;
+	volatile uint32 _dataEnded;
+	volatile uint32 _streamEnded;
+};
+
+/**
+ * Owns the timer decoding all DecodeAheadAudioStreams.
+ */
+class DecodeAheadManager : public Common::Singleton<DecodeAheadManager> {
+public:
+	void addStream(DecodeAheadAudioStreamImpl *stream);
+	void removeStream(DecodeAheadAudioStreamImpl *stream);
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DecodeAheadManager() : _timerInstalled(false) {}
+
+	static void timerProc(void *refCon);
+	void decodeStreams();
+
+	Common::Mutex _mutex;
+	Common::Array<DecodeAheadAudioStreamImpl *> _streams;
+	bool _timerInstalled;
+};
+
+} // End of namespace Audio
+
+namespace Common {
+DECLARE_SINGLETON(Audio::DecodeAheadManager);
+}
+
+namespace Audio {
+
+void DecodeAheadManager::addStream(DecodeAheadAudioStreamImpl *stream) {
+	bool installTimer;
+	{
+		Common::StackLock lock(_mutex);
+		_streams.push_back(stream);
+		installTimer = !_timerInstalled;
+		_timerInstalled = true;
+	}
+
+	// The timer stays installed once there was a stream. Removing it along
+	// with the last stream could deadlock with a running timerProc().
+	if (installTimer)
+		g_system->getTimerManager()->installTimerProc(&timerProc, DECODE_INTERVAL, this, "AudioDecodeAhead");
+}
+
+void DecodeAheadManager::removeStream(DecodeAheadAudioStreamImpl *stream) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _streams.size(); i++) {
+		if (_streams[i] == stream) {
+			_streams.remove_at(i);
+			break;
+		}
+	}
+}
+
+void DecodeAheadManager::timerProc(void *refCon) {
+	((DecodeAheadManager *)refCon)->decodeStreams();
+}
+
+void DecodeAheadManager::decodeStreams() {
+	// Each tick decodes at most one chunk per stream, so that filling the
+	// buffers of new or seeked streams does not hold up the other timers.
+	// The lock is released between the streams, so destroying a stream
+	// never waits for more than a chunk either.
+	for (uint i = 0; ; i++) {
+		Common::StackLock lock(_mutex);
+		if (i >= _streams.size())
+			break;
+
+		_streams[i]->decodeChunk();
+	}
+}
+
+DecodeAheadAudioStreamImpl::DecodeAheadAudioStreamImpl(SeekableAudioStream *parent, uint32 bufferTime, DisposeAfterUse::Flag disposeAfterUse)
+	: _parent(parent, disposeAfterUse), _registered(false), _buffer(0), _bufferSize(DECODE_CHUNK_SIZE),
+	  _head(0), _tail(0), _decodeLock(0), _dataEnded(0), _streamEnded(0) {
+	const uint32 samples = (uint64)_parent->getRate() * (_parent->isStereo() ? 2 : 1) * bufferTime / 1000;
+	while (_bufferSize < samples)
+		_bufferSize <<= 1;
+
+	_buffer = new int16[_bufferSize];
+	updateSourceState();
+
+	if (g_system && g_system->getTimerManager()) {
+		DecodeAheadManager::instance().addStream(this);
+		_registered = true;
+	}
+}
+
+DecodeAheadAudioStreamImpl::~DecodeAheadAudioStreamImpl() {
+	// Once removed, the timer does not touch this stream anymore
+	if (_registered)
+		DecodeAheadManager::instance().removeStream(this);
+
+	delete[] _buffer;
+}
+
+int DecodeAheadAudioStreamImpl::readBuffer(int16 *buffer, const int numSamples) {
+	uint32 samples = consume(buffer, numSamples);
+
+	// On an underrun the source is read directly. Should the timer be busy
+	// with it, waiting for its chunk is still better than playing a gap.
+	if (samples < (uint32)numSamples) {
+		lockSource();
+
+		// The timer may have completed a chunk before giving up the lock
+		samples += consume(buffer + samples, numSamples - samples);
+
+		if (samples < (uint32)numSamples && !_parent->endOfData()) {
+			const int read = _parent->readBuffer(buffer + samples, numSamples - samples);
+			if (read > 0)
+				samples += read;
+		}
+
+		updateSourceState();
+		unlockSource();
+	}
+
+	return samples;
+}
+
+bool DecodeAheadAudioStreamImpl::endOfData() const {
+	// The flag has to be read first: once it is set, the buffer holds all
+	// the remaining samples.
+	return Common::atomicLoad(&_dataEnded) && Common::atomicLoad(&_head) == Common::atomicLoad(&_tail);
+}
+
+bool DecodeAheadAudioStreamImpl::endOfStream() const {
+	return Common::atomicLoad(&_streamEnded) && Common::atomicLoad(&_head) == Common::atomicLoad(&_tail);
+}
+
+bool DecodeAheadAudioStreamImpl::seek(const Timestamp &where) {
+	lockSource();
+
+	// The stream is not played while seeking, so the buffer can be emptied
+	// from here.
+	Common::atomicStore(&_tail, _head);
+	const bool result = _parent->seek(where);
+	updateSourceState();
+
+	unlockSource();
+	return result;
+}
+
+void DecodeAheadAudioStreamImpl::decodeAhead() {
+	while (decodeChunk())
+		;
+}
+
+uint32 DecodeAheadAudioStreamImpl::getBufferedSamples() const {
+	return Common::atomicLoad(&_head) - Common::atomicLoad(&_tail);
+}
+
+bool DecodeAheadAudioStreamImpl::decodeChunk() {
+	if (!Common::atomicCompareExchange(&_decodeLock, 0, 1))
+		return false;
+
+	const uint32 tail = Common::atomicLoad(&_tail);
+	const uint32 head = _head;
+	bool decoded = false;
+
+	if (head - tail < _bufferSize && !_parent->endOfData()) {
+		const uint32 offset = head & (_bufferSize - 1);
+		const uint32 count = MIN<uint32>(MIN<uint32>(_bufferSize - (head - tail), _bufferSize - offset), DECODE_CHUNK_SIZE);
+
+		const int read = _parent->readBuffer(_buffer + offset, count);
+		if (read > 0) {
+			Common::atomicStore(&_head, head + read);
+			decoded = true;
+		}
+	}
+
+	updateSourceState();
+	Common::atomicStore(&_decodeLock, 0);
+	return decoded;
+}
+
+uint32 DecodeAheadAudioStreamImpl::consume(int16 *buffer, uint32 numSamples) {
+	const uint32 head = Common::atomicLoad(&_head);
+	uint32 tail = _tail;
+	uint32 samples = 0;
+
+	while (samples < numSamples && tail != head) {
+		const uint32 offset = tail & (_bufferSize - 1);
+		const uint32 count = MIN<uint32>(MIN<uint32>(numSamples - samples, head - tail), _bufferSize - offset);
+		memcpy(buffer + samples, _buffer + offset, count * sizeof(int16));
+		samples += count;
+		tail += count;
+	}
+
+	Common::atomicStore(&_tail, tail);
+	return samples;
+}
+
+void DecodeAheadAudioStreamImpl::lockSource() {
+	// The timer holds the lock for no more than a chunk
+	while (!Common::atomicCompareExchange(&_decodeLock, 0, 1))
+		g_system->delayMillis(1);
+}
+
+void DecodeAheadAudioStreamImpl::unlockSource() {
+	Common::atomicStore(&_decodeLock, 0);
+}
+
+void DecodeAheadAudioStreamImpl::updateSourceState() {
+	Common::atomicStore(&_dataEnded, _parent->endOfData());
+	Common::atomicStore(&_streamEnded, _parent->endOfStream());
+}
+
+#else
+
+/**
+ * Without atomic operations the source stream is simply decoded on demand.
+ */
+class DecodeAheadAudioStreamImpl : public DecodeAheadAudioStream {
+public:
+	DecodeAheadAudioStreamImpl(SeekableAudioStream *parent, uint32 bufferTime, DisposeAfterUse::Flag disposeAfterUse)
+		: _parent(parent, disposeAfterUse) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) { return _parent->readBuffer(buffer, numSamples); }
+	bool isStereo() const { return _parent->isStereo(); }
+	int getRate() const { return _parent->getRate(); }
+	bool endOfData() const { return _parent->endOfData(); }
+	bool endOfStream() const { return _parent->endOfStream(); }
+
+	bool seek(const Timestamp &where) { return _parent->seek(where); }
+	Timestamp getLength() const { return _parent->getLength(); }
+
+	void decodeAhead() {}
+	uint32 getBufferedSamples() const { return 0; }
+
+private:
+	Common::DisposablePtr<SeekableAudioStream> _parent;
+};
+
+#endif // SCUMMVM_HAVE_ATOMICS
+
+DecodeAheadAudioStream *makeDecodeAheadStream(SeekableAudioStream *stream, uint32 bufferTime, DisposeAfterUse::Flag disposeAfterUse) {
+	return new DecodeAheadAudioStreamImpl(stream, bufferTime, disposeAfterUse);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,74 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_DECODE_AHEAD_H
+#define AUDIO_DECODE_AHEAD_H
+
+#include "audio/audiostream.h"
+#include "common/types.h"
+
+namespace Audio {
+
+/**
+ * A SeekableAudioStream which decodes its source stream ahead of playback
+ * into a buffer of PCM samples. The mixer callback then only has to copy
+ * the buffered samples instead of waiting for a Vorbis, FLAC or MP3 decoder.
+ *
+ * The decoding is done by a timer, which is shared by all decode-ahead
+ * streams and decodes a limited amount per stream on each tick. Should the
+ * buffer run dry, readBuffer() decodes the source directly, after waiting
+ * for the timer to finish the part it is decoding at that moment.
+ *
+ * As with any SeekableAudioStream, seeking is not required to work while
+ * the stream is being played by the mixer.
+ */
+class DecodeAheadAudioStream : public SeekableAudioStream {
+public:
+	/**
+	 * Decode samples until the buffer is full or the source stream has no
+	 * more data. The timer does the same over several ticks; engines may
+	 * call this, for example to fill the buffer before the stream is played.
+	 */
+	virtual void decodeAhead() = 0;
+
+	/**
+	 * Return the number of decoded samples waiting in the buffer.
+	 */
+	virtual uint32 getBufferedSamples() const = 0;
+};
+
+/**
+ * Factory function for a DecodeAheadAudioStream.
+ *
+ * When there is no timer manager, or the platform lacks atomic operations,
+ * the returned stream decodes its source on demand, just like the source
+ * stream itself.
+ *
+ * @param stream          The stream to decode ahead
+ * @param bufferTime      The amount of audio to keep decoded, in milliseconds
+ * @param disposeAfterUse Whether the source stream should be destroyed on destruction of the returned stream
+ */
+DecodeAheadAudioStream *makeDecodeAheadStream(SeekableAudioStream *stream, uint32 bufferTime, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::YES);
+
+} // End of namespace Audio
+
+#endif
@@ -22,18 +22,53 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/timer.h"
 
 #include "audio/mixer_intern.h"
 #include "audio/rate.h"
+#include "audio/rate_intern.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
 
 
 namespace Audio {
 
+namespace {
+
+#ifdef SCUMMVM_HAVE_ATOMICS
+using Common::atomicLoad;
+using Common::atomicStore;
+using Common::atomicCompareExchange;
+#else
+// The command queue mode can not be enabled without atomics, these only
+// keep its code paths compiling.
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return *ptr;
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 value) {
+	*ptr = value;
+}
+
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	if (*ptr != expected)
+		return false;
+	*ptr = desired;
+	return true;
+}
+#endif
+
+enum {
+	PRERENDER_BUFFER_SIZE = 8192, // Sample frames, must be a power of two
+	PRERENDER_INTERVAL = 10000    // Microseconds
+};
+
+} // End of anonymous namespace
+
 #pragma mark -
 #pragma mark --- Channel classes ---
 #pragma mark -
@@ -44,7 +79,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterQuality quality);
 	~Channel();
 
 	/**
@@ -61,7 +96,32 @@ public:
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const;
+
+	/**
+	 * Switches the channel to reading its stream ahead of time, see
+	 * prerender(). Must be called before the channel is handed over to
+	 * the mixer callback.
+	 */
+	void enablePrerendering();
+
+	/**
+	 * Takes the stream for prerender(). Fails if mix() is reading the
+	 * stream at the same time.
+	 */
+	bool claimForPrerendering();
+
+	/**
+	 * Renders the stream into the channel's ring buffer until it is full,
+	 * then releases the stream. The stream has to be claimed first.
+	 */
+	void prerender();
+
+	/**
+	 * Waits until prerender() has released the stream, and keeps it from
+	 * being claimed again. Called before the channel is deleted.
+	 */
+	void waitForPrerendering();
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -167,6 +227,21 @@ private:
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
+
+	// Prerendering state. The ring buffer holds stereo frames at full
+	// volume, it is filled by whoever holds _renderLock (usually
+	// prerender()) and only emptied by mix(). _streamEnded mirrors the
+	// stream's endOfStream(), the stream itself may only be queried with
+	// _renderLock held.
+	st_sample_t *_ring;
+	volatile uint32 _ringHead;
+	volatile uint32 _ringTail;
+	volatile uint32 _renderLock;
+	volatile uint32 _streamEnded;
+	MixBufferProc _mixProc;
+
+	uint consumePrerendered(int16 *data, uint len);
+	int mixPrerendered(int16 *data, uint len);
 };
 
 #pragma mark -
@@ -175,23 +250,73 @@ private:
 
 // TODO: parameter "system" is unused
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _rateConverterQuality(kRateConverterQualityLow), _mixerReady(false), _handleSeed(0),
+	  _soundTypeSettings(), _useCommandQueue(false), _commandHead(0), _commandTail(0), _consumerLock(0),
+	  _usePrerendering(false), _prerenderTimerInstalled(0) {
 
 	assert(sampleRate > 0);
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		_channels[i] = 0;
+
+	// Advanced users can trade CPU time for better resampling of low rate
+	// sounds by setting this value in their ScummVM config file directly
+	const char *const appDomain = Common::ConfigManager::kApplicationDomain;
+	if (ConfMan.hasKey("resampling_quality", appDomain))
+		_rateConverterQuality = parseRateConverterQuality(ConfMan.get("resampling_quality", appDomain).c_str());
+	prepareRateConverterTables(_sampleRate, _rateConverterQuality);
 }
 
 MixerImpl::~MixerImpl() {
+	if (_prerenderTimerInstalled)
+		g_system->getTimerManager()->removeTimerProc(&prerenderTimerProc);
+
+	// In command queue mode the slots own all channels, including the ones
+	// still waiting in the queue.
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		delete _channels[i];
+		delete (_useCommandQueue ? _slots[i].channel : _channels[i]);
+
+	freeRateConverterTables();
 }
 
 void MixerImpl::setReady(bool ready) {
 	_mixerReady = ready;
 }
 
+bool MixerImpl::setUseCommandQueue(bool enable) {
+#ifdef SCUMMVM_HAVE_ATOMICS
+	assert(!_mixerReady);
+
+	for (int i = 0; i != NUM_CHANNELS; i++)
+		assert(!_channels[i] && !_slots[i].channel);
+
+	assert(enable || !_usePrerendering);
+
+	_useCommandQueue = enable;
+#else
+	if (enable)
+		warning("MixerImpl: Command queue mode is not supported on this platform");
+#endif
+	return _useCommandQueue == enable;
+}
+
+bool MixerImpl::setUsePrerendering(bool enable) {
+	assert(!_mixerReady);
+
+	// The prerendered samples are mixed in with the regular mixing
+	// routines, which expect signed silence in the ring buffers.
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	if (_useCommandQueue)
+		_usePrerendering = enable;
+	else if (enable)
+		warning("MixerImpl: Prerendering requires the command queue mode");
+#else
+	if (enable)
+		warning("MixerImpl: Prerendering is not supported on this platform");
+#endif
+	return _usePrerendering == enable;
+}
+
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
@@ -229,7 +354,13 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
+	// The timer manager is not available yet while the backend sets up
+	// the mixer. Install the timer before taking _queueMutex, which the
+	// timer procedure takes as well.
+	if (_usePrerendering && !atomicLoad(&_prerenderTimerInstalled))
+		installPrerenderTimer();
+
+	Common::StackLock lock(_useCommandQueue ? _queueMutex : _mutex);
 
 	if (stream == 0) {
 		warning("stream is 0");
@@ -239,10 +370,13 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	if (_useCommandQueue)
+		reclaimRetiredSlots();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (_useCommandQueue ? (isSlotActive(i) && _slots[i].id == id) : (_channels[i] != 0 && _channels[i]->getId() == id)) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -260,17 +394,41 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
-	insertChannel(handle, chan);
+	if (_usePrerendering)
+		chan->enablePrerendering();
+	if (_useCommandQueue)
+		playStreamQueued(handle, chan, id);
+	else
+		insertChannel(handle, chan);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
+	if (_useCommandQueue) {
+		// An engine thread waiting for a stop may be processing the commands
+		// in place of the callback. Rather than waiting for it, this period
+		// is left silent; it only happens when a stop coincides with the
+		// start of a callback.
+		if (!atomicCompareExchange(&_consumerLock, 0, 1)) {
+			memset(samples, 0, len);
+			return 0;
+		}
+
+		processCommands();
+		const int res = mixChannels(samples, len);
+		atomicStore(&_consumerLock, 0);
+		return res;
+	}
+
 	Common::StackLock lock(_mutex);
+	return mixChannels(samples, len);
+}
 
+int MixerImpl::mixChannels(byte *samples, uint len) {
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
@@ -287,8 +445,12 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
+				if (_useCommandQueue) {
+					retireChannel(i);
+				} else {
+					delete _channels[i];
+					_channels[i] = 0;
+				}
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
 
@@ -301,6 +463,18 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 }
 
 void MixerImpl::stopAll() {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (isSlotActive(i) && !_slots[i].permanent)
+				stopSlot(i);
+		}
+		waitForStoppedSlots();
+		reclaimRetiredSlots();
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
@@ -311,6 +485,18 @@ void MixerImpl::stopAll() {
 }
 
 void MixerImpl::stopID(int id) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (isSlotActive(i) && _slots[i].id == id)
+				stopSlot(i);
+		}
+		waitForStoppedSlots();
+		reclaimRetiredSlots();
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
@@ -321,6 +507,17 @@ void MixerImpl::stopID(int id) {
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		if (index != -1)
+			stopSlot(index);
+		waitForStoppedSlots();
+		reclaimRetiredSlots();
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore stop requests for handles of sounds that already terminated
@@ -336,6 +533,13 @@ void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
 	_soundTypeSettings[type].mute = mute;
 
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		pushCommand(Command::kGlobalVolume, type, 0, 0);
+		return;
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
 			_channels[i]->notifyGlobalVolChange();
@@ -348,6 +552,17 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			_slots[index].volume = volume;
+			pushCommand(Command::kVolume, index, handle._val, volume);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -358,6 +573,13 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		return index != -1 ? _slots[index].volume : 0;
+	}
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -366,6 +588,17 @@ byte MixerImpl::getChannelVolume(SoundHandle handle) {
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		if (index != -1) {
+			_slots[index].balance = balance;
+			pushCommand(Command::kBalance, index, handle._val, balance);
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -376,6 +609,13 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		return index != -1 ? _slots[index].balance : 0;
+	}
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -388,6 +628,20 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 }
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
+	if (_useCommandQueue) {
+		// Retired channels are only freed with _queueMutex held, so the
+		// channel stays valid here. Its timing fields are updated by the
+		// mixer callback concurrently, which at worst makes the estimate
+		// off by one callback period.
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		if (index == -1)
+			return Timestamp(0, _sampleRate);
+
+		return _slots[index].channel->getElapsedTime();
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -398,6 +652,13 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		pushCommand(Command::kPauseAll, 0, 0, paused);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
@@ -407,6 +668,18 @@ void MixerImpl::pauseAll(bool paused) {
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (isSlotActive(i) && _slots[i].id == id) {
+				pushCommand(Command::kPause, i, _slots[i].handle._val, paused);
+				return;
+			}
+		}
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
@@ -417,6 +690,15 @@ void MixerImpl::pauseID(int id, bool paused) {
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		if (index != -1)
+			pushCommand(Command::kPause, index, handle._val, paused);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
@@ -428,12 +710,20 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_useCommandQueue ? _queueMutex : _mutex);
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	if (_useCommandQueue) {
+		flushPendingCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (isSlotActive(i) && _slots[i].id == id)
+				return true;
+		return false;
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
@@ -441,6 +731,13 @@ bool MixerImpl::isSoundIDActive(int id) {
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		const int index = findActiveSlot(handle);
+		return index != -1 ? _slots[index].id : 0;
+	}
+
 	Common::StackLock lock(_mutex);
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
@@ -449,17 +746,31 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Common::StackLock lock(_useCommandQueue ? _queueMutex : _mutex);
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
+	if (_useCommandQueue) {
+		flushPendingCommands();
+		return findActiveSlot(handle) != -1;
+	}
+
 	const int index = handle._val % NUM_CHANNELS;
 	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (isSlotActive(i) && _slots[i].type == type)
+				return true;
+		return false;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
@@ -479,6 +790,14 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
+	if (_useCommandQueue) {
+		Common::StackLock lock(_queueMutex);
+		flushPendingCommands();
+		_soundTypeSettings[type].volume = volume;
+		pushCommand(Command::kGlobalVolume, type, 0, 0);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].volume = volume;
 
@@ -494,28 +813,337 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	return _soundTypeSettings[type].volume;
 }
 
+#pragma mark -
+#pragma mark --- Command queue mode ---
+#pragma mark -
+
+// The engine side (any thread holding _queueMutex) owns the slots: it
+// allocates them, creates and deletes their channels and tracks the
+// channel properties which can be queried. The mixer callback owns
+// _channels[] and is the only one to touch the channels it contains. The
+// two sides communicate through the command ring (engine side -> callback)
+// and the slot states (callback -> engine side, for finished channels).
+
+void MixerImpl::playStreamQueued(SoundHandle *handle, Channel *chan, int id) {
+	int index = -1;
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (atomicLoad(&_slots[i].state) == kSlotFree) {
+			index = i;
+			break;
+		}
+	}
+	if (index == -1) {
+		warning("MixerImpl::out of mixer slots");
+		delete chan;
+		return;
+	}
+
+	SoundHandle chanHandle;
+	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	chan->setHandle(chanHandle);
+	_handleSeed++;
+
+	Slot &slot = _slots[index];
+	slot.channel = chan;
+	slot.handle = chanHandle;
+	slot.id = id;
+	slot.type = chan->getType();
+	slot.permanent = chan->isPermanent();
+	slot.volume = chan->getVolume();
+	slot.balance = chan->getBalance();
+	atomicStore(&slot.state, kSlotActive);
+
+	pushCommand(Command::kPlay, index, chanHandle._val, 0);
+
+	if (handle)
+		*handle = chanHandle;
+}
+
+bool MixerImpl::isSlotActive(int index) const {
+	return atomicLoad(&_slots[index].state) == kSlotActive;
+}
+
+int MixerImpl::findActiveSlot(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (!isSlotActive(index) || _slots[index].handle._val != handle._val)
+		return -1;
+	return index;
+}
+
+void MixerImpl::stopSlot(int index) {
+	// The callback may retire the channel at the same time, in which case
+	// the slot simply stays retired.
+	if (atomicCompareExchange(&_slots[index].state, kSlotActive, kSlotStopping))
+		pushCommand(Command::kStop, index, _slots[index].handle._val, 0);
+}
+
+void MixerImpl::waitForStoppedSlots() {
+	// Streams not disposed by the mixer are usually deleted right after
+	// stopping them, so the callback has to drop the channels first. When
+	// the callback is not running, the commands are processed from here.
+	for (;;) {
+		bool stopping = false;
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (atomicLoad(&_slots[i].state) == kSlotStopping)
+				stopping = true;
+		}
+		if (!stopping)
+			return;
+
+		flushPendingCommands();
+		if (atomicCompareExchange(&_consumerLock, 0, 1)) {
+			processCommands();
+			atomicStore(&_consumerLock, 0);
+		} else {
+			g_system->delayMillis(1);
+		}
+	}
+}
+
+void MixerImpl::pushCommand(Command::Type type, int index, uint32 handle, int value) {
+	Command cmd;
+	cmd.type = type;
+	cmd.index = index;
+	cmd.handle = handle;
+	cmd.value = value;
+
+	// Keep the commands in order: anything which overflowed earlier has to
+	// go into the ring first.
+	flushPendingCommands();
+
+	if (!_pendingCommands.empty() || !tryPushCommand(cmd))
+		_pendingCommands.push(cmd);
+}
+
+void MixerImpl::flushPendingCommands() {
+	while (!_pendingCommands.empty() && tryPushCommand(_pendingCommands.front()))
+		_pendingCommands.pop();
+}
+
+bool MixerImpl::tryPushCommand(const Command &cmd) {
+	const uint32 head = _commandHead;
+	if (head - atomicLoad(&_commandTail) == COMMAND_QUEUE_SIZE)
+		return false;
+
+	_commands[head & (COMMAND_QUEUE_SIZE - 1)] = cmd;
+	atomicStore(&_commandHead, head + 1);
+	return true;
+}
+
+void MixerImpl::reclaimRetiredSlots() {
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (atomicLoad(&_slots[i].state) == kSlotRetired) {
+			if (_usePrerendering)
+				_slots[i].channel->waitForPrerendering();
+			delete _slots[i].channel;
+			_slots[i].channel = 0;
+			atomicStore(&_slots[i].state, kSlotFree);
+		}
+	}
+}
+
+void MixerImpl::processCommands() {
+	const uint32 head = atomicLoad(&_commandHead);
+	uint32 tail = _commandTail;
+
+	while (tail != head) {
+		executeCommand(_commands[tail & (COMMAND_QUEUE_SIZE - 1)]);
+		tail++;
+	}
+
+	atomicStore(&_commandTail, tail);
+}
+
+void MixerImpl::executeCommand(const Command &cmd) {
+	if (cmd.type == Command::kPauseAll) {
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_channels[i])
+				_channels[i]->pause(cmd.value != 0);
+		return;
+	} else if (cmd.type == Command::kGlobalVolume) {
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_channels[i] && _channels[i]->getType() == cmd.index)
+				_channels[i]->notifyGlobalVolChange();
+		return;
+	} else if (cmd.type == Command::kPlay) {
+		_channels[cmd.index] = _slots[cmd.index].channel;
+		return;
+	}
+
+	// Ignore commands for channels which already terminated
+	Channel *chan = _channels[cmd.index];
+	if (!chan || chan->getHandle()._val != cmd.handle)
+		return;
+
+	switch (cmd.type) {
+	case Command::kStop:
+		retireChannel(cmd.index);
+		break;
+	case Command::kPause:
+		chan->pause(cmd.value != 0);
+		break;
+	case Command::kVolume:
+		chan->setVolume(cmd.value);
+		break;
+	case Command::kBalance:
+		chan->setBalance(cmd.value);
+		break;
+	default:
+		break;
+	}
+}
+
+void MixerImpl::retireChannel(int index) {
+	// The channel is deleted by the engine side, deleting streams can be
+	// expensive and has no place in the audio callback.
+	_channels[index] = 0;
+	atomicStore(&_slots[index].state, kSlotRetired);
+}
+
+#pragma mark -
+#pragma mark --- Prerendering ---
+#pragma mark -
+
+// The prerendering timer claims the streams of active channels with
+// _queueMutex held, and renders them after releasing it, so the engine
+// threads do not wait for the rendering. The engine side waits for the
+// claim to be released before deleting a channel. The mixer callback and
+// the timer hand the ring buffer and the stream back and forth through
+// atomics in the channels.
+
+void MixerImpl::installPrerenderTimer() {
+	if (atomicCompareExchange(&_prerenderTimerInstalled, 0, 1))
+		g_system->getTimerManager()->installTimerProc(&prerenderTimerProc, PRERENDER_INTERVAL, this, "MixerPrerender");
+}
+
+void MixerImpl::prerenderTimerProc(void *refCon) {
+	((MixerImpl *)refCon)->prerenderChannels();
+}
+
+void MixerImpl::prerenderChannels() {
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		Channel *chan = 0;
+		{
+			Common::StackLock lock(_queueMutex);
+			if (isSlotActive(i) && _slots[i].channel->claimForPrerendering())
+				chan = _slots[i].channel;
+		}
+
+		if (chan)
+			chan->prerender();
+	}
+}
+
 
 #pragma mark -
 #pragma mark --- Channel implementations ---
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterQuality quality)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
       _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
       _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
-      _stream(stream, autofreeStream) {
+      _stream(stream, autofreeStream), _ring(0), _ringHead(0), _ringTail(0),
+      _renderLock(0), _streamEnded(0), _mixProc(0) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
+	delete[] _ring;
 	delete _converter;
 }
 
+bool Channel::isFinished() const {
+	if (!_ring)
+		return _stream->endOfStream();
+
+	return atomicLoad(&_streamEnded) && atomicLoad(&_ringHead) == _ringTail;
+}
+
+void Channel::enablePrerendering() {
+	assert(!_ring);
+	_ring = new st_sample_t[PRERENDER_BUFFER_SIZE * 2];
+	_mixProc = getMixBufferProc(true, false);
+}
+
+bool Channel::claimForPrerendering() {
+	return atomicCompareExchange(&_renderLock, 0, 1);
+}
+
+void Channel::waitForPrerendering() {
+	while (!atomicCompareExchange(&_renderLock, 0, 1))
+		g_system->delayMillis(1);
+}
+
+void Channel::prerender() {
+	const uint32 tail = atomicLoad(&_ringTail);
+	uint32 head = _ringHead;
+
+	while (head - tail < PRERENDER_BUFFER_SIZE && !_stream->endOfData()) {
+		const uint32 offset = head & (PRERENDER_BUFFER_SIZE - 1);
+		const uint32 frames = MIN<uint32>(PRERENDER_BUFFER_SIZE - (head - tail), PRERENDER_BUFFER_SIZE - offset);
+		st_sample_t *dst = _ring + offset * 2;
+
+		// Mixing into silence at full volume stores the converter output
+		// unchanged, mix() applies the channel volume later on.
+		memset(dst, 0, frames * 2 * sizeof(st_sample_t));
+		const int rendered = _converter->flow(*_stream, dst, frames, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+		if (rendered <= 0)
+			break;
+
+		head += rendered;
+		atomicStore(&_ringHead, head);
+	}
+
+	if (_stream->endOfStream())
+		atomicStore(&_streamEnded, 1);
+
+	atomicStore(&_renderLock, 0);
+}
+
+uint Channel::consumePrerendered(int16 *data, uint len) {
+	const uint32 head = atomicLoad(&_ringHead);
+	uint32 tail = _ringTail;
+	uint res = 0;
+
+	while (res < len && tail != head) {
+		const uint32 offset = tail & (PRERENDER_BUFFER_SIZE - 1);
+		const uint32 frames = MIN<uint32>(MIN<uint32>(len - res, head - tail), PRERENDER_BUFFER_SIZE - offset);
+		_mixProc(data + res * 2, _ring + offset * 2, frames, _volL, _volR);
+		res += frames;
+		tail += frames;
+	}
+
+	atomicStore(&_ringTail, tail);
+	return res;
+}
+
+int Channel::mixPrerendered(int16 *data, uint len) {
+	uint res = consumePrerendered(data, len);
+
+	// On an underrun the stream is read directly, unless the timer is busy
+	// with it. Then this channel is cut short, but the others still play.
+	if (res < len && atomicCompareExchange(&_renderLock, 0, 1)) {
+		// The timer may have completed a chunk before giving up the lock
+		res += consumePrerendered(data + res * 2, len - res);
+
+		if (res < len && !_stream->endOfData())
+			res += _converter->flow(*_stream, data + res * 2, len - res, _volL, _volR);
+
+		if (_stream->endOfStream())
+			atomicStore(&_streamEnded, 1);
+
+		atomicStore(&_renderLock, 0);
+	}
+
+	return res;
+}
+
 void Channel::setVolume(const byte volume) {
 	_volume = volume;
 	updateChannelVolumes();
@@ -611,7 +1239,13 @@ int Channel::mix(int16 *data, uint len) {
 	assert(_stream);
 
 	int res = 0;
-	if (_stream->endOfData()) {
+	if (_ring) {
+		_samplesConsumed = _samplesDecoded;
+		_mixerTimeStamp = g_system->getMillis(true);
+		_pauseTime = 0;
+		res = mixPrerendered(data, len);
+		_samplesDecoded += res;
+	} else if (_stream->endOfData()) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
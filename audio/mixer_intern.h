@@ -24,8 +24,11 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
+#include "common/queue.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -46,17 +49,30 @@ namespace Audio {
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
  *
+ * By default all methods and the mixer callback share a single mutex.
+ * Backends may instead enable the command queue mode (see
+ * setUseCommandQueue()), in which the mixer callback never waits on a
+ * mutex: control operations are passed to it through a lock-free ring
+ * buffer and the channel status is published through atomics.
+ *
+ * On top of the command queue mode, channels can be prerendered (see
+ * setUsePrerendering()): a timer decodes and resamples every channel
+ * ahead of time into a per channel ring buffer, so that the mixer callback
+ * is left with scaling and summing the buffered samples.
+ *
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		COMMAND_QUEUE_SIZE = 256 // Must be a power of two
 	};
 
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
+	RateConverterQuality _rateConverterQuality;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -70,6 +86,80 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * A control operation queued for the mixer callback in command queue
+	 * mode. Operations on a channel carry the slot index and the handle it
+	 * was issued for, so stale commands for reused slots are ignored.
+	 */
+	struct Command {
+		enum Type {
+			kPlay,
+			kStop,
+			kPause,
+			kPauseAll,
+			kVolume,
+			kBalance,
+			kGlobalVolume
+		};
+
+		Type type;
+		int index;
+		uint32 handle;
+		int value;
+	};
+
+	enum SlotState {
+		kSlotFree,     ///< Unused, may be taken by playStream()
+		kSlotActive,   ///< Channel handed over to (or queued for) the mixer callback
+		kSlotStopping, ///< Stop requested, the mixer callback still owns the channel
+		kSlotRetired   ///< Removed by the mixer callback, channel waits to be freed
+	};
+
+	/**
+	 * The engine side view of a channel slot in command queue mode. Only
+	 * the state is shared with the mixer callback; everything else is
+	 * guarded by _queueMutex.
+	 */
+	struct Slot {
+		Slot() : state(kSlotFree), channel(0), id(-1), type(kPlainSoundType), permanent(false), volume(kMaxChannelVolume), balance(0) {}
+
+		volatile uint32 state;
+		Channel *channel;
+		SoundHandle handle;
+		int id;
+		SoundType type;
+		bool permanent;
+		byte volume;
+		int8 balance;
+	};
+
+	bool _useCommandQueue;
+
+	/** Serializes the engine threads in command queue mode, never taken by mixCallback(). */
+	Common::Mutex _queueMutex;
+
+	Slot _slots[NUM_CHANNELS];
+
+	Command _commands[COMMAND_QUEUE_SIZE];
+	volatile uint32 _commandHead; ///< Only written by the engine side
+	volatile uint32 _commandTail; ///< Only written by mixCallback()
+
+	/**
+	 * Commands which did not fit into the ring. Every engine side entry
+	 * point flushes them in order once there is space again.
+	 */
+	Common::Queue<Command> _pendingCommands;
+
+	/**
+	 * Held by whoever consumes the command ring and touches _channels[]:
+	 * the mixer callback, or an engine thread waiting for a stop while the
+	 * callback is not running.
+	 */
+	volatile uint32 _consumerLock;
+
+	bool _usePrerendering;
+	volatile uint32 _prerenderTimerInstalled;
+
 
 public:
 
@@ -121,6 +211,28 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+private:
+	int mixChannels(byte *samples, uint len);
+
+	// Command queue mode
+	void playStreamQueued(SoundHandle *handle, Channel *chan, int id);
+	bool isSlotActive(int index) const;
+	int findActiveSlot(SoundHandle handle) const;
+	void stopSlot(int index);
+	void waitForStoppedSlots();
+	void pushCommand(Command::Type type, int index, uint32 handle, int value);
+	void flushPendingCommands();
+	bool tryPushCommand(const Command &cmd);
+	void reclaimRetiredSlots();
+	void processCommands();
+	void executeCommand(const Command &cmd);
+	void retireChannel(int index);
+
+	// Prerendering
+	void installPrerenderTimer();
+	static void prerenderTimerProc(void *refCon);
+	void prerenderChannels();
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -139,6 +251,32 @@ public:
 	 * their audio system has been completed.
 	 */
 	void setReady(bool ready);
+
+	/**
+	 * Switch the mixer to (or back from) the command queue mode. This must
+	 * be done before the mixer is marked as ready, while no sound is playing.
+	 *
+	 * In command queue mode, stopping a sound waits until the mixer
+	 * callback has dropped it, so streams which are not disposed by the
+	 * mixer may be deleted right afterwards, just like in the default mode.
+	 *
+	 * @return whether the requested mode is in effect
+	 */
+	bool setUseCommandQueue(bool enable);
+
+	/**
+	 * Enable prerendering of the channels. This requires the command queue
+	 * mode and must be done before the mixer is marked as ready.
+	 *
+	 * Channels then read from their streams up to 8192 sample frames
+	 * ahead of playback. Volume, balance, pause and stop requests still
+	 * take effect with the next mixer callback, but changes made to a
+	 * stream behind the mixer's back (e.g. seeking it) are only heard once
+	 * the buffered samples have been played.
+	 *
+	 * @return whether the requested mode is in effect
+	 */
+	bool setUsePrerendering(bool enable);
 };
 
 
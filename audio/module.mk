@@ -3,6 +3,7 @@ MODULE := audio
 MODULE_OBJS := \
 	adlib.o \
 	audiostream.o \
+	decode_ahead.o \
 	fmopl.o \
 	mididrv.o \
 	midiparser_qt.o \
@@ -16,6 +17,7 @@ MODULE_OBJS := \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	sound_cache.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
@@ -67,7 +69,25 @@ endif
 
 ifndef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
-	rate.o
+	rate.o \
+	rate_polyphase.o
+
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	rate_sse2.o
+$(MODULE)/rate_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	rate_avx2.o
+$(MODULE)/rate_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	rate_neon.o
+endif
 else
 MODULE_OBJS += \
 	rate_arm.o \
@@ -30,8 +30,10 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_intern.h"
 #include "audio/mixer.h"
 #include "common/frac.h"
+#include "common/system.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
@@ -57,6 +59,52 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+template<bool stereo, bool reverseStereo>
+static void mixBufferC(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; numFrames > 0; numFrames--) {
+		st_sample_t out0, out1;
+		out0 = *ibuf++;
+		out1 = (stereo ? *ibuf++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+MixBufferProc getMixBufferProcC(bool stereo, bool reverseStereo) {
+	if (!stereo)
+		return &mixBufferC<false, false>;
+	else if (reverseStereo)
+		return &mixBufferC<true, true>;
+	else
+		return &mixBufferC<true, false>;
+}
+
+MixBufferProc getMixBufferProc(bool stereo, bool reverseStereo) {
+	// The optimized routines rely on the signed saturating add
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	const OSystem::CpuExtension cpuExtension = OSystem::getCpuExtension();
+#ifdef SCUMMVM_AVX2
+	if (cpuExtension >= OSystem::kCpuExtensionAVX2)
+		return getMixBufferProcAVX2(stereo, reverseStereo);
+#endif
+#ifdef SCUMMVM_SSE2
+	if (cpuExtension >= OSystem::kCpuExtensionSSE2)
+		return getMixBufferProcSSE2(stereo, reverseStereo);
+#endif
+#ifdef SCUMMVM_NEON
+	if (cpuExtension == OSystem::kCpuExtensionNEON)
+		return getMixBufferProcNEON(stereo, reverseStereo);
+#endif
+#endif
+	return getMixBufferProcC(stereo, reverseStereo);
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -70,6 +118,10 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled samples, waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+	MixBufferProc mixProc;
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -105,6 +157,8 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 	opos_inc = inrate / outrate;
 
 	inLen = 0;
+
+	mixProc = getMixBufferProc(stereo, reverseStereo);
 }
 
 /*
@@ -118,38 +172,47 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		// Resample a chunk of input samples into the intermediate buffer
+		const st_size_t chunkFrames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *optr = outBuf;
+		st_sample_t *const ochunkEnd = outBuf + chunkFrames * (stereo ? 2 : 1);
+
+		while (optr < ochunkEnd) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (endOfInput)
+				break;
+
+			*optr++ = *inPtr++;
+			if (stereo)
+				*optr++ = *inPtr++;
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		obuf += 2;
+		// Mix the chunk into the output buffer
+		const st_size_t frames = (optr - outBuf) / (stereo ? 2 : 1);
+		mixProc(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -183,6 +246,10 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	/** interpolated samples, waiting to be mixed into the output */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+	MixBufferProc mixProc;
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -214,6 +281,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	icur0 = icur1 = 0;
 
 	inLen = 0;
+
+	mixProc = getMixBufferProc(stereo, reverseStereo);
 }
 
 /*
@@ -227,48 +296,57 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
-	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		// Interpolate a chunk of output samples into the intermediate
+		// buffer. Upsampling produces only a few samples per input sample,
+		// so mixing them in bigger chunks is much cheaper.
+		const st_size_t chunkFrames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *optr = outBuf;
+		st_sample_t *const ochunkEnd = outBuf + chunkFrames * (stereo ? 2 : 1);
+
+		while (optr < ochunkEnd) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						endOfInput = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			opos -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			if (endOfInput)
+				break;
 
-			obuf += 2;
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the intermediate buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && optr < ochunkEnd) {
+				// interpolate
+				*optr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*optr++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
 
-			// Increment output position
-			opos += opos_inc;
+				// Increment output position
+				opos += opos_inc;
+			}
 		}
+
+		// Mix the chunk into the output buffer
+		const st_size_t frames = (optr - outBuf) / (stereo ? 2 : 1);
+		mixProc(obuf, outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -284,8 +362,9 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
+	MixBufferProc _mixProc;
 public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	CopyRateConverter() : _buffer(0), _bufferSize(0), _mixProc(getMixBufferProc(stereo, reverseStereo)) {}
 	~CopyRateConverter() {
 		free(_buffer);
 	}
@@ -293,11 +372,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -312,24 +386,14 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		const int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		const st_size_t frames = len / (stereo ? 2 : 1);
+		_mixProc(obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -353,10 +417,22 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 	}
 }
 
+RateConverterQuality parseRateConverterQuality(const char *quality) {
+	if (!scumm_stricmp(quality, "high"))
+		return kRateConverterQualityHigh;
+	else if (!scumm_stricmp(quality, "medium"))
+		return kRateConverterQualityMedium;
+	else
+		return kRateConverterQualityLow;
+}
+
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
+	if (inrate != outrate && quality != kRateConverterQualityLow)
+		return makePolyphaseRateConverter(inrate, outrate, stereo, reverseStereo, quality == kRateConverterQualityHigh ? 32 : 16);
+
 	if (stereo) {
 		if (reverseStereo)
 			return makeRateConverter<true, true>(inrate, outrate);
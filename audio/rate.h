@@ -78,7 +78,42 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * Quality of the resampling done by a RateConverter.
+ */
+enum RateConverterQuality {
+	kRateConverterQualityLow,    ///< Nearest neighbour or linear interpolation
+	kRateConverterQualityMedium, ///< Windowed-sinc polyphase filter with 16 taps
+	kRateConverterQualityHigh    ///< Windowed-sinc polyphase filter with 32 taps
+};
+
+/**
+ * Parse a "resampling_quality" config value ("low", "medium" or "high").
+ * Unknown values map to kRateConverterQualityLow.
+ */
+RateConverterQuality parseRateConverterQuality(const char *quality);
+
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, RateConverterQuality quality = kRateConverterQualityLow);
+
+/**
+ * Precompute the filter tables of the polyphase rate converters for
+ * conversions of the common sample rates (11025, 22050, 44100 Hz ...) to
+ * the given output rate. Converters for other rates compute their own
+ * tables on creation.
+ *
+ * Every call must be paired with a call to freeRateConverterTables(), so
+ * that several mixers can share the tables. As the table cache is not
+ * locked, this must not run while rate converters are created on other
+ * threads (it is usually called on mixer creation).
+ */
+void prepareRateConverterTables(st_rate_t outrate, RateConverterQuality quality);
+
+/**
+ * Release the tables precomputed by prepareRateConverterTables(). They are
+ * freed once every preparation has been released, no rate converter using
+ * them may be alive anymore at that point.
+ */
+void freeRateConverterTables();
 
 } // End of namespace Audio
 
@@ -444,10 +444,22 @@ public:
 #pragma mark -
 
 
+RateConverterQuality parseRateConverterQuality(const char *quality) {
+	return kRateConverterQualityLow;
+}
+
+// The polyphase rate converter is not available with the ARM assembly
+// converters, so the quality setting is ignored.
+void prepareRateConverterTables(st_rate_t outrate, RateConverterQuality quality) {
+}
+
+void freeRateConverterTables() {
+}
+
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
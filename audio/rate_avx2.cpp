@@ -0,0 +1,112 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_intern.h"
+#include "audio/mixer.h"
+
+#include <immintrin.h>
+
+namespace Audio {
+
+/**
+ * Multiply sixteen samples by their volumes and divide the products by
+ * Mixer::kMaxMixerVolume, rounding towards zero like the C code does.
+ */
+static inline __m256i scaleSamplesAVX2(__m256i samples, __m256i volumes) {
+	const __m256i lo = _mm256_mullo_epi16(samples, volumes);
+	const __m256i hi = _mm256_mulhi_epi16(samples, volumes);
+	// Unpacking and packing both work per 128 bit lane, so the sample
+	// order is preserved.
+	__m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+	__m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+
+	const __m256i bias = _mm256_set1_epi32(Mixer::kMaxMixerVolume - 1);
+	p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), bias)), 8);
+
+	return _mm256_packs_epi32(p0, p1);
+}
+
+static inline void mixSamplesAVX2(st_sample_t *obuf, __m256i samples, __m256i volumes) {
+	const __m256i out = _mm256_loadu_si256((const __m256i *)obuf);
+	_mm256_storeu_si256((__m256i *)obuf, _mm256_adds_epi16(out, scaleSamplesAVX2(samples, volumes)));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixBufferAVX2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	// The 16 bit multiplications need volumes representable as int16
+	if (vol_l <= 0x7FFF && vol_r <= 0x7FFF) {
+		// With reversed stereo the input frames are swapped below, so the
+		// right volume applies to the first sample of each frame.
+		const __m256i volumes = reverseStereo ?
+			_mm256_set1_epi32((vol_l << 16) | vol_r) :
+			_mm256_set1_epi32((vol_r << 16) | vol_l);
+
+		if (stereo) {
+			for (; numFrames >= 8; numFrames -= 8) {
+				__m256i in = _mm256_loadu_si256((const __m256i *)ibuf);
+				if (reverseStereo) {
+					in = _mm256_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+					in = _mm256_shufflehi_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+				}
+				mixSamplesAVX2(obuf, in, volumes);
+				ibuf += 16;
+				obuf += 16;
+			}
+		} else {
+			for (; numFrames >= 16; numFrames -= 16) {
+				const __m256i in = _mm256_loadu_si256((const __m256i *)ibuf);
+				const __m256i lo = _mm256_unpacklo_epi16(in, in);
+				const __m256i hi = _mm256_unpackhi_epi16(in, in);
+				mixSamplesAVX2(obuf, _mm256_permute2x128_si256(lo, hi, 0x20), volumes);
+				mixSamplesAVX2(obuf + 16, _mm256_permute2x128_si256(lo, hi, 0x31), volumes);
+				ibuf += 16;
+				obuf += 32;
+			}
+		}
+	}
+
+	if (numFrames)
+		getMixBufferProcC(stereo, reverseStereo)(obuf, ibuf, numFrames, vol_l, vol_r);
+}
+
+int32 dotProductAVX2(const int16 *a, const int16 *b, uint len) {
+	__m256i sum = _mm256_setzero_si256();
+	for (uint i = 0; i < len; i += 16)
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(a + i)), _mm256_loadu_si256((const __m256i *)(b + i))));
+
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+}
+
+MixBufferProc getMixBufferProcAVX2(bool stereo, bool reverseStereo) {
+	if (!stereo)
+		return &mixBufferAVX2<false, false>;
+	else if (reverseStereo)
+		return &mixBufferAVX2<true, true>;
+	else
+		return &mixBufferAVX2<true, false>;
+}
+
+} // End of namespace Audio
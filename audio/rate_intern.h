@@ -0,0 +1,89 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_INTERN_H
+#define AUDIO_RATE_INTERN_H
+
+#include "audio/rate.h"
+
+namespace Audio {
+
+/**
+ * Mix numFrames sample frames from ibuf into obuf.
+ *
+ * The input is either mono or interleaved stereo, the output is always
+ * interleaved stereo. Every input sample is scaled by the channel volume
+ * (0 - Mixer::kMaxMixerVolume) and then added to the output with
+ * clamping, exactly as clampedAdd() does.
+ */
+typedef void (*MixBufferProc)(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t numFrames, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Return the fastest mixing routine the host CPU supports.
+ */
+MixBufferProc getMixBufferProc(bool stereo, bool reverseStereo);
+
+/**
+ * Return the portable mixing routine, which the optimized variants use
+ * for the frames they do not handle themselves.
+ */
+MixBufferProc getMixBufferProcC(bool stereo, bool reverseStereo);
+
+/**
+ * Compute the dot product of two vectors of 16 bit samples, as used by
+ * the FIR filter of the polyphase rate converter. The length must be a
+ * multiple of 16.
+ */
+typedef int32 (*DotProductProc)(const int16 *a, const int16 *b, uint len);
+
+/**
+ * Return the fastest dot product routine the host CPU supports.
+ */
+DotProductProc getDotProductProc();
+
+int32 dotProductC(const int16 *a, const int16 *b, uint len);
+
+#ifdef SCUMMVM_SSE2
+MixBufferProc getMixBufferProcSSE2(bool stereo, bool reverseStereo);
+int32 dotProductSSE2(const int16 *a, const int16 *b, uint len);
+#endif
+
+#ifdef SCUMMVM_AVX2
+MixBufferProc getMixBufferProcAVX2(bool stereo, bool reverseStereo);
+int32 dotProductAVX2(const int16 *a, const int16 *b, uint len);
+#endif
+
+#ifdef SCUMMVM_NEON
+MixBufferProc getMixBufferProcNEON(bool stereo, bool reverseStereo);
+int32 dotProductNEON(const int16 *a, const int16 *b, uint len);
+#endif
+
+/**
+ * Create a windowed-sinc polyphase rate converter.
+ *
+ * @param taps number of filter taps per output sample, a multiple of 16
+ */
+RateConverter *makePolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, uint taps);
+
+} // End of namespace Audio
+
+#endif
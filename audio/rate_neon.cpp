@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_intern.h"
+#include "audio/mixer.h"
+
+#include <arm_neon.h>
+
+namespace Audio {
+
+/**
+ * Multiply four samples by their volumes and divide the products by
+ * Mixer::kMaxMixerVolume, rounding towards zero like the C code does.
+ */
+static inline int16x4_t scaleSamplesNEON(int16x4_t samples, int16x4_t volumes) {
+	int32x4_t p = vmull_s16(samples, volumes);
+	const int32x4_t bias = vandq_s32(vshrq_n_s32(p, 31), vdupq_n_s32(Mixer::kMaxMixerVolume - 1));
+	p = vshrq_n_s32(vaddq_s32(p, bias), 8);
+	return vqmovn_s32(p);
+}
+
+static inline void mixSamplesNEON(st_sample_t *obuf, int16x8_t samples, int16x4_t volumes) {
+	const int16x8_t scaled = vcombine_s16(scaleSamplesNEON(vget_low_s16(samples), volumes), scaleSamplesNEON(vget_high_s16(samples), volumes));
+	vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), scaled));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixBufferNEON(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	// The 16 bit multiplications need volumes representable as int16
+	if (vol_l <= 0x7FFF && vol_r <= 0x7FFF) {
+		// With reversed stereo the input frames are swapped below, so the
+		// right volume applies to the first sample of each frame.
+		const int16x4_t volumes = vreinterpret_s16_u32(vdup_n_u32(reverseStereo ? ((vol_l << 16) | vol_r) : ((vol_r << 16) | vol_l)));
+
+		if (stereo) {
+			for (; numFrames >= 4; numFrames -= 4) {
+				int16x8_t in = vld1q_s16(ibuf);
+				if (reverseStereo)
+					in = vrev32q_s16(in);
+				mixSamplesNEON(obuf, in, volumes);
+				ibuf += 8;
+				obuf += 8;
+			}
+		} else {
+			for (; numFrames >= 8; numFrames -= 8) {
+				const int16x8_t in = vld1q_s16(ibuf);
+				const int16x8x2_t dup = vzipq_s16(in, in);
+				mixSamplesNEON(obuf, dup.val[0], volumes);
+				mixSamplesNEON(obuf + 8, dup.val[1], volumes);
+				ibuf += 8;
+				obuf += 16;
+			}
+		}
+	}
+
+	if (numFrames)
+		getMixBufferProcC(stereo, reverseStereo)(obuf, ibuf, numFrames, vol_l, vol_r);
+}
+
+int32 dotProductNEON(const int16 *a, const int16 *b, uint len) {
+	int32x4_t sum = vdupq_n_s32(0);
+	for (uint i = 0; i < len; i += 8) {
+		const int16x8_t va = vld1q_s16(a + i);
+		const int16x8_t vb = vld1q_s16(b + i);
+		sum = vmlal_s16(sum, vget_low_s16(va), vget_low_s16(vb));
+		sum = vmlal_s16(sum, vget_high_s16(va), vget_high_s16(vb));
+	}
+
+	int32x2_t sum2 = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	sum2 = vpadd_s32(sum2, sum2);
+	return vget_lane_s32(sum2, 0);
+}
+
+MixBufferProc getMixBufferProcNEON(bool stereo, bool reverseStereo) {
+	if (!stereo)
+		return &mixBufferNEON<false, false>;
+	else if (reverseStereo)
+		return &mixBufferNEON<true, true>;
+	else
+		return &mixBufferNEON<true, false>;
+}
+
+} // End of namespace Audio
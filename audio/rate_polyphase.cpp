@@ -0,0 +1,350 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Polyphase windowed-sinc rate converter.
+ *
+ * For a conversion ratio of L/M (output rate / input rate, reduced), the
+ * input is conceptually upsampled by L, low-pass filtered and decimated by
+ * M. Only the filter coefficients which hit actual input samples are ever
+ * evaluated: they are grouped into L phases of 'taps' coefficients each,
+ * and every output sample is the dot product of the last 'taps' input
+ * samples with one phase.
+ */
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+#include "audio/rate_intern.h"
+#include "common/algorithm.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+#include <math.h>
+
+namespace Audio {
+
+enum {
+	/** Fractional bits of the filter coefficients */
+	COEFF_BITS = 14,
+
+	/**
+	 * The maximal number of phases of a filter. Ratios which would need
+	 * more are approximated, like the linear converter does with its
+	 * fixed point increment.
+	 */
+	MAX_PHASES = 1024,
+
+	/** Size of the input and output buffers, in samples */
+	POLYPHASE_BUFFER_SIZE = 512,
+
+	/** Size of the per channel input history, in frames */
+	POLYPHASE_HISTORY_SIZE = 1024
+};
+
+int32 dotProductC(const int16 *a, const int16 *b, uint len) {
+	int32 sum = 0;
+	for (uint i = 0; i < len; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+DotProductProc getDotProductProc() {
+	const OSystem::CpuExtension cpuExtension = OSystem::getCpuExtension();
+#ifdef SCUMMVM_AVX2
+	if (cpuExtension >= OSystem::kCpuExtensionAVX2)
+		return &dotProductAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (cpuExtension >= OSystem::kCpuExtensionSSE2)
+		return &dotProductSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (cpuExtension == OSystem::kCpuExtensionNEON)
+		return &dotProductNEON;
+#endif
+	return &dotProductC;
+}
+
+/**
+ * The coefficients of a polyphase filter for one conversion ratio.
+ */
+struct PolyphaseFilter {
+	st_rate_t inrate;
+	st_rate_t outrate;
+	uint taps;
+
+	uint phases;    ///< L, the number of phases
+	uint posStep;   ///< M / L, whole input frames to advance per output frame
+	uint phaseStep; ///< M % L, phases to advance per output frame
+
+	/** phases * taps coefficients, in reverse order within each phase */
+	int16 *coefficients;
+
+	PolyphaseFilter(st_rate_t in, st_rate_t out, uint numTaps);
+	~PolyphaseFilter() { delete[] coefficients; }
+};
+
+/** Zeroth order modified Bessel function of the first kind, for the Kaiser window */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+	return sum;
+}
+
+PolyphaseFilter::PolyphaseFilter(st_rate_t in, st_rate_t out, uint numTaps) : inrate(in), outrate(out), taps(numTaps) {
+	assert(taps % 16 == 0);
+
+	uint l = out, m = in;
+	const uint divisor = Common::gcd<uint>(l, m);
+	l /= divisor;
+	m /= divisor;
+	if (l > MAX_PHASES) {
+		m = (uint)(((double)m * MAX_PHASES) / l + 0.5);
+		l = MAX_PHASES;
+	}
+
+	phases = l;
+	posStep = m / l;
+	phaseStep = m % l;
+	coefficients = new int16[phases * taps];
+
+	// Cut off slightly below the Nyquist frequency of the lower rate, in
+	// units of the input rate.
+	const double cutoff = 0.5 * 0.92 * MIN<double>(1.0, (double)l / m);
+	const double beta = 8.0;
+	const double center = (taps * l - 1) / 2.0;
+	const double i0Beta = besselI0(beta);
+
+	double *phase = new double[taps];
+	for (uint p = 0; p < phases; p++) {
+		double sum = 0;
+		for (uint j = 0; j < taps; j++) {
+			// Coefficient index in the prototype filter, which runs at
+			// the upsampled rate
+			const uint k = p + (taps - 1 - j) * l;
+			const double t = (k - center) / l;
+			const double x = 2 * cutoff * t;
+			const double sinc = (fabs(x) < 1e-9) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			const double w = (k - center) / center;
+			const double window = besselI0(beta * sqrt(MAX<double>(0.0, 1.0 - w * w))) / i0Beta;
+			phase[j] = sinc * window;
+			sum += phase[j];
+		}
+
+		// Normalize every phase to unity gain, and distribute the rounding
+		// error so that the quantized coefficients sum up exactly.
+		int16 *coeffs = coefficients + p * taps;
+		int total = 0;
+		for (uint j = 0; j < taps; j++) {
+			coeffs[j] = (int16)floor(phase[j] / sum * (1 << COEFF_BITS) + 0.5);
+			total += coeffs[j];
+		}
+		coeffs[taps / 2] += (1 << COEFF_BITS) - total;
+	}
+	delete[] phase;
+}
+
+/**
+ * Filters precomputed by prepareRateConverterTables(). Filters are only
+ * added while there are users and never change afterwards, so no locking
+ * is needed.
+ */
+static PolyphaseFilter *s_filterCache[32];
+static uint s_filterCacheSize = 0;
+static uint s_filterCacheUsers = 0;
+
+static const PolyphaseFilter *findCachedFilter(st_rate_t inrate, st_rate_t outrate, uint taps) {
+	for (uint i = 0; i < s_filterCacheSize; i++) {
+		const PolyphaseFilter *filter = s_filterCache[i];
+		if (filter->inrate == inrate && filter->outrate == outrate && filter->taps == taps)
+			return filter;
+	}
+	return 0;
+}
+
+void prepareRateConverterTables(st_rate_t outrate, RateConverterQuality quality) {
+	s_filterCacheUsers++;
+
+	if (quality == kRateConverterQualityLow)
+		return;
+
+	static const st_rate_t commonRates[] = { 8000, 11025, 16000, 22050, 32000, 44100, 48000 };
+	const uint taps = (quality == kRateConverterQualityHigh) ? 32 : 16;
+	for (uint i = 0; i < ARRAYSIZE(commonRates); i++) {
+		if (commonRates[i] == outrate || findCachedFilter(commonRates[i], outrate, taps))
+			continue;
+		if (s_filterCacheSize == ARRAYSIZE(s_filterCache))
+			break;
+		s_filterCache[s_filterCacheSize++] = new PolyphaseFilter(commonRates[i], outrate, taps);
+	}
+}
+
+void freeRateConverterTables() {
+	assert(s_filterCacheUsers > 0);
+	if (--s_filterCacheUsers)
+		return;
+
+	for (uint i = 0; i < s_filterCacheSize; i++)
+		delete s_filterCache[i];
+	s_filterCacheSize = 0;
+}
+
+template<bool stereo, bool reverseStereo>
+class PolyphaseRateConverter : public RateConverter {
+protected:
+	enum {
+		kChannels = stereo ? 2 : 1
+	};
+
+	const PolyphaseFilter *_filter;
+	PolyphaseFilter *_ownFilter;
+	DotProductProc _dotProduct;
+	MixBufferProc _mixProc;
+
+	st_sample_t _inBuf[POLYPHASE_BUFFER_SIZE];
+	st_sample_t _outBuf[POLYPHASE_BUFFER_SIZE];
+
+	/** The input samples, per channel. The filter window starts at _pos. */
+	int16 _history[kChannels][POLYPHASE_HISTORY_SIZE];
+	uint _historyLen;
+	uint _pos;
+	uint _phase;
+
+	bool fillHistory(AudioStream &input);
+
+	st_sample_t filterSample(const int16 *samples, const int16 *coeffs) const {
+		const int32 sum = _dotProduct(samples, coeffs, _filter->taps) + (1 << (COEFF_BITS - 1));
+		return (st_sample_t)CLIP<int32>(sum >> COEFF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+
+public:
+	PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, uint taps);
+	~PolyphaseRateConverter() { delete _ownFilter; }
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+PolyphaseRateConverter<stereo, reverseStereo>::PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, uint taps)
+	: _ownFilter(0), _dotProduct(getDotProductProc()), _mixProc(getMixBufferProc(stereo, reverseStereo)), _pos(0), _phase(0) {
+	_filter = findCachedFilter(inrate, outrate, taps);
+	if (!_filter)
+		_filter = _ownFilter = new PolyphaseFilter(inrate, outrate, taps);
+
+	// Start with a silent history, so that the first output sample is
+	// based on the first input sample.
+	_historyLen = taps - 1;
+	for (int c = 0; c < kChannels; c++)
+		memset(_history[c], 0, _historyLen * sizeof(int16));
+}
+
+template<bool stereo, bool reverseStereo>
+bool PolyphaseRateConverter<stereo, reverseStereo>::fillHistory(AudioStream &input) {
+	// Drop the samples the filter window has moved past
+	if (_pos >= _historyLen) {
+		_pos -= _historyLen;
+		_historyLen = 0;
+	} else if (_pos) {
+		for (int c = 0; c < kChannels; c++)
+			memmove(_history[c], _history[c] + _pos, (_historyLen - _pos) * sizeof(int16));
+		_historyLen -= _pos;
+		_pos = 0;
+	}
+
+	const uint frames = MIN<uint>(POLYPHASE_HISTORY_SIZE - _historyLen, POLYPHASE_BUFFER_SIZE / kChannels);
+	const int len = input.readBuffer(_inBuf, frames * kChannels);
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *in = _inBuf;
+	for (int i = 0; i < len / kChannels; i++) {
+		_history[0][_historyLen] = *in++;
+		if (stereo)
+			_history[1][_historyLen] = *in++;
+		_historyLen++;
+	}
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+int PolyphaseRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart = obuf;
+	st_sample_t *oend = obuf + osamp * 2;
+	const uint taps = _filter->taps;
+
+	bool endOfInput = false;
+	while (obuf < oend && !endOfInput) {
+		// Filter a chunk of output samples into the intermediate buffer
+		const st_size_t chunkFrames = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(_outBuf) / kChannels);
+		st_sample_t *optr = _outBuf;
+		st_size_t frames = 0;
+
+		while (frames < chunkFrames) {
+			if (_pos + taps > _historyLen) {
+				if (!fillHistory(input)) {
+					endOfInput = true;
+					break;
+				}
+				continue;
+			}
+
+			const int16 *coeffs = _filter->coefficients + _phase * taps;
+			*optr++ = filterSample(_history[0] + _pos, coeffs);
+			if (stereo)
+				*optr++ = filterSample(_history[1] + _pos, coeffs);
+			frames++;
+
+			_pos += _filter->posStep;
+			_phase += _filter->phaseStep;
+			if (_phase >= _filter->phases) {
+				_phase -= _filter->phases;
+				_pos++;
+			}
+		}
+
+		// Mix the chunk into the output buffer
+		_mixProc(obuf, _outBuf, frames, vol_l, vol_r);
+		obuf += frames * 2;
+	}
+	return (obuf - ostart) / 2;
+}
+
+RateConverter *makePolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, uint taps) {
+	if (stereo) {
+		if (reverseStereo)
+			return new PolyphaseRateConverter<true, true>(inrate, outrate, taps);
+		else
+			return new PolyphaseRateConverter<true, false>(inrate, outrate, taps);
+	} else
+		return new PolyphaseRateConverter<false, false>(inrate, outrate, taps);
+}
+
+} // End of namespace Audio
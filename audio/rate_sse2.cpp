@@ -0,0 +1,107 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_intern.h"
+#include "audio/mixer.h"
+
+#include <emmintrin.h>
+
+namespace Audio {
+
+/**
+ * Multiply eight samples by their volumes and divide the products by
+ * Mixer::kMaxMixerVolume, rounding towards zero like the C code does.
+ */
+static inline __m128i scaleSamplesSSE2(__m128i samples, __m128i volumes) {
+	const __m128i lo = _mm_mullo_epi16(samples, volumes);
+	const __m128i hi = _mm_mulhi_epi16(samples, volumes);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	const __m128i bias = _mm_set1_epi32(Mixer::kMaxMixerVolume - 1);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+
+	return _mm_packs_epi32(p0, p1);
+}
+
+static inline void mixSamplesSSE2(st_sample_t *obuf, __m128i samples, __m128i volumes) {
+	const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+	_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, scaleSamplesSSE2(samples, volumes)));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixBufferSSE2(st_sample_t *obuf, const st_sample_t *ibuf, st_size_t numFrames, st_volume_t vol_l, st_volume_t vol_r) {
+	// The 16 bit multiplications need volumes representable as int16
+	if (vol_l <= 0x7FFF && vol_r <= 0x7FFF) {
+		// With reversed stereo the input frames are swapped below, so the
+		// right volume applies to the first sample of each frame.
+		const __m128i volumes = reverseStereo ?
+			_mm_set_epi16(vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r) :
+			_mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+
+		if (stereo) {
+			for (; numFrames >= 4; numFrames -= 4) {
+				__m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+				if (reverseStereo) {
+					in = _mm_shufflelo_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+					in = _mm_shufflehi_epi16(in, _MM_SHUFFLE(2, 3, 0, 1));
+				}
+				mixSamplesSSE2(obuf, in, volumes);
+				ibuf += 8;
+				obuf += 8;
+			}
+		} else {
+			for (; numFrames >= 8; numFrames -= 8) {
+				const __m128i in = _mm_loadu_si128((const __m128i *)ibuf);
+				mixSamplesSSE2(obuf, _mm_unpacklo_epi16(in, in), volumes);
+				mixSamplesSSE2(obuf + 8, _mm_unpackhi_epi16(in, in), volumes);
+				ibuf += 8;
+				obuf += 16;
+			}
+		}
+	}
+
+	if (numFrames)
+		getMixBufferProcC(stereo, reverseStereo)(obuf, ibuf, numFrames, vol_l, vol_r);
+}
+
+int32 dotProductSSE2(const int16 *a, const int16 *b, uint len) {
+	__m128i sum = _mm_setzero_si128();
+	for (uint i = 0; i < len; i += 8)
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(a + i)), _mm_loadu_si128((const __m128i *)(b + i))));
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+MixBufferProc getMixBufferProcSSE2(bool stereo, bool reverseStereo) {
+	if (!stereo)
+		return &mixBufferSSE2<false, false>;
+	else if (reverseStereo)
+		return &mixBufferSSE2<true, true>;
+	else
+		return &mixBufferSSE2<true, false>;
+}
+
+} // End of namespace Audio
@@ -0,0 +1,216 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/sound_cache.h"
+#include "audio/audiostream.h"
+
+#include "common/array.h"
+#include "common/atomic.h"
+
+namespace Audio {
+
+/**
+ * The decoded samples of a sound, shared by the cache and the streams
+ * playing it. The streams are destroyed by the mixer thread, hence the
+ * reference count is atomic.
+ */
+class DecodedSound {
+public:
+	DecodedSound(int16 *samples, uint32 numSamples, int rate, bool stereo)
+		: _samples(samples), _numSamples(numSamples), _rate(rate), _stereo(stereo), _refCount(1) {}
+
+	const int16 *getSamples() const { return _samples; }
+	uint32 getNumSamples() const { return _numSamples; }
+	int getRate() const { return _rate; }
+	bool isStereo() const { return _stereo; }
+
+#ifdef SCUMMVM_HAVE_ATOMICS
+	void incRef() { Common::atomicAdd(&_refCount, 1); }
+
+	void decRef() {
+		if (!Common::atomicAdd(&_refCount, (uint32)-1))
+			delete this;
+	}
+#else
+	void incRef() { _refCount++; }
+
+	void decRef() {
+		if (!--_refCount)
+			delete this;
+	}
+#endif
+
+private:
+	~DecodedSound() { delete[] _samples; }
+
+	int16 *_samples;
+	const uint32 _numSamples;
+	const int _rate;
+	const bool _stereo;
+	volatile uint32 _refCount;
+};
+
+namespace {
+
+/**
+ * Plays a DecodedSound.
+ */
+class DecodedSoundStream : public SeekableAudioStream {
+public:
+	DecodedSoundStream(DecodedSound *sound) : _sound(sound), _pos(0) { _sound->incRef(); }
+	~DecodedSoundStream() { _sound->decRef(); }
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const uint32 samples = MIN<uint32>(numSamples, _sound->getNumSamples() - _pos);
+		memcpy(buffer, _sound->getSamples() + _pos, samples * sizeof(int16));
+		_pos += samples;
+		return samples;
+	}
+
+	bool isStereo() const { return _sound->isStereo(); }
+	int getRate() const { return _sound->getRate(); }
+	bool endOfData() const { return _pos >= _sound->getNumSamples(); }
+
+	bool seek(const Timestamp &where) {
+		_pos = MIN<uint32>(convertTimeToStreamPos(where, getRate(), isStereo()).totalNumberOfFrames(), _sound->getNumSamples());
+		return true;
+	}
+
+	Timestamp getLength() const {
+		return Timestamp(0, _sound->getNumSamples() / (isStereo() ? 2 : 1), getRate());
+	}
+
+private:
+	DecodedSound *_sound;
+	uint32 _pos;
+};
+
+} // End of anonymous namespace
+
+DecodedSoundCache::DecodedSoundCache(uint32 maxSize) : _maxSize(maxSize), _size(0) {
+}
+
+DecodedSoundCache::~DecodedSoundCache() {
+	clear();
+}
+
+SeekableAudioStream *DecodedSoundCache::get(const Common::String &name) {
+	EntryMap::iterator i = _entries.find(name);
+	if (i == _entries.end())
+		return 0;
+
+	_lru.erase(i->_value.lruPos);
+	_lru.push_front(name);
+	i->_value.lruPos = _lru.begin();
+
+#ifdef SCUMMVM_HAVE_ATOMICS
+	return new DecodedSoundStream(i->_value.sound);
+#else
+	// Without atomic operations the reference count cannot be shared with
+	// the mixer thread, so every stream gets its own copy of the samples.
+	const DecodedSound *sound = i->_value.sound;
+	int16 *samples = new int16[sound->getNumSamples()];
+	memcpy(samples, sound->getSamples(), sound->getNumSamples() * sizeof(int16));
+
+	DecodedSound *copy = new DecodedSound(samples, sound->getNumSamples(), sound->getRate(), sound->isStereo());
+	SeekableAudioStream *stream = new DecodedSoundStream(copy);
+	copy->decRef();
+	return stream;
+#endif
+}
+
+SeekableAudioStream *DecodedSoundCache::add(const Common::String &name, SeekableAudioStream *stream) {
+	remove(name);
+
+	const uint32 maxSamples = _maxSize / sizeof(int16);
+	const uint channels = stream->isStereo() ? 2 : 1;
+
+	// Skip the decoding when the length of the sound tells it is too large.
+	// Streams not knowing their length report zero.
+	const uint64 length = (uint64)stream->getLength().convertToFramerate(stream->getRate()).totalNumberOfFrames() * channels;
+	if (length > maxSamples)
+		return stream;
+
+	Common::Array<int16> samples;
+	samples.resize(MIN<uint32>(MAX<uint64>(length, 4096), maxSamples));
+
+	uint32 numSamples = 0;
+	while (!stream->endOfData()) {
+		if (numSamples == samples.size()) {
+			if (numSamples >= maxSamples) {
+				stream->rewind();
+				return stream;
+			}
+			samples.resize(MIN<uint32>(numSamples * 2, maxSamples));
+		}
+
+		const int read = stream->readBuffer(&samples[numSamples], samples.size() - numSamples);
+		if (read <= 0)
+			break;
+		numSamples += read;
+	}
+
+	int16 *data = new int16[MAX<uint32>(numSamples, 1)];
+	if (numSamples)
+		memcpy(data, &samples[0], numSamples * sizeof(int16));
+
+	DecodedSound *sound = new DecodedSound(data, numSamples, stream->getRate(), stream->isStereo());
+	delete stream;
+
+	_size += numSamples * sizeof(int16);
+	while (_size > _maxSize)
+		dropLeastRecentlyUsed();
+
+	_lru.push_front(name);
+	Entry &entry = _entries[name];
+	entry.sound = sound;
+	entry.lruPos = _lru.begin();
+
+	return new DecodedSoundStream(sound);
+}
+
+void DecodedSoundCache::remove(const Common::String &name) {
+	EntryMap::iterator i = _entries.find(name);
+	if (i == _entries.end())
+		return;
+
+	_size -= i->_value.sound->getNumSamples() * sizeof(int16);
+	i->_value.sound->decRef();
+	_lru.erase(i->_value.lruPos);
+	_entries.erase(i);
+}
+
+void DecodedSoundCache::clear() {
+	for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i)
+		i->_value.sound->decRef();
+
+	_entries.clear();
+	_lru.clear();
+	_size = 0;
+}
+
+void DecodedSoundCache::dropLeastRecentlyUsed() {
+	assert(!_lru.empty());
+	remove(_lru.back());
+}
+
+} // End of namespace Audio
@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_SOUND_CACHE_H
+#define AUDIO_SOUND_CACHE_H
+
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+namespace Audio {
+
+class DecodedSound;
+class SeekableAudioStream;
+
+/**
+ * Keeps short sounds, like sound effects, in memory once they have been
+ * decoded, so playing a sound again does not decode it again. The sounds
+ * are identified by a name, usually the name of the resource they were
+ * loaded from. When the decoded sounds take more than the given amount
+ * of memory, the least recently played ones are dropped.
+ *
+ * The cache itself is meant to be used from the engine thread only. The
+ * streams it returns may be played by the mixer, and stay valid after
+ * their sound has been dropped from the cache.
+ */
+class DecodedSoundCache : Common::NonCopyable {
+public:
+	/**
+	 * @param maxSize The memory the decoded samples may use, in bytes
+	 */
+	explicit DecodedSoundCache(uint32 maxSize);
+	~DecodedSoundCache();
+
+	/**
+	 * Return a new stream playing the named sound from the start, or 0 if
+	 * the sound is not cached.
+	 */
+	SeekableAudioStream *get(const Common::String &name);
+
+	/**
+	 * Decode the stream completely and cache the samples under the given
+	 * name, replacing any sound cached under the same name. Sounds taking
+	 * more memory than the whole cache are not cached; the stream is then
+	 * rewound and returned as is.
+	 *
+	 * @param name   The name to cache the sound under
+	 * @param stream The stream to decode, which is destroyed by the cache
+	 * @return a new stream playing the sound from the start
+	 */
+	SeekableAudioStream *add(const Common::String &name, SeekableAudioStream *stream);
+
+	/**
+	 * Drop the named sound from the cache.
+	 */
+	void remove(const Common::String &name);
+
+	/**
+	 * Drop all sounds from the cache.
+	 */
+	void clear();
+
+	/**
+	 * Return the memory taken by the cached sounds, in bytes.
+	 */
+	uint32 getSize() const { return _size; }
+
+private:
+	typedef Common::List<Common::String> NameList;
+
+	struct Entry {
+		DecodedSound *sound;
+		NameList::iterator lruPos;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void dropLeastRecentlyUsed();
+
+	const uint32 _maxSize;
+	uint32 _size;
+	EntryMap _entries;
+	NameList _lru; ///< Names of the cached sounds, most recently used first
+};
+
+} // End of namespace Audio
+
+#endif
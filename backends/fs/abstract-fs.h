@@ -173,6 +173,18 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the time of the last modification of the file
+	 * referred by this node. The time is in seconds, relative to an
+	 * unspecified epoch which stays the same across runs.
+	 *
+	 * @note By default, this method returns false.
+	 *
+	 * @return true if successful, false if the node does not refer to an
+	 *         existing file or if the backend can not provide the information.
+	 */
+	virtual bool getFileStats(int32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -25,9 +25,11 @@
 
 #include "backends/graphics/opengl/opengl-sys.h"
 
+#include "graphics/dirty_region.h"
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/rect.h"
 
 namespace OpenGL {
@@ -99,6 +101,19 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Copy image data of several areas to the texture.
+	 *
+	 * Every texture row covered by any of the areas is uploaded exactly
+	 * once.
+	 *
+	 * @param areas    The areas to update.
+	 * @param src      Surface for the whole texture containing the pixel data
+	 *                 to upload.
+	 * @return The number of texture rows uploaded.
+	 */
+	uint updateAreas(const Common::Array<Common::Rect> &areas, const Graphics::Surface &src);
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -201,7 +216,7 @@ public:
 	void fill(uint32 color);
 
 	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	virtual bool isDirty() const { return _allDirty || !_dirtyRegion.isEmpty(); }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -239,12 +254,18 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	void clearDirty() { _allDirty = false; _dirtyRegion.clear(); }
 
-	Common::Rect getDirtyArea() const;
+	/**
+	 * Obtain the areas changed since the last clearDirty call.
+	 *
+	 * Separate updates are kept apart instead of being merged into their
+	 * bounding box, as long as that saves converting unchanged pixels.
+	 */
+	Common::Array<Common::Rect> getDirtyAreas() const;
 private:
 	bool _allDirty;
-	Common::Rect _dirtyArea;
+	Graphics::DirtyRegion _dirtyRegion;
 };
 
 /**
@@ -0,0 +1,64 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/scaler-threads.h"
+#include "common/util.h"
+
+void ScalerThreadPool::scaleBand(void *band) {
+	const Band &b = *(const Band *)band;
+	b.scalerProc(b.srcPtr, b.srcPitch, b.dstPtr, b.dstPitch, b.width, b.height);
+}
+
+void ScalerThreadPool::scale(ScalerProc *scalerProc, const uint8 *srcPtr, uint32 srcPitch,
+                             uint8 *dstPtr, uint32 dstPitch, int width, int height, int scaleFactor) {
+	const int numBands = MIN<int>(getNumThreads(), height / kMinBandHeight);
+	if (numBands < 2) {
+		scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	// Bands start on multiples of 4 rows, so that the scalers depending on
+	// the row parity, like DotMatrix, give the same result
+	const int bandHeight = ((height + numBands - 1) / numBands + 3) & ~3;
+
+	void *jobs[kMaxThreads];
+	int n = 0;
+	for (int y = 0; y < height; y += bandHeight, n++) {
+		Band &band = _bands[n];
+		band.scalerProc = scalerProc;
+		band.srcPtr = srcPtr + y * srcPitch;
+		band.srcPitch = srcPitch;
+		band.dstPtr = dstPtr + y * scaleFactor * dstPitch;
+		band.dstPitch = dstPitch;
+		band.width = width;
+		band.height = MIN(bandHeight, height - y);
+		jobs[n] = &band;
+	}
+
+	runJobs(scaleBand, jobs, n);
+}
+
+#endif
@@ -0,0 +1,67 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALER_THREADS_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALER_THREADS_H
+
+#include "backends/jobs/sdl/sdl-thread-pool.h"
+#include "graphics/scaler.h"
+
+/**
+ * A pool of threads running a scaler on horizontal bands of a rectangle.
+ *
+ * The scalers only read from the source and write to disjoint rows of the
+ * destination, so the bands can be scaled in parallel.
+ */
+class ScalerThreadPool : public SdlThreadPool {
+public:
+	enum {
+		/** Rectangles are only split into bands of at least that many rows */
+		kMinBandHeight = 32
+	};
+
+	ScalerThreadPool(int numThreads) : SdlThreadPool(numThreads, "ScummVM scaler") {}
+
+	/**
+	 * Scale a rectangle like scalerProc would, and return once all bands
+	 * are done.
+	 */
+	void scale(ScalerProc *scalerProc, const uint8 *srcPtr, uint32 srcPitch,
+	           uint8 *dstPtr, uint32 dstPitch, int width, int height, int scaleFactor);
+
+private:
+	struct Band {
+		ScalerProc *scalerProc;
+		const uint8 *srcPtr;
+		uint32 srcPitch;
+		uint8 *dstPtr;
+		uint32 dstPitch;
+		int width;
+		int height;
+	};
+
+	static void scaleBand(void *band);
+
+	Band _bands[kMaxThreads];
+};
+
+#endif
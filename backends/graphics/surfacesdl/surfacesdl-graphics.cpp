@@ -24,6 +24,7 @@
 
 #if defined(SDL_BACKEND)
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
+#include "backends/graphics/surfacesdl/scaler-threads.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
@@ -142,11 +143,13 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_screenFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_cursorFormat(Graphics::PixelFormat::createFormatCLUT8()),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerThreads(0), _screenChangeCount(0),
 	_mouseData(nullptr), _mouseSurface(nullptr),
 	_mouseOrigSurface(nullptr), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
 	_paletteDirtyStart(0), _paletteDirtyEnd(0),
+	_dirtyRegion(NUM_DIRTY_RECT - NUM_REAL_DIRTY_RECT), _numRealDirtyRects(0), _numDirtyRects(0),
+	_numScaledPixels(0),
 	_screenIsLocked(false),
 	_graphicsMutex(0),
 	_displayDisabled(false),
@@ -188,6 +191,22 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_scalerType = 0;
 
+	// Large dirty rects are scaled by one thread per CPU core, unless
+	// configured otherwise. This matters most for HQ2x and HQ3x, which
+	// have no SIMD versions.
+	int scalerThreads = 0;
+	if (ConfMan.hasKey("scaler_threads"))
+		scalerThreads = ConfMan.getInt("scaler_threads");
+	if (scalerThreads <= 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		scalerThreads = SDL_GetCPUCount();
+#else
+		scalerThreads = 1;
+#endif
+	}
+	if (scalerThreads > 1)
+		_scalerThreads = new ScalerThreadPool(scalerThreads);
+
 #if !defined(_WIN32_WCE) && !defined(__SYMBIAN32__)
 	_videoMode.fullscreen = ConfMan.getBool("fullscreen");
 #else
@@ -217,6 +236,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	if (_mouseSurface) {
 		SDL_FreeSurface(_mouseSurface);
 	}
+	delete _scalerThreads;
 	g_system->deleteMutex(_graphicsMutex);
 	free(_currentPalette);
 	free(_cursorPalette);
@@ -1224,6 +1244,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
+		_numScaledPixels = 0;
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			int dst_y = r->y + _currentShakePos;
 			int dst_h = 0;
@@ -1246,8 +1268,14 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwScreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				if (_scalerThreads)
+					_scalerThreads->scale(scalerProc, (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwScreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h, scale1);
+				else
+					scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwScreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+
+				_numScaledPixels += r->w * dst_h;
 			}
 
 			r->x = rx1;
@@ -1263,6 +1291,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwScreen);
 
+		debug(9, "SurfaceSdlGraphicsManager: Scaled %u pixels in %d rects", _numScaledPixels, _numDirtyRects);
+
 		// Readjust the dirty rect list in case we are doing a full update.
 		// This is necessary if shaking is active.
 		if (_forceRedraw) {
@@ -1547,11 +1577,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceRedraw)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceRedraw = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1602,12 +1627,46 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	}
 
 	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+		if (_numDirtyRects == 0) {
+			_dirtyRegion.clear();
+			_numRealDirtyRects = 0;
+		}
+
+		if (realCoordinates) {
+			// Rects in real coordinates are added while drawing, when the
+			// list has already been scaled to the screen, so they are only
+			// appended
+			if (_numRealDirtyRects == NUM_REAL_DIRTY_RECT) {
+				_forceRedraw = true;
+				return;
+			}
+
+			SDL_Rect *r = &_realDirtyRectList[_numRealDirtyRects++];
 
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+			r->x = x;
+			r->y = y;
+			r->w = w;
+			r->h = h;
+
+			_dirtyRectList[_numDirtyRects++] = *r;
+		} else {
+			// Once the region is full, it merges the two rects cheapest to
+			// merge instead of forcing a full redraw
+			_dirtyRegion.add(Common::Rect(x, y, x + w, y + h));
+
+			const Common::Array<Common::Rect> &rects = _dirtyRegion.getRects();
+			for (_numDirtyRects = 0; _numDirtyRects < (int)rects.size(); ++_numDirtyRects) {
+				SDL_Rect *r = &_dirtyRectList[_numDirtyRects];
+
+				r->x = rects[_numDirtyRects].left;
+				r->y = rects[_numDirtyRects].top;
+				r->w = rects[_numDirtyRects].width();
+				r->h = rects[_numDirtyRects].height();
+			}
+
+			for (int i = 0; i < _numRealDirtyRects; ++i)
+				_dirtyRectList[_numDirtyRects++] = _realDirtyRectList[i];
+		}
 	}
 }
 
@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirty_region.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -59,6 +60,8 @@ enum {
 };
 
 
+class ScalerThreadPool;
+
 class AspectRatio {
 	int _kw, _kh;
 public:
@@ -274,6 +277,7 @@ protected:
 
 	ScalerProc *_scalerProc;
 	int _scalerType;
+	ScalerThreadPool *_scalerThreads;
 	int _transactionMode;
 
 	// Indicates whether it is needed to free _hwSurface in destructor
@@ -289,13 +293,25 @@ protected:
 
 	enum {
 		NUM_DIRTY_RECT = 100,
+		NUM_REAL_DIRTY_RECT = 8,
 		MAX_SCALING = 3
 	};
 
-	// Dirty rect management
+	// Dirty rect management. Rects in game or overlay coordinates are
+	// collected in _dirtyRegion, which merges them, and are mirrored at the
+	// start of _dirtyRectList, where drawing scales them. Rects in real
+	// coordinates, like the mouse cursor drawn after scaling, are kept in
+	// _realDirtyRectList and appended. Drawing resets _numDirtyRects, which
+	// empties both.
+	Graphics::DirtyRegion _dirtyRegion;
+	SDL_Rect _realDirtyRectList[NUM_REAL_DIRTY_RECT];
+	int _numRealDirtyRects;
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	/** Number of game or overlay pixels scaled by the last screen update */
+	uint32 _numScaledPixels;
+
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
 		int16 w, h;
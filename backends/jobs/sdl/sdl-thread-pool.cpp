@@ -0,0 +1,147 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/jobs/sdl/sdl-thread-pool.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SdlThreadPool::SdlThreadPool(int numThreads, const char *name) :
+		_numWorkers(0), _done(0), _runMutex(0), _jobMutex(0), _quit(false),
+		_proc(0), _jobs(0), _numJobs(0), _nextJob(0) {
+	numThreads = CLIP<int>(numThreads, 1, kMaxThreads);
+	if (numThreads == 1)
+		return;
+
+	_done = SDL_CreateSemaphore(0);
+	_runMutex = SDL_CreateMutex();
+	_jobMutex = SDL_CreateMutex();
+	if (!_done || !_runMutex || !_jobMutex) {
+		warning("Could not create %s thread pool: %s", name, SDL_GetError());
+		return;
+	}
+
+	while (_numWorkers < numThreads - 1) {
+		Worker &worker = _workers[_numWorkers];
+		worker.pool = this;
+		worker.start = SDL_CreateSemaphore(0);
+		if (!worker.start)
+			break;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		worker.thread = SDL_CreateThread(workerProc, name, &worker);
+#else
+		worker.thread = SDL_CreateThread(workerProc, &worker);
+#endif
+		if (!worker.thread) {
+			SDL_DestroySemaphore(worker.start);
+			break;
+		}
+
+		_numWorkers++;
+	}
+
+	if (_numWorkers < numThreads - 1)
+		warning("Could only start %d of %d %s threads: %s", _numWorkers, numThreads - 1, name, SDL_GetError());
+}
+
+SdlThreadPool::~SdlThreadPool() {
+	_quit = true;
+	for (int i = 0; i < _numWorkers; i++)
+		SDL_SemPost(_workers[i].start);
+
+	for (int i = 0; i < _numWorkers; i++) {
+		SDL_WaitThread(_workers[i].thread, NULL);
+		SDL_DestroySemaphore(_workers[i].start);
+	}
+
+	if (_jobMutex)
+		SDL_DestroyMutex(_jobMutex);
+	if (_runMutex)
+		SDL_DestroyMutex(_runMutex);
+	if (_done)
+		SDL_DestroySemaphore(_done);
+}
+
+int SDLCALL SdlThreadPool::workerProc(void *data) {
+	Worker &worker = *(Worker *)data;
+
+	for (;;) {
+		SDL_SemWait(worker.start);
+		if (worker.pool->_quit)
+			break;
+
+		worker.pool->runQueuedJobs();
+
+		SDL_SemPost(worker.pool->_done);
+	}
+
+	return 0;
+}
+
+void SdlThreadPool::runQueuedJobs() {
+	for (;;) {
+		SDL_LockMutex(_jobMutex);
+		const uint job = _nextJob;
+		if (job < _numJobs)
+			_nextJob++;
+		SDL_UnlockMutex(_jobMutex);
+
+		if (job >= _numJobs)
+			break;
+
+		_proc(_jobs[job]);
+	}
+}
+
+void SdlThreadPool::runJobs(OSystem::JobProc proc, void *const *jobs, uint numJobs) {
+	if (!_numWorkers || numJobs < 2) {
+		for (uint i = 0; i < numJobs; i++)
+			proc(jobs[i]);
+		return;
+	}
+
+	SDL_LockMutex(_runMutex);
+
+	_proc = proc;
+	_jobs = jobs;
+	_numJobs = numJobs;
+	_nextJob = 0;
+
+	// The calling thread runs jobs as well, so one worker less than there
+	// are jobs is enough
+	const int started = MIN<int>(_numWorkers, numJobs - 1);
+	for (int i = 0; i < started; i++)
+		SDL_SemPost(_workers[i].start);
+
+	runQueuedJobs();
+
+	for (int i = 0; i < started; i++)
+		SDL_SemWait(_done);
+
+	SDL_UnlockMutex(_runMutex);
+}
+
+#endif
@@ -0,0 +1,83 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_JOBS_SDL_THREAD_POOL_H
+#define BACKENDS_JOBS_SDL_THREAD_POOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/system.h"
+
+/**
+ * A pool of threads running independent jobs, which backs
+ * OSystem::runJobs() in the SDL backend.
+ *
+ * The calling thread takes part in running the jobs, so a pool of one
+ * thread starts no worker thread at all.
+ */
+class SdlThreadPool {
+public:
+	enum {
+		kMaxThreads = 8
+	};
+
+	/**
+	 * Start numThreads - 1 worker threads. Fewer are used if the threads
+	 * can't be created.
+	 */
+	SdlThreadPool(int numThreads, const char *name);
+	virtual ~SdlThreadPool();
+
+	/** Return the number of threads running jobs, including the calling one. */
+	int getNumThreads() const { return _numWorkers + 1; }
+
+	/**
+	 * Run proc on each of the jobs, and return once all of them are done.
+	 * Calls from several threads are run one after the other.
+	 */
+	void runJobs(OSystem::JobProc proc, void *const *jobs, uint numJobs);
+
+private:
+	struct Worker {
+		SdlThreadPool *pool;
+		SDL_Thread *thread;
+		SDL_sem *start;
+	};
+
+	static int SDLCALL workerProc(void *data);
+
+	/** Run the jobs of the current runJobs() call until none is left. */
+	void runQueuedJobs();
+
+	Worker _workers[kMaxThreads - 1];
+	int _numWorkers;
+	SDL_sem *_done;
+	SDL_mutex *_runMutex; ///< Held for a whole runJobs() call
+	SDL_mutex *_jobMutex; ///< Protects _nextJob
+	bool _quit;
+
+	OSystem::JobProc _proc;
+	void *const *_jobs;
+	uint _numJobs;
+	uint _nextJob;
+};
+
+#endif
@@ -120,6 +120,19 @@ void SdlMixerManager::init() {
 
 	_mixer = new Audio::MixerImpl(g_system, _obtained.freq);
 	assert(_mixer);
+
+	// Advanced users can let the audio callback run without ever waiting
+	// for the engine threads by enabling the command queue mode in their
+	// ScummVM config file. Prerendering builds on top of it.
+	const char *const appDomain = Common::ConfigManager::kApplicationDomain;
+	const bool prerender = ConfMan.hasKey("mixer_prerender", appDomain) && ConfMan.getBool("mixer_prerender", appDomain);
+	if (prerender || (ConfMan.hasKey("mixer_command_queue", appDomain) && ConfMan.getBool("mixer_command_queue", appDomain))) {
+		if (_mixer->setUseCommandQueue(true))
+			debug(1, "Using mixer command queue");
+	}
+	if (prerender && _mixer->setUsePrerendering(true))
+		debug(1, "Using mixer prerendering");
+
 	_mixer->setReady(true);
 
 	startAudio();
@@ -138,7 +138,9 @@ ifdef SDL_BACKEND
 MODULE_OBJS += \
 	events/sdl/sdl-events.o \
 	graphics/sdl/sdl-graphics.o \
+	graphics/surfacesdl/scaler-threads.o \
 	graphics/surfacesdl/surfacesdl-graphics.o \
+	jobs/sdl/sdl-thread-pool.o \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
@@ -172,6 +172,42 @@ void OSystem_POSIX::addSysArchivesToSearchSet(Common::SearchSet &s, int priority
 	OSystem_SDL::addSysArchivesToSearchSet(s, priority);
 }
 
+Common::String OSystem_POSIX::getDefaultCachePath() {
+	const char *prefix = nullptr;
+	Common::String cachePath;
+#ifdef MACOSX
+	prefix = getenv("HOME");
+	if (prefix == nullptr) {
+		return Common::String();
+	}
+
+	cachePath = "Library/Caches/ScummVM";
+#elif SAMSUNGTV
+	return Common::String();
+#else
+	// On POSIX systems we follow the XDG Base Directory Specification for
+	// where to store files. The version we based our code upon can be found
+	// over here: http://standards.freedesktop.org/basedir-spec/basedir-spec-0.8.html
+	prefix = getenv("XDG_CACHE_HOME");
+	if (prefix == nullptr || !*prefix) {
+		prefix = getenv("HOME");
+		if (prefix == nullptr) {
+			return Common::String();
+		}
+
+		cachePath = ".cache/";
+	}
+
+	cachePath += "scummvm";
+#endif
+
+	if (!Posix::assureDirectoryExists(cachePath, prefix)) {
+		return Common::String();
+	}
+
+	return Common::String::format("%s/%s", prefix, cachePath.c_str());
+}
+
 Common::WriteStream *OSystem_POSIX::createLogFile() {
 	// Start out by resetting _logFilePath, so that in case
 	// of a failure, we know that no log file is open.
@@ -42,6 +42,8 @@ public:
 
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority = 0);
 
+	virtual Common::String getDefaultCachePath();
+
 protected:
 	/**
 	 * Base string for creating the default path and filename for the
@@ -45,6 +45,7 @@
 
 #include "backends/events/default/default-events.h"
 #include "backends/events/sdl/sdl-events.h"
+#include "backends/jobs/sdl/sdl-thread-pool.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
@@ -88,7 +89,8 @@ OSystem_SDL::OSystem_SDL()
 	_logger(0),
 	_mixerManager(0),
 	_eventSource(0),
-	_window(0) {
+	_window(0),
+	_jobThreads(0) {
 
 	ConfMan.registerDefault("kbdmouse_speed", 3);
 	ConfMan.registerDefault("joystick_deadzone", 3);
@@ -118,6 +120,8 @@ OSystem_SDL::~OSystem_SDL() {
 	_audiocdManager = 0;
 	delete _mixerManager;
 	_mixerManager = 0;
+	delete _jobThreads;
+	_jobThreads = 0;
 
 #ifdef ENABLE_EVENTRECORDER
 	// HACK HACK HACK
@@ -186,6 +190,16 @@ bool OSystem_SDL::hasFeature(Feature f) {
 		bool joystickSupportEnabled = ConfMan.getInt("joystick_num") >= 0;
 		return joystickSupportEnabled;
 	}
+	if (f == kFeatureCpuSSE2)
+		return SDL_HasSSE2();
+#if SDL_VERSION_ATLEAST(2, 0, 4)
+	if (f == kFeatureCpuAVX2)
+		return SDL_HasAVX2();
+#endif
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+	if (f == kFeatureCpuNEON)
+		return SDL_HasNEON();
+#endif
 	return ModularBackend::hasFeature(f);
 }
 
@@ -286,6 +300,14 @@ void OSystem_SDL::initBackend() {
 
 	_audiocdManager = createAudioCDManager();
 
+	if (_jobThreads == 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		_jobThreads = new SdlThreadPool(SDL_GetCPUCount(), "ScummVM jobs");
+#else
+		_jobThreads = new SdlThreadPool(1, "ScummVM jobs");
+#endif
+	}
+
 	// Setup a custom program icon.
 	_window->setupIcon();
 
@@ -582,6 +604,13 @@ Common::SaveFileManager *OSystem_SDL::getSavefileManager() {
 #endif
 }
 
+void OSystem_SDL::runJobs(JobProc proc, void *const *jobs, uint numJobs) {
+	if (_jobThreads)
+		_jobThreads->runJobs(proc, jobs, numJobs);
+	else
+		ModularBackend::runJobs(proc, jobs, numJobs);
+}
+
 //Not specified in base class
 Common::String OSystem_SDL::getScreenshotsPath() {
 	Common::String path = ConfMan.get("screenshotpath");
@@ -33,6 +33,8 @@
 
 #include "common/array.h"
 
+class SdlThreadPool;
+
 /**
  * Base OSystem class for all SDL ports.
  */
@@ -81,6 +83,7 @@ public:
 	virtual Audio::Mixer *getMixer();
 	virtual Common::TimerManager *getTimerManager();
 	virtual Common::SaveFileManager *getSavefileManager();
+	virtual void runJobs(JobProc proc, void *const *jobs, uint numJobs);
 
 	//Screenshots
 	virtual Common::String getScreenshotsPath();
@@ -108,6 +111,11 @@ protected:
 	 */
 	SdlWindow *_window;
 
+	/**
+	 * The threads running the jobs passed to runJobs().
+	 */
+	SdlThreadPool *_jobThreads;
+
 	virtual Common::EventSource *getDefaultEventSource() { return _eventSource; }
 
 	/**
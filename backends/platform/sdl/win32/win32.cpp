@@ -242,6 +242,28 @@ Common::String OSystem_Win32::getDefaultConfigFileName() {
 	return configFile;
 }
 
+Common::String OSystem_Win32::getDefaultCachePath() {
+	char cachePath[MAXPATHLEN];
+
+	// Use the local Application Data directory, which does not roam with
+	// the user profile. It only exists since Windows Vista.
+	// A value which does not fit leaves the buffer unterminated, and the
+	// size it needs is returned
+	uint ret = GetEnvironmentVariable("LOCALAPPDATA", cachePath, sizeof(cachePath));
+	if (ret == 0 || ret + strlen("\\ScummVM\\Cache") >= sizeof(cachePath))
+		return Common::String();
+
+	strcat(cachePath, "\\ScummVM");
+	CreateDirectory(cachePath, NULL);
+	strcat(cachePath, "\\Cache");
+	if (!CreateDirectory(cachePath, NULL)) {
+		if (GetLastError() != ERROR_ALREADY_EXISTS)
+			return Common::String();
+	}
+
+	return cachePath;
+}
+
 Common::WriteStream *OSystem_Win32::createLogFile() {
 	// Start out by resetting _logFilePath, so that in case
 	// of a failure, we know that no log file is open.
@@ -52,6 +52,7 @@ protected:
 	Common::String _logFilePath;
 
 	virtual Common::String getDefaultConfigFileName();
+	virtual Common::String getDefaultCachePath();
 	virtual Common::WriteStream *createLogFile();
 
 	// Override createAudioCDManager() to get our Mac-specific
@@ -27,6 +27,7 @@
 
 #include <limits.h>
 
+#include "engines/massDetector.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
 #include "base/plugins.h"
@@ -856,16 +857,18 @@ static bool addGameToConf(const GameDescriptor &gd) {
 }
 
 static GameList recListGames(const Common::FSNode &dir, const Common::String &gameId, bool recursive) {
-	GameList list = getGameList(dir);
-
-	if (recursive) {
-		Common::FSList files;
-		dir.getChildren(files, Common::FSNode::kListDirectoriesOnly);
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			GameList rec = recListGames(*file, gameId, recursive);
-			for (GameList::const_iterator game = rec.begin(); game != rec.end(); ++game) {
-				if (gameId.empty() || game->gameid().c_str() == gameId)
-					list.push_back(*game);
+	if (!recursive)
+		return getGameList(dir);
+
+	GameList list;
+	MassDetector detector(dir, true);
+	Common::FSNode gameDir;
+	GameList candidates;
+	while (detector.detectNext(gameDir, candidates)) {
+		for (GameList::iterator game = candidates.begin(); game != candidates.end(); ++game) {
+			if (gameId.empty() || game->gameid().c_str() == gameId) {
+				(*game)["path"] = gameDir.getPath();
+				list.push_back(*game);
 			}
 		}
 	}
@@ -902,7 +905,7 @@ static Common::String detectGames(const Common::String &path, const Common::Stri
 
 static int recAddGames(const Common::FSNode &dir, const Common::String &game, bool recursive) {
 	int count = 0;
-	GameList list = getGameList(dir);
+	GameList list = recListGames(dir, Common::String(), recursive);
 	for (GameList::iterator v = list.begin(); v != list.end(); ++v) {
 		if (v->gameid().c_str() != game && !game.empty()) {
 			printf("Found %s, only adding %s per --game option, ignoring...\n", v->gameid().c_str(), game.c_str());
@@ -915,15 +918,6 @@ static int recAddGames(const Common::FSNode &dir, const Common::String &game, bo
 		}
 	}
 
-	if (recursive) {
-		Common::FSList files;
-		if (dir.getChildren(files, Common::FSNode::kListDirectoriesOnly)) {
-			for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-				count += recAddGames(*file, game, recursive);
-			}
-		}
-	}
-
 	return count;
 }
 
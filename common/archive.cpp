@@ -98,6 +98,9 @@ void SearchSet::add(const String &name, Archive *archive, int priority, bool aut
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+
+		if (_useIndex && _indexValid)
+			indexNode(*find(name));
 	} else {
 		if (autoFree)
 			delete archive;
@@ -173,6 +176,7 @@ void SearchSet::remove(const String &name) {
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		_indexValid = false;
 	}
 }
 
@@ -187,6 +191,9 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_index.clear();
+	_unindexedCount = 0;
+	_indexValid = false;
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -203,19 +210,98 @@ void SearchSet::setPriority(const String &name, int priority) {
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
+	_indexValid = false;
 }
 
-bool SearchSet::hasFile(const String &name) const {
-	if (name.empty())
-		return false;
+void SearchSet::setIndexed(bool enable) {
+	_useIndex = enable;
+	_index.clear();
+	_unindexedCount = 0;
+	_indexValid = false;
+}
 
+void SearchSet::indexNode(const Node &node) const {
+	StringArray names;
+	node._indexed = node._arc->listMemberNames(names);
+	if (!node._indexed) {
+		_unindexedCount++;
+		return;
+	}
+
+	for (StringArray::const_iterator name = names.begin(); name != names.end(); ++name) {
+		NameIndex::iterator entry = _index.find(*name);
+		if (entry == _index.end() || entry->_value._priority < node._priority) {
+			IndexEntry &newEntry = _index[*name];
+			newEntry._arc = node._arc;
+			newEntry._priority = node._priority;
+		}
+	}
+}
+
+void SearchSet::updateIndex() const {
+	if (_indexValid)
+		return;
+
+	_index.clear();
+	_unindexedCount = 0;
+
+	// Nodes are sorted by descending priority, so the first archive
+	// containing a member keeps it
+	ArchiveNodeList::const_iterator it = _list.begin();
+	for (; it != _list.end(); ++it)
+		indexNode(*it);
+
+	_indexValid = true;
+}
+
+Archive *SearchSet::findArchive(const String &name) const {
 	ArchiveNodeList::const_iterator it = _list.begin();
+
+	if (_useIndex) {
+		updateIndex();
+
+		NameIndex::const_iterator entry = _index.find(name);
+		const Archive *indexed = (entry != _index.end()) ? entry->_value._arc : 0;
+
+		if (!_unindexedCount) {
+			if (!indexed)
+				return 0;
+			if (indexed->hasFile(name))
+				return entry->_value._arc;
+		} else {
+			// Only the archives which could not be indexed need to be
+			// asked, up to the one the index points to
+			for (; it != _list.end(); ++it) {
+				if (it->_indexed && it->_arc != indexed)
+					continue;
+				if (it->_arc->hasFile(name))
+					return it->_arc;
+				if (it->_arc == indexed)
+					break;
+			}
+
+			if (!indexed)
+				return 0;
+		}
+
+		// The member has disappeared from the archive the index points to,
+		// so fall back to asking every archive
+		it = _list.begin();
+	}
+
 	for (; it != _list.end(); ++it) {
 		if (it->_arc->hasFile(name))
-			return true;
+			return it->_arc;
 	}
 
-	return false;
+	return 0;
+}
+
+bool SearchSet::hasFile(const String &name) const {
+	if (name.empty())
+		return false;
+
+	return findArchive(name) != 0;
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -242,19 +328,22 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return it->_arc->getMember(name);
-	}
+	Archive *arc = findArchive(name);
+	if (!arc)
+		return ArchiveMemberPtr();
 
-	return ArchiveMemberPtr();
+	return arc->getMember(name);
 }
 
 SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) const {
 	if (name.empty())
 		return 0;
 
+	if (_useIndex) {
+		Archive *arc = findArchive(name);
+		return arc ? arc->createReadStreamForMember(name) : 0;
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
@@ -267,6 +356,7 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 
 
 SearchManager::SearchManager() {
+	setIndexed(true);
 	clear();    // Force a reset
 }
 
@@ -24,6 +24,9 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/str-array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -112,6 +115,16 @@ public:
 	 */
 	virtual int listMembers(ArchiveMemberList &list) const = 0;
 
+	/**
+	 * Add the names of all members of the Archive to names, exactly as
+	 * hasFile() and createReadStreamForMember() accept them. This is what
+	 * allows a SearchSet to index the Archive.
+	 *
+	 * @return false if the Archive can not list its members this way, or
+	 *         if they may change over time
+	 */
+	virtual bool listMemberNames(StringArray &names) const { return false; }
+
 	/**
 	 * Returns a ArchiveMember representation of the given file.
 	 */
@@ -132,6 +145,12 @@ public:
  * contained Archives, hence the simplistic policy of always looking for the first
  * match. SearchSet *DOES* guarantee that searches are performed in *DESCENDING*
  * priority order. In case of conflicting priorities, insertion order prevails.
+ *
+ * Optionally, a SearchSet can maintain an index mapping member names to the
+ * archive with the highest priority containing them (see setIndexed()). This
+ * turns lookups into a single hash lookup instead of asking every archive in
+ * turn. Archives which can not list their members (see
+ * Archive::listMemberNames()) are still asked in priority order.
  */
 class SearchSet : public Archive {
 	struct Node {
@@ -139,20 +158,43 @@ class SearchSet : public Archive {
 		String	_name;
 		Archive	*_arc;
 		bool	_autoFree;
+		mutable bool	_indexed;
 		Node(int priority, const String &name, Archive *arc, bool autoFree)
-			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree) {
+			: _priority(priority), _name(name), _arc(arc), _autoFree(autoFree), _indexed(false) {
 		}
 	};
 	typedef List<Node> ArchiveNodeList;
 	ArchiveNodeList _list;
 
+	struct IndexEntry {
+		Archive	*_arc;
+		int		_priority;
+	};
+	typedef HashMap<String, IndexEntry, IgnoreCase_Hash, IgnoreCase_EqualTo> NameIndex;
+
+	bool _useIndex;
+	mutable bool _indexValid;
+	mutable NameIndex _index;
+	mutable uint _unindexedCount;	// number of archives which could not be indexed
+
 	ArchiveNodeList::iterator find(const String &name);
 	ArchiveNodeList::const_iterator find(const String &name) const;
 
 	// Add an archive keeping the list sorted by descending priority.
 	void insert(const Node& node);
 
+	// Add the members of an archive to the index, unless a previously
+	// indexed archive with a higher or equal priority contains them.
+	void indexNode(const Node &node) const;
+
+	// Rebuild the index if it has been invalidated.
+	void updateIndex() const;
+
+	// Find the archive to serve the given member from, or 0.
+	Archive *findArchive(const String &name) const;
+
 public:
+	SearchSet() : _useIndex(false), _indexValid(false), _unindexedCount(0) {}
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -236,6 +278,17 @@ public:
 	 */
 	void setPriority(const String& name, int priority);
 
+	/**
+	 * Enable or disable the member name index. The index is built on the
+	 * first lookup after it has been enabled, and kept up to date when
+	 * archives are added. Removing an archive or changing its priority
+	 * causes the index to be rebuilt on the next lookup.
+	 *
+	 * Archives are assumed not to change their members while they are part
+	 * of an indexed SearchSet, except for members disappearing.
+	 */
+	void setIndexed(bool enable);
+
 	virtual bool hasFile(const String &name) const;
 	virtual int listMatchingMembers(ArchiveMemberList &list, const String &pattern) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Minimal set of atomic operations on 32-bit words, for the few places
+ * (like the audio mixer) which need to exchange data between threads
+ * without taking an OSystem mutex.
+ *
+ * Loads have acquire semantics and stores have release semantics. The
+ * read-modify-write operations are full barriers.
+ *
+ * SCUMMVM_HAVE_ATOMICS is defined when the compiler provides the
+ * required intrinsics. Code using these functions must provide a
+ * (mutex based) fallback for when it is not defined.
+ */
+
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7))
+#define SCUMMVM_HAVE_ATOMICS
+#define SCUMMVM_ATOMICS_GCC
+#elif defined(__clang__)
+#define SCUMMVM_HAVE_ATOMICS
+#define SCUMMVM_ATOMICS_GCC
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define SCUMMVM_HAVE_ATOMICS
+#define SCUMMVM_ATOMICS_MSVC
+#endif
+
+#ifdef SCUMMVM_HAVE_ATOMICS
+
+namespace Common {
+
+#if defined(SCUMMVM_ATOMICS_GCC)
+
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 value) {
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+
+inline uint32 atomicExchange(volatile uint32 *ptr, uint32 value) {
+	return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Replace the value at ptr with desired if it currently equals expected.
+ *
+ * @return true if the value was replaced
+ */
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Add delta to the value at ptr.
+ *
+ * @return the new value
+ */
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 delta) {
+	return __atomic_add_fetch(ptr, delta, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(SCUMMVM_ATOMICS_MSVC)
+
+// MSVC gives volatile accesses acquire/release semantics by default
+// (/volatile:ms), the compiler barriers prevent reordering around them.
+inline uint32 atomicLoad(const volatile uint32 *ptr) {
+	uint32 value = *ptr;
+	_ReadWriteBarrier();
+	return value;
+}
+
+inline void atomicStore(volatile uint32 *ptr, uint32 value) {
+	_ReadWriteBarrier();
+	*ptr = value;
+}
+
+inline uint32 atomicExchange(volatile uint32 *ptr, uint32 value) {
+	return (uint32)_InterlockedExchange((volatile long *)ptr, (long)value);
+}
+
+inline bool atomicCompareExchange(volatile uint32 *ptr, uint32 expected, uint32 desired) {
+	return (uint32)_InterlockedCompareExchange((volatile long *)ptr, (long)desired, (long)expected) == expected;
+}
+
+inline uint32 atomicAdd(volatile uint32 *ptr, uint32 delta) {
+	return (uint32)_InterlockedExchangeAdd((volatile long *)ptr, (long)delta) + delta;
+}
+
+#endif
+
+} // End of namespace Common
+
+#endif // SCUMMVM_HAVE_ATOMICS
+
+#endif
@@ -24,6 +24,8 @@
 #include "common/debug.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
@@ -78,6 +80,7 @@ void ConfigManager::copyFrom(ConfigManager &source) {
 	_activeDomainName = source._activeDomainName;
 	_activeDomain = &_gameDomains[_activeDomainName];
 	_filename = source._filename;
+	_flushedDigest = source._flushedDigest;
 }
 
 
@@ -86,6 +89,7 @@ void ConfigManager::loadDefaultConfigFile() {
 	assert(g_system);
 	SeekableReadStream *stream = g_system->createConfigReadStream();
 	_filename.clear();  // clear the filename to indicate that we are using the default config file
+	_flushedDigest.clear();
 
 	// ... load it, if available ...
 	if (stream) {
@@ -104,6 +108,7 @@ void ConfigManager::loadDefaultConfigFile() {
 
 void ConfigManager::loadConfigFile(const String &filename) {
 	_filename = filename;
+	_flushedDigest.clear();
 
 	FSNode node(filename);
 	File cfg_file;
@@ -175,41 +180,59 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 	_cloudDomain.clear();
 #endif
 
+	// The file on disk is not the one flushToDisk() wrote last anymore
+	_flushedDigest.clear();
+
+	// Read the whole file at once and parse it in place, so that only the
+	// resulting keys, values and comments are allocated.
+	const int32 size = MAX<int32>(stream.size() - stream.pos(), 0);
+	char *buffer = new char[size + 1];
+	const char *const bufferEnd = buffer + stream.read(buffer, size);
+
 	// TODO: Detect if a domain occurs multiple times (or likewise, if
 	// a key occurs multiple times inside one domain).
 
-	while (!stream.eos() && !stream.err()) {
+	for (const char *line = buffer, *lineEnd; line < bufferEnd; line = lineEnd) {
 		lineno++;
 
-		// Read a line
-		String line = stream.readLine();
+		// Find the end of the line. CR, LF and CR/LF line breaks are accepted.
+		const char *end = line;
+		while (end < bufferEnd && *end != '\r' && *end != '\n')
+			end++;
+
+		lineEnd = end;
+		if (lineEnd < bufferEnd) {
+			if (*lineEnd == '\r' && lineEnd + 1 < bufferEnd && lineEnd[1] == '\n')
+				lineEnd++;
+			lineEnd++;
+		}
 
-		if (line.size() == 0) {
+		if (line == end) {
 			// Do nothing
 		} else if (line[0] == '#') {
 			// Accumulate comments here. Once we encounter either the start
 			// of a new domain, or a key-value-pair, we associate the value
 			// of the 'comment' variable with that entity.
-			comment += line;
+			comment += String(line, end);
 			comment += "\n";
 		} else if (line[0] == '[') {
 			// It's a new domain which begins here.
 			// Determine where the previously accumulated domain goes, if we accumulated anything.
 			addDomain(domainName, domain);
-			domain.clear();
-			const char *p = line.c_str() + 1;
+			domain = Domain();
+			const char *p = line + 1;
 			// Get the domain name, and check whether it's valid (that
 			// is, verify that it only consists of alphanumerics,
 			// dashes and underscores).
-			while (*p && (isAlnum(*p) || *p == '-' || *p == '_'))
+			while (p < end && (isAlnum(*p) || *p == '-' || *p == '_'))
 				p++;
 
-			if (*p == '\0')
+			if (p == end)
 				error("Config file buggy: missing ] in line %d", lineno);
 			else if (*p != ']')
 				error("Config file buggy: Invalid character '%c' occurred in section name in line %d", *p, lineno);
 
-			domainName = String(line.c_str() + 1, p);
+			domainName = String(line + 1, p);
 
 			domain.setDomainComment(comment);
 			comment.clear();
@@ -218,12 +241,12 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 			// This line should be a line with a 'key=value' pair, or an empty one.
 
 			// Skip leading whitespaces
-			const char *t = line.c_str();
-			while (isSpace(*t))
+			const char *t = line;
+			while (t < end && isSpace(*t))
 				t++;
 
 			// Skip empty lines / lines with only whitespace
-			if (*t == 0)
+			if (t == end)
 				continue;
 
 			// If no domain has been set, this config file is invalid!
@@ -232,86 +255,120 @@ void ConfigManager::loadFromStream(SeekableReadStream &stream) {
 			}
 
 			// Split string at '=' into 'key' and 'value'. First, find the "=" delimeter.
-			const char *p = strchr(t, '=');
+			const char *p = (const char *)memchr(t, '=', end - t);
 			if (!p)
-				error("Config file buggy: Junk found in line line %d: '%s'", lineno, t);
+				error("Config file buggy: Junk found in line line %d: '%s'", lineno, String(t, end).c_str());
 
-			// Extract the key/value pair
-			String key(t, p);
-			String value(p + 1);
+			// Extract the key/value pair, without the surrounding spaces
+			const char *keyEnd = p;
+			while (keyEnd > t && isSpace(keyEnd[-1]))
+				keyEnd--;
 
-			// Trim of spaces
-			key.trim();
-			value.trim();
+			const char *value = p + 1;
+			const char *valueEnd = end;
+			while (value < valueEnd && isSpace(*value))
+				value++;
+			while (valueEnd > value && isSpace(valueEnd[-1]))
+				valueEnd--;
+
+			const String key(t, keyEnd);
 
 			// Finally, store the key/value pair in the active domain
-			domain[key] = value;
+			domain.setVal(key, String(value, valueEnd));
 
 			// Store comment
-			domain.setKVComment(key, comment);
-			comment.clear();
+			if (!comment.empty()) {
+				domain.setKVComment(key, comment);
+				comment.clear();
+			}
 		}
 	}
 
+	delete[] buffer;
+
 	addDomain(domainName, domain); // Add the last domain found
 }
 
-void ConfigManager::flushToDisk() {
-#ifndef __DC__
-	WriteStream *stream;
-
-	if (_filename.empty()) {
-		// Write to the default config file
-		assert(g_system);
-		stream = g_system->createConfigWriteStream();
-		if (!stream)    // If writing to the config file is not possible, do nothing
-			return;
-	} else {
-		DumpFile *dump = new DumpFile();
-		assert(dump);
-
-		if (!dump->open(_filename)) {
-			warning("Unable to write configuration file: %s", _filename.c_str());
-			delete dump;
-			return;
-		}
-
-		stream = dump;
-	}
-
+void ConfigManager::saveToStream(WriteStream &stream) {
 	// Write the application domain
-	writeDomain(*stream, kApplicationDomain, _appDomain);
+	writeDomain(stream, kApplicationDomain, _appDomain);
 
 #ifdef ENABLE_KEYMAPPER
 	// Write the keymapper domain
-	writeDomain(*stream, kKeymapperDomain, _keymapperDomain);
+	writeDomain(stream, kKeymapperDomain, _keymapperDomain);
 #endif
 #ifdef USE_CLOUD
 	// Write the cloud domain
-	writeDomain(*stream, kCloudDomain, _cloudDomain);
+	writeDomain(stream, kCloudDomain, _cloudDomain);
 #endif
 
 	DomainMap::const_iterator d;
 
 	// Write the miscellaneous domains next
 	for (d = _miscDomains.begin(); d != _miscDomains.end(); ++d) {
-		writeDomain(*stream, d->_key, d->_value);
+		writeDomain(stream, d->_key, d->_value);
 	}
 
 	// First write the domains in _domainSaveOrder, in that order.
 	// Note: It's possible for _domainSaveOrder to list domains which
 	// are not present anymore, so we validate each name.
+	HashMap<String, bool> ordered;
 	Array<String>::const_iterator i;
 	for (i = _domainSaveOrder.begin(); i != _domainSaveOrder.end(); ++i) {
+		ordered[*i] = true;
 		if (_gameDomains.contains(*i)) {
-			writeDomain(*stream, *i, _gameDomains[*i]);
+			writeDomain(stream, *i, _gameDomains[*i]);
 		}
 	}
 
 	// Now write the domains which haven't been written yet
 	for (d = _gameDomains.begin(); d != _gameDomains.end(); ++d) {
-		if (find(_domainSaveOrder.begin(), _domainSaveOrder.end(), d->_key) == _domainSaveOrder.end())
-			writeDomain(*stream, d->_key, d->_value);
+		if (!ordered.contains(d->_key))
+			writeDomain(stream, d->_key, d->_value);
+	}
+}
+
+void ConfigManager::flushToDisk() {
+#ifndef __DC__
+	// Build the whole file in memory, so that it can be written at once,
+	// or not at all if it did not change since the last time.
+	MemoryWriteStreamDynamic data(DisposeAfterUse::YES);
+	saveToStream(data);
+
+	MemoryReadStream dataStream(data.getData(), data.size());
+	const String digest = computeStreamMD5AsString(dataStream);
+	if (digest == _flushedDigest)
+		return;
+
+	WriteStream *stream;
+
+	if (_filename.empty()) {
+		// Write to the default config file
+		assert(g_system);
+		stream = g_system->createConfigWriteStream();
+		if (!stream)    // If writing to the config file is not possible, do nothing
+			return;
+	} else {
+		DumpFile *dump = new DumpFile();
+		assert(dump);
+
+		if (!dump->open(_filename)) {
+			warning("Unable to write configuration file: %s", _filename.c_str());
+			delete dump;
+			return;
+		}
+
+		stream = dump;
+	}
+
+	stream->write(data.getData(), data.size());
+	stream->flush();
+
+	if (stream->err()) {
+		warning("Unable to write configuration file: %s", _filename.c_str());
+		_flushedDigest.clear();
+	} else {
+		_flushedDigest = digest;
 	}
 
 	delete stream;
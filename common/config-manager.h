@@ -149,8 +149,24 @@ public:
 	void				registerDefault(const String &key, int value);
 	void				registerDefault(const String &key, bool value);
 
+	/**
+	 * Writes the configuration to the config file. Nothing is written when
+	 * the configuration did not change since the last write.
+	 */
 	void				flushToDisk();
 
+	/**
+	 * Replaces all the domains, except for the defaults, with the ones
+	 * in the given stream, which must be in the config file format.
+	 */
+	void				loadFromStream(SeekableReadStream &stream);
+
+	/**
+	 * Writes all the domains, except for the defaults and the transient
+	 * domain, to the given stream in the config file format.
+	 */
+	void				saveToStream(WriteStream &stream);
+
 	void				setActiveDomain(const String &domName);
 	Domain *			getActiveDomain() { return _activeDomain; }
 	const Domain *		getActiveDomain() const { return _activeDomain; }
@@ -178,7 +194,6 @@ private:
 	friend class Singleton<SingletonBaseType>;
 	ConfigManager();
 
-	void			loadFromStream(SeekableReadStream &stream);
 	void			addDomain(const String &domainName, const Domain &domain);
 	void			writeDomain(WriteStream &stream, const String &name, const Domain &domain);
 	void			renameDomain(const String &oldName, const String &newName, DomainMap &map);
@@ -203,6 +218,9 @@ private:
 	Domain *		_activeDomain;
 
 	String			_filename;
+
+	/** MD5 of the contents last written to the config file, if any */
+	String			_flushedDigest;
 };
 
 } // End of namespace Common
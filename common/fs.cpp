@@ -125,6 +125,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileStats(int32 &size, uint32 &modificationTime) const {
+	return _realNode && _realNode->getFileStats(size, modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == 0)
 		return 0;
@@ -335,5 +339,18 @@ int FSDirectory::listMembers(ArchiveMemberList &list) const {
 	return files;
 }
 
+bool FSDirectory::listMemberNames(StringArray &names) const {
+	if (!_node.isDirectory())
+		return true;
+
+	// Cache dir data
+	ensureCached();
+
+	for (NodeCache::const_iterator it = _fileCache.begin(); it != _fileCache.end(); ++it)
+		names.push_back(it->_key);
+
+	return true;
+}
+
 
 } // End of namespace Common
@@ -213,6 +213,17 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieves the size and the time of the last modification of the file
+	 * referred by this node, without opening it. The time is in seconds,
+	 * relative to an unspecified epoch which stays the same across runs.
+	 * This is meant for detecting whether a file has changed.
+	 *
+	 * @return true if successful, false if the node does not refer to an
+	 *         existing file or if the backend can not provide the information.
+	 */
+	bool getFileStats(int32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -338,6 +349,11 @@ public:
 	 */
 	virtual int listMembers(ArchiveMemberList &list) const;
 
+	/**
+	 * Adds the names of all files in the cache to names.
+	 */
+	virtual bool listMemberNames(StringArray &names) const;
+
 	/**
 	 * Get a ArchiveMember representation of the specified file. A full match of relative
 	 * path and filename is needed for success.
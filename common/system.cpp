@@ -49,6 +49,7 @@ OSystem::OSystem() {
 	_updateManager = 0;
 #endif
 	_fsFactory = 0;
+	_cpuExtension = kCpuExtensionNone;
 }
 
 OSystem::~OSystem() {
@@ -98,6 +99,29 @@ void OSystem::initBackend() {
 	// set it.
 // 	if (!_fsFactory)
 // 		error("Backend failed to instantiate fs factory");
+
+	_cpuExtension = kCpuExtensionNone;
+#ifdef SCUMMVM_NEON
+	if (hasFeature(kFeatureCpuNEON))
+		_cpuExtension = kCpuExtensionNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (hasFeature(kFeatureCpuSSE2))
+		_cpuExtension = kCpuExtensionSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+	if (_cpuExtension == kCpuExtensionSSE2 && hasFeature(kFeatureCpuAVX2))
+		_cpuExtension = kCpuExtensionAVX2;
+#endif
+}
+
+OSystem::CpuExtension OSystem::getCpuExtension() {
+	return g_system ? g_system->_cpuExtension : kCpuExtensionNone;
+}
+
+void OSystem::runJobs(JobProc proc, void *const *jobs, uint numJobs) {
+	for (uint i = 0; i < numJobs; i++)
+		proc(jobs[i]);
 }
 
 bool OSystem::setGraphicsMode(const char *name) {
@@ -149,6 +173,10 @@ Common::String OSystem::getDefaultConfigFileName() {
 	return "scummvm.ini";
 }
 
+Common::String OSystem::getDefaultCachePath() {
+	return Common::String();
+}
+
 Common::String OSystem::getSystemLanguage() const {
 	return "en_US";
 }
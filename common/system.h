@@ -367,7 +367,19 @@ public:
 		/**
 		* shaders
 		*/
-		kFeatureShader
+		kFeatureShader,
+
+		/**
+		 * The presence of these features indicates whether the host CPU
+		 * supports the respective SIMD instruction set. Code picks its
+		 * optimized routines through getCpuExtension(), which is based on
+		 * them.
+		 *
+		 * These features have no associated state.
+		 */
+		kFeatureCpuSSE2,
+		kFeatureCpuAVX2,
+		kFeatureCpuNEON
 
 	};
 
@@ -388,6 +400,29 @@ public:
 	 */
 	virtual bool getFeatureState(Feature f) { return false; }
 
+	/**
+	 * The SIMD instruction sets optimized routines can be picked for. The
+	 * x86 ones are ordered so that each one implies those before it, down
+	 * to kCpuExtensionSSE2.
+	 */
+	enum CpuExtension {
+		kCpuExtensionNone,
+		kCpuExtensionNEON,
+		kCpuExtensionSSE2,
+		kCpuExtensionAVX2
+	};
+
+	/**
+	 * Return the most capable SIMD instruction set which the host CPU
+	 * supports, according to the kFeatureCpu* features, and which this
+	 * build has been configured with. It is determined once by
+	 * initBackend(), so it may be called from any thread.
+	 *
+	 * @return the instruction set, or kCpuExtensionNone if there is no
+	 *         initialized backend
+	 */
+	static CpuExtension getCpuExtension();
+
 	//@}
 
 
@@ -1109,6 +1144,24 @@ public:
 	 */
 	virtual void deleteMutex(MutexRef mutex) = 0;
 
+	/** A function run by runJobs() on each job. */
+	typedef void (*JobProc)(void *job);
+
+	/**
+	 * Run proc on each of the given jobs, and return once all of them are
+	 * done. Backends may spread the jobs over several threads, so a job
+	 * must not depend on another one, and must neither call runJobs() nor
+	 * any other OSystem method.
+	 *
+	 * The default implementation runs the jobs one after the other on the
+	 * calling thread.
+	 *
+	 * @param proc		the function to run on each job.
+	 * @param jobs		the jobs, passed to proc.
+	 * @param numJobs	the number of jobs.
+	 */
+	virtual void runJobs(JobProc proc, void *const *jobs, uint numJobs);
+
 	//@}
 
 
@@ -1272,6 +1325,16 @@ public:
 	 */
 	virtual Common::String getDefaultConfigFileName();
 
+	/**
+	 * Get the default path of a directory for data which can be recreated
+	 * at any time, like the compiled theme files. It must not be the save
+	 * path, whose files may be synced to cloud storage.
+	 * Note that not all ports may use this.
+	 *
+	 * @return the path, or an empty string if there is no such directory
+	 */
+	virtual Common::String getDefaultCachePath();
+
 	/**
 	 * Logs a given message.
 	 *
@@ -1368,6 +1431,10 @@ public:
 	virtual Common::String getSystemLanguage() const;
 
 	//@}
+
+private:
+	/** The result of getCpuExtension(), set by initBackend() */
+	CpuExtension _cpuExtension;
 };
 
 
@@ -103,9 +103,14 @@ typedef struct {
 
 #endif  // !USE_ZLIB
 
+#include "common/array.h"
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/system.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -378,10 +383,58 @@ typedef struct {
 typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
 	Common::IgnoreCase_EqualTo> ZipHash;
 
+namespace Common {
+
+/**
+ * The stream of a ZIP archive, shared by the archive and the streams of its
+ * members. Member streams may be read from other threads, for example by
+ * the mixer, so positioning the stream and reading from it is only done
+ * while holding the lock.
+ */
+class ZipArchiveStream {
+public:
+	ZipArchiveStream(SeekableReadStream *stream) : _stream(stream), _mutex(g_system ? new Mutex() : 0) {}
+	~ZipArchiveStream() {
+		delete _mutex;
+		delete _stream;
+	}
+
+	SeekableReadStream *getStream() { return _stream; }
+
+	void lock() {
+		if (_mutex)
+			_mutex->lock();
+	}
+
+	void unlock() {
+		if (_mutex)
+			_mutex->unlock();
+	}
+
+private:
+	SeekableReadStream *_stream;
+	Mutex *_mutex;
+};
+
+/**
+ * Locks a ZipArchiveStream for its lifetime.
+ */
+class ZipArchiveStreamLock {
+public:
+	ZipArchiveStreamLock(ZipArchiveStream &stream) : _stream(stream) { _stream.lock(); }
+	~ZipArchiveStreamLock() { _stream.unlock(); }
+
+private:
+	ZipArchiveStream &_stream;
+};
+
+} // End of namespace Common
+
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::ZipArchiveStream> _streamRef;	/* owns _stream, shared with the member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +597,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef = Common::SharedPtr<Common::ZipArchiveStream>(new Common::ZipArchiveStream(stream));
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +649,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -644,7 +697,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1124,6 +1176,31 @@ int unzOpenCurrentFile (unzFile file) {
 	return err;
 }
 
+/*
+  Get the position of the data of the current file in the zipfile (including
+  the bytes before the zipfile), after checking its local header.
+  The current file is not opened for reading.
+*/
+static int unzlocal_GetCurrentFileDataPosition(unzFile file, uLong *pposition) {
+	unz_s* s;
+	uInt iSizeVar;
+	uLong offset_local_extrafield;
+	uInt  size_local_extrafield;
+
+	if (file==NULL)
+		return UNZ_PARAMERROR;
+	s=(unz_s*)file;
+	if (!s->current_file_ok)
+		return UNZ_PARAMERROR;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s,&iSizeVar,
+				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
+		return UNZ_BADZIPFILE;
+
+	*pposition = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER +
+	             iSizeVar + s->byte_before_the_zipfile;
+	return UNZ_OK;
+}
 
 /*
   Read bytes from the current file.
@@ -1419,6 +1496,358 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+enum {
+	/** Deflated members up to this size are inflated into memory at once. */
+	ZIP_STREAM_THRESHOLD = 256 * 1024,
+	/** Minimum distance between the inflate checkpoints of a ZipStream. */
+	ZIP_CHECKPOINT_SPACING = 1024 * 1024
+};
+
+/**
+ * A stored member, read straight from the archive's stream. Every read
+ * positions that stream while holding its lock, so any number of members
+ * may be open and read from different threads at the same time. Holds a
+ * reference to the stream, so it may outlive the ZipArchive.
+ */
+class ZipStoredStream : public SeekableReadStream {
+public:
+	ZipStoredStream(const SharedPtr<ZipArchiveStream> &archiveStream, uint32 begin, uint32 end)
+		: _archiveStream(archiveStream), _begin(begin), _end(end), _pos(begin), _eos(false), _err(false) {
+		assert(_begin <= _end);
+	}
+
+	bool err() const { return _err; }
+	void clearErr() { _err = false; }
+	bool eos() const { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	int32 pos() const { return _pos - _begin; }
+	int32 size() const { return _end - _begin; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	SharedPtr<ZipArchiveStream> _archiveStream;
+	const uint32 _begin;
+	const uint32 _end;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+};
+
+uint32 ZipStoredStream::read(void *dataPtr, uint32 dataSize) {
+	if (dataSize > _end - _pos) {
+		dataSize = _end - _pos;
+		_eos = true;
+	}
+
+	ZipArchiveStreamLock lock(*_archiveStream);
+	SeekableReadStream *stream = _archiveStream->getStream();
+
+	if (!stream->seek(_pos)) {
+		_err = true;
+		return 0;
+	}
+
+	dataSize = stream->read(dataPtr, dataSize);
+	if (stream->err())
+		_err = true;
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+bool ZipStoredStream::seek(int32 offset, int whence) {
+	int32 newPos = 0;
+	switch (whence) {
+	case SEEK_END:
+		newPos = size() + offset;
+		break;
+	case SEEK_SET:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = pos() + offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > size())
+		return false;
+
+	_pos = _begin + newPos;
+	_eos = false;
+	return true;
+}
+
+#ifdef USE_ZLIB
+
+/**
+ * A deflated member, inflated on demand.
+ *
+ * The last 32 KB of decompressed data are kept, so short backward seeks
+ * are free. For longer ones, the inflate state is saved at deflate block
+ * boundaries every ZIP_CHECKPOINT_SPACING bytes, and decompression
+ * restarts from the closest checkpoint before the seek target.
+ *
+ * It reads the compressed data through a ZipStoredStream, so any number of
+ * members may be open and read from different threads at the same time.
+ */
+class ZipStream : public SeekableReadStream {
+public:
+	ZipStream(const SharedPtr<ZipArchiveStream> &archiveStream, uint32 begin, uint32 compressedSize, uint32 size, uint32 crc);
+	~ZipStream();
+
+	bool err() const { return _err; }
+	void clearErr() { _err = false; }
+	bool eos() const { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	enum {
+		kWindowSize = 32768, ///< The largest deflate window
+		kInputSize = 16384
+	};
+
+	struct Checkpoint {
+		uint32 outPos;  ///< Position in the decompressed data
+		uint32 inPos;   ///< Compressed bytes consumed up to here
+		int bits;       ///< Bits of the byte before inPos which are not consumed yet
+		byte *window;   ///< The kWindowSize bytes before outPos
+	};
+
+	ZipStoredStream _input;
+
+	z_stream _zStream;
+	bool _zStreamInitialized;
+	byte _inBuf[kInputSize];
+
+	/** Ring of the last decompressed bytes, position x is stored at x % kWindowSize. */
+	byte _window[kWindowSize];
+	uint32 _decoded;
+	uint32 _pos;
+	const uint32 _size;
+
+	uint32 _crc;
+	uint32 _crcPos;
+	const uint32 _expectedCrc;
+
+	bool _eos;
+	bool _err;
+
+	Array<Checkpoint> _checkpoints;
+
+	uint32 readInternal(byte *dst, uint32 dataSize);
+	bool inflateMore();
+	void addCheckpoint(uint32 outPos);
+	void restart(const Checkpoint *checkpoint);
+};
+
+ZipStream::ZipStream(const SharedPtr<ZipArchiveStream> &archiveStream, uint32 begin, uint32 compressedSize, uint32 size, uint32 crc)
+	: _input(archiveStream, begin, begin + compressedSize),
+	  _zStreamInitialized(false), _decoded(0), _pos(0), _size(size), _crc(::crc32(0, Z_NULL, 0)),
+	  _crcPos(0), _expectedCrc(crc), _eos(false), _err(false) {
+	memset(&_zStream, 0, sizeof(_zStream));
+
+	// Raw deflate data, without a zlib header
+	if (inflateInit2(&_zStream, -MAX_WBITS) == Z_OK)
+		_zStreamInitialized = true;
+	else
+		_err = true;
+}
+
+ZipStream::~ZipStream() {
+	if (_zStreamInitialized)
+		inflateEnd(&_zStream);
+
+	for (uint i = 0; i < _checkpoints.size(); i++)
+		delete[] _checkpoints[i].window;
+}
+
+uint32 ZipStream::read(void *dataPtr, uint32 dataSize) {
+	assert(dataPtr);
+	return readInternal((byte *)dataPtr, dataSize);
+}
+
+uint32 ZipStream::readInternal(byte *dst, uint32 dataSize) {
+	uint32 total = 0;
+
+	while (total < dataSize) {
+		if (_pos == _decoded) {
+			if (_decoded == _size) {
+				_eos = true;
+				break;
+			}
+			if (_err || !inflateMore())
+				break;
+		}
+
+		const uint32 offset = _pos % kWindowSize;
+		const uint32 count = MIN(MIN(dataSize - total, _decoded - _pos), kWindowSize - offset);
+		if (dst)
+			memcpy(dst + total, _window + offset, count);
+		_pos += count;
+		total += count;
+	}
+
+	return total;
+}
+
+bool ZipStream::inflateMore() {
+	// Only called once everything decompressed has been read, so the
+	// bytes about to be overwritten are no longer needed.
+	assert(_pos == _decoded);
+
+	const uint32 offset = _decoded % kWindowSize;
+	const uint32 wanted = MIN<uint32>(kWindowSize - offset, _size - _decoded);
+	_zStream.next_out = _window + offset;
+	_zStream.avail_out = wanted;
+
+	while (_zStream.avail_out) {
+		if (_zStream.avail_in == 0) {
+			_zStream.next_in = _inBuf;
+			_zStream.avail_in = _input.read(_inBuf, kInputSize);
+			if (_zStream.avail_in == 0) {
+				// The member is truncated
+				_err = true;
+				break;
+			}
+		}
+
+		// Z_BLOCK makes inflate() return at the end of every deflate block,
+		// which are the only places where checkpoints can be taken.
+		const int res = inflate(&_zStream, Z_BLOCK);
+		if (res == Z_STREAM_END)
+			break;
+		if (res != Z_OK && res != Z_BUF_ERROR) {
+			_err = true;
+			break;
+		}
+
+		const bool atBlockBoundary = (_zStream.data_type & 128) && !(_zStream.data_type & 64);
+		if (atBlockBoundary) {
+			const uint32 outPos = _decoded + (wanted - _zStream.avail_out);
+			const uint32 lastCheckpoint = _checkpoints.empty() ? 0 : _checkpoints.back().outPos;
+			if (outPos > lastCheckpoint && outPos - lastCheckpoint >= ZIP_CHECKPOINT_SPACING)
+				addCheckpoint(outPos);
+		}
+	}
+
+	const uint32 produced = wanted - _zStream.avail_out;
+
+	// Verify the checksum the first time the data is decompressed
+	if (_decoded <= _crcPos && _decoded + produced > _crcPos) {
+		const uint32 skip = _crcPos - _decoded;
+		_crc = ::crc32(_crc, _window + offset + skip, produced - skip);
+		_crcPos = _decoded + produced;
+		if (_crcPos == _size && _crc != _expectedCrc) {
+			warning("ZipStream: CRC mismatch");
+			_err = true;
+		}
+	}
+
+	_decoded += produced;
+	return produced > 0;
+}
+
+void ZipStream::addCheckpoint(uint32 outPos) {
+	// Checkpoints are far apart, so there is always a full window
+	assert(outPos >= kWindowSize);
+
+	Checkpoint checkpoint;
+	checkpoint.outPos = outPos;
+	checkpoint.inPos = _input.pos() - _zStream.avail_in;
+	checkpoint.bits = _zStream.data_type & 7;
+	checkpoint.window = new byte[kWindowSize];
+
+	const uint32 offset = outPos % kWindowSize;
+	memcpy(checkpoint.window, _window + offset, kWindowSize - offset);
+	memcpy(checkpoint.window + kWindowSize - offset, _window, offset);
+
+	_checkpoints.push_back(checkpoint);
+}
+
+void ZipStream::restart(const Checkpoint *checkpoint) {
+	inflateReset(&_zStream);
+	_zStream.avail_in = 0;
+
+	if (!checkpoint) {
+		_input.seek(0);
+		_decoded = _pos = 0;
+		return;
+	}
+
+	_input.seek(checkpoint->inPos - (checkpoint->bits ? 1 : 0));
+	if (checkpoint->bits) {
+		const byte partial = _input.readByte();
+		inflatePrime(&_zStream, checkpoint->bits, partial >> (8 - checkpoint->bits));
+	}
+	inflateSetDictionary(&_zStream, checkpoint->window, kWindowSize);
+
+	const uint32 offset = checkpoint->outPos % kWindowSize;
+	memcpy(_window + offset, checkpoint->window, kWindowSize - offset);
+	memcpy(_window, checkpoint->window + kWindowSize - offset, offset);
+
+	_decoded = _pos = checkpoint->outPos;
+}
+
+bool ZipStream::seek(int32 offset, int whence) {
+	int32 newPos = 0;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	case SEEK_SET:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	}
+
+	if (newPos < 0 || newPos > (int32)_size)
+		return false;
+
+	const uint32 target = newPos;
+	_eos = false;
+
+	if (target >= _pos) {
+		// Jump over the data to skip if a checkpoint allows it
+		const Checkpoint *checkpoint = 0;
+		for (uint i = _checkpoints.size(); i-- > 0; ) {
+			if (_checkpoints[i].outPos <= target) {
+				if (_checkpoints[i].outPos > _decoded)
+					checkpoint = &_checkpoints[i];
+				break;
+			}
+		}
+		if (checkpoint)
+			restart(checkpoint);
+	} else if (_decoded - target <= MIN<uint32>(_decoded, kWindowSize)) {
+		// Still in the window
+		_pos = target;
+		return true;
+	} else {
+		const Checkpoint *checkpoint = 0;
+		for (uint i = _checkpoints.size(); i-- > 0; ) {
+			if (_checkpoints[i].outPos <= target) {
+				checkpoint = &_checkpoints[i];
+				break;
+			}
+		}
+		restart(checkpoint);
+	}
+
+	readInternal(0, target - _pos);
+	return !_err;
+}
+
+#endif // USE_ZLIB
+
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
@@ -1431,6 +1860,7 @@ public:
 
 	virtual bool hasFile(const String &name) const;
 	virtual int listMembers(ArchiveMemberList &list) const;
+	virtual bool listMemberNames(StringArray &names) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
 };
@@ -1478,6 +1908,15 @@ int ZipArchive::listMembers(ArchiveMemberList &list) const {
 	return members;
 }
 
+bool ZipArchive::listMemberNames(StringArray &names) const {
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	for (ZipHash::const_iterator i = archive->_hash.begin(), end = archive->_hash.end();
+	     i != end; ++i)
+		names.push_back(i->_key);
+
+	return true;
+}
+
 const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 	if (!hasFile(name))
 		return ArchiveMemberPtr();
@@ -1486,14 +1925,33 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	// Streams of other members may be reading the archive at the same time
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	ZipArchiveStreamLock lock(*archive->_streamRef);
+
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
 	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+	uLong position;
+	if (unzlocal_GetCurrentFileDataPosition(_zipFile, &position) != UNZ_OK)
+		return 0;
+
+	// Stored members need no decompression, read them in place
+	if (fileInfo.compression_method == 0)
+		return new ZipStoredStream(archive->_streamRef, position, position + fileInfo.uncompressed_size);
+
+#ifdef USE_ZLIB
+	if (fileInfo.compression_method == Z_DEFLATED && fileInfo.uncompressed_size > ZIP_STREAM_THRESHOLD)
+		return new ZipStream(archive->_streamRef, position, fileInfo.compressed_size, fileInfo.uncompressed_size, fileInfo.crc);
+#endif
+
+	// Small members (and those with unsupported compression methods, which
+	// fail here) are inflated at once
+	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
 		return 0;
 
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
@@ -1510,11 +1968,6 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -24,10 +24,33 @@
 #include "common/archive.h"
 #include "common/fs.h"
 #include "common/memstream.h"
+#include "common/stream.h"
 #include "common/system.h"
 
 namespace Common {
 
+/** Markers of the parsed keys recorded by XMLParser::setCompiledStream() */
+enum {
+	kCompiledEnd = 0,
+	kCompiledKeyOpen = 1,
+	kCompiledKeyClose = 2,
+	kCompiledHeader = 3
+};
+
+static void writeCompiledString(WriteStream *stream, const String &str) {
+	stream->writeUint16LE(str.size());
+	stream->write(str.c_str(), str.size());
+}
+
+static bool readCompiledString(SeekableReadStream *stream, String &str) {
+	uint16 size = stream->readUint16LE();
+	str.clear();
+	while (size-- && !stream->eos())
+		str += (char)stream->readByte();
+
+	return !stream->eos() && !stream->err();
+}
+
 XMLParser::~XMLParser() {
 	while (!_activeKey.empty())
 		freeNode(_activeKey.pop());
@@ -159,6 +182,16 @@ bool XMLParser::parseActiveKey(bool closed) {
 
 	ParserNode *key = _activeKey.top();
 
+	if (_compiledStream) {
+		_compiledStream->writeByte(key->header ? kCompiledHeader : kCompiledKeyOpen);
+		writeCompiledString(_compiledStream, key->name);
+		_compiledStream->writeUint16LE(key->values.size());
+		for (StringMap::const_iterator i = key->values.begin(); i != key->values.end(); ++i) {
+			writeCompiledString(_compiledStream, i->_key);
+			writeCompiledString(_compiledStream, i->_value);
+		}
+	}
+
 	if (key->name == "xml" && key->header == true) {
 		assert(closed);
 		return parseXMLHeader(key) && closeKey();
@@ -290,6 +323,9 @@ bool XMLParser::closeKey() {
 			ignore = true;
 	}
 
+	if (_compiledStream && !_activeKey.top()->header)
+		_compiledStream->writeByte(kCompiledKeyClose);
+
 	if (ignore == false)
 		result = closedKeyCallback(_activeKey.top());
 
@@ -459,9 +495,78 @@ bool XMLParser::parse() {
 	if (_state != kParserNeedKey || !_activeKey.empty())
 		return parserError("Unexpected end of file.");
 
+	if (_compiledStream)
+		_compiledStream->writeByte(kCompiledEnd);
+
 	return true;
 }
 
+bool XMLParser::parseCompiled() {
+	if (_stream == 0)
+		return false;
+
+	if (_XMLkeys == 0)
+		buildLayout();
+
+	while (!_activeKey.empty())
+		freeNode(_activeKey.pop());
+
+	cleanup();
+
+	_state = kParserNeedKey;
+
+	while (_state != kParserError) {
+		byte marker = _stream->readByte();
+
+		if (_stream->eos() || _stream->err())
+			return parserError("Unexpected end of compiled data.");
+
+		if (marker == kCompiledEnd) {
+			if (!_activeKey.empty())
+				return parserError("Unexpected end of file.");
+
+			return true;
+		}
+
+		if (marker == kCompiledKeyClose) {
+			if (_activeKey.empty())
+				return parserError("Unexpected closure.");
+
+			if (!closeKey())
+				return parserError("Missing data when closing key '" + _activeKey.top()->name + "'.");
+
+			continue;
+		}
+
+		if (marker != kCompiledKeyOpen && marker != kCompiledHeader)
+			return parserError("Invalid compiled data.");
+
+		ParserNode *node = allocNode();
+		node->ignore = false;
+		node->header = (marker == kCompiledHeader);
+		node->depth = _activeKey.size();
+		node->layout = 0;
+		_activeKey.push(node);
+
+		if (!readCompiledString(_stream, node->name))
+			return parserError("Unexpected end of compiled data.");
+
+		uint16 count = _stream->readUint16LE();
+		while (count--) {
+			String name, value;
+			if (!readCompiledString(_stream, name) || !readCompiledString(_stream, value))
+				return parserError("Unexpected end of compiled data.");
+
+			node->values[name] = value;
+		}
+
+		// Headers are always self-closed
+		parseActiveKey(node->header);
+	}
+
+	return false;
+}
+
 bool XMLParser::skipSpaces() {
 	if (!isSpace(_char))
 		return false;
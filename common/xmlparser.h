@@ -37,6 +37,7 @@
 namespace Common {
 
 class SeekableReadStream;
+class WriteStream;
 
 #define MAX_XML_DEPTH 8
 
@@ -92,7 +93,7 @@ public:
 	/**
 	 * Parser constructor.
 	 */
-	XMLParser() : _XMLkeys(0), _stream(0) {}
+	XMLParser() : _XMLkeys(0), _stream(0), _compiledStream(0) {}
 
 	virtual ~XMLParser();
 
@@ -187,6 +188,26 @@ public:
 	 */
 	bool parse();
 
+	/**
+	 * Records the keys parsed by every following call to parse() into
+	 * the given stream, in a compact binary form which can be read back
+	 * with parseCompiled(). Recording is stopped by passing 0. The stream
+	 * is not owned by the parser.
+	 *
+	 * @param stream Stream to write the parsed keys to.
+	 */
+	void setCompiledStream(WriteStream *stream) { _compiledStream = stream; }
+
+	/**
+	 * Parses keys recorded during a call to parse() from the loaded data
+	 * stream, which is left at the end of the recording. The keys are
+	 * validated and handed to the callbacks just like when parsing the
+	 * original XML data, without any of the text processing.
+	 * The recordings of several parse() calls may be stored one after the
+	 * other and read back by calling this function for each of them.
+	 */
+	bool parseCompiled();
+
 	/**
 	 * Returns the active node being parsed (the one on top of
 	 * the node stack).
@@ -347,6 +368,8 @@ private:
 	String _token; /** Current text token */
 
 	Stack<ParserNode *> _activeKey; /** Node stack of the parsed keys */
+
+	WriteStream *_compiledStream; /** Stream the parsed keys are recorded to */
 };
 
 } // End of namespace Common
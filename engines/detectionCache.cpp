@@ -0,0 +1,232 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectionCache.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/stream.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+enum {
+	kCacheVersion = 1,
+	// Once the cache grows beyond this, entries not used in this session
+	// are dropped when saving
+	kMaxEntries = 100000,
+	// Minimum delay between two non forced saves, in milliseconds
+	kSaveInterval = 10000
+};
+
+static const char *const kCacheFileName = "detection.cache";
+
+static void writeString(Common::WriteStream *stream, const Common::String &str) {
+	stream->writeUint16LE(str.size());
+	stream->write(str.c_str(), str.size());
+}
+
+static bool readString(Common::SeekableReadStream *stream, Common::String &str) {
+	const uint16 size = stream->readUint16LE();
+	if (stream->eos() || size > stream->size() - stream->pos())
+		return false;
+
+	char *buffer = new char[size];
+	stream->read(buffer, size);
+	str = Common::String(buffer, size);
+	delete[] buffer;
+	return !stream->err();
+}
+
+DetectionCache::DetectionCache()
+	: _mutex(0), _enabled(true), _loaded(false), _dirty(false), _saved(false), _lastSave(0) {
+	if (ConfMan.hasKey("detection_cache", Common::ConfigManager::kApplicationDomain))
+		_enabled = ConfMan.getBool("detection_cache", Common::ConfigManager::kApplicationDomain);
+
+	// Mutexes are not available before initBackend(), which is also when
+	// the savefile manager is created
+	if (!g_system->getSavefileManager())
+		_enabled = false;
+
+	// The cache is kept out of the save directory, whose files may be
+	// synced to the cloud
+	if (_enabled) {
+		const Common::String path = g_system->getDefaultCachePath();
+		const Common::FSNode dir(path);
+		if (path.empty() || !dir.isDirectory())
+			_enabled = false;
+		else
+			_file = dir.getChild(kCacheFileName);
+	}
+
+	if (_enabled)
+		_mutex = new Common::Mutex();
+}
+
+DetectionCache::~DetectionCache() {
+	flush();
+	delete _mutex;
+}
+
+Common::String DetectionCache::makeKey(const Common::FSNode &node, uint md5Bytes) {
+	return Common::String::format("%u:", md5Bytes) + node.getPath();
+}
+
+bool DetectionCache::lookup(const Common::FSNode &node, uint md5Bytes, int32 &size, Common::String &md5) {
+	if (!_enabled)
+		return false;
+
+	int32 fileSize;
+	uint32 modificationTime;
+	if (!node.getFileStats(fileSize, modificationTime))
+		return false;
+
+	Common::StackLock lock(*_mutex);
+	load();
+
+	EntryMap::iterator entry = _entries.find(makeKey(node, md5Bytes));
+	if (entry == _entries.end())
+		return false;
+
+	if (entry->_value.size != fileSize || entry->_value.modificationTime != modificationTime) {
+		_entries.erase(entry);
+		_dirty = true;
+		return false;
+	}
+
+	entry->_value.used = true;
+	size = entry->_value.size;
+	md5 = entry->_value.md5;
+	return true;
+}
+
+void DetectionCache::store(const Common::FSNode &node, uint md5Bytes, int32 size, const Common::String &md5) {
+	if (!_enabled)
+		return;
+
+	// The file might have changed since it has been hashed, in which
+	// case the entry is invalidated on the next lookup
+	int32 fileSize;
+	uint32 modificationTime;
+	if (!node.getFileStats(fileSize, modificationTime) || fileSize != size)
+		return;
+
+	Common::StackLock lock(*_mutex);
+	load();
+
+	Entry &entry = _entries[makeKey(node, md5Bytes)];
+	entry.size = size;
+	entry.modificationTime = modificationTime;
+	entry.md5 = md5;
+	entry.used = true;
+	_dirty = true;
+}
+
+void DetectionCache::flush(bool force) {
+	if (!_enabled)
+		return;
+
+	Common::StackLock lock(*_mutex);
+	if (!_dirty)
+		return;
+
+	const uint32 now = g_system->getMillis();
+	if (!force && _saved && now - _lastSave < kSaveInterval)
+		return;
+
+	save();
+	_saved = true;
+	_lastSave = now;
+}
+
+void DetectionCache::load() {
+	if (_loaded)
+		return;
+	_loaded = true;
+
+	Common::SeekableReadStream *file = _file.exists() ? _file.createReadStream() : 0;
+	if (!file)
+		return;
+
+	if (file->readUint32BE() != MKTAG('D', 'C', 'S', 'H') || file->readUint32LE() != kCacheVersion) {
+		debug(1, "DetectionCache: Ignoring '%s' with an unknown format", kCacheFileName);
+		delete file;
+		return;
+	}
+
+	const uint32 count = file->readUint32LE();
+	for (uint32 i = 0; i < count; i++) {
+		Common::String key;
+		Entry entry;
+		if (!readString(file, key))
+			break;
+		entry.size = file->readSint32LE();
+		entry.modificationTime = file->readUint32LE();
+		if (!readString(file, entry.md5))
+			break;
+		entry.used = false;
+		_entries[key] = entry;
+	}
+
+	debug(2, "DetectionCache: Loaded %u entries", _entries.size());
+	delete file;
+}
+
+void DetectionCache::save() {
+	bool pruneUnused = _entries.size() > kMaxEntries;
+
+	Common::WriteStream *file = _file.createWriteStream();
+	if (!file) {
+		warning("DetectionCache: Could not open '%s' for writing", kCacheFileName);
+		return;
+	}
+
+	uint32 count = 0;
+	for (EntryMap::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
+		if (!pruneUnused || entry->_value.used)
+			count++;
+	}
+
+	file->writeUint32BE(MKTAG('D', 'C', 'S', 'H'));
+	file->writeUint32LE(kCacheVersion);
+	file->writeUint32LE(count);
+	for (EntryMap::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
+		if (pruneUnused && !entry->_value.used)
+			continue;
+		writeString(file, entry->_key);
+		file->writeSint32LE(entry->_value.size);
+		file->writeUint32LE(entry->_value.modificationTime);
+		writeString(file, entry->_value.md5);
+	}
+
+	file->finalize();
+	if (file->err())
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+	else
+		_dirty = false;
+
+	delete file;
+}
@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/fs.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+/**
+ * Persistent cache of the MD5 checksums computed while detecting games.
+ *
+ * Entries are keyed by the path of the file and the number of bytes the
+ * checksum covers, and are only used as long as the size and modification
+ * time of the file did not change. Files for which the backend can not
+ * provide this information are never cached.
+ *
+ * The cache is stored as "detection.cache" in the directory returned by
+ * OSystem::getDefaultCachePath(), and is disabled on ports which have no
+ * such directory. It can also be disabled by setting the "detection_cache"
+ * configuration key to false. It is also disabled if the instance is
+ * created before the backend has been initialized, as happens when
+ * detecting games from the command line.
+ *
+ * All methods may be called from several threads at once, but the
+ * instance must have been created beforehand.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	DetectionCache();
+	~DetectionCache();
+
+	/**
+	 * Look up the checksum of the first md5Bytes bytes of a file.
+	 *
+	 * @return true if a valid entry was found, in which case size and md5
+	 *         are set
+	 */
+	bool lookup(const Common::FSNode &node, uint md5Bytes, int32 &size, Common::String &md5);
+
+	/**
+	 * Store the checksum of the first md5Bytes bytes of a file.
+	 */
+	void store(const Common::FSNode &node, uint md5Bytes, int32 size, const Common::String &md5);
+
+	/**
+	 * Write the cache if it has been modified. Unless force is set, this
+	 * is done at most every few seconds, so calling it after each detected
+	 * directory is cheap.
+	 */
+	void flush(bool force = true);
+
+private:
+	struct Entry {
+		int32 size;
+		uint32 modificationTime;
+		Common::String md5;
+		bool used;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void load();
+	void save();
+
+	static Common::String makeKey(const Common::FSNode &node, uint md5Bytes);
+
+	Common::Mutex *_mutex;
+	Common::FSNode _file;
+	EntryMap _entries;
+	bool _enabled;
+	bool _loaded;
+	bool _dirty;
+	bool _saved;
+	uint32 _lastSave;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+#endif
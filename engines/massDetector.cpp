@@ -0,0 +1,167 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/massDetector.h"
+#include "engines/metaengine.h"
+
+#include "common/algorithm.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+enum {
+	// Interval of the lister timer procedure, in microseconds
+	kListerInterval = 10000,
+	// Upper bound (in milliseconds) of the time spent in one call of the
+	// lister, so other timer procedures are not held up for too long
+	kMaxListTime = 8,
+	// Number of listed directories after which the lister waits for the
+	// detectors to catch up
+	kMaxListedDirs = 256
+};
+
+// The lister is a single timer procedure, so only one MassDetector at a
+// time can use it. Only accessed from the thread creating the detectors.
+static bool s_listerInstalled = false;
+
+MassDetector::MassDetector(const Common::FSNode &startDir, bool recursive)
+	: _recursive(recursive), _threaded(false), _mutex(0), _listingDone(false), _dirsFound(1), _dirsScanned(0) {
+	_pending.push(Common::String(startDir.getPath().c_str()));
+
+	// Timers and mutexes are only available once the backend has been
+	// initialized
+	if (!s_listerInstalled && g_system->getTimerManager()) {
+		_threaded = true;
+		_mutex = new Common::Mutex();
+		s_listerInstalled = g_system->getTimerManager()->installTimerProc(&listerProc, kListerInterval, this, "MassDetector");
+		if (!s_listerInstalled) {
+			_threaded = false;
+			delete _mutex;
+			_mutex = 0;
+		}
+	}
+}
+
+MassDetector::~MassDetector() {
+	if (_threaded) {
+		// Waits for the lister to return, if it is running
+		g_system->getTimerManager()->removeTimerProc(&listerProc);
+		s_listerInstalled = false;
+	}
+
+	delete _mutex;
+}
+
+void MassDetector::listerProc(void *refCon) {
+	MassDetector *detector = (MassDetector *)refCon;
+	const uint32 start = g_system->getMillis();
+
+	do {
+		Common::StackLock lock(*detector->_mutex);
+		if (detector->_listingDone || detector->_listed.size() >= kMaxListedDirs)
+			return;
+	} while (detector->listNext() && g_system->getMillis() - start < kMaxListTime);
+}
+
+bool MassDetector::listNext() {
+	if (_pending.empty())
+		return false;
+
+	ListedDir listed;
+	listed.dir = Common::FSNode(_pending.pop());
+	if (listed.dir.getChildren(listed.files, Common::FSNode::kListAll))
+		Common::sort(listed.files.begin(), listed.files.end());
+	else
+		listed.files.clear();
+
+	uint subDirs = 0;
+	if (_recursive) {
+		for (Common::FSList::const_iterator file = listed.files.begin(); file != listed.files.end(); ++file) {
+			if (file->isDirectory()) {
+				// Make a deep copy, the node is handed to the other thread
+				_pending.push(Common::String(file->getPath().c_str()));
+				subDirs++;
+			}
+		}
+	}
+
+	if (_mutex)
+		_mutex->lock();
+
+	_listed.push(listed);
+	_dirsFound += subDirs;
+	_listingDone = _pending.empty();
+
+	// Drop our references while still holding the lock, as the reference
+	// counts are not atomic
+	listed = ListedDir();
+
+	if (_mutex)
+		_mutex->unlock();
+
+	return true;
+}
+
+bool MassDetector::detectNext(Common::FSNode &dir, GameList &candidates) {
+	if (!_threaded && _listed.empty())
+		listNext();
+
+	ListedDir listed;
+	if (_mutex)
+		_mutex->lock();
+	const bool available = !_listed.empty();
+	if (available)
+		listed = _listed.pop();
+	if (_mutex)
+		_mutex->unlock();
+
+	if (!available)
+		return false;
+
+	dir = listed.dir;
+	if (listed.files.empty())
+		candidates.clear();
+	else
+		candidates = EngineMan.detectGames(listed.files);
+
+	_dirsScanned++;
+	return true;
+}
+
+bool MassDetector::isFinished() const {
+	if (_mutex)
+		_mutex->lock();
+	const bool finished = _listingDone && _listed.empty();
+	if (_mutex)
+		_mutex->unlock();
+
+	return finished;
+}
+
+uint MassDetector::getDirsFound() const {
+	if (_mutex)
+		_mutex->lock();
+	const uint found = _dirsFound;
+	if (_mutex)
+		_mutex->unlock();
+
+	return found;
+}
@@ -0,0 +1,114 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_MASSDETECTOR_H
+#define ENGINES_MASSDETECTOR_H
+
+#include "common/fs.h"
+#include "common/mutex.h"
+#include "common/queue.h"
+#include "common/str.h"
+
+#include "engines/game.h"
+
+/**
+ * Detects the games in all directories of a tree.
+ *
+ * Detection is split into two stages: listing the contents of the
+ * directories, and running the engine detectors on them. Once the backend
+ * has been initialized, the directories are listed by a timer procedure,
+ * so waiting for the filesystem overlaps with running the detectors. Before
+ * that, as when detecting from the command line, both stages run on the
+ * calling thread.
+ *
+ * The detectors themselves always run on the calling thread, since neither
+ * plugin loading nor the fallback detection of many engines is reentrant.
+ *
+ * Directories are visited breadth first, with the entries of each directory
+ * sorted by name, so the order of the results only depends on the tree.
+ */
+class MassDetector {
+public:
+	/**
+	 * @param startDir	the directory to start at
+	 * @param recursive	whether to descend into subdirectories
+	 */
+	MassDetector(const Common::FSNode &startDir, bool recursive);
+	~MassDetector();
+
+	/**
+	 * Run the detectors on the next directory.
+	 *
+	 * @param dir			set to the directory
+	 * @param candidates	set to the games detected in it
+	 * @return false if there was no directory left, or none has been
+	 *         listed yet (see isFinished())
+	 */
+	bool detectNext(Common::FSNode &dir, GameList &candidates);
+
+	/**
+	 * Check whether all directories have been handled by detectNext().
+	 */
+	bool isFinished() const;
+
+	/**
+	 * Return the number of directories handled by detectNext().
+	 */
+	uint getDirsScanned() const { return _dirsScanned; }
+
+	/**
+	 * Return the number of directories found so far, including the ones
+	 * not handled yet.
+	 */
+	uint getDirsFound() const;
+
+private:
+	struct ListedDir {
+		Common::FSNode dir;
+		Common::FSList files;
+	};
+
+	/**
+	 * List the next directory and queue its subdirectories.
+	 * @return false if there was nothing left to list
+	 */
+	bool listNext();
+
+	static void listerProc(void *refCon);
+
+	const bool _recursive;
+	bool _threaded;
+
+	// Only accessed by the lister. Paths are stored instead of nodes, so
+	// no reference counted data is shared with the calling thread.
+	Common::Queue<Common::String> _pending;
+
+	// Shared with the lister, protected by _mutex when threaded.
+	Common::Mutex *_mutex;
+	Common::Queue<ListedDir> _listed;
+	bool _listingDone;
+	uint _dirsFound;
+
+	uint _dirsScanned;
+};
+
+#endif
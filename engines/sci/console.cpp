@@ -128,6 +128,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("room",				WRAP_METHOD(Console, cmdRoomNumber));
 	registerCmd("quit",				WRAP_METHOD(Console, cmdQuit));
 	registerCmd("list_saves",			WRAP_METHOD(Console, cmdListSaves));
+	registerCmd("avoidpath_bench",	WRAP_METHOD(Console, cmdAvoidPathBench));
 	// Graphics
 	registerCmd("show_map",			WRAP_METHOD(Console, cmdShowMap));
 	registerCmd("set_palette",		WRAP_METHOD(Console, cmdSetPalette));
@@ -225,6 +226,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("vm_bench",			WRAP_METHOD(Console, cmdVMBench));
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -256,6 +258,10 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	_debugState.breakpointWasHit = false;
 	_debugState._breakpoints.clear(); // No breakpoints defined
 	_debugState._activeBreakpointTypes = 0;
+	_debugState.recordPcTrace = false;
+
+	_vmBenchStartTime = 0;
+	_vmBenchStartSteps = 0;
 }
 
 Console::~Console() {
@@ -350,6 +356,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" version - Shows the resource and interpreter versions\n");
 	debugPrintf(" room - Gets or sets the current room number\n");
 	debugPrintf(" quit - Quits the game\n");
+	debugPrintf(" avoidpath_bench - Records pathfinding requests and measures the time to compute them\n");
 	debugPrintf("\n");
 	debugPrintf("Graphics:\n");
 	debugPrintf(" show_map - Switches to visual, priority, control or display screen\n");
@@ -424,6 +431,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" vm_bench - Records the executed SCI operations and measures the time to decode them\n");
 	debugPrintf(" vm_varlist / vmvarlist / vl - Shows the addresses of variables in the VM\n");
 	debugPrintf(" vm_vars / vmvars / vv - Displays or changes variables in the VM\n");
 	debugPrintf(" stack - Lists the specified number of stack elements\n");
@@ -1054,6 +1062,43 @@ bool Console::cmdRoomNumber(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdAvoidPathBench(int argc, const char **argv) {
+	if (argc != 2) {
+		debugPrintf("Records pathfinding requests of the game, and measures the time to compute\n");
+		debugPrintf("them with and without the visibility graph cache\n");
+		debugPrintf("Usage: %s start|stop|<iterations>\n", argv[0]);
+		debugPrintf("%d requests recorded\n", getRecordedAvoidPathInputs(_engine->_gamestate));
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "start")) {
+		recordAvoidPathInputs(_engine->_gamestate, true);
+		debugPrintf("Recording pathfinding requests\n");
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "stop")) {
+		recordAvoidPathInputs(_engine->_gamestate, false);
+		debugPrintf("%d requests recorded\n", getRecordedAvoidPathInputs(_engine->_gamestate));
+		return true;
+	}
+
+	const int iterations = atoi(argv[1]);
+	if (iterations <= 0) {
+		debugPrintf("Invalid number of iterations '%s'\n", argv[1]);
+		return true;
+	}
+
+	const AvoidPathBenchmarkResult result = benchmarkAvoidPath(_engine->_gamestate, iterations);
+	debugPrintf("%d requests, %d iterations\n", getRecordedAvoidPathInputs(_engine->_gamestate), iterations);
+	debugPrintf("Without cache: %d ms\n", result.uncachedMillis);
+	debugPrintf("With cache: %d ms\n", result.cachedMillis);
+	if (result.mismatches)
+		debugPrintf("WARNING: %d paths differ\n", result.mismatches);
+
+	return true;
+}
+
 bool Console::cmdResourceInfo(int argc, const char **argv) {
 	if (argc != 3) {
 		debugPrintf("Shows information about a resource\n");
@@ -3248,6 +3293,86 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdVMBench(int argc, const char **argv) {
+	if (argc != 2) {
+		debugPrintf("Records the addresses of the executed SCI operations, and measures the time\n");
+		debugPrintf("to decode them from the script buffers and from the decoded instruction cache\n");
+		debugPrintf("Usage: %s start|stop|<iterations>\n", argv[0]);
+		debugPrintf("%d operations recorded\n", _debugState.pcTrace.size());
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "start")) {
+		_debugState.pcTrace.clear();
+		_debugState.recordPcTrace = true;
+		_vmBenchStartTime = g_system->getMillis();
+		_vmBenchStartSteps = _engine->_gamestate->scriptStepCounter;
+		debugPrintf("Recording SCI operations\n");
+		return true;
+	}
+
+	if (!scumm_stricmp(argv[1], "stop")) {
+		if (_debugState.recordPcTrace) {
+			const uint32 time = g_system->getMillis() - _vmBenchStartTime;
+			const int steps = _engine->_gamestate->scriptStepCounter - _vmBenchStartSteps;
+			debugPrintf("%d operations executed in %d ms\n", steps, time);
+		}
+		_debugState.recordPcTrace = false;
+		debugPrintf("%d operations recorded\n", _debugState.pcTrace.size());
+		return true;
+	}
+
+	const int iterations = atoi(argv[1]);
+	if (iterations <= 0) {
+		debugPrintf("Invalid number of iterations '%s'\n", argv[1]);
+		return true;
+	}
+
+	// Only replay the operations of scripts which are still loaded
+	Common::Array<Script *> scripts;
+	Common::Array<uint32> offsets;
+	for (uint i = 0; i < _debugState.pcTrace.size(); i++) {
+		const reg32_t &pc = _debugState.pcTrace[i];
+		Script *script = _engine->_gamestate->_segMan->getScriptIfLoaded(pc.getSegment());
+		if (script && pc.getOffset() < script->getBufSize()) {
+			scripts.push_back(script);
+			offsets.push_back(pc.getOffset());
+		}
+	}
+
+	// Sum up the decoded data, so that the work can't be skipped
+	uint32 readSum = 0;
+	uint32 startTime = g_system->getMillis();
+	for (int i = 0; i < iterations; i++) {
+		for (uint j = 0; j < scripts.size(); j++) {
+			byte extOpcode;
+			int16 opparams[4];
+			readSum += readPMachineInstruction(scripts[j]->getBuf(offsets[j]), extOpcode, opparams);
+			readSum += extOpcode + opparams[0];
+		}
+	}
+	const uint32 readTime = g_system->getMillis() - startTime;
+
+	uint32 cachedSum = 0;
+	startTime = g_system->getMillis();
+	for (int i = 0; i < iterations; i++) {
+		for (uint j = 0; j < scripts.size(); j++) {
+			const PMachineInstruction instruction = scripts[j]->getInstruction(offsets[j]);
+			cachedSum += instruction.size;
+			cachedSum += instruction.extOpcode + instruction.opparams[0];
+		}
+	}
+	const uint32 cachedTime = g_system->getMillis() - startTime;
+
+	debugPrintf("%d of %d recorded operations replayed, %d iterations\n", scripts.size(), _debugState.pcTrace.size(), iterations);
+	debugPrintf("Decoding from the script buffers: %d ms\n", readTime);
+	debugPrintf("Decoded instruction cache: %d ms\n", cachedTime);
+	if (readSum != cachedSum)
+		debugPrintf("WARNING: the decoded instructions differ\n");
+
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	int curScriptNr = -1;
 
@@ -83,6 +83,7 @@ private:
 	bool cmdRoomNumber(int argc, const char **argv);
 	bool cmdQuit(int argc, const char **argv);
 	bool cmdListSaves(int argc, const char **argv);
+	bool cmdAvoidPathBench(int argc, const char **argv);
 	// Screen
 	bool cmdShowMap(int argc, const char **argv);
 	// Graphics
@@ -153,6 +154,7 @@ private:
 	bool cmdBreakpointAddress(int argc, const char **argv);
 	// VM
 	bool cmdScriptSteps(int argc, const char **argv);
+	bool cmdVMBench(int argc, const char **argv);
 	bool cmdScriptObjects(int argc, const char **argv);
 	bool cmdScriptStrings(int argc, const char **argv);
 	bool cmdScriptSaid(int argc, const char **argv);
@@ -200,6 +202,8 @@ private:
 	DebugState &_debugState;
 	Common::String _videoFile;
 	int _videoFrameDelay;
+	uint32 _vmBenchStartTime;
+	int _vmBenchStartSteps;
 };
 
 } // End of namespace Sci
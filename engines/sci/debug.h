@@ -23,6 +23,7 @@
 #ifndef SCI_DEBUG_H
 #define SCI_DEBUG_H
 
+#include "common/array.h"
 #include "common/list.h"
 #include "sci/engine/vm_types.h"	// for StackPtr
 
@@ -84,10 +85,16 @@ struct DebugState {
 	StackPtr old_sp;
 	Common::List<Breakpoint> _breakpoints;   //< List of breakpoints
 	int _activeBreakpointTypes;  //< Bit mask specifying which types of breakpoints are active
+	bool recordPcTrace;          //< Whether to record the addresses of executed instructions
+	Common::Array<reg32_t> pcTrace; //< Addresses of the executed instructions, for the vm_bench command
 
 	void updateActiveBreakpointTypes();
 };
 
+enum {
+	kMaxPcTraceSize = 4 * 1024 * 1024 //< Maximum number of addresses recorded in DebugState::pcTrace
+};
+
 // Various global variables used for debugging are declared here
 extern int g_debug_sleeptime_factor;
 extern int g_debug_simulated_key;
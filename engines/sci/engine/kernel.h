@@ -733,6 +733,40 @@ reg_t kFileIOIsValidDirectory(EngineState *s, int argc, reg_t *argv);
 
 //@}
 
+/**
+ * @name kAvoidPath support, see kpathing.cpp
+ */
+//@{
+
+struct AvoidPathCache;
+
+/** Frees the pathfinding state kept in EngineState::_avoidPathCache. */
+void freeAvoidPathCache(AvoidPathCache *cache);
+
+/**
+ * Starts or stops recording the kAvoidPath inputs, for
+ * benchmarkAvoidPath(). Starting discards the inputs recorded before.
+ */
+void recordAvoidPathInputs(EngineState *s, bool enable);
+
+/** Returns the number of recorded kAvoidPath inputs. */
+uint getRecordedAvoidPathInputs(EngineState *s);
+
+struct AvoidPathBenchmarkResult {
+	uint32 uncachedMillis; ///< Time taken without the visibility graph cache
+	uint32 cachedMillis;   ///< Time taken with the visibility graph cache
+	uint mismatches;       ///< Number of inputs with differing paths
+};
+
+/**
+ * Computes the paths for the recorded kAvoidPath inputs, with and without
+ * the visibility graph cache.
+ * @param iterations	how many times to compute each path
+ */
+AvoidPathBenchmarkResult benchmarkAvoidPath(EngineState *s, uint iterations);
+
+//@}
+
 } // End of namespace Sci
 
 #endif // SCI_ENGINE_KERNEL_H
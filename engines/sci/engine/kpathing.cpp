@@ -28,6 +28,7 @@
 #include "sci/graphics/palette.h"
 #include "sci/graphics/screen.h"
 
+#include "common/array.h"
 #include "common/debug-channels.h"
 #include "common/list.h"
 #include "common/system.h"
@@ -41,6 +42,9 @@ namespace Sci {
 
 #define AVOIDPATH_DYNMEM_STRING "AvoidPath polyline"
 
+// Maximum number of inputs recorded for the avoidpath_bench console command
+#define AVOIDPATH_MAX_RECORDED_INPUTS 1000
+
 #define POLY_LAST_POINT 0x7777
 #define POLY_POINT_SIZE 4
 
@@ -111,22 +115,32 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Position in the vertex index, and in the visibility graph cache (-1
+	// if not cached)
+	int index;
+	int cacheIndex;
+
+	// A* open set position (-1 if not in the open set), and the order in
+	// which the vertex was added to it
+	int heapIndex;
+	uint32 openOrder;
+
+	// Whether the shortest path to this vertex is known
+	bool closed;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = NULL;
+		index = -1;
+		cacheIndex = -1;
+		heapIndex = -1;
+		openOrder = 0;
+		closed = false;
 	}
 };
 
 class VertexList: public Common::List<Vertex *> {
-public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
-		}
-		return false;
-	}
 };
 
 /* Circular list definitions. */
@@ -236,6 +250,41 @@ public:
 
 typedef Common::List<Polygon *> PolygonList;
 
+// Pathfinding input, after conversion from the script data
+struct AvoidPathInput {
+	// Type and number of vertices of each polygon
+	Common::Array<int> types;
+	Common::Array<uint> sizes;
+
+	// Vertices of all polygons
+	Common::Array<Common::Point> points;
+
+	Common::Point start, end;
+	int width, height, opt;
+};
+
+// Visibility graph of the last polygon set, kept across kAvoidPath calls.
+// It is valid as long as only the vertices merged in for the start and end
+// points differ: these either have no edges, or lie on an existing edge,
+// and so don't change the visibility between the other vertices.
+struct AvoidPathCache {
+	// Vertices of the polygon set before the start and end points are
+	// merged, and the number of vertices of each polygon
+	Common::Array<Common::Point> points;
+	Common::Array<uint> sizes;
+
+	// Vertices visible from each vertex in ascending order, computed on
+	// first use
+	Common::Array<Common::Array<uint16> > visible;
+	Common::Array<bool> known;
+
+	// Inputs recorded for the avoidpath_bench console command
+	bool recording;
+	Common::Array<AvoidPathInput> inputs;
+
+	AvoidPathCache() : recording(false) {}
+};
+
 // Pathfinding state
 struct PathfindingState {
 	// List of all polygons
@@ -257,6 +306,14 @@ struct PathfindingState {
 	// Screen size
 	int _width, _height;
 
+	// Visibility graph cache, or NULL
+	AvoidPathCache *_cache;
+
+	// The vertices in the cache by cache index, and the vertices which are
+	// not in it in vertex index order
+	Common::Array<Vertex *> _cachedVertices;
+	Common::Array<Vertex *> _uncachedVertices;
+
 	PathfindingState(int width, int height) : _width(width), _height(height) {
 		vertex_start = NULL;
 		vertex_end = NULL;
@@ -264,6 +321,7 @@ struct PathfindingState {
 		_prependPoint = NULL;
 		_appendPoint = NULL;
 		vertices = 0;
+		_cache = NULL;
 	}
 
 	~PathfindingState() {
@@ -660,44 +718,91 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 }
 
 /**
- * Returns a list of all vertices that are visible from a particular vertex.
+ * Determines whether a vertex is visible from another vertex.
+ * @param s				the pathfinding state
+ * @param vertex_cur	the vertex to look from
+ * @param vertex		the vertex to look at
+ * @return true if the line between the vertices doesn't intersect a polygon
+ */
+static bool is_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges
+	for (int j = 0; j < s->vertices; j++) {
+		Vertex *edge = s->vertex_index[j];
+		if (VERTEX_HAS_EDGES(edge)) {
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
+
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
+
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Returns a list of all vertices that are visible from a particular vertex,
+ * in descending vertex index order.
  * @param s				the pathfinding state
  * @param vertex_cur	the vertex
  * @return list of vertices that are visible from vert
  */
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
+	AvoidPathCache *cache = s->_cache;
 
-	for (int i = 0; i < s->vertices; i++) {
-		Vertex *vertex = s->vertex_index[i];
+	if (!cache || vertex_cur->cacheIndex < 0) {
+		for (int i = 0; i < s->vertices; i++) {
+			Vertex *vertex = s->vertex_index[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
+			if (is_visible(s, vertex_cur, vertex))
+				visVerts->push_front(vertex);
+		}
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
+		return visVerts;
+	}
 
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
+	const int cur = vertex_cur->cacheIndex;
+
+	if (!cache->known[cur]) {
+		for (uint i = 0; i < s->_cachedVertices.size(); i++) {
+			if (is_visible(s, vertex_cur, s->_cachedVertices[i]))
+				cache->visible[cur].push_back(i);
 		}
 
-		if (j == s->vertices)
-			visVerts->push_front(vertex);
+		cache->known[cur] = true;
+	}
+
+	// Merge the cached vertices with the visible uncached ones, keeping the
+	// vertex index order
+	const Common::Array<uint16> &visible = cache->visible[cur];
+	uint next = 0;
+
+	for (uint i = 0; i < s->_uncachedVertices.size(); i++) {
+		Vertex *vertex = s->_uncachedVertices[i];
+
+		if (!is_visible(s, vertex_cur, vertex))
+			continue;
+
+		while (next < visible.size() && s->_cachedVertices[visible[next]]->index < vertex->index)
+			visVerts->push_front(s->_cachedVertices[visible[next++]]);
+
+		visVerts->push_front(vertex);
 	}
 
+	while (next < visible.size())
+		visVerts->push_front(s->_cachedVertices[visible[next++]]);
+
 	return visVerts;
 }
 
@@ -1186,39 +1291,40 @@ static void change_polygons_opt_0(PathfindingState *s) {
 }
 
 /**
- * Converts the SCI input data for pathfinding
+ * Lists the vertices of the polygon set
+ * Parameters: (PathfindingState *) s: The pathfinding state
+ *             (Common::Array<Common::Point> &) points: The vertices of all polygons
+ *             (Common::Array<uint> &) sizes: The number of vertices of each polygon
+ */
+static void list_polygon_set(PathfindingState *s, Common::Array<Common::Point> &points, Common::Array<uint> &sizes) {
+	for (PolygonList::iterator it = s->polygons.begin(); it != s->polygons.end(); ++it) {
+		Vertex *vertex;
+		uint size = 0;
+
+		CLIST_FOREACH(vertex, &(*it)->vertices) {
+			points.push_back(vertex->v);
+			size++;
+		}
+
+		sizes.push_back(size);
+	}
+}
+
+/**
+ * Prepares converted polygons for pathfinding: applies the optimization
+ * level, fixes up the start and end points and merges them into the polygon
+ * set. The polygons must have been added to the pathfinding state.
  * Parameters: (EngineState *) s: The game state
- *             (reg_t) poly_list: Polygon list
+ *             (PathfindingState *) pf_s: The pathfinding state
  *             (Common::Point) start: The start point
  *             (Common::Point) end: The end point
  *             (int) opt: Optimization level (0, 1 or 2)
- * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
- *                            NULL otherwise
+ * Returns   : (PathfindingState *) On success pf_s, NULL otherwise, in which
+ *                            case pf_s has been deleted
  */
-static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
-	SegManager *segMan = s->_segMan;
+static PathfindingState *prepare_polygon_set(EngineState *s, PathfindingState *pf_s, Common::Point start, Common::Point end, int opt) {
 	Polygon *polygon;
 	int count = 0;
-	PathfindingState *pf_s = new PathfindingState(width, height);
-
-	// Convert all polygons
-	if (poly_list.getSegment()) {
-		List *list = s->_segMan->lookupList(poly_list);
-		Node *node = s->_segMan->lookupNode(list->first);
-
-		while (node) {
-			// The node value might be null, in which case there's no polygon to parse.
-			// Happens in LB2 floppy - refer to bug #3041232
-			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
-
-			if (polygon) {
-				pf_s->polygons.push_back(polygon);
-				count += readSelectorValue(segMan, node->value, SELECTOR(size));
-			}
-
-			node = s->_segMan->lookupNode(node->succ);
-		}
-	}
 
 	if (opt == 0)
 		change_polygons_opt_0(pf_s);
@@ -1276,6 +1382,43 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		}
 	}
 
+	// Number the vertices for the cache, and start over if the polygon set
+	// changed
+	AvoidPathCache *cache = pf_s->_cache;
+
+	if (cache) {
+		uint cacheIndex = 0;
+		uint polygonIndex = 0;
+		bool same = cache->sizes.size() == pf_s->polygons.size();
+
+		for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+			Vertex *vertex;
+			const uint first = cacheIndex;
+
+			CLIST_FOREACH(vertex, &(*it)->vertices) {
+				same = same && cacheIndex < cache->points.size() && cache->points[cacheIndex] == vertex->v;
+				vertex->cacheIndex = cacheIndex++;
+			}
+
+			same = same && cache->sizes[polygonIndex++] == cacheIndex - first;
+		}
+
+		same = same && cacheIndex == cache->points.size();
+
+		if (!same) {
+			cache->points.clear();
+			cache->sizes.clear();
+			list_polygon_set(pf_s, cache->points, cache->sizes);
+			cache->visible.clear();
+			cache->visible.resize(cacheIndex);
+			cache->known.clear();
+			cache->known.resize(cacheIndex);
+		}
+
+		if (cacheIndex > 0xFFFF)
+			cache = pf_s->_cache = NULL;
+	}
+
 	// Merge start and end points into polygon set
 	pf_s->vertex_start = merge_point(pf_s, *new_start);
 	pf_s->vertex_end = merge_point(pf_s, *new_end);
@@ -1283,8 +1426,11 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_start;
 	delete new_end;
 
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+		count += (*it)->vertices.size();
+
 	// Allocate and build vertex index
-	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
+	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * count);
 
 	count = 0;
 
@@ -1293,15 +1439,179 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		Vertex *vertex;
 
 		CLIST_FOREACH(vertex, &polygon->vertices) {
+			vertex->index = count;
 			pf_s->vertex_index[count++] = vertex;
 		}
 	}
 
 	pf_s->vertices = count;
 
+	if (cache) {
+		pf_s->_cachedVertices.resize(cache->points.size());
+
+		for (int i = 0; i < count; i++) {
+			Vertex *vertex = pf_s->vertex_index[i];
+
+			if (vertex->cacheIndex < 0)
+				pf_s->_uncachedVertices.push_back(vertex);
+			else
+				pf_s->_cachedVertices[vertex->cacheIndex] = vertex;
+		}
+	}
+
 	return pf_s;
 }
 
+/**
+ * Converts the SCI input data for pathfinding
+ * Parameters: (EngineState *) s: The game state
+ *             (reg_t) poly_list: Polygon list
+ *             (Common::Point) start: The start point
+ *             (Common::Point) end: The end point
+ *             (int) opt: Optimization level (0, 1 or 2)
+ * Returns   : (PathfindingState *) On success a newly allocated pathfinding state,
+ *                            NULL otherwise
+ */
+static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Common::Point start, Common::Point end, int width, int height, int opt) {
+	Polygon *polygon;
+	PathfindingState *pf_s = new PathfindingState(width, height);
+
+	// Convert all polygons
+	if (poly_list.getSegment()) {
+		List *list = s->_segMan->lookupList(poly_list);
+		Node *node = s->_segMan->lookupNode(list->first);
+
+		while (node) {
+			// The node value might be null, in which case there's no polygon to parse.
+			// Happens in LB2 floppy - refer to bug #3041232
+			polygon = !node->value.isNull() ? convert_polygon(s, node->value) : NULL;
+
+			if (polygon)
+				pf_s->polygons.push_back(polygon);
+
+			node = s->_segMan->lookupNode(node->succ);
+		}
+	}
+
+	if (!s->_avoidPathCache)
+		s->_avoidPathCache = new AvoidPathCache();
+
+	AvoidPathCache *cache = s->_avoidPathCache;
+
+	if (cache->recording && cache->inputs.size() < AVOIDPATH_MAX_RECORDED_INPUTS) {
+		AvoidPathInput input;
+
+		for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it)
+			input.types.push_back((*it)->type);
+
+		list_polygon_set(pf_s, input.points, input.sizes);
+		input.start = start;
+		input.end = end;
+		input.width = width;
+		input.height = height;
+		input.opt = opt;
+		cache->inputs.push_back(input);
+	}
+
+	pf_s->_cache = cache;
+
+	return prepare_polygon_set(s, pf_s, start, end, opt);
+}
+
+/**
+ * The A* open set: a binary heap of vertices ordered by F cost. Of vertices
+ * with the same F cost, the one added last comes first.
+ */
+class OpenSet {
+public:
+	OpenSet() : _order(0) {}
+
+	~OpenSet() {
+		for (uint i = 0; i < _heap.size(); i++)
+			_heap[i]->heapIndex = -1;
+	}
+
+	bool empty() const {
+		return _heap.empty();
+	}
+
+	Vertex *top() const {
+		return _heap[0];
+	}
+
+	void push(Vertex *vertex) {
+		vertex->openOrder = _order++;
+		vertex->heapIndex = _heap.size();
+		_heap.push_back(vertex);
+		siftUp(vertex->heapIndex);
+	}
+
+	void pop() {
+		Vertex *last = _heap.back();
+		_heap[0]->heapIndex = -1;
+		_heap.pop_back();
+
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			last->heapIndex = 0;
+			siftDown(0);
+		}
+	}
+
+	/** Restores the order after the F cost of a vertex has decreased. */
+	void update(Vertex *vertex) {
+		siftUp(vertex->heapIndex);
+	}
+
+private:
+	static bool before(const Vertex *a, const Vertex *b) {
+		if (a->costF != b->costF)
+			return a->costF < b->costF;
+		return a->openOrder > b->openOrder;
+	}
+
+	void place(Vertex *vertex, int index) {
+		_heap[index] = vertex;
+		vertex->heapIndex = index;
+	}
+
+	void siftUp(int index) {
+		Vertex *vertex = _heap[index];
+
+		while (index > 0) {
+			const int parent = (index - 1) / 2;
+			if (!before(vertex, _heap[parent]))
+				break;
+			place(_heap[parent], index);
+			index = parent;
+		}
+
+		place(vertex, index);
+	}
+
+	void siftDown(int index) {
+		Vertex *vertex = _heap[index];
+		const int size = _heap.size();
+
+		for (;;) {
+			int child = 2 * index + 1;
+			if (child >= size)
+				break;
+			if (child + 1 < size && before(_heap[child + 1], _heap[child]))
+				child++;
+			if (!before(_heap[child], vertex))
+				break;
+			place(_heap[child], index);
+			index = child;
+		}
+
+		place(vertex, index);
+	}
+
+	Common::Array<Vertex *> _heap;
+	uint32 _order;
+};
+
 /**
  * Computes a shortest path from vertex_start to vertex_end. The caller can
  * construct the resulting path by following the path_prev links from
@@ -1310,40 +1620,35 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
-	// The remaining vertices
-	VertexList openSet;
+	// The vertices of which the shortest path is not known yet. Vertices of
+	// which it is known are marked as closed.
+	OpenSet openSet;
 
-	openSet.push_front(s->vertex_start);
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
+	openSet.push(s->vertex_start);
 
-	while (!openSet.empty()) {
-		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = 0;
-		uint32 min = HUGE_DISTANCE;
+	// WORKAROUND: The screen border check below fails in QFG1VGA, room 81
+	// (bug report #3568452). However, it is needed in other SCI1.1 games,
+	// such as LB2. Therefore, we add this workaround for that scene in
+	// QFG1VGA, until our algorithm matches better what SSCI is doing. With
+	// this workaround, QFG1VGA no longer freezes in that scene.
+	const bool qfg1VgaWorkaround = (g_sci->getGameId() == GID_QFG1VGA &&
+									g_sci->getEngineState()->currentRoomNumber() == 81);
 
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
-			}
-		}
+	while (!openSet.empty()) {
+		// Take the vertex in the open set with the lowest F cost
+		Vertex *vertex_min = openSet.top();
 
-		assert(vertex_min != 0);	// the vertex cost should never be bigger than HUGE_DISTANCE
+		assert(vertex_min->costF != HUGE_DISTANCE);	// the vertex cost should never be bigger than HUGE_DISTANCE
 
 		// Check if we are done
 		if (vertex_min == s->vertex_end)
 			break;
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+		openSet.pop();
+		vertex_min->closed = true;
 
 		VertexList *visVerts = visible_vertices(s, vertex_min);
 
@@ -1351,12 +1656,9 @@ static void AStar(PathfindingState *s) {
 			uint32 new_dist;
 			Vertex *vertex = *it;
 
-			if (closedSet.contains(vertex))
+			if (vertex->closed)
 				continue;
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
-
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
 			// When travelling to a vertex on the screen edge, we
@@ -1366,15 +1668,6 @@ static void AStar(PathfindingState *s) {
 			// other, while we apply a penalty to paths traversing it.
 			// This difference might lead to problems, but none are
 			// known at the time of writing.
-
-			// WORKAROUND: This check fails in QFG1VGA, room 81 (bug report #3568452).
-			// However, it is needed in other SCI1.1 games, such as LB2. Therefore, we
-			// add this workaround for that scene in QFG1VGA, until our algorithm matches
-			// better what SSCI is doing. With this workaround, QFG1VGA no longer freezes
-			// in that scene.
-			bool qfg1VgaWorkaround = (g_sci->getGameId() == GID_QFG1VGA &&
-									  g_sci->getEngineState()->currentRoomNumber() == 81);
-
 			if (s->pointOnScreenBorder(vertex->v) && !qfg1VgaWorkaround)
 				new_dist += 10000;
 
@@ -1382,6 +1675,12 @@ static void AStar(PathfindingState *s) {
 				vertex->costG = new_dist;
 				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
 				vertex->path_prev = vertex_min;
+
+				// Vertices seen for the first time always get here
+				if (vertex->heapIndex < 0)
+					openSet.push(vertex);
+				else
+					openSet.update(vertex);
 			}
 		}
 
@@ -1577,6 +1876,103 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 	}
 }
 
+void freeAvoidPathCache(AvoidPathCache *cache) {
+	delete cache;
+}
+
+void recordAvoidPathInputs(EngineState *s, bool enable) {
+	if (!s->_avoidPathCache)
+		s->_avoidPathCache = new AvoidPathCache();
+
+	if (enable)
+		s->_avoidPathCache->inputs.clear();
+	s->_avoidPathCache->recording = enable;
+}
+
+uint getRecordedAvoidPathInputs(EngineState *s) {
+	return s->_avoidPathCache ? s->_avoidPathCache->inputs.size() : 0;
+}
+
+/**
+ * Computes the path for a recorded input
+ * Parameters: (EngineState *) s: The game state
+ *             (const AvoidPathInput &) input: The recorded input
+ *             (AvoidPathCache *) cache: The visibility graph cache to use, or NULL
+ *             (Common::Array<Common::Point> *) path: If not NULL, receives the
+ *                                                    path from the end point back
+ */
+static void replay_input(EngineState *s, const AvoidPathInput &input, AvoidPathCache *cache, Common::Array<Common::Point> *path) {
+	PathfindingState *pf_s = new PathfindingState(input.width, input.height);
+	uint point = 0;
+
+	for (uint i = 0; i < input.sizes.size(); i++) {
+		Polygon *polygon = new Polygon(input.types[i]);
+
+		for (uint j = 0; j < input.sizes[i]; j++)
+			polygon->vertices.insertAtEnd(new Vertex(input.points[point++]));
+
+		pf_s->polygons.push_back(polygon);
+	}
+
+	pf_s->_cache = cache;
+	pf_s = prepare_polygon_set(s, pf_s, input.start, input.end, input.opt);
+
+	if (!pf_s)
+		return;
+
+	AStar(pf_s);
+
+	if (path) {
+		if (pf_s->_appendPoint)
+			path->push_back(*pf_s->_appendPoint);
+		for (Vertex *vertex = pf_s->vertex_end; vertex; vertex = vertex->path_prev)
+			path->push_back(vertex->v);
+		if (pf_s->_prependPoint)
+			path->push_back(*pf_s->_prependPoint);
+	}
+
+	delete pf_s;
+}
+
+AvoidPathBenchmarkResult benchmarkAvoidPath(EngineState *s, uint iterations) {
+	AvoidPathBenchmarkResult result;
+	result.uncachedMillis = result.cachedMillis = 0;
+	result.mismatches = 0;
+
+	if (!s->_avoidPathCache)
+		return result;
+
+	const Common::Array<AvoidPathInput> &inputs = s->_avoidPathCache->inputs;
+	Common::Array<Common::Array<Common::Point> > uncachedPaths, cachedPaths;
+
+	uncachedPaths.resize(inputs.size());
+	cachedPaths.resize(inputs.size());
+
+	uint32 startTime = g_system->getMillis();
+	for (uint i = 0; i < iterations; i++) {
+		for (uint j = 0; j < inputs.size(); j++)
+			replay_input(s, inputs[j], NULL, i ? NULL : &uncachedPaths[j]);
+	}
+	result.uncachedMillis = g_system->getMillis() - startTime;
+
+	// A separate cache, to leave the one of the game alone
+	AvoidPathCache cache;
+
+	startTime = g_system->getMillis();
+	for (uint i = 0; i < iterations; i++) {
+		for (uint j = 0; j < inputs.size(); j++)
+			replay_input(s, inputs[j], &cache, i ? NULL : &cachedPaths[j]);
+	}
+	result.cachedMillis = g_system->getMillis() - startTime;
+
+	for (uint j = 0; j < inputs.size(); j++) {
+		if (uncachedPaths[j] != cachedPaths[j])
+			result.mismatches++;
+	}
+
+	return result;
+}
+
 static bool PointInRect(const Common::Point &point, int16 rectX1, int16 rectY1, int16 rectX2, int16 rectY2) {
 	int16 top = MIN<int16>(rectY1, rectY2);
 	int16 left = MIN<int16>(rectX1, rectX2);
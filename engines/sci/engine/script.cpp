@@ -73,6 +73,30 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_instructionIndex.clear();
+	_instructions.clear();
+}
+
+PMachineInstruction Script::getInstruction(uint32 offset) {
+	if (_instructionIndex.empty())
+		_instructionIndex.resize(getBufSize());
+
+	const uint16 index = _instructionIndex[offset];
+	if (index)
+		return _instructions[index - 1];
+
+	PMachineInstruction instruction;
+	decodePMachineInstruction(getBuf(offset), instruction);
+
+	// The index can't address more instructions, decode the remaining ones
+	// every time
+	if (_instructions.size() < 0xFFFF) {
+		_instructions.push_back(instruction);
+		_instructionIndex[offset] = _instructions.size();
+	}
+
+	return instruction;
 }
 
 enum {
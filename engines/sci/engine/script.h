@@ -27,6 +27,7 @@
 #include "sci/util.h"
 #include "sci/engine/segment.h"
 #include "sci/engine/script_patches.h"
+#include "sci/engine/vm.h"
 
 namespace Sci {
 
@@ -102,6 +103,9 @@ private:
 	uint16 _offsetLookupStringCount;
 	uint16 _offsetLookupSaidCount;
 
+	Common::Array<uint16> _instructionIndex; /**< 1-based index into _instructions by buffer offset, 0 if not decoded yet */
+	Common::Array<PMachineInstruction> _instructions; /**< Instructions decoded by getInstruction() */
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -118,6 +122,12 @@ public:
 	}
 
 	const byte *getBuf(uint offset = 0) const { return _buf->getUnsafeDataAt(offset); }
+
+	/**
+	 * Returns the instruction at the given offset, which is decoded once
+	 * and kept for as long as the script is loaded.
+	 */
+	PMachineInstruction getInstruction(uint32 offset);
 	SciSpan<const byte> getSpan(uint offset) const { return _buf->subspan(offset); }
 
 	int getScriptNumber() const { return _nr; }
@@ -68,13 +68,15 @@ static const uint16 s_halfWidthSJISMap[256] = {
 
 EngineState::EngineState(SegManager *segMan)
 : _segMan(segMan),
-	_dirseeker() {
+	_dirseeker(),
+	_avoidPathCache(NULL) {
 
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	freeAvoidPathCache(_avoidPathCache);
 }
 
 void EngineState::reset(bool isRestoring) {
@@ -49,6 +49,7 @@ class EventManager;
 class MessageState;
 class SoundCommandParser;
 class VirtualIndexFile;
+struct AvoidPathCache;
 
 enum AbortGameState {
 	kAbortNone = 0,
@@ -192,6 +193,8 @@ public:
 
 	MessageState *_msgState;
 
+	AvoidPathCache *_avoidPathCache; /**< kAvoidPath visibility graph cache and recorded inputs */
+
 	// MemorySegment provides access to a 256-byte block of memory that remains
 	// intact across restarts and restores
 	enum {
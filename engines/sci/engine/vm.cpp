@@ -204,8 +204,15 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 // 16 bit:
 #define PUSH(v) PUSH32(make_reg(0, v))
 // 32 bit:
+#ifdef RELEASE_BUILD
+// The stack bounds are checked once per instruction in run_vm(), using the
+// stack accesses recorded in PMachineInstruction::stackUse
+#define PUSH32(a) (*((s->xs->sp)++) = (a))
+#define POP32() (*(--(s->xs->sp)))
+#else
 #define PUSH32(a) (*(validate_stack_addr(s, (s->xs->sp)++)) = (a))
 #define POP32() (*(validate_stack_addr(s, --(s->xs->sp))))
+#endif
 
 ExecStack *execute_method(EngineState *s, uint16 script, uint16 pubfunct, StackPtr sp, reg_t calling_obj, uint16 argc, StackPtr argp) {
 	int seg = s->_segMan->getScriptSegment(script);
@@ -535,6 +542,71 @@ int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4])
 	return offset;
 }
 
+void decodePMachineInstruction(const byte *src, PMachineInstruction &instruction) {
+	instruction.size = readPMachineInstruction(src, instruction.extOpcode, instruction.opparams);
+
+	const byte opcode = instruction.extOpcode >> 1;
+	switch (opcode) {
+	case op_add:
+	case op_sub:
+	case op_mul:
+	case op_div:
+	case op_mod:
+	case op_shr:
+	case op_shl:
+	case op_xor:
+	case op_and:
+	case op_or:
+	case op_eq_:
+	case op_ne_:
+	case op_gt_:
+	case op_ge_:
+	case op_lt_:
+	case op_le_:
+	case op_ugt_:
+	case op_uge_:
+	case op_ult_:
+	case op_ule_:
+	case op_sTop:
+		instruction.stackUse = kStackPop;
+		break;
+
+	case op_push:
+	case op_pushi:
+	case op_dup:
+	case op_info:
+	case op_superP:
+	case op_pprev:
+	case op_pTos:
+	case op_ipTos:
+	case op_dpTos:
+	case op_lofss:
+	case op_push0:
+	case op_push1:
+	case op_push2:
+	case op_pushSelf:
+		instruction.stackUse = kStackPush;
+		break;
+
+	default:
+		if (opcode >= op_lsg && opcode <= op_lsp)
+			instruction.stackUse = kStackPush;
+		else if (opcode >= op_lsgi && opcode <= op_lspi)
+			instruction.stackUse = kStackPush;
+		else if (opcode >= op_sagi && opcode <= op_sapi)
+			instruction.stackUse = kStackPop;
+		else if ((opcode >= op_ssg && opcode <= op_ssp) || (opcode >= op_ssgi && opcode <= op_sspi))
+			instruction.stackUse = kStackPop;
+		else if ((opcode >= op_plussg && opcode <= op_plussp) || (opcode >= op_plussgi && opcode <= op_plusspi))
+			instruction.stackUse = kStackPush;
+		else if ((opcode >= op_minussg && opcode <= op_minussp) || (opcode >= op_minussgi && opcode <= op_minusspi))
+			instruction.stackUse = kStackPush;
+		else
+			instruction.stackUse = 0;
+		break;
+	}
+}
+
 uint32 findOffset(const int16 relOffset, const Script *scr, const uint32 pcOffset) {
 	uint32 offset;
 
@@ -568,7 +640,6 @@ void run_vm(EngineState *s) {
 	int temp;
 	reg_t r_temp; // Temporary register
 	StackPtr s_temp; // Temporary stack pointer
-	int16 opparams[4]; // opcode parameters
 
 	s->r_rest = 0;	// &rest adjusts the parameter count by this value
 	// Current execution data:
@@ -650,9 +721,15 @@ void run_vm(EngineState *s) {
 			error("run_vm(): program counter gone astray, addr: %d, code buffer size: %d",
 			s->xs->addr.pc.getOffset(), scr->getBufSize());
 
-		// Get opcode
-		byte extOpcode;
-		s->xs->addr.pc.incOffset(readPMachineInstruction(scr->getBuf(s->xs->addr.pc.getOffset()), extOpcode, opparams));
+		if (g_sci->_debugState.recordPcTrace && g_sci->_debugState.pcTrace.size() < kMaxPcTraceSize)
+			g_sci->_debugState.pcTrace.push_back(s->xs->addr.pc);
+
+		// Get opcode. The instruction is copied, as running it may decode
+		// further instructions of the same script.
+		const PMachineInstruction instruction = scr->getInstruction(s->xs->addr.pc.getOffset());
+		const byte extOpcode = instruction.extOpcode;
+		const int16 *opparams = instruction.opparams;
+		s->xs->addr.pc.incOffset(instruction.size);
 		const byte opcode = extOpcode >> 1;
 		//debug("%s: %d, %d, %d, %d, acc = %04x:%04x, script %d, local script %d", opcodeNames[opcode], opparams[0], opparams[1], opparams[2], opparams[3], PRINT_REG(s->r_acc), scr->getScriptNumber(), local_script->getScriptNumber());
 
@@ -671,6 +748,13 @@ void run_vm(EngineState *s) {
 		prevOpcode = opcode;
 #endif
 
+#ifdef RELEASE_BUILD
+		if ((instruction.stackUse & kStackPop) && s->xs->sp <= s->stack_base)
+			validate_stack_addr(s, s->xs->sp - 1);
+		if ((instruction.stackUse & kStackPush) && s->xs->sp >= s->stack_top)
+			validate_stack_addr(s, s->xs->sp);
+#endif
+
 		switch (opcode) {
 
 		case op_bnot: // 0x00 (00)
@@ -1086,8 +1170,10 @@ void run_vm(EngineState *s) {
 			temp = (uint16) opparams[0]; // First argument
 			s->r_rest = MAX<int16>(s->xs->argc - temp + 1, 0); // +1 because temp counts the paramcount while argc doesn't
 
+			// Pushes a variable number of values, so the stack is checked
+			// for each
 			for (; temp <= s->xs->argc; temp++)
-				PUSH32(s->xs->variables_argp[temp]);
+				*(validate_stack_addr(s, (s->xs->sp)++)) = s->xs->variables_argp[temp];
 
 			break;
 
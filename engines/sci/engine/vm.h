@@ -413,6 +413,30 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj, Selector selectorid,
  */
 int readPMachineInstruction(const byte *src, byte &extOpcode, int16 opparams[4]);
 
+/** Stack accesses of an instruction, see PMachineInstruction::stackUse */
+enum {
+	kStackPop = 1 << 0,  ///< the instruction pops one value
+	kStackPush = 1 << 1  ///< the instruction pushes one value
+};
+
+/**
+ * A decoded PMachine instruction.
+ */
+struct PMachineInstruction {
+	byte extOpcode;     ///< "extended" opcode
+	byte stackUse;      ///< kStackPop and kStackPush flags
+	uint16 size;        ///< length in bytes
+	int16 opparams[4];  ///< parameters
+};
+
+/**
+ * Decode a PMachine instruction from a memory buffer.
+ *
+ * @param[in] src			address from which to start parsing
+ * @param[out] instruction	the decoded instruction
+ */
+void decodePMachineInstruction(const byte *src, PMachineInstruction &instruction);
+
 /**
  * Finds the script-absolute offset of a relative object offset.
  *
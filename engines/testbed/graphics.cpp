@@ -20,8 +20,11 @@
  *
  */
 
+#include "common/archive.h"
 #include "common/events.h"
+#include "common/file.h"
 #include "common/list.h"
+#include "common/memstream.h"
 #include "common/random.h"
 
 #include "engines/engine.h"
@@ -29,12 +32,28 @@
 #include "testbed/graphics.h"
 #include "testbed/testsuite.h"
 
+#include "graphics/conversion.h"
 #include "graphics/cursorman.h"
 #include "graphics/fontman.h"
+#include "graphics/fonts/ttf.h"
 #include "graphics/palette.h"
 #include "graphics/surface.h"
+#include "graphics/transparent_surface.h"
 #include "graphics/VectorRendererSpec.h"
 
+#include "gui/gui-manager.h"
+#include "gui/ThemeEngine.h"
+
+#include "image/codecs/cinepak.h"
+#include "image/codecs/msvideo1.h"
+#include "image/codecs/qtrle.h"
+#include "image/codecs/rpza.h"
+
+#include "video/avi_decoder.h"
+#include "video/bink_decoder.h"
+#include "video/qt_decoder.h"
+#include "video/smk_decoder.h"
+
 namespace Testbed {
 
 byte GFXTestSuite::_palette[256 * 3] = {0, 0, 0, 255, 255, 255, 255, 255, 255};
@@ -77,6 +96,12 @@ GFXTestSuite::GFXTestSuite() {
 	addTest("PaletteRotation", &GFXtests::paletteRotation);
 	addTest("cursorTrailsInGUI", &GFXtests::cursorTrails);
 	//addTest("Pixel Formats", &GFXtests::pixelFormats);
+	addTest("ConversionThroughput", &GFXtests::conversionThroughput, false);
+	addTest("TransparentBlitThroughput", &GFXtests::transparentBlitThroughput, false);
+	addTest("ThemeLoadTime", &GFXtests::themeLoadTime, false);
+	addTest("TextDrawThroughput", &GFXtests::textDrawThroughput, false);
+	addTest("VideoDecodeThroughput", &GFXtests::videoDecodeThroughput, false);
+	addTest("CodecDecodeThroughput", &GFXtests::codecDecodeThroughput, false);
 }
 
 void GFXTestSuite::setCustomColor(uint r, uint g, uint b) {
@@ -1286,4 +1311,650 @@ TestExitStatus GFXtests::pixelFormats() {
 	return kTestPassed;
 }
 
+TestExitStatus GFXtests::conversionThroughput() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the throughput of the pixel format conversions", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Conversion Throughput\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Converting...", Common::Point(0, 100));
+	}
+
+	const Graphics::PixelFormat clut8 = Graphics::PixelFormat::createFormatCLUT8();
+	const Graphics::PixelFormat rgb565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+	const Graphics::PixelFormat xrgb8888(4, 8, 8, 8, 0, 16, 8, 0, 0);
+	const Graphics::PixelFormat rgba8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	const Graphics::PixelFormat bgra8888(4, 8, 8, 8, 8, 8, 16, 24, 0);
+
+	static const struct {
+		const Graphics::PixelFormat *src, *dst;
+		const char *name;
+	} pairs[] = {
+		{ &clut8, &rgb565, "CLUT8 -> RGB565" },
+		{ &clut8, &xrgb8888, "CLUT8 -> XRGB8888" },
+		{ &rgb565, &xrgb8888, "RGB565 -> XRGB8888" },
+		{ &xrgb8888, &rgb565, "XRGB8888 -> RGB565" },
+		{ &bgra8888, &rgba8888, "BGRA8888 -> RGBA8888" },
+		{ &rgba8888, &bgra8888, "RGBA8888 -> BGRA8888" }
+	};
+	static const struct {
+		uint w, h;
+	} sizes[] = { { 320, 200 }, { 640, 480 }, { 1280, 720 }, { 1920, 1080 } };
+	const uint kPixels = 200 * 1000 * 1000;
+
+	Common::RandomSource rnd("testbed");
+	uint32 map[256];
+	for (uint i = 0; i < ARRAYSIZE(map); i++)
+		map[i] = rnd.getRandomNumber(0xFFFFFFFF);
+
+	for (uint s = 0; s < ARRAYSIZE(sizes); s++) {
+		const uint w = sizes[s].w, h = sizes[s].h;
+		byte *src = new byte[w * h * 4];
+		byte *dst = new byte[w * h * 4];
+		for (uint i = 0; i < w * h * 4; i++)
+			src[i] = rnd.getRandomNumber(255);
+
+		for (uint p = 0; p < ARRAYSIZE(pairs); p++) {
+			const Graphics::PixelFormat &srcFmt = *pairs[p].src, &dstFmt = *pairs[p].dst;
+			const uint frames = kPixels / (w * h);
+
+			const uint32 start = g_system->getMillis();
+			for (uint frame = 0; frame < frames; frame++) {
+				if (srcFmt.bytesPerPixel == 1)
+					Graphics::crossBlitMap(dst, src, w * dstFmt.bytesPerPixel, w, w, h, dstFmt.bytesPerPixel, map);
+				else
+					Graphics::crossBlit(dst, src, w * dstFmt.bytesPerPixel, w * srcFmt.bytesPerPixel, w, h, dstFmt, srcFmt);
+			}
+			const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			Testsuite::logDetailedPrintf("Converting %s at %ux%u: %u frames in %ums, %u us per frame\n",
+				pairs[p].name, w, h, frames, elapsed, elapsed * 1000 / frames);
+		}
+
+		delete[] src;
+		delete[] dst;
+	}
+
+	return kTestPassed;
+}
+
+TestExitStatus GFXtests::transparentBlitThroughput() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the throughput of the transparent surface blits", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Transparent Blit Throughput\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Blitting...", Common::Point(0, 100));
+	}
+
+	// A render queue like the ones of Wintermute games: a full screen
+	// background, then sprites with all blend modes, faded and flipped.
+	static const struct {
+		int w, h;
+		Graphics::AlphaType alphaType;
+		Graphics::TSpriteBlendMode blendMode;
+		uint32 color;
+		int flipping;
+		int count;
+	} queue[] = {
+		{ 800, 600, Graphics::ALPHA_OPAQUE, Graphics::BLEND_NORMAL, 0xFFFFFFFF, Graphics::FLIP_NONE, 1 },
+		{ 256, 256, Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, 0xFFFFFFFF, Graphics::FLIP_NONE, 8 },
+		{ 128, 192, Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, 0xFFFFFFFF, Graphics::FLIP_H, 8 },
+		{ 128, 192, Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, 0x80FFFFFF, Graphics::FLIP_NONE, 4 },
+		{ 64, 64, Graphics::ALPHA_BINARY, Graphics::BLEND_NORMAL, 0xFFFFFFFF, Graphics::FLIP_NONE, 32 },
+		{ 64, 64, Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, 0xFFC08040, Graphics::FLIP_NONE, 16 },
+		{ 128, 128, Graphics::ALPHA_FULL, Graphics::BLEND_ADDITIVE, 0xFFFFFFFF, Graphics::FLIP_NONE, 8 },
+		{ 128, 128, Graphics::ALPHA_FULL, Graphics::BLEND_SUBTRACTIVE, 0xFFFFFFFF, Graphics::FLIP_NONE, 4 },
+		{ 128, 128, Graphics::ALPHA_FULL, Graphics::BLEND_MULTIPLY, 0xFFFFFFFF, Graphics::FLIP_V, 4 },
+		{ 800, 100, Graphics::ALPHA_FULL, Graphics::BLEND_NORMAL, 0xFFFFFFFF, Graphics::FLIP_NONE, 1 }
+	};
+	const uint kFrames = 200;
+
+	Common::RandomSource rnd("testbed");
+	const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+	Graphics::Surface target;
+	target.create(800, 600, format);
+
+	Graphics::TransparentSurface *sprites[ARRAYSIZE(queue)];
+	for (uint i = 0; i < ARRAYSIZE(queue); i++) {
+		sprites[i] = new Graphics::TransparentSurface();
+		sprites[i]->create(queue[i].w, queue[i].h, format);
+		sprites[i]->setAlphaMode(queue[i].alphaType);
+		uint32 *pixels = (uint32 *)sprites[i]->getPixels();
+		for (int p = 0; p < queue[i].w * queue[i].h; p++)
+			pixels[p] = rnd.getRandomNumber(0xFFFFFFFF);
+	}
+
+	const uint32 start = g_system->getMillis();
+	for (uint frame = 0; frame < kFrames; frame++) {
+		for (uint i = 0; i < ARRAYSIZE(queue); i++) {
+			for (int n = 0; n < queue[i].count; n++) {
+				// Spread the sprites over the screen, some partially off screen
+				const int x = (n * 97 + frame) % 800 - queue[i].w / 4;
+				const int y = (n * 61 + i * 37) % 600 - queue[i].h / 4;
+				sprites[i]->blit(target, x, y, queue[i].flipping, nullptr, queue[i].color, -1, -1, queue[i].blendMode);
+			}
+		}
+	}
+	const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+	Testsuite::logDetailedPrintf("Blitting the render queue: %u frames in %ums, %u us per frame\n",
+		kFrames, elapsed, elapsed * 1000 / kFrames);
+
+	for (uint i = 0; i < ARRAYSIZE(queue); i++) {
+		sprites[i]->free();
+		delete sprites[i];
+	}
+	target.free();
+
+	return kTestPassed;
+}
+
+TestExitStatus GFXtests::themeLoadTime() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the loading time of the GUI theme", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Theme Load Time\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Loading...", Common::Point(0, 100));
+	}
+
+	const Common::String themeId = g_gui.theme()->getThemeId();
+	const GUI::ThemeEngine::GraphicsMode mode = (GUI::ThemeEngine::GraphicsMode)g_gui.theme()->getGraphicsMode();
+
+	// The first load parses the XML data and compiles it, the following
+	// ones load the compiled theme.
+	GUI::ThemeEngine::invalidateCompiledThemes();
+
+	bool passed = true;
+	for (int i = 0; i < 3; i++) {
+		const uint32 start = g_system->getMillis();
+		GUI::ThemeEngine *theme = new GUI::ThemeEngine(themeId, mode);
+		const bool ready = theme->init();
+		const uint32 elapsed = g_system->getMillis() - start;
+		delete theme;
+
+		if (!ready) {
+			Testsuite::logPrintf("Error! Failed to load theme '%s'\n", themeId.c_str());
+			passed = false;
+			break;
+		}
+
+		Testsuite::logDetailedPrintf("Loading theme '%s' (%s): %ums\n", themeId.c_str(), i ? "compiled" : "XML", elapsed);
+	}
+
+	return passed ? kTestPassed : kTestFailed;
+}
+
+TestExitStatus GFXtests::textDrawThroughput() {
+#ifdef USE_FREETYPE2
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the throughput of drawing subtitles with a TrueType font", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Text Draw Throughput\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Drawing...", Common::Point(0, 100));
+	}
+
+	Common::File file;
+	if (!file.open("FreeSans.ttf")) {
+		Testsuite::logPrintf("Info! Skipping test : Text Draw Throughput, FreeSans.ttf not found\n");
+		return kTestSkipped;
+	}
+
+	// Subtitles redrawn every frame, like Wintermute does on a 32 bit
+	// screen and ZVision on a 16 bit one.
+	static const char *const subtitles[] = {
+		"You know, I have been waiting for you for quite a while now.",
+		"The key you are looking for is in the drawer of the old desk,",
+		"but the drawer is locked and I have no idea where to find that key.",
+		"Perhaps \"Mr. Wavertree\" knows more about it. Try asking him!"
+	};
+	static const struct {
+		int width, height;
+		Graphics::PixelFormat format;
+	} screens[] = {
+		{ 800, 600, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) },
+		{ 640, 480, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) }
+	};
+	static const int sizes[] = { 16, 32 };
+	const uint kFrames = 200;
+
+	for (uint s = 0; s < ARRAYSIZE(sizes); s++) {
+		file.seek(0);
+		Graphics::Font *font = Graphics::loadTTFFont(file, sizes[s]);
+		if (!font) {
+			Testsuite::logPrintf("Error! Failed to load FreeSans.ttf\n");
+			return kTestFailed;
+		}
+
+		for (uint i = 0; i < ARRAYSIZE(screens); i++) {
+			Graphics::Surface target;
+			target.create(screens[i].width, screens[i].height, screens[i].format);
+			const uint32 color = screens[i].format.RGBToColor(255, 255, 192);
+
+			// Draw character by character first, which is how every string
+			// used to be drawn.
+			uint32 start = g_system->getMillis();
+			for (uint frame = 0; frame < kFrames; frame++) {
+				for (uint line = 0; line < ARRAYSIZE(subtitles); line++) {
+					int x = 20;
+					uint32 last = 0;
+					for (const char *c = subtitles[line]; *c; c++) {
+						const uint32 cur = (byte)*c;
+						x += font->getKerningOffset(last, cur);
+						last = cur;
+						font->drawChar(&target, cur, x, target.h - (4 - line) * font->getFontHeight(), color);
+						x += font->getCharWidth(cur);
+					}
+				}
+			}
+			const uint32 charElapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			start = g_system->getMillis();
+			for (uint frame = 0; frame < kFrames; frame++) {
+				for (uint line = 0; line < ARRAYSIZE(subtitles); line++) {
+					font->drawString(&target, subtitles[line], 0, target.h - (4 - line) * font->getFontHeight(), target.w, color, Graphics::kTextAlignCenter);
+				}
+			}
+			const uint32 stringElapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+			Testsuite::logDetailedPrintf("Drawing subtitles at size %d, %dbpp: %u us per frame by character, %u us per frame by string\n",
+				sizes[s], screens[i].format.bytesPerPixel * 8, charElapsed * 1000 / kFrames, stringElapsed * 1000 / kFrames);
+
+			target.free();
+		}
+
+		delete font;
+	}
+
+	return kTestPassed;
+#else
+	Testsuite::logPrintf("Info! Skipping test : Text Draw Throughput, FreeType2 support is not compiled in\n");
+	return kTestSkipped;
+#endif
+}
+
+namespace {
+
+Video::VideoDecoder *createVideoDecoder(Common::String fileName) {
+	fileName.toLowercase();
+
+#ifdef USE_BINK
+	if (fileName.hasSuffix(".bik"))
+		return new Video::BinkDecoder();
+#endif
+	if (fileName.hasSuffix(".smk"))
+		return new Video::SmackerDecoder();
+	if (fileName.hasSuffix(".avi"))
+		return new Video::AVIDecoder();
+	if (fileName.hasSuffix(".mov"))
+		return new Video::QuickTimeDecoder();
+
+	return 0;
+}
+
+} // End of anonymous namespace
+
+TestExitStatus GFXtests::videoDecodeThroughput() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the decoding speed of the videos in the game directory", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Video Decode Throughput\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Decoding...", Common::Point(0, 100));
+	}
+
+	static const char *const patterns[] = { "*.bik", "*.smk", "*.avi", "*.mov" };
+	const uint kMaxFrames = 500;
+	const uint32 kPlaybackTime = 5000;
+
+	bool found = false;
+	for (uint i = 0; i < ARRAYSIZE(patterns); i++) {
+		Common::ArchiveMemberList files;
+		if (!SearchMan.listMatchingMembers(files, patterns[i]))
+			continue;
+
+		const Common::String fileName = files.front()->getName();
+		Video::VideoDecoder *decoder = createVideoDecoder(fileName);
+		if (!decoder)
+			continue;
+
+		if (!decoder->loadFile(fileName)) {
+			Testsuite::logPrintf("Error! Failed to load '%s'\n", fileName.c_str());
+			delete decoder;
+			return kTestFailed;
+		}
+		found = true;
+
+		// Decode as fast as possible
+		uint frames = 0;
+		uint32 worstTime = 0;
+		const uint32 start = g_system->getMillis();
+		while (frames < kMaxFrames && (uint)(decoder->getCurFrame() + 1) < decoder->getFrameCount()) {
+			const uint32 frameStart = g_system->getMillis();
+			decoder->decodeNextFrame();
+			worstTime = MAX(worstTime, g_system->getMillis() - frameStart);
+			frames++;
+		}
+		const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+		Testsuite::logDetailedPrintf("Decoding '%s': %u frames, %u fps, slowest frame %ums\n",
+			fileName.c_str(), frames, frames * 1000 / elapsed, worstTime);
+
+		// Play back in real time, the way engines poll for the next frame,
+		// and measure how long the engine waits for decodeNextFrame().
+		for (uint decodeAhead = 0; decodeAhead <= 4; decodeAhead += 4) {
+			decoder->rewind();
+			decoder->setDecodeAhead(decodeAhead);
+			decoder->setVolume(0);
+			decoder->start();
+
+			frames = 0;
+			worstTime = 0;
+			const uint32 playbackStart = g_system->getMillis();
+			while (!decoder->endOfVideo() && g_system->getMillis() - playbackStart < kPlaybackTime) {
+				if (decoder->needsUpdate()) {
+					const uint32 frameStart = g_system->getMillis();
+					decoder->decodeNextFrame();
+					worstTime = MAX(worstTime, g_system->getMillis() - frameStart);
+					frames++;
+				}
+				decoder->decodeAhead();
+				g_system->delayMillis(1);
+			}
+
+			decoder->stop();
+
+			Testsuite::logDetailedPrintf("Playing '%s' decoding %u frames ahead: %u frames, longest wait for a frame %ums\n",
+				fileName.c_str(), decodeAhead, frames, worstTime);
+		}
+
+		delete decoder;
+	}
+
+	if (!found) {
+		Testsuite::logPrintf("Info! Skipping test : Video Decode Throughput, no videos found\n");
+		return kTestSkipped;
+	}
+
+	return kTestPassed;
+}
+
+namespace {
+
+/**
+ * Builds synthetic frames for the codec benchmark, using all block types
+ * of the codecs.
+ */
+class CodecFrameWriter {
+public:
+	CodecFrameWriter(Common::RandomSource &rnd) : _rnd(rnd) {}
+
+	const Common::Array<byte> &data() const { return _data; }
+
+	void writeMSVideo1(uint w, uint h) {
+		for (uint i = 0; i < (w / 4) * (h / 4); i++) {
+			switch (_rnd.getRandomNumber(3)) {
+			case 0: // 1 color
+				put16LE(0x8000 | randomValue(0x7FFF));
+				break;
+			case 1: // 2 colors
+				put16LE(randomValue(0x7FFF));
+				put16LE(randomValue(0x7FFF));
+				put16LE(randomValue(0x7FFF));
+				break;
+			case 2: // 8 colors
+				put16LE(randomValue(0x7FFF));
+				put16LE(0x8000 | randomValue(0x7FFF));
+				for (int j = 0; j < 7; j++)
+					put16LE(randomValue(0x7FFF));
+				break;
+			default: // skip
+				put16LE(0x8401);
+				break;
+			}
+		}
+	}
+
+	void writeRPZA(uint w, uint h) {
+		put8(0xE1);
+		put16BE(0); // Chunk size, set below
+		put8(0);
+
+		for (uint i = 0; i < ((w + 3) / 4) * ((h + 3) / 4); i++) {
+			switch (_rnd.getRandomNumber(3)) {
+			case 0: // fill
+				put8(0xA0);
+				put16BE(randomValue(0x7FFF));
+				break;
+			case 1: // blend
+				put8(0xC0);
+				put16BE(randomValue(0x7FFF));
+				put16BE(randomValue(0x7FFF));
+				for (int j = 0; j < 4; j++)
+					put8(randomValue(0xFF));
+				break;
+			case 2: // 16 colors
+				for (int j = 0; j < 16; j++)
+					put16BE(randomValue(0x7FFF));
+				break;
+			default: // skip
+				put8(0x80);
+				break;
+			}
+		}
+
+		_data[1] = _data.size() >> 16;
+		_data[2] = _data.size() >> 8;
+		_data[3] = _data.size();
+	}
+
+	void writeQTRLE(uint w, uint h, uint bitsPerPixel) {
+		put16BE(0); // Chunk size, which is not checked
+		put16BE(0);
+		put16BE(0); // No header
+
+		for (uint y = 0; y < h; y++) {
+			put8(1);
+
+			for (uint x = 0; x < w;) {
+				const uint count = MIN<uint>(1 + _rnd.getRandomNumber(15), w - x);
+				if (_rnd.getRandomNumber(1)) {
+					put8(-(int)count); // run
+					putQTRLEColor(bitsPerPixel);
+				} else {
+					put8(count); // copy
+					for (uint i = 0; i < count; i++)
+						putQTRLEColor(bitsPerPixel);
+				}
+				x += count;
+			}
+
+			put8(0xFF);
+		}
+	}
+
+	void writeCinepak(uint w, uint h) {
+		const uint kStripCount = 4;
+		const uint stripHeight = h / kStripCount;
+
+		put8(0); // flags
+		put8(0); // Frame size, set below
+		put16BE(0);
+		put16BE(w);
+		put16BE(h);
+		put16BE(kStripCount);
+
+		for (uint strip = 0; strip < kStripCount; strip++) {
+			const uint stripStart = _data.size();
+			put16BE(0x1000);
+			put16BE(0); // Strip size, set below
+			put16BE(0);
+			put16BE(0);
+			put16BE(stripHeight);
+			put16BE(w);
+
+			// V4 and V1 codebooks
+			for (byte chunkID = 0x20; chunkID <= 0x22; chunkID += 2) {
+				put8(chunkID);
+				put8(0);
+				put16BE(4 + 256 * 6);
+				for (uint i = 0; i < 256 * 6; i++)
+					put8(randomValue(0xFF));
+			}
+
+			// Vectors, choosing V1 or V4 for each block
+			const uint chunkStart = _data.size();
+			put8(0x30);
+			put8(0); // Chunk size, set below
+			put16BE(0);
+
+			const uint blocks = (w / 4) * (stripHeight / 4);
+			for (uint i = 0; i < blocks; i += 32) {
+				const uint32 flags = _rnd.getRandomNumber(0xFFFFFFFF);
+				put16BE(flags >> 16);
+				put16BE(flags);
+
+				for (uint j = 0; j < 32 && i + j < blocks; j++) {
+					for (int k = (flags & (0x80000000 >> j)) ? 4 : 1; k > 0; k--)
+						put8(randomValue(0xFF));
+				}
+			}
+
+			setSize24(chunkStart + 1, _data.size() - chunkStart);
+			_data[stripStart + 2] = (_data.size() - stripStart) >> 8;
+			_data[stripStart + 3] = (_data.size() - stripStart);
+		}
+
+		setSize24(1, _data.size());
+	}
+
+private:
+	Common::RandomSource &_rnd;
+	Common::Array<byte> _data;
+
+	uint32 randomValue(uint32 max) { return _rnd.getRandomNumber(max); }
+
+	void put8(uint32 value) { _data.push_back(value & 0xFF); }
+	void put16BE(uint32 value) { put8(value >> 8); put8(value); }
+	void put16LE(uint32 value) { put8(value); put8(value >> 8); }
+
+	void putQTRLEColor(uint bitsPerPixel) {
+		for (uint i = 0; i < bitsPerPixel / 8; i++)
+			put8(randomValue(0xFF));
+	}
+
+	void setSize24(uint pos, uint32 size) {
+		_data[pos] = size >> 16;
+		_data[pos + 1] = size >> 8;
+		_data[pos + 2] = size;
+	}
+};
+
+Image::Codec *createBenchmarkCodec(uint32 tag, uint w, uint h, uint bitsPerPixel) {
+	switch (tag) {
+	case MKTAG('c', 'v', 'i', 'd'):
+		return new Image::CinepakDecoder(bitsPerPixel);
+	case MKTAG('m', 's', 'v', 'c'):
+		return new Image::MSVideo1Decoder(w, h, bitsPerPixel);
+	case MKTAG('r', 'p', 'z', 'a'):
+		return new Image::RPZADecoder(w, h);
+	default:
+		return new Image::QTRLEDecoder(w, h, bitsPerPixel);
+	}
+}
+
+/**
+ * Decode the frame repeatedly, converting it to the format afterwards when
+ * the codec does not decode into it by itself.
+ *
+ * @return the milliseconds taken
+ */
+uint32 decodeCodecFrames(Image::Codec *codec, const Common::Array<byte> &data, const Graphics::PixelFormat &format, uint frames) {
+	const uint32 start = g_system->getMillis();
+
+	for (uint frame = 0; frame < frames; frame++) {
+		Common::MemoryReadStream stream(&data[0], data.size());
+		const Graphics::Surface *surface = codec->decodeFrame(stream);
+
+		if (surface->format != format) {
+			Graphics::Surface *converted = surface->convertTo(format);
+			converted->free();
+			delete converted;
+		}
+	}
+
+	return MAX<uint32>(g_system->getMillis() - start, 1);
+}
+
+} // End of anonymous namespace
+
+TestExitStatus GFXtests::codecDecodeThroughput() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the decoding speed of the video codecs", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Codec Decode Throughput\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Decoding...", Common::Point(0, 100));
+	}
+
+	static const struct {
+		uint32 tag;
+		uint bitsPerPixel;
+		const char *name;
+	} codecs[] = {
+		{ MKTAG('c', 'v', 'i', 'd'), 24, "Cinepak" },
+		{ MKTAG('m', 's', 'v', 'c'), 16, "MSVideo1" },
+		{ MKTAG('r', 'p', 'z', 'a'), 16, "RPZA" },
+		{ MKTAG('r', 'l', 'e', ' '), 16, "QTRLE 16 bit" },
+		{ MKTAG('r', 'l', 'e', ' '), 24, "QTRLE 24 bit" }
+	};
+	const uint kWidth = 640, kHeight = 480;
+	const uint kFrames = 200;
+
+	// Decode into the screen format, like the engines playing the videos
+	Graphics::PixelFormat format = g_system->getScreenFormat();
+	if (format.bytesPerPixel == 1)
+		format = Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+
+	Common::RandomSource rnd("testbed");
+
+	for (uint i = 0; i < ARRAYSIZE(codecs); i++) {
+		CodecFrameWriter writer(rnd);
+		switch (codecs[i].tag) {
+		case MKTAG('c', 'v', 'i', 'd'):
+			writer.writeCinepak(kWidth, kHeight);
+			break;
+		case MKTAG('m', 's', 'v', 'c'):
+			writer.writeMSVideo1(kWidth, kHeight);
+			break;
+		case MKTAG('r', 'p', 'z', 'a'):
+			writer.writeRPZA(kWidth, kHeight);
+			break;
+		default:
+			writer.writeQTRLE(kWidth, kHeight, codecs[i].bitsPerPixel);
+			break;
+		}
+
+		Image::Codec *codec = createBenchmarkCodec(codecs[i].tag, kWidth, kHeight, codecs[i].bitsPerPixel);
+		const uint32 convertTime = decodeCodecFrames(codec, writer.data(), format, kFrames);
+		delete codec;
+
+		codec = createBenchmarkCodec(codecs[i].tag, kWidth, kHeight, codecs[i].bitsPerPixel);
+		if (!codec->setOutputPixelFormat(format)) {
+			Testsuite::logPrintf("Error! %s cannot decode into the screen format\n", codecs[i].name);
+			delete codec;
+			return kTestFailed;
+		}
+		const uint32 directTime = decodeCodecFrames(codec, writer.data(), format, kFrames);
+		delete codec;
+
+		Testsuite::logDetailedPrintf("Decoding %s at %ux%u: %u us per frame converting afterwards, %u us per frame decoding directly\n",
+			codecs[i].name, kWidth, kHeight, convertTime * 1000 / kFrames, directTime * 1000 / kFrames);
+	}
+
+	return kTestPassed;
+}
+
 } // End of namespace Testbed
@@ -53,6 +53,12 @@ TestExitStatus focusRectangle();
 TestExitStatus overlayGraphics();
 TestExitStatus paletteRotation();
 TestExitStatus pixelFormats();
+TestExitStatus conversionThroughput();
+TestExitStatus transparentBlitThroughput();
+TestExitStatus themeLoadTime();
+TestExitStatus textDrawThroughput();
+TestExitStatus videoDecodeThroughput();
+TestExitStatus codecDecodeThroughput();
 // add more here
 
 } // End of namespace GFXtests
@@ -21,6 +21,8 @@
  */
 
 #include "testbed/misc.h"
+#include "common/config-manager.h"
+#include "common/memstream.h"
 #include "common/timer.h"
 
 namespace Testbed {
@@ -183,11 +185,72 @@ TestExitStatus MiscTests::testOpenUrl() {
 	return kTestPassed;
 }
 
+TestExitStatus MiscTests::testConfigLoadSave() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the loading and saving of a configuration with 10000 games", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Config Load/Save\n");
+			return kTestSkipped;
+		}
+	}
+
+	// The benchmark replaces the configuration, keep the current one
+	Common::MemoryWriteStreamDynamic backup(DisposeAfterUse::YES);
+	ConfMan.saveToStream(backup);
+	const Common::ConfigManager::Domain transientDomain = *ConfMan.getDomain(Common::ConfigManager::kTransientDomain);
+	const Common::String activeDomainName = ConfMan.getActiveDomainName();
+	const Common::ConfigManager::Domain activeDomain = ConfMan.getActiveDomain() ? *ConfMan.getActiveDomain() : Common::ConfigManager::Domain();
+
+	const int kGames = 10000;
+	const int kSaves = 10;
+
+	Common::MemoryWriteStreamDynamic config(DisposeAfterUse::YES);
+	config.writeString("[scummvm]\nlanguage=en\ngfx_mode=2x\nfullscreen=false\n\n");
+	for (int i = 0; i < kGames; i++) {
+		config.writeString(Common::String::format(
+			"# Game %d\n[game%05d]\ngameid=game\ndescription=Game %d (DOS/English)\npath=/home/user/games/game%05d\n"
+			"language=en\nplatform=pc\nmusic_volume=192\nsubtitles=true\n\n", i, i, i, i));
+	}
+
+	uint32 start = g_system->getMillis();
+	Common::MemoryReadStream configStream(config.getData(), config.size());
+	ConfMan.loadFromStream(configStream);
+	const uint32 loadTime = g_system->getMillis() - start;
+
+	const bool loaded = ConfMan.getGameDomains().size() == kGames;
+
+	start = g_system->getMillis();
+	uint32 savedSize = 0;
+	for (int i = 0; i < kSaves; i++) {
+		Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+		ConfMan.saveToStream(saved);
+		savedSize = saved.size();
+	}
+	const uint32 saveTime = g_system->getMillis() - start;
+
+	// Restore the previous configuration
+	Common::MemoryReadStream backupStream(backup.getData(), backup.size());
+	ConfMan.loadFromStream(backupStream);
+	*ConfMan.getDomain(Common::ConfigManager::kTransientDomain) = transientDomain;
+	ConfMan.setActiveDomain(activeDomainName);
+	if (ConfMan.getActiveDomain())
+		*ConfMan.getActiveDomain() = activeDomain;
+
+	if (!loaded) {
+		Testsuite::logPrintf("Error! Loading the configuration lost games\n");
+		return kTestFailed;
+	}
+
+	Testsuite::logDetailedPrintf("Loading %u bytes with %d games: %ums\n", config.size(), kGames, loadTime);
+	Testsuite::logDetailedPrintf("Saving %u bytes with %d games: %u us\n", savedSize, kGames, saveTime * 1000 / kSaves);
+	return kTestPassed;
+}
+
 MiscTestSuite::MiscTestSuite() {
 	addTest("Datetime", &MiscTests::testDateTime, false);
 	addTest("Timers", &MiscTests::testTimers, false);
 	addTest("Mutexes", &MiscTests::testMutexes, false);
 	addTest("openUrl", &MiscTests::testOpenUrl, true);
+	addTest("ConfigLoadSave", &MiscTests::testConfigLoadSave, false);
 }
 
 } // End of namespace Testbed
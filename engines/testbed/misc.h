@@ -50,6 +50,7 @@ TestExitStatus testDateTime();
 TestExitStatus testTimers();
 TestExitStatus testMutexes();
 TestExitStatus testOpenUrl();
+TestExitStatus testConfigLoadSave();
 // add more here
 
 } // End of namespace MiscTests
@@ -20,11 +20,19 @@
  *
  */
 
+#include "audio/audiostream.h"
+#include "audio/decode_ahead.h"
+#include "audio/mixer_intern.h"
+#include "audio/rate.h"
+#include "audio/sound_cache.h"
+#include "audio/decoders/adpcm.h"
 #include "audio/softsynth/pcspk.h"
 
 #include "backends/audiocd/audiocd.h"
 
 #include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/random.h"
 
 #include "testbed/sound.h"
 
@@ -261,6 +269,378 @@ TestExitStatus SoundSubsystem::sampleRates() {
 	return passed;
 }
 
+/**
+ * Silent stream which records how regularly the mixer callback pulls data
+ * from it.
+ */
+class CallbackProbeStream : public Audio::AudioStream {
+public:
+	CallbackProbeStream(int rate) : _rate(rate), _lastCall(0), _calls(0), _maxInterval(0), _totalInterval(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const uint32 now = g_system->getMillis();
+		if (_lastCall) {
+			const uint32 interval = now - _lastCall;
+			_maxInterval = MAX(_maxInterval, interval);
+			_totalInterval += interval;
+			_calls++;
+		}
+		_lastCall = now;
+
+		memset(buffer, 0, numSamples * sizeof(int16));
+		return numSamples;
+	}
+
+	bool isStereo() const { return true; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+	uint32 getCalls() const { return _calls; }
+	uint32 getMaxInterval() const { return _maxInterval; }
+	uint32 getAverageInterval() const { return _calls ? _totalInterval / _calls : 0; }
+
+private:
+	const int _rate;
+	uint32 _lastCall;
+	uint32 _calls;
+	uint32 _maxInterval;
+	uint32 _totalInterval;
+};
+
+TestExitStatus SoundSubsystem::mixerStress() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Stress testing the mixer control API while measuring audio callback jitter", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Mixer Stress\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Hammering the mixer for 5s...", Common::Point(0, 100));
+	}
+
+	Audio::Mixer *mixer = g_system->getMixer();
+	if (!mixer->isReady()) {
+		Testsuite::logPrintf("Info! Skipping test : Mixer Stress, the mixer is not ready\n");
+		return kTestSkipped;
+	}
+
+	const uint kNumStreams = 8;
+	const uint32 kDuration = 5000;
+
+	// The probe stream runs at the output rate, so it is read exactly once
+	// per mixer callback.
+	CallbackProbeStream *probe = new CallbackProbeStream(mixer->getOutputRate());
+	Audio::SoundHandle probeHandle;
+	mixer->playStream(Audio::Mixer::kPlainSoundType, &probeHandle, probe, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO);
+
+	Audio::SoundHandle handles[kNumStreams];
+	for (uint i = 0; i < kNumStreams; i++) {
+		Audio::PCSpeaker *speaker = new Audio::PCSpeaker();
+		speaker->play(Audio::PCSpeaker::kWaveFormSine, 1000 + i * 100, -1);
+		mixer->playStream(Audio::Mixer::kSFXSoundType, &handles[i], speaker, -1, 0);
+	}
+
+	TestExitStatus passed = kTestPassed;
+	uint32 operations = 0;
+	const uint32 start = g_system->getMillis();
+	while (g_system->getMillis() - start < kDuration) {
+		for (uint i = 0; i < kNumStreams; i++) {
+			if (!mixer->isSoundHandleActive(handles[i]))
+				passed = kTestFailed;
+			mixer->setChannelVolume(handles[i], operations & 1);
+			mixer->pauseHandle(handles[i], true);
+			mixer->pauseHandle(handles[i], false);
+			mixer->getElapsedTime(handles[i]);
+			mixer->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType);
+		}
+		operations += kNumStreams * 6;
+	}
+	const uint32 elapsed = g_system->getMillis() - start;
+
+	for (uint i = 0; i < kNumStreams; i++) {
+		mixer->stopHandle(handles[i]);
+		if (mixer->isSoundHandleActive(handles[i]))
+			passed = kTestFailed;
+	}
+	mixer->stopHandle(probeHandle);
+	// Give the mixer callback the chance to let go of the probe
+	g_system->delayMillis(200);
+
+	Testsuite::logDetailedPrintf("Mixer control operations: %u in %ums (%u/ms)\n", operations, elapsed, operations / MAX<uint32>(elapsed, 1));
+	Testsuite::logDetailedPrintf("Mixer callbacks: %u, average interval %ums, worst interval %ums\n", probe->getCalls(), probe->getAverageInterval(), probe->getMaxInterval());
+
+	if (!probe->getCalls()) {
+		Testsuite::logDetailedPrintf("Error! The mixer callback was never invoked\n");
+		passed = kTestFailed;
+	}
+
+	delete probe;
+	return passed;
+}
+
+/**
+ * Endless stream of pseudo random samples, cheap enough to not distort
+ * rate converter timings.
+ */
+class NoiseStream : public Audio::AudioStream {
+public:
+	NoiseStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _seed(1) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; i++) {
+			_seed = _seed * 1103515245 + 12345;
+			buffer[i] = (int16)(_seed >> 16);
+		}
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	const int _rate;
+	const bool _stereo;
+	uint32 _seed;
+};
+
+TestExitStatus SoundSubsystem::resamplerThroughput() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the throughput of the rate converters", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Resampler Throughput\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Resampling...", Common::Point(0, 100));
+	}
+
+	static const uint32 inRates[] = { 11025, 22050, 44100 };
+	static const uint32 outRates[] = { 44100, 48000 };
+	static const Audio::RateConverterQuality qualities[] = { Audio::kRateConverterQualityLow, Audio::kRateConverterQualityMedium, Audio::kRateConverterQualityHigh };
+	static const char *const qualityNames[] = { "low", "medium", "high" };
+	const uint kSeconds = 10;
+	const uint kChunk = 1024;
+
+	int16 *buffer = new int16[kChunk * 2];
+
+	for (uint q = 0; q < ARRAYSIZE(qualities); q++) {
+		for (uint o = 0; o < ARRAYSIZE(outRates); o++) {
+			for (uint i = 0; i < ARRAYSIZE(inRates); i++) {
+				for (int stereo = 0; stereo < 2; stereo++) {
+					// The filter is built by the converter itself when it is
+					// not cached, which happens before the timing starts.
+					NoiseStream input(inRates[i], stereo);
+					Audio::RateConverter *converter = Audio::makeRateConverter(inRates[i], outRates[o], stereo, false, qualities[q]);
+
+					const uint32 start = g_system->getMillis();
+					for (uint32 frames = 0; frames < kSeconds * outRates[o]; frames += kChunk) {
+						memset(buffer, 0, kChunk * 2 * sizeof(int16));
+						converter->flow(input, buffer, kChunk, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+					}
+					const uint32 elapsed = MAX<uint32>(g_system->getMillis() - start, 1);
+
+					Testsuite::logDetailedPrintf("Resampling %s %u -> %u Hz (%s): %us of audio in %ums, %ux realtime\n",
+						stereo ? "stereo" : "mono", inRates[i], outRates[o], qualityNames[q], kSeconds, elapsed, kSeconds * 1000 / elapsed);
+					delete converter;
+				}
+			}
+		}
+	}
+
+	delete[] buffer;
+
+	return kTestPassed;
+}
+
+TestExitStatus SoundSubsystem::mixerPrerender() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Comparing the output of a prerendering mixer with the regular one", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Mixer Prerender\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Mixing...", Common::Point(0, 100));
+	}
+
+	const uint kOutputRate = 44100;
+	const uint kCallbacks = 200;
+	const uint kFrames = 1024;
+
+	// Both mixers are driven from here instead of an audio thread, so the
+	// prerendering timer is the only other thread touching them.
+	Audio::MixerImpl *mixers[2];
+	mixers[0] = new Audio::MixerImpl(g_system, kOutputRate);
+	mixers[1] = new Audio::MixerImpl(g_system, kOutputRate);
+	if (!mixers[1]->setUseCommandQueue(true) || !mixers[1]->setUsePrerendering(true)) {
+		Testsuite::logPrintf("Info! Skipping test : Mixer Prerender, prerendering is not supported\n");
+		delete mixers[0];
+		delete mixers[1];
+		return kTestSkipped;
+	}
+
+	Audio::SoundHandle handles[2][3];
+	for (uint m = 0; m < 2; m++) {
+		mixers[m]->setReady(true);
+
+		Audio::Mixer *mixer = mixers[m];
+		mixer->playStream(Audio::Mixer::kSFXSoundType, &handles[m][0], new NoiseStream(22050, false));
+		mixer->playStream(Audio::Mixer::kMusicSoundType, &handles[m][1], new NoiseStream(44100, true),
+			-1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false, true);
+		mixer->playStream(Audio::Mixer::kSpeechSoundType, &handles[m][2], new NoiseStream(11025, true), -1, 200, -50);
+	}
+
+	byte *buffers[2];
+	buffers[0] = new byte[kFrames * 4];
+	buffers[1] = new byte[kFrames * 4];
+	uint32 callbackTime[2] = { 0, 0 };
+
+	TestExitStatus passed = kTestPassed;
+	for (uint i = 0; i < kCallbacks && passed == kTestPassed; i++) {
+		for (uint m = 0; m < 2; m++) {
+			if (i % 10 == 5)
+				mixers[m]->setChannelVolume(handles[m][0], (i * 7) & 0xFF);
+
+			const uint32 start = g_system->getMillis();
+			mixers[m]->mixCallback(buffers[m], kFrames * 4);
+			callbackTime[m] += g_system->getMillis() - start;
+		}
+
+		if (memcmp(buffers[0], buffers[1], kFrames * 4)) {
+			Testsuite::logDetailedPrintf("Error! Prerendered output differs in callback %u\n", i);
+			passed = kTestFailed;
+		}
+
+		// Give the prerendering timer a chance to run
+		g_system->delayMillis(2);
+	}
+
+	Testsuite::logDetailedPrintf("Time spent in %u mixer callbacks: %ums regular, %ums prerendered\n", kCallbacks, callbackTime[0], callbackTime[1]);
+
+	delete[] buffers[0];
+	delete[] buffers[1];
+	delete mixers[0];
+	delete mixers[1];
+
+	return passed;
+}
+
+/**
+ * Fill data with MS IMA ADPCM blocks of random samples.
+ */
+static void generateADPCM(byte *data, uint32 size, uint32 blockAlign, int channels, Common::RandomSource &rnd) {
+	for (uint32 i = 0; i < size; i++)
+		data[i] = rnd.getRandomNumber(0xFF);
+
+	// The block headers need a valid step index
+	for (uint32 block = 0; block + blockAlign <= size; block += blockAlign) {
+		for (int i = 0; i < channels; i++)
+			WRITE_LE_UINT16(data + block + i * 4 + 2, rnd.getRandomNumber(88));
+	}
+}
+
+static Audio::SeekableAudioStream *makeBenchmarkADPCMStream(const byte *data, uint32 size, uint32 blockAlign, int rate, int channels) {
+	return Audio::makeADPCMStream(new Common::MemoryReadStream(data, size), DisposeAfterUse::YES, size, Audio::kADPCMMSIma, rate, channels, blockAlign);
+}
+
+TestExitStatus SoundSubsystem::decodeAhead() {
+	if (ConfParams.isSessionInteractive()) {
+		if (Testsuite::handleInteractiveInput("Measuring the mixer callback time with streams decoded ahead, and the decoded sound cache", "Continue", "Skip", kOptionRight)) {
+			Testsuite::logPrintf("Info! Skipping test : Decode Ahead\n");
+			return kTestSkipped;
+		}
+		Testsuite::writeOnScreen("Mixing...", Common::Point(0, 100));
+	}
+
+	const uint kOutputRate = 44100;
+	const uint kStreams = 6;
+	const uint kCallbacks = 200;
+	const uint kFrames = 1024;
+	const uint32 kMusicBlockAlign = 2048;
+	// 30 seconds of stereo audio at four bits per sample
+	const uint32 kMusicSize = 30 * kOutputRate * 2 / 2 / kMusicBlockAlign * kMusicBlockAlign;
+
+	Common::RandomSource rnd("testbed");
+	byte *music = new byte[kMusicSize];
+	generateADPCM(music, kMusicSize, kMusicBlockAlign, 2, rnd);
+
+	byte *buffer = new byte[kFrames * 4];
+	TestExitStatus passed = kTestPassed;
+
+	// The mixer is driven from here, the decode-ahead timer runs while
+	// waiting for the next callback.
+	for (int ahead = 0; ahead < 2; ahead++) {
+		Audio::MixerImpl *mixerImpl = new Audio::MixerImpl(g_system, kOutputRate);
+		mixerImpl->setReady(true);
+
+		Audio::Mixer *mixer = mixerImpl;
+
+		for (uint i = 0; i < kStreams; i++) {
+			Audio::SeekableAudioStream *stream = makeBenchmarkADPCMStream(music, kMusicSize, kMusicBlockAlign, kOutputRate, 2);
+			if (ahead) {
+				Audio::DecodeAheadAudioStream *decodeAhead = Audio::makeDecodeAheadStream(stream, 500);
+				decodeAhead->decodeAhead();
+				stream = decodeAhead;
+			}
+			mixer->playStream(Audio::Mixer::kMusicSoundType, 0, stream, -1, Audio::Mixer::kMaxChannelVolume / kStreams);
+		}
+
+		uint32 totalTime = 0, maxTime = 0;
+		for (uint i = 0; i < kCallbacks; i++) {
+			const uint32 start = g_system->getMillis();
+			mixerImpl->mixCallback(buffer, kFrames * 4);
+			const uint32 time = g_system->getMillis() - start;
+
+			totalTime += time;
+			maxTime = MAX(maxTime, time);
+			g_system->delayMillis(10);
+		}
+
+		if (!mixer->hasActiveChannelOfType(Audio::Mixer::kMusicSoundType)) {
+			Testsuite::logDetailedPrintf("Error! The streams ended early\n");
+			passed = kTestFailed;
+		}
+
+		Testsuite::logDetailedPrintf("Mixing %u ADPCM streams %s: %ums in %u mixer callbacks, worst callback %ums\n",
+			kStreams, ahead ? "decoded ahead" : "decoded on demand", totalTime, kCallbacks, maxTime);
+		delete mixerImpl;
+	}
+
+	delete[] buffer;
+	delete[] music;
+
+	// Play a short sound effect repeatedly, decoding it every time or
+	// taking it from the cache
+	const uint kPlays = 500;
+	const uint32 kSoundBlockAlign = 512;
+	const uint32 kSoundSize = 22050 / 2 / kSoundBlockAlign * kSoundBlockAlign;
+
+	byte *sound = new byte[kSoundSize];
+	generateADPCM(sound, kSoundSize, kSoundBlockAlign, 1, rnd);
+	int16 *samples = new int16[kSoundSize * 2];
+	Audio::DecodedSoundCache cache(1024 * 1024);
+
+	for (int cached = 0; cached < 2; cached++) {
+		const uint32 start = g_system->getMillis();
+		for (uint i = 0; i < kPlays; i++) {
+			Audio::SeekableAudioStream *stream = cached ? cache.get("sound") : 0;
+			if (!stream) {
+				stream = makeBenchmarkADPCMStream(sound, kSoundSize, kSoundBlockAlign, 22050, 1);
+				if (cached)
+					stream = cache.add("sound", stream);
+			}
+
+			while (!stream->endOfData())
+				stream->readBuffer(samples, kSoundSize * 2);
+			delete stream;
+		}
+		const uint32 elapsed = g_system->getMillis() - start;
+
+		Testsuite::logDetailedPrintf("Playing a one second ADPCM sound %u times %s: %ums\n",
+			kPlays, cached ? "from the decoded sound cache" : "decoding it every time", elapsed);
+	}
+
+	delete[] samples;
+	delete[] sound;
+
+	return passed;
+}
+
 SoundSubsystemTestSuite::SoundSubsystemTestSuite() {
 	addTest("SimpleBeeps", &SoundSubsystem::playBeeps, true);
 	addTest("MixSounds", &SoundSubsystem::mixSounds, true);
@@ -276,6 +656,10 @@ SoundSubsystemTestSuite::SoundSubsystemTestSuite() {
 		}
 	}
 	addTest("SampleRates", &SoundSubsystem::sampleRates, true);
+	addTest("MixerStress", &SoundSubsystem::mixerStress, false);
+	addTest("ResamplerThroughput", &SoundSubsystem::resamplerThroughput, false);
+	addTest("MixerPrerender", &SoundSubsystem::mixerPrerender, false);
+	addTest("DecodeAhead", &SoundSubsystem::decodeAhead, false);
 }
 
 } // End of namespace Testbed
@@ -47,6 +47,10 @@ TestExitStatus playBeeps();
 TestExitStatus mixSounds();
 TestExitStatus audiocdOutput();
 TestExitStatus sampleRates();
+TestExitStatus mixerStress();
+TestExitStatus resamplerThroughput();
+TestExitStatus mixerPrerender();
+TestExitStatus decodeAhead();
 }
 
 class SoundSubsystemTestSuite : public Testsuite {
@@ -538,6 +538,9 @@ VectorRendererSpec(PixelFormat format) :
 	_blueMask((0xFF >> format.bLoss) << format.bShift),
 	_alphaMask((0xFF >> format.aLoss) << format.aShift) {
 
+	_fgColor = _bgColor = _bevelColor = 0;
+	_gradientStart = _gradientEnd = 0;
+	_gradientBytes[0] = _gradientBytes[1] = _gradientBytes[2] = 0;
 	_bitmapAlphaColor = _format.RGBToColor(255, 0, 255);
 	_clippingArea = Common::Rect(0, 0, 32767, 32767);
 }
@@ -563,6 +566,16 @@ setGradientColors(uint8 r1, uint8 g1, uint8 b1, uint8 r2, uint8 g2, uint8 b2) {
 	}
 }
 
+template<typename PixelType>
+void VectorRendererSpec<PixelType>::
+getColors(uint32 colors[5]) const {
+	colors[0] = _fgColor;
+	colors[1] = _bgColor;
+	colors[2] = _bevelColor;
+	colors[3] = _gradientStart;
+	colors[4] = _gradientEnd;
+}
+
 template<typename PixelType>
 inline PixelType VectorRendererSpec<PixelType>::
 calcGradient(uint32 pos, uint32 max) {
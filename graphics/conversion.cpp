@@ -21,16 +21,161 @@
  */
 
 #include "graphics/conversion.h"
+#include "graphics/conversion_intern.h"
 #include "graphics/pixelformat.h"
 
 #include "common/endian.h"
+#include "common/system.h"
 
 namespace Graphics {
 
 // TODO: YUV to RGB conversion function
 
+void convert8888To8888C(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	for (uint i = 0; i < count; ++i) {
+		const uint32 color = src[i];
+		uint32 out = swizzle.fill;
+		for (uint c = 0; c < swizzle.numChannels; ++c)
+			out |= ((color >> swizzle.srcShift[c]) & 0xFF) << swizzle.dstShift[c];
+		dst[i] = out;
+	}
+}
+
+void convert565To8888C(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle) {
+	while (count-- > 0) {
+		const uint color = src[count];
+		dst[count] = swizzle.fill |
+		             (ColorComponent<5>::expand(color >> 11) << swizzle.dstShift[0]) |
+		             (ColorComponent<6>::expand(color >> 5) << swizzle.dstShift[1]) |
+		             (ColorComponent<5>::expand(color) << swizzle.dstShift[2]);
+	}
+}
+
+void convert8888To565C(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	for (uint i = 0; i < count; ++i) {
+		const uint32 color = src[i];
+		dst[i] = (((color >> swizzle.srcShift[0]) & 0xF8) << 8) |
+		         (((color >> swizzle.srcShift[1]) & 0xFC) << 3) |
+		         (((color >> swizzle.srcShift[2]) & 0xFF) >> 3);
+	}
+}
+
+ChannelSwizzle makeChannelSwizzle(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const bool srcAlpha = (srcFmt.aLoss == 0);
+	const bool dstAlpha = (dstFmt.aLoss == 0);
+
+	ChannelSwizzle swizzle;
+	swizzle.srcShift[0] = srcFmt.rShift;
+	swizzle.srcShift[1] = srcFmt.gShift;
+	swizzle.srcShift[2] = srcFmt.bShift;
+	swizzle.srcShift[3] = srcFmt.aShift;
+	swizzle.dstShift[0] = dstFmt.rShift;
+	swizzle.dstShift[1] = dstFmt.gShift;
+	swizzle.dstShift[2] = dstFmt.bShift;
+	swizzle.dstShift[3] = dstFmt.aShift;
+	swizzle.numChannels = (srcAlpha && dstAlpha) ? 4 : 3;
+	// Colors without alpha are opaque
+	swizzle.fill = (!srcAlpha && dstAlpha) ? (0xFFu << dstFmt.aShift) : 0;
+	return swizzle;
+}
+
 namespace {
 
+/**
+ * The fastest variants of the fast path kernels the host CPU supports.
+ */
+struct ConversionProcs {
+	Convert8888To8888Proc convert8888To8888;
+	Convert565To8888Proc convert565To8888;
+	Convert8888To565Proc convert8888To565;
+};
+
+const ConversionProcs &getConversionProcs() {
+	static const ConversionProcs procsC = { &convert8888To8888C, &convert565To8888C, &convert8888To565C };
+#ifdef SCUMMVM_NEON
+	static const ConversionProcs procsNEON = { &convert8888To8888NEON, &convert565To8888NEON, &convert8888To565NEON };
+#endif
+#ifdef SCUMMVM_SSE2
+	static const ConversionProcs procsSSE2 = { &convert8888To8888SSE2, &convert565To8888SSE2, &convert8888To565SSE2 };
+#endif
+#ifdef SCUMMVM_AVX2
+	static const ConversionProcs procsAVX2 = { &convert8888To8888AVX2, &convert565To8888AVX2, &convert8888To565AVX2 };
+#endif
+
+	const OSystem::CpuExtension cpuExtension = OSystem::getCpuExtension();
+#ifdef SCUMMVM_AVX2
+	if (cpuExtension >= OSystem::kCpuExtensionAVX2)
+		return procsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (cpuExtension >= OSystem::kCpuExtensionSSE2)
+		return procsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (cpuExtension == OSystem::kCpuExtensionNEON)
+		return procsNEON;
+#endif
+	return procsC;
+}
+
+/**
+ * Check whether a format has 32 bpp, with 8 bits for each of red, green,
+ * blue and, if present, alpha. Such formats only differ in the order of
+ * their channel bytes.
+ */
+bool is8888(const PixelFormat &fmt) {
+	if (fmt.bytesPerPixel != 4 || fmt.rLoss != 0 || fmt.gLoss != 0 || fmt.bLoss != 0)
+		return false;
+	if (fmt.aLoss != 0 && fmt.aLoss != 8)
+		return false;
+
+	const uint shifts[4] = { fmt.rShift, fmt.gShift, fmt.bShift, fmt.aShift };
+	const uint numChannels = (fmt.aLoss == 0) ? 4 : 3;
+	uint32 used = 0;
+	for (uint c = 0; c < numChannels; ++c) {
+		if ((shifts[c] & 7) != 0 || shifts[c] > 24 || (used & (0xFFu << shifts[c])))
+			return false;
+		used |= 0xFFu << shifts[c];
+	}
+	return true;
+}
+
+bool is565(const PixelFormat &fmt) {
+	return fmt.bytesPerPixel == 2 && fmt.aLoss == 8 &&
+	       fmt.rLoss == 3 && fmt.gLoss == 2 && fmt.bLoss == 3 &&
+	       fmt.rShift == 11 && fmt.gShift == 5 && fmt.bShift == 0;
+}
+
+/**
+ * Convert a rectangle with the row kernel of a fast path. Rows are
+ * converted from the last one to the first one when backward is set,
+ * to allow converting in place to larger pixels.
+ */
+template<typename SrcColor, typename DstColor, typename Proc>
+void fastBlitLogic(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                   const uint w, const uint h, const ChannelSwizzle &swizzle, Proc proc, bool backward) {
+	if (backward) {
+		for (uint y = h; y-- > 0;)
+			proc((DstColor *)(dst + y * dstPitch), (const SrcColor *)(src + y * srcPitch), w, swizzle);
+	} else {
+		for (uint y = 0; y < h; ++y)
+			proc((DstColor *)(dst + y * dstPitch), (const SrcColor *)(src + y * srcPitch), w, swizzle);
+	}
+}
+
+template<typename DstColor>
+inline void crossBlitMapLogic(byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                              const uint w, const uint h, const uint32 *map) {
+	// From the bottom right to the top left, so that the larger
+	// destination pixels never overwrite unconverted source pixels.
+	for (uint y = h; y-- > 0;) {
+		const byte *srcRow = src + y * srcPitch;
+		DstColor *dstRow = (DstColor *)(dst + y * dstPitch);
+		for (uint x = w; x-- > 0;)
+			dstRow[x] = map[srcRow[x]];
+	}
+}
+
 template<typename SrcColor, typename DstColor, bool backward>
 inline void crossBlitLogic(byte *dst, const byte *src, const uint w, const uint h,
                            const PixelFormat &srcFmt, const PixelFormat &dstFmt,
@@ -126,6 +271,23 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+	// Common formats which only need their channels moved or expanded
+	const bool src8888 = is8888(srcFmt);
+	const bool dst8888 = is8888(dstFmt);
+	if (src8888 && dst8888) {
+		fastBlitLogic<uint32, uint32>(dst, src, dstPitch, srcPitch, w, h, makeChannelSwizzle(dstFmt, srcFmt),
+		                              getConversionProcs().convert8888To8888, false);
+		return true;
+	} else if (dst8888 && is565(srcFmt)) {
+		fastBlitLogic<uint16, uint32>(dst, src, dstPitch, srcPitch, w, h, makeChannelSwizzle(dstFmt, srcFmt),
+		                              getConversionProcs().convert565To8888, true);
+		return true;
+	} else if (src8888 && is565(dstFmt)) {
+		fastBlitLogic<uint32, uint16>(dst, src, dstPitch, srcPitch, w, h, makeChannelSwizzle(dstFmt, srcFmt),
+		                              getConversionProcs().convert8888To565, false);
+		return true;
+	}
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -167,4 +329,18 @@ bool crossBlit(byte *dst, const byte *src,
 	return true;
 }
 
+bool crossBlitMap(byte *dst, const byte *src,
+                  const uint dstPitch, const uint srcPitch,
+                  const uint w, const uint h,
+                  const uint bytesPerPixel, const uint32 *map) {
+	if (bytesPerPixel == 2) {
+		crossBlitMapLogic<uint16>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else if (bytesPerPixel == 4) {
+		crossBlitMapLogic<uint32>(dst, src, dstPitch, srcPitch, w, h, map);
+	} else {
+		return false;
+	}
+	return true;
+}
+
 } // End of namespace Graphics
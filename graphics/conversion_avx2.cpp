@@ -0,0 +1,119 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/conversion_intern.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+/**
+ * Expand eight RGB565 colors, zero extended to 32 bit lanes, and place
+ * the channels at their offsets.
+ */
+static inline __m256i expand565AVX2(__m256i colors, __m128i rShift, __m128i gShift, __m128i bShift, __m256i fill) {
+	__m256i r = _mm256_srli_epi32(colors, 11);
+	r = _mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2));
+	__m256i g = _mm256_and_si256(_mm256_srli_epi32(colors, 5), _mm256_set1_epi32(0x3F));
+	g = _mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4));
+	__m256i b = _mm256_and_si256(colors, _mm256_set1_epi32(0x1F));
+	b = _mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2));
+
+	__m256i out = _mm256_or_si256(fill, _mm256_sll_epi32(r, rShift));
+	out = _mm256_or_si256(out, _mm256_sll_epi32(g, gShift));
+	return _mm256_or_si256(out, _mm256_sll_epi32(b, bShift));
+}
+
+/**
+ * Pack eight 32 bpp colors into the 16 bit RGB565 values, sign extended
+ * to 32 bit lanes.
+ */
+static inline __m256i pack565AVX2(__m256i colors, __m128i rShift, __m128i gShift, __m128i bShift) {
+	const __m256i r = _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(colors, rShift), _mm256_set1_epi32(0xF8)), 24);
+	const __m256i g = _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(colors, gShift), _mm256_set1_epi32(0xFC)), 19);
+	const __m256i b = _mm256_slli_epi32(_mm256_and_si256(_mm256_srl_epi32(colors, bShift), _mm256_set1_epi32(0xF8)), 13);
+	return _mm256_srai_epi32(_mm256_or_si256(_mm256_or_si256(r, g), b), 16);
+}
+
+void convert8888To8888AVX2(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	// All channels are whole bytes, so the conversion is a byte shuffle.
+	// Destination bytes not receiving a channel are cleared, index 0x80.
+	byte control[32];
+	memset(control, 0x80, sizeof(control));
+	for (uint pixel = 0; pixel < 8; ++pixel) {
+		for (uint c = 0; c < swizzle.numChannels; ++c)
+			control[pixel * 4 + swizzle.dstShift[c] / 8] = (pixel % 4) * 4 + swizzle.srcShift[c] / 8;
+	}
+	const __m256i shuffle = _mm256_loadu_si256((const __m256i *)control);
+	const __m256i fill = _mm256_set1_epi32(swizzle.fill);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_or_si256(_mm256_shuffle_epi8(in, shuffle), fill));
+	}
+
+	convert8888To8888C(dst + i, src + i, count - i, swizzle);
+}
+
+void convert565To8888AVX2(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle) {
+	const __m128i rShift = _mm_cvtsi32_si128(swizzle.dstShift[0]);
+	const __m128i gShift = _mm_cvtsi32_si128(swizzle.dstShift[1]);
+	const __m128i bShift = _mm_cvtsi32_si128(swizzle.dstShift[2]);
+	const __m256i fill = _mm256_set1_epi32(swizzle.fill);
+
+	// From the end of the row, see Convert565To8888Proc. Both halves are
+	// loaded before anything is stored.
+	while (count >= 16) {
+		count -= 16;
+
+		const __m256i in = _mm256_loadu_si256((const __m256i *)(src + count));
+		const __m256i lo = expand565AVX2(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(in)), rShift, gShift, bShift, fill);
+		const __m256i hi = expand565AVX2(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(in, 1)), rShift, gShift, bShift, fill);
+
+		_mm256_storeu_si256((__m256i *)(dst + count), lo);
+		_mm256_storeu_si256((__m256i *)(dst + count + 8), hi);
+	}
+
+	convert565To8888C(dst, src, count, swizzle);
+}
+
+void convert8888To565AVX2(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	const __m128i rShift = _mm_cvtsi32_si128(swizzle.srcShift[0]);
+	const __m128i gShift = _mm_cvtsi32_si128(swizzle.srcShift[1]);
+	const __m128i bShift = _mm_cvtsi32_si128(swizzle.srcShift[2]);
+
+	uint i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m256i lo = pack565AVX2(_mm256_loadu_si256((const __m256i *)(src + i)), rShift, gShift, bShift);
+		const __m256i hi = pack565AVX2(_mm256_loadu_si256((const __m256i *)(src + i + 8)), rShift, gShift, bShift);
+
+		// The pack works on the 128 bit halves, put the quarters in order
+		const __m256i packed = _mm256_packs_epi32(lo, hi);
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	convert8888To565C(dst + i, src + i, count - i, swizzle);
+}
+
+} // End of namespace Graphics
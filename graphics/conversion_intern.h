@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_CONVERSION_INTERN_H
+#define GRAPHICS_CONVERSION_INTERN_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+struct PixelFormat;
+
+/**
+ * Describes how the fast paths of crossBlit() move the color channels of
+ * 32 bpp formats with 8 bits per channel, such as XRGB8888 or RGBA8888.
+ *
+ * Each channel is a byte of the 32 bit color value, at the given bit
+ * offset. The RGB565 kernels only use the offsets of the 32 bpp side.
+ */
+struct ChannelSwizzle {
+	/** Bit offsets of the channels in the source color, red, green, blue and alpha. */
+	uint32 srcShift[4];
+	/** Bit offsets of the same channels in the destination color. */
+	uint32 dstShift[4];
+	/** The number of channels to move: 3, or 4 if alpha is moved too. */
+	uint32 numChannels;
+	/** Bits set in every destination color, the opaque alpha of a source without alpha. */
+	uint32 fill;
+};
+
+/**
+ * Return the swizzle converting from srcFmt to dstFmt, each being either a
+ * 32 bpp format with 8 bits per channel, or RGB565.
+ */
+ChannelSwizzle makeChannelSwizzle(const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+
+/**
+ * Convert count pixels between two 32 bpp formats with 8 bits per channel.
+ */
+typedef void (*Convert8888To8888Proc)(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+
+/**
+ * Convert count RGB565 pixels to a 32 bpp format with 8 bits per channel.
+ *
+ * The pixels are converted from the end of the row to its start, so that
+ * a row can be converted in place.
+ */
+typedef void (*Convert565To8888Proc)(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle);
+
+/**
+ * Convert count pixels of a 32 bpp format with 8 bits per channel to
+ * RGB565.
+ */
+typedef void (*Convert8888To565Proc)(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+
+void convert8888To8888C(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+void convert565To8888C(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle);
+void convert8888To565C(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+
+#ifdef SCUMMVM_SSE2
+void convert8888To8888SSE2(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+void convert565To8888SSE2(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle);
+void convert8888To565SSE2(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+#endif
+
+#ifdef SCUMMVM_AVX2
+void convert8888To8888AVX2(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+void convert565To8888AVX2(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle);
+void convert8888To565AVX2(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+#endif
+
+#ifdef SCUMMVM_NEON
+void convert8888To8888NEON(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+void convert565To8888NEON(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle);
+void convert8888To565NEON(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle);
+#endif
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/conversion_intern.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+/**
+ * Extract the channel at the given bit offset of four 32 bpp colors, and
+ * move it to the bits at another offset. Negative shifts shift right.
+ */
+static inline uint32x4_t moveChannelNEON(uint32x4_t colors, int32x4_t srcShift, int32x4_t dstShift) {
+	return vshlq_u32(vandq_u32(vshlq_u32(colors, srcShift), vdupq_n_u32(0xFF)), dstShift);
+}
+
+void convert8888To8888NEON(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	int32x4_t srcShift[4], dstShift[4];
+	for (uint c = 0; c < 4; ++c) {
+		srcShift[c] = vdupq_n_s32(-(int32)swizzle.srcShift[c]);
+		dstShift[c] = vdupq_n_s32(swizzle.dstShift[c]);
+	}
+	const uint32x4_t fill = vdupq_n_u32(swizzle.fill);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t in = vld1q_u32(src + i);
+		uint32x4_t out = vorrq_u32(fill, moveChannelNEON(in, srcShift[0], dstShift[0]));
+		out = vorrq_u32(out, moveChannelNEON(in, srcShift[1], dstShift[1]));
+		out = vorrq_u32(out, moveChannelNEON(in, srcShift[2], dstShift[2]));
+		if (swizzle.numChannels == 4)
+			out = vorrq_u32(out, moveChannelNEON(in, srcShift[3], dstShift[3]));
+		vst1q_u32(dst + i, out);
+	}
+
+	convert8888To8888C(dst + i, src + i, count - i, swizzle);
+}
+
+void convert565To8888NEON(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle) {
+	const int32x4_t rShift = vdupq_n_s32(swizzle.dstShift[0]);
+	const int32x4_t gShift = vdupq_n_s32(swizzle.dstShift[1]);
+	const int32x4_t bShift = vdupq_n_s32(swizzle.dstShift[2]);
+	const uint32x4_t fill = vdupq_n_u32(swizzle.fill);
+
+	// From the end of the row, see Convert565To8888Proc
+	while (count >= 4) {
+		count -= 4;
+
+		const uint32x4_t in = vmovl_u16(vld1_u16(src + count));
+		uint32x4_t r = vshrq_n_u32(in, 11);
+		r = vorrq_u32(vshlq_n_u32(r, 3), vshrq_n_u32(r, 2));
+		uint32x4_t g = vandq_u32(vshrq_n_u32(in, 5), vdupq_n_u32(0x3F));
+		g = vorrq_u32(vshlq_n_u32(g, 2), vshrq_n_u32(g, 4));
+		uint32x4_t b = vandq_u32(in, vdupq_n_u32(0x1F));
+		b = vorrq_u32(vshlq_n_u32(b, 3), vshrq_n_u32(b, 2));
+
+		uint32x4_t out = vorrq_u32(fill, vshlq_u32(r, rShift));
+		out = vorrq_u32(out, vshlq_u32(g, gShift));
+		out = vorrq_u32(out, vshlq_u32(b, bShift));
+		vst1q_u32(dst + count, out);
+	}
+
+	convert565To8888C(dst, src, count, swizzle);
+}
+
+void convert8888To565NEON(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	const int32x4_t rShift = vdupq_n_s32(-(int32)swizzle.srcShift[0]);
+	const int32x4_t gShift = vdupq_n_s32(-(int32)swizzle.srcShift[1]);
+	const int32x4_t bShift = vdupq_n_s32(-(int32)swizzle.srcShift[2]);
+
+	uint i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const uint32x4_t in = vld1q_u32(src + i);
+		const uint32x4_t r = vshlq_n_u32(vandq_u32(vshlq_u32(in, rShift), vdupq_n_u32(0xF8)), 8);
+		const uint32x4_t g = vshlq_n_u32(vandq_u32(vshlq_u32(in, gShift), vdupq_n_u32(0xFC)), 3);
+		const uint32x4_t b = vshrq_n_u32(vandq_u32(vshlq_u32(in, bShift), vdupq_n_u32(0xF8)), 3);
+		vst1_u16(dst + i, vmovn_u32(vorrq_u32(vorrq_u32(r, g), b)));
+	}
+
+	convert8888To565C(dst + i, src + i, count - i, swizzle);
+}
+
+} // End of namespace Graphics
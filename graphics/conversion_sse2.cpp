@@ -0,0 +1,137 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/conversion_intern.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+/**
+ * Extract the channel at the given bit offset of four 32 bpp colors, and
+ * move it to the bits at another offset.
+ */
+static inline __m128i moveChannelSSE2(__m128i colors, __m128i srcShift, __m128i dstShift) {
+	return _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(colors, srcShift), _mm_set1_epi32(0xFF)), dstShift);
+}
+
+/**
+ * Convert eight RGB565 colors into the three 8 bit channels, in 16 bit
+ * lanes.
+ */
+static inline void expand565SSE2(__m128i colors, __m128i &r, __m128i &g, __m128i &b) {
+	r = _mm_srli_epi16(colors, 11);
+	r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+	g = _mm_and_si128(_mm_srli_epi16(colors, 5), _mm_set1_epi16(0x3F));
+	g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+	b = _mm_and_si128(colors, _mm_set1_epi16(0x1F));
+	b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+}
+
+/**
+ * Pack four 32 bpp colors into the 16 bit RGB565 values, in 32 bit lanes.
+ */
+static inline __m128i pack565SSE2(__m128i colors, __m128i rShift, __m128i gShift, __m128i bShift) {
+	const __m128i r = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(colors, rShift), _mm_set1_epi32(0xF8)), 8);
+	const __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(colors, gShift), _mm_set1_epi32(0xFC)), 3);
+	const __m128i b = _mm_srli_epi32(_mm_and_si128(_mm_srl_epi32(colors, bShift), _mm_set1_epi32(0xF8)), 3);
+	return _mm_or_si128(_mm_or_si128(r, g), b);
+}
+
+void convert8888To8888SSE2(uint32 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	__m128i srcShift[4], dstShift[4];
+	for (uint c = 0; c < 4; ++c) {
+		srcShift[c] = _mm_cvtsi32_si128(swizzle.srcShift[c]);
+		dstShift[c] = _mm_cvtsi32_si128(swizzle.dstShift[c]);
+	}
+	const __m128i fill = _mm_set1_epi32(swizzle.fill);
+
+	uint i = 0;
+	if (swizzle.numChannels == 4) {
+		for (; i + 4 <= count; i += 4) {
+			const __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i out = _mm_or_si128(moveChannelSSE2(in, srcShift[0], dstShift[0]), moveChannelSSE2(in, srcShift[1], dstShift[1]));
+			out = _mm_or_si128(out, moveChannelSSE2(in, srcShift[2], dstShift[2]));
+			out = _mm_or_si128(out, moveChannelSSE2(in, srcShift[3], dstShift[3]));
+			_mm_storeu_si128((__m128i *)(dst + i), out);
+		}
+	} else {
+		for (; i + 4 <= count; i += 4) {
+			const __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i out = _mm_or_si128(moveChannelSSE2(in, srcShift[0], dstShift[0]), moveChannelSSE2(in, srcShift[1], dstShift[1]));
+			out = _mm_or_si128(out, moveChannelSSE2(in, srcShift[2], dstShift[2]));
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_or_si128(out, fill));
+		}
+	}
+
+	convert8888To8888C(dst + i, src + i, count - i, swizzle);
+}
+
+void convert565To8888SSE2(uint32 *dst, const uint16 *src, uint count, const ChannelSwizzle &swizzle) {
+	const __m128i rShift = _mm_cvtsi32_si128(swizzle.dstShift[0]);
+	const __m128i gShift = _mm_cvtsi32_si128(swizzle.dstShift[1]);
+	const __m128i bShift = _mm_cvtsi32_si128(swizzle.dstShift[2]);
+	const __m128i fill = _mm_set1_epi32(swizzle.fill);
+	const __m128i zero = _mm_setzero_si128();
+
+	// From the end of the row, see Convert565To8888Proc
+	while (count >= 8) {
+		count -= 8;
+
+		__m128i r, g, b;
+		expand565SSE2(_mm_loadu_si128((const __m128i *)(src + count)), r, g, b);
+
+		__m128i lo = _mm_or_si128(fill, _mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rShift));
+		lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gShift));
+		lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bShift));
+		__m128i hi = _mm_or_si128(fill, _mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rShift));
+		hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gShift));
+		hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bShift));
+
+		_mm_storeu_si128((__m128i *)(dst + count), lo);
+		_mm_storeu_si128((__m128i *)(dst + count + 4), hi);
+	}
+
+	convert565To8888C(dst, src, count, swizzle);
+}
+
+void convert8888To565SSE2(uint16 *dst, const uint32 *src, uint count, const ChannelSwizzle &swizzle) {
+	const __m128i rShift = _mm_cvtsi32_si128(swizzle.srcShift[0]);
+	const __m128i gShift = _mm_cvtsi32_si128(swizzle.srcShift[1]);
+	const __m128i bShift = _mm_cvtsi32_si128(swizzle.srcShift[2]);
+
+	uint i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m128i lo = pack565SSE2(_mm_loadu_si128((const __m128i *)(src + i)), rShift, gShift, bShift);
+		__m128i hi = pack565SSE2(_mm_loadu_si128((const __m128i *)(src + i + 4)), rShift, gShift, bShift);
+
+		// Sign extend, so that the signed saturation does not alter the values
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+
+	convert8888To565C(dst + i, src + i, count - i, swizzle);
+}
+
+} // End of namespace Graphics
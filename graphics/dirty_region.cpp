@@ -0,0 +1,124 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/dirty_region.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+static inline uint32 area(const Common::Rect &r) {
+	return (uint32)r.width() * (uint32)r.height();
+}
+
+DirtyRegion::DirtyRegion(uint maxRects) : _maxRects(MAX<uint>(maxRects, 1)) {
+}
+
+uint32 DirtyRegion::getMergeWaste(const Common::Rect &r1, const Common::Rect &r2) {
+	Common::Rect bounds(r1);
+	bounds.extend(r2);
+
+	uint32 covered = area(r1) + area(r2);
+	if (r1.intersects(r2))
+		covered -= area(r1.findIntersectingRect(r2));
+
+	return area(bounds) - covered;
+}
+
+bool DirtyRegion::isCheapToMerge(const Common::Rect &r1, const Common::Rect &r2) {
+	// At most a quarter of the changed pixels may be added
+	return getMergeWaste(r1, r2) <= (area(r1) + area(r2)) / 4;
+}
+
+void DirtyRegion::add(const Common::Rect &rect) {
+	if (rect.isEmpty())
+		return;
+
+	// Absorb the rectangles which are cheap to merge. The merged rectangle
+	// grows with every merge, which can make other merges cheap, so repeat
+	// until nothing changes anymore.
+	Common::Rect r(rect);
+	bool merged;
+	do {
+		merged = false;
+		for (uint i = 0; i < _rects.size();) {
+			if (_rects[i].contains(r))
+				return;
+
+			if (isCheapToMerge(_rects[i], r)) {
+				r.extend(_rects[i]);
+				_rects.remove_at(i);
+				merged = true;
+			} else {
+				++i;
+			}
+		}
+	} while (merged);
+
+	_rects.push_back(r);
+
+	while (_rects.size() > _maxRects)
+		mergeCheapestPair();
+}
+
+void DirtyRegion::mergeCheapestPair() {
+	uint best1 = 0, best2 = 1;
+	uint32 bestWaste = 0xFFFFFFFF;
+
+	for (uint i = 0; i < _rects.size(); ++i) {
+		for (uint j = i + 1; j < _rects.size(); ++j) {
+			const uint32 waste = getMergeWaste(_rects[i], _rects[j]);
+			if (waste < bestWaste) {
+				bestWaste = waste;
+				best1 = i;
+				best2 = j;
+			}
+		}
+	}
+
+	Common::Rect r(_rects[best1]);
+	r.extend(_rects[best2]);
+	_rects.remove_at(best2);
+	_rects.remove_at(best1);
+
+	// The merged rectangle may now contain, or be cheap to merge with,
+	// other rectangles
+	add(r);
+}
+
+Common::Rect DirtyRegion::getBoundingBox() const {
+	if (_rects.empty())
+		return Common::Rect();
+
+	Common::Rect bounds(_rects[0]);
+	for (uint i = 1; i < _rects.size(); ++i)
+		bounds.extend(_rects[i]);
+	return bounds;
+}
+
+uint32 DirtyRegion::getArea() const {
+	uint32 pixels = 0;
+	for (uint i = 0; i < _rects.size(); ++i)
+		pixels += area(_rects[i]);
+	return pixels;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_REGION_H
+#define GRAPHICS_DIRTY_REGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * A set of rectangles covering the changed parts of a surface.
+ *
+ * Rectangles are merged when their bounding box adds few unchanged
+ * pixels, and the set never holds more than a given number of them.
+ * Consumers can thus process every rectangle separately, touching little
+ * more than the changed pixels, instead of the bounding box of all
+ * changes.
+ */
+class DirtyRegion {
+public:
+	/**
+	 * @param maxRects the maximum number of rectangles kept. Beyond that,
+	 *                 the two rectangles cheapest to merge are merged.
+	 */
+	DirtyRegion(uint maxRects = 16);
+
+	/**
+	 * Add a changed area. Empty rectangles are ignored.
+	 */
+	void add(const Common::Rect &r);
+
+	void clear() { _rects.clear(); }
+
+	bool isEmpty() const { return _rects.empty(); }
+
+	/**
+	 * Return the rectangles of the region. Rectangles may overlap when
+	 * merging them would cover too many unchanged pixels.
+	 */
+	const Common::Array<Common::Rect> &getRects() const { return _rects; }
+
+	/**
+	 * Return the bounding box of all rectangles, or an empty rectangle.
+	 */
+	Common::Rect getBoundingBox() const;
+
+	/**
+	 * Return the number of pixels of all rectangles, that is what
+	 * processing them one after the other costs.
+	 */
+	uint32 getArea() const;
+
+	/**
+	 * Return whether the bounding box of two rectangles covers few enough
+	 * unchanged pixels to process it instead of both rectangles.
+	 */
+	static bool isCheapToMerge(const Common::Rect &r1, const Common::Rect &r2);
+
+private:
+	/**
+	 * Return the number of pixels the bounding box of two rectangles
+	 * covers, which none of them does.
+	 */
+	static uint32 getMergeWaste(const Common::Rect &r1, const Common::Rect &r2);
+
+	void mergeCheapestPair();
+
+	uint _maxRects;
+	Common::Array<Common::Rect> _rects;
+};
+
+} // End of namespace Graphics
+
+#endif
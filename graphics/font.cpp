@@ -94,26 +94,26 @@ int getStringWidthImpl(const Font &font, const StringType &str) {
 }
 
 template<class StringType>
-void drawStringImpl(const Font &font, Surface *dst, const StringType &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) {
-	// The logic in getBoundingImpl is the same as we use here. In case we
-	// ever change something here we will need to change it there too.
-	assert(dst != 0);
-
-	const int leftX = x, rightX = x + w;
+int alignStringImpl(const Font &font, const StringType &str, int x, int w, TextAlign align, int deltax) {
 	int width = font.getStringWidth(str);
 
 	if (align == kTextAlignCenter)
 		x = x + (w - width)/2;
 	else if (align == kTextAlignRight)
 		x = x + w - width;
-	x += deltax;
+	return x + deltax;
+}
 
+template<class StringType>
+void drawStringImpl(const Font &font, Surface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color) {
+	// The logic in getBoundingImpl is the same as we use here. In case we
+	// ever change something here we will need to change it there too.
 	typename StringType::unsigned_type last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
 		const typename StringType::unsigned_type cur = *i;
 		x += font.getKerningOffset(last, cur);
 		last = cur;
-		w = font.getCharWidth(cur);
+		const int w = font.getCharWidth(cur);
 		if (x+w > rightX)
 			break;
 		if (x+w >= leftX)
@@ -283,12 +283,24 @@ void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color)
 }
 
 void Font::drawString(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
+	assert(dst != 0);
+
 	Common::String renderStr = useEllipsis ? handleEllipsis(str, w) : str;
-	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
+	drawStringRun(dst, renderStr, alignStringImpl(*this, renderStr, x, w, align, deltax), y, x, x + w, color);
 }
 
 void Font::drawString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align) const {
-	drawStringImpl(*this, dst, str, x, y, w, color, align, 0);
+	assert(dst != 0);
+
+	drawStringRun(dst, str, alignStringImpl(*this, str, x, w, align, 0), y, x, x + w, color);
+}
+
+void Font::drawStringRun(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color) const {
+	drawStringImpl(*this, dst, str, x, y, leftX, rightX, color);
+}
+
+void Font::drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color) const {
+	drawStringImpl(*this, dst, str, x, y, leftX, rightX, color);
 }
 
 void Font::drawString(ManagedSurface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
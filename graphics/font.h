@@ -178,6 +178,26 @@ public:
 	int wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines, int initWidth = 0) const;
 	int wordWrapText(const Common::U32String &str, int maxWidth, Common::Array<Common::U32String> &lines, int initWidth = 0) const;
 
+protected:
+	/**
+	 * Draw an already aligned string. Characters ending left of leftX are
+	 * skipped and drawing stops at the first character ending right of
+	 * rightX, which is what drawString does with its text area.
+	 *
+	 * The default implementation draws the string character by character.
+	 * Fonts can override it to draw the whole string at once.
+	 *
+	 * @param dst    The surface to draw on.
+	 * @param str    The string to draw.
+	 * @param x      The x coordinate where to draw the first character.
+	 * @param y      The y coordinate where to draw the string.
+	 * @param leftX  The left edge of the text area.
+	 * @param rightX The right edge of the text area.
+	 * @param color  The color of the string.
+	 */
+	virtual void drawStringRun(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color) const;
+	virtual void drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color) const;
+
 private:
 	Common::String handleEllipsis(const Common::String &str, int w) const;
 };
@@ -34,6 +34,7 @@
 #include "common/singleton.h"
 #include "common/stream.h"
 #include "common/memstream.h"
+#include "common/array.h"
 #include "common/hashmap.h"
 #include "common/ptr.h"
 
@@ -122,6 +123,11 @@ public:
 	virtual Common::Rect getBoundingBox(uint32 chr) const;
 
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const;
+
+protected:
+	virtual void drawStringRun(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color) const;
+	virtual void drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color) const;
+
 private:
 	bool _initialized;
 	FT_Face _face;
@@ -133,7 +139,9 @@ private:
 	int _ascent, _descent;
 
 	struct Glyph {
-		Surface image;
+		const uint8 *image;
+		int pitch;
+		int width, height;
 		int xOffset, yOffset;
 		int advance;
 		FT_UInt slot;
@@ -145,6 +153,34 @@ private:
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	/**
+	 * Direct lookup of the first 256 characters, which are all cached on
+	 * load. The entries point into _glyphs, whose nodes never move.
+	 */
+	const Glyph *_glyphTable[256];
+	const Glyph *findGlyph(uint32 chr) const;
+
+	/**
+	 * The glyph images are packed row by row into large 8 bit pages instead
+	 * of one surface per glyph.
+	 */
+	mutable Common::Array<Surface *> _atlasPages;
+	int _atlasPageSize;
+	mutable int _atlasPage, _atlasX, _atlasY, _atlasRowHeight;
+	uint8 *allocateGlyphImage(int w, int h, int &pitch) const;
+
+	/**
+	 * Kerning of character pairs below 256, filled in on demand. Offsets not
+	 * fitting into an int8 are never stored.
+	 */
+	enum {
+		kKerningUnknown = -128
+	};
+	mutable int8 *_kerningTable;
+
+	template<class StringType>
+	void drawStringRunImpl(Surface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color) const;
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -159,7 +195,9 @@ private:
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
       _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-      _hasKerning(false), _allowLateCaching(false) {
+      _hasKerning(false), _allowLateCaching(false), _atlasPageSize(0), _atlasPage(-1), _atlasX(0), _atlasY(0),
+      _atlasRowHeight(0), _kerningTable(0) {
+	memset(_glyphTable, 0, sizeof(_glyphTable));
 }
 
 TTFFont::~TTFFont() {
@@ -169,11 +207,15 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	for (uint i = 0; i < _atlasPages.size(); ++i) {
+		_atlasPages[i]->free();
+		delete _atlasPages[i];
+	}
+
+	delete[] _kerningTable;
 }
 
 bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping) {
@@ -245,6 +287,11 @@ bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode siz
 	_width = ftCeil26_6(FT_MulFix(_face->max_advance_width, _face->size->metrics.x_scale));
 	_height = _ascent - _descent + 1;
 
+	// Make a page large enough for about 256 glyphs
+	_atlasPageSize = 64;
+	while (_atlasPageSize < 16 * MAX(_width, _height) && _atlasPageSize < 1024)
+		_atlasPageSize *= 2;
+
 	if (!mapping) {
 		// Allow loading of all unicode characters.
 		_allowLateCaching = true;
@@ -272,6 +319,9 @@ bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode siz
 		}
 	}
 
+	for (GlyphCache::const_iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
+		_glyphTable[i->_key] = &i->_value;
+
 	_initialized = (_glyphs.size() != 0);
 	return _initialized;
 }
@@ -405,56 +455,51 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
+	int8 *cachedOffset = 0;
+	if (left < 256 && right < 256) {
+		if (!_kerningTable) {
+			_kerningTable = new int8[256 * 256];
+			memset(_kerningTable, kKerningUnknown, 256 * 256);
+		}
 
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
-		return 0;
+		cachedOffset = &_kerningTable[left * 256 + right];
+		if (*cachedOffset != kKerningUnknown)
+			return *cachedOffset;
 	}
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
-		return 0;
+	const Glyph *leftGlyph = findGlyph(left);
+	const Glyph *rightGlyph = findGlyph(right);
+
+	int offset = 0;
+	if (leftGlyph && rightGlyph && leftGlyph->slot && rightGlyph->slot) {
+		FT_Vector kerningVector;
+		FT_Get_Kerning(_face, leftGlyph->slot, rightGlyph->slot, FT_KERNING_DEFAULT, &kerningVector);
+		offset = kerningVector.x / 64;
 	}
 
-	if (!leftGlyph || !rightGlyph)
-		return 0;
+	if (cachedOffset && offset > kKerningUnknown && offset <= 127)
+		*cachedOffset = offset;
 
-	FT_Vector kerningVector;
-	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		return Common::Rect(glyph->xOffset, glyph->yOffset, glyph->xOffset + glyph->width, glyph->yOffset + glyph->height);
 	}
 }
 
@@ -494,29 +539,12 @@ void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const i
 	}
 }
 
-} // End of anonymous namespace
-
-void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
-		return;
-
-	const Glyph &glyph = glyphEntry->_value;
-
-	x += glyph.xOffset;
-	y += glyph.yOffset;
-
+void drawImage(Surface *dst, int x, int y, const uint8 *srcPos, const int srcPitch, int w, int h, uint32 color) {
 	if (x > dst->w)
 		return;
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
-
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
-
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
 		srcPos -= x;
@@ -531,7 +559,7 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * srcPitch;
 		h += y;
 		y = 0;
 	}
@@ -560,12 +588,50 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += srcPitch;
 		}
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format);
+	}
+}
+
+} // End of anonymous namespace
+
+void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
+		return;
+
+	drawImage(dst, x + glyph->xOffset, y + glyph->yOffset, glyph->image, glyph->pitch, glyph->width, glyph->height, color);
+}
+
+void TTFFont::drawStringRun(Surface *dst, const Common::String &str, int x, int y, int leftX, int rightX, uint32 color) const {
+	drawStringRunImpl(dst, str, x, y, leftX, rightX, color);
+}
+
+void TTFFont::drawStringRun(Surface *dst, const Common::U32String &str, int x, int y, int leftX, int rightX, uint32 color) const {
+	drawStringRunImpl(dst, str, x, y, leftX, rightX, color);
+}
+
+template<class StringType>
+void TTFFont::drawStringRunImpl(Surface *dst, const StringType &str, int x, int y, int leftX, int rightX, uint32 color) const {
+	// Same as Font::drawStringRun, but every glyph is looked up only once
+	// and drawn directly.
+	typename StringType::unsigned_type last = 0;
+	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
+		const typename StringType::unsigned_type cur = *i;
+		x += TTFFont::getKerningOffset(last, cur);
+		last = cur;
+
+		const Glyph *glyph = findGlyph(cur);
+		const int w = glyph ? glyph->advance : 0;
+		if (x + w > rightX)
+			break;
+		if (x + w >= leftX && glyph)
+			drawImage(dst, x + glyph->xOffset, y + glyph->yOffset, glyph->image, glyph->pitch, glyph->width, glyph->height, color);
+		x += w;
 	}
 }
 
@@ -594,7 +660,15 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	glyph.advance = ftCeil26_6(_face->glyph->advance.x);
 
 	const FT_Bitmap &bitmap = _face->glyph->bitmap;
-	glyph.image.create(bitmap.width, bitmap.rows, PixelFormat::createFormatCLUT8());
+	if (bitmap.pixel_mode != FT_PIXEL_MODE_MONO && bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
+		return false;
+	}
+
+	glyph.width = bitmap.width;
+	glyph.height = bitmap.rows;
+	uint8 *dst = allocateGlyphImage(glyph.width, glyph.height, glyph.pitch);
+	glyph.image = dst;
 
 	const uint8 *src = bitmap.buffer;
 	int srcPitch = bitmap.pitch;
@@ -603,9 +677,6 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		srcPitch = -srcPitch;
 	}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
-	memset(dst, 0, glyph.image.h * glyph.image.pitch);
-
 	switch (bitmap.pixel_mode) {
 	case FT_PIXEL_MODE_MONO:
 		for (int y = 0; y < (int)bitmap.rows; ++y) {
@@ -617,12 +688,12 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = 255;
 
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += glyph.pitch;
 			src += srcPitch;
 		}
 		break;
@@ -630,20 +701,60 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	case FT_PIXEL_MODE_GRAY:
 		for (int y = 0; y < (int)bitmap.rows; ++y) {
 			memcpy(dst, src, bitmap.width);
-			dst += glyph.image.pitch;
+			dst += glyph.pitch;
 			src += srcPitch;
 		}
 		break;
 
 	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
-		glyph.image.free();
-		return false;
+		break;
 	}
 
 	return true;
 }
 
+uint8 *TTFFont::allocateGlyphImage(int w, int h, int &pitch) const {
+	pitch = 0;
+	if (w <= 0 || h <= 0)
+		return 0;
+
+	Surface *page;
+	if (w > _atlasPageSize || h > _atlasPageSize) {
+		// Oversized glyphs get a page of their own, which is not filled up
+		page = new Surface();
+		page->create(w, h, PixelFormat::createFormatCLUT8());
+		memset(page->getPixels(), 0, page->h * page->pitch);
+		_atlasPages.push_back(page);
+
+		pitch = page->pitch;
+		return (uint8 *)page->getPixels();
+	}
+
+	if (_atlasPage >= 0 && _atlasX + w > _atlasPageSize) {
+		_atlasX = 0;
+		_atlasY += _atlasRowHeight;
+		_atlasRowHeight = 0;
+	}
+
+	if (_atlasPage < 0 || _atlasY + h > _atlasPageSize) {
+		page = new Surface();
+		page->create(_atlasPageSize, _atlasPageSize, PixelFormat::createFormatCLUT8());
+		memset(page->getPixels(), 0, page->h * page->pitch);
+		_atlasPages.push_back(page);
+
+		_atlasPage = _atlasPages.size() - 1;
+		_atlasX = _atlasY = _atlasRowHeight = 0;
+	}
+
+	page = _atlasPages[_atlasPage];
+	uint8 *image = (uint8 *)page->getBasePtr(_atlasX, _atlasY);
+	_atlasX += w;
+	_atlasRowHeight = MAX(_atlasRowHeight, h);
+
+	pitch = page->pitch;
+	return image;
+}
+
 void TTFFont::assureCached(uint32 chr) const {
 	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
 		return;
@@ -655,6 +766,18 @@ void TTFFont::assureCached(uint32 chr) const {
 	}
 }
 
+const TTFFont::Glyph *TTFFont::findGlyph(uint32 chr) const {
+	if (chr < ARRAYSIZE(_glyphTable))
+		return _glyphTable[chr];
+
+	assureCached(chr);
+	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry == _glyphs.end())
+		return 0;
+	else
+		return &glyphEntry->_value;
+}
+
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping) {
 	TTFFont *font = new TTFFont();
 
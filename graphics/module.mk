@@ -3,6 +3,7 @@ MODULE := graphics
 MODULE_OBJS := \
 	conversion.o \
 	cursorman.o \
+	dirty_region.o \
 	font.o \
 	fontman.o \
 	fonts/bdf.o \
@@ -38,6 +39,33 @@ MODULE_OBJS := \
 	wincursor.o \
 	yuv_to_rgb.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	conversion_sse2.o \
+	transparent_surface_sse2.o \
+	yuv_to_rgb_sse2.o
+$(MODULE)/conversion_sse2.o: CXXFLAGS += -msse2
+$(MODULE)/transparent_surface_sse2.o: CXXFLAGS += -msse2
+$(MODULE)/yuv_to_rgb_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	conversion_avx2.o \
+	transparent_surface_avx2.o \
+	yuv_to_rgb_avx2.o
+$(MODULE)/conversion_avx2.o: CXXFLAGS += -mavx2
+$(MODULE)/transparent_surface_avx2.o: CXXFLAGS += -mavx2
+$(MODULE)/yuv_to_rgb_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	conversion_neon.o \
+	transparent_surface_neon.o \
+	yuv_to_rgb_neon.o
+endif
+
 ifdef USE_SCALERS
 MODULE_OBJS += \
 	scaler/2xsai.o \
@@ -47,6 +75,23 @@ MODULE_OBJS += \
 	scaler/scale3x.o \
 	scaler/scalebit.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	scaler/scalebit_sse2.o
+$(MODULE)/scaler/scalebit_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	scaler/scalebit_avx2.o
+$(MODULE)/scaler/scalebit_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	scaler/scalebit_neon.o
+endif
+
 ifdef USE_ARM_SCALER_ASM
 MODULE_OBJS += \
 	scaler/downscalerARM.o \
@@ -144,6 +144,10 @@ void InitScalers(uint32 BitFormat) {
 	InitLUT(format);
 #endif
 
+#ifdef USE_SCALERS
+	scale_init();
+#endif
+
 	// Build dotmatrix lookup table for the DotMatrix scaler.
 	g_dotmatrix[0] = g_dotmatrix[10] = format.RGBToColor(0, 63, 0);
 	g_dotmatrix[1] = g_dotmatrix[11] = format.RGBToColor(0, 0, 63);
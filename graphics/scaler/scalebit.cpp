@@ -34,6 +34,7 @@
  */
 
 #include "common/scummsys.h"
+#include "common/system.h"
 
 #include "graphics/scaler/scale2x.h"
 #include "graphics/scaler/scale3x.h"
@@ -41,10 +42,54 @@
 #define DST(bits, num)	(scale2x_uint ## bits *)dst ## num
 #define SRC(bits, num)	(const scale2x_uint ## bits *)src ## num
 
+typedef void scale2x_16_proc(scale2x_uint16* dst0, scale2x_uint16* dst1, const scale2x_uint16* src0, const scale2x_uint16* src1, const scale2x_uint16* src2, unsigned count);
+typedef void scale3x_16_proc(scale3x_uint16* dst0, scale3x_uint16* dst1, scale3x_uint16* dst2, const scale3x_uint16* src0, const scale3x_uint16* src1, const scale3x_uint16* src2, unsigned count);
+
+/* SIMD implementations for 16 bits pixels, selected by scale_init() */
+static scale2x_16_proc* scale2x_16_simd = 0;
+static scale3x_16_proc* scale3x_16_simd = 0;
+
+/**
+ * Select the fastest implementations of the Scale effect the host CPU
+ * supports. Must be called before the first use of ::scale().
+ */
+void scale_init(void) {
+	scale2x_16_simd = 0;
+	scale3x_16_simd = 0;
+
+	const OSystem::CpuExtension cpuExtension = OSystem::getCpuExtension();
+#ifdef SCUMMVM_AVX2
+	if (cpuExtension >= OSystem::kCpuExtensionAVX2) {
+		scale2x_16_simd = scale2x_16_avx2;
+		scale3x_16_simd = scale3x_16_avx2;
+		return;
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (cpuExtension >= OSystem::kCpuExtensionSSE2) {
+		scale2x_16_simd = scale2x_16_sse2;
+		scale3x_16_simd = scale3x_16_sse2;
+		return;
+	}
+#endif
+#ifdef SCUMMVM_NEON
+	if (cpuExtension == OSystem::kCpuExtensionNEON) {
+		scale2x_16_simd = scale2x_16_neon;
+		scale3x_16_simd = scale3x_16_neon;
+		return;
+	}
+#endif
+}
+
 /**
  * Apply the Scale2x effect on a group of rows. Used internally.
  */
 static inline void stage_scale2x(void* dst0, void* dst1, const void* src0, const void* src1, const void* src2, unsigned pixel, unsigned pixel_per_row) {
+	if (pixel == 2 && scale2x_16_simd) {
+		scale2x_16_simd(DST(16,0), DST(16,1), SRC(16,0), SRC(16,1), SRC(16,2), pixel_per_row);
+		return;
+	}
+
 	switch (pixel) {
 #if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
 	case 1 : scale2x_8_mmx(DST(8,0), DST(8,1), SRC(8,0), SRC(8,1), SRC(8,2), pixel_per_row); break;
@@ -66,6 +111,11 @@ static inline void stage_scale2x(void* dst0, void* dst1, const void* src0, const
  * Apply the Scale3x effect on a group of rows. Used internally.
  */
 static inline void stage_scale3x(void* dst0, void* dst1, void* dst2, const void* src0, const void* src1, const void* src2, unsigned pixel, unsigned pixel_per_row) {
+	if (pixel == 2 && scale3x_16_simd) {
+		scale3x_16_simd(DST(16,0), DST(16,1), DST(16,2), SRC(16,0), SRC(16,1), SRC(16,2), pixel_per_row);
+		return;
+	}
+
 	switch (pixel) {
 	case 1 : scale3x_8_def(DST(8,0), DST(8,1), DST(8,2), SRC(8,0), SRC(8,1), SRC(8,2), pixel_per_row); break;
 	case 2 : scale3x_16_def(DST(16,0), DST(16,1), DST(16,2), SRC(16,0), SRC(16,1), SRC(16,2), pixel_per_row); break;
@@ -36,6 +36,7 @@
 #ifndef SCALER_SCALEBIT_H
 #define SCALER_SCALEBIT_H
 
+void scale_init(void);
 int scale_precondition(unsigned scale, unsigned pixel, unsigned width, unsigned height);
 void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height);
 
@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/scale2x.h"
+#include "graphics/scaler/scale3x.h"
+#include "graphics/scaler/scalebit_sse2.h"
+
+#include <immintrin.h>
+
+#define LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define STORE(p, x) _mm256_storeu_si256((__m256i *)(p), x)
+
+/**
+ * Select the lanes of x where mask is set, and those of y elsewhere.
+ */
+static inline __m256i scale_select_avx2(__m256i mask, __m256i x, __m256i y) {
+	return _mm256_blendv_epi8(y, x, mask);
+}
+
+/***************************************************************************/
+/* Scale2x AVX2 implementation */
+
+/**
+ * Scale by a factor of 2 a row of pixels of 16 bits.
+ * This function operates like scale2x_16_def(), sixteen pixels at a time.
+ */
+void scale2x_16_avx2(scale2x_uint16* dst0, scale2x_uint16* dst1, const scale2x_uint16* src0, const scale2x_uint16* src1, const scale2x_uint16* src2, unsigned count) {
+	unsigned i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const __m256i B = LOAD(src0 + i);
+		const __m256i D = LOAD(src1 + i - 1);
+		const __m256i E = LOAD(src1 + i);
+		const __m256i F = LOAD(src1 + i + 1);
+		const __m256i H = LOAD(src2 + i);
+
+		/* lanes where the pixel is just copied */
+		const __m256i copy = _mm256_or_si256(_mm256_cmpeq_epi16(B, H), _mm256_cmpeq_epi16(D, F));
+
+		const __m256i e0 = scale_select_avx2(_mm256_andnot_si256(copy, _mm256_cmpeq_epi16(D, B)), B, E);
+		const __m256i e1 = scale_select_avx2(_mm256_andnot_si256(copy, _mm256_cmpeq_epi16(F, B)), B, E);
+		const __m256i e2 = scale_select_avx2(_mm256_andnot_si256(copy, _mm256_cmpeq_epi16(D, H)), H, E);
+		const __m256i e3 = scale_select_avx2(_mm256_andnot_si256(copy, _mm256_cmpeq_epi16(F, H)), H, E);
+
+		/* the unpacks work on each 128 bit half separately */
+		const __m256i lo0 = _mm256_unpacklo_epi16(e0, e1);
+		const __m256i hi0 = _mm256_unpackhi_epi16(e0, e1);
+		const __m256i lo1 = _mm256_unpacklo_epi16(e2, e3);
+		const __m256i hi1 = _mm256_unpackhi_epi16(e2, e3);
+
+		STORE(dst0 + 2 * i, _mm256_permute2x128_si256(lo0, hi0, 0x20));
+		STORE(dst0 + 2 * i + 16, _mm256_permute2x128_si256(lo0, hi0, 0x31));
+		STORE(dst1 + 2 * i, _mm256_permute2x128_si256(lo1, hi1, 0x20));
+		STORE(dst1 + 2 * i + 16, _mm256_permute2x128_si256(lo1, hi1, 0x31));
+	}
+
+	if (i < count)
+		scale2x_16_def(dst0 + 2 * i, dst1 + 2 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+/***************************************************************************/
+/* Scale3x AVX2 implementation */
+
+static inline void scale_store3_16_avx2(scale3x_uint16* dst, __m256i a, __m256i b, __m256i c) {
+	scale_store3_16_sse2(dst, _mm256_castsi256_si128(a), _mm256_castsi256_si128(b), _mm256_castsi256_si128(c));
+	scale_store3_16_sse2(dst + 24, _mm256_extracti128_si256(a, 1), _mm256_extracti128_si256(b, 1), _mm256_extracti128_si256(c, 1));
+}
+
+/**
+ * Scale by a factor of 3 a row of pixels of 16 bits.
+ * This function operates like scale3x_16_def(), sixteen pixels at a time.
+ */
+void scale3x_16_avx2(scale3x_uint16* dst0, scale3x_uint16* dst1, scale3x_uint16* dst2, const scale3x_uint16* src0, const scale3x_uint16* src1, const scale3x_uint16* src2, unsigned count) {
+	unsigned i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		const __m256i A = LOAD(src0 + i - 1);
+		const __m256i B = LOAD(src0 + i);
+		const __m256i C = LOAD(src0 + i + 1);
+		const __m256i D = LOAD(src1 + i - 1);
+		const __m256i E = LOAD(src1 + i);
+		const __m256i F = LOAD(src1 + i + 1);
+		const __m256i G = LOAD(src2 + i - 1);
+		const __m256i H = LOAD(src2 + i);
+		const __m256i I = LOAD(src2 + i + 1);
+
+		/* lanes where the pixel is just copied */
+		const __m256i copy = _mm256_or_si256(_mm256_cmpeq_epi16(B, H), _mm256_cmpeq_epi16(D, F));
+
+		const __m256i DB = _mm256_andnot_si256(copy, _mm256_cmpeq_epi16(D, B));
+		const __m256i FB = _mm256_andnot_si256(copy, _mm256_cmpeq_epi16(F, B));
+		const __m256i DH = _mm256_andnot_si256(copy, _mm256_cmpeq_epi16(D, H));
+		const __m256i FH = _mm256_andnot_si256(copy, _mm256_cmpeq_epi16(F, H));
+		const __m256i EA = _mm256_cmpeq_epi16(E, A);
+		const __m256i EC = _mm256_cmpeq_epi16(E, C);
+		const __m256i EG = _mm256_cmpeq_epi16(E, G);
+		const __m256i EI = _mm256_cmpeq_epi16(E, I);
+
+		scale_store3_16_avx2(dst0 + 3 * i,
+			scale_select_avx2(DB, D, E),
+			scale_select_avx2(_mm256_or_si256(_mm256_andnot_si256(EC, DB), _mm256_andnot_si256(EA, FB)), B, E),
+			scale_select_avx2(FB, F, E));
+		scale_store3_16_avx2(dst1 + 3 * i,
+			scale_select_avx2(_mm256_or_si256(_mm256_andnot_si256(EG, DB), _mm256_andnot_si256(EA, DH)), D, E),
+			E,
+			scale_select_avx2(_mm256_or_si256(_mm256_andnot_si256(EI, FB), _mm256_andnot_si256(EC, FH)), F, E));
+		scale_store3_16_avx2(dst2 + 3 * i,
+			scale_select_avx2(DH, D, E),
+			scale_select_avx2(_mm256_or_si256(_mm256_andnot_si256(EI, DH), _mm256_andnot_si256(EG, FH)), H, E),
+			scale_select_avx2(FH, F, E));
+	}
+
+	if (i < count)
+		scale3x_16_def(dst0 + 3 * i, dst1 + 3 * i, dst2 + 3 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/scale2x.h"
+#include "graphics/scaler/scale3x.h"
+
+#include <arm_neon.h>
+
+/***************************************************************************/
+/* Scale2x NEON implementation */
+
+/**
+ * Scale by a factor of 2 a row of pixels of 16 bits.
+ * This function operates like scale2x_16_def(), eight pixels at a time.
+ */
+void scale2x_16_neon(scale2x_uint16* dst0, scale2x_uint16* dst1, const scale2x_uint16* src0, const scale2x_uint16* src1, const scale2x_uint16* src2, unsigned count) {
+	unsigned i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const uint16x8_t B = vld1q_u16(src0 + i);
+		const uint16x8_t D = vld1q_u16(src1 + i - 1);
+		const uint16x8_t E = vld1q_u16(src1 + i);
+		const uint16x8_t F = vld1q_u16(src1 + i + 1);
+		const uint16x8_t H = vld1q_u16(src2 + i);
+
+		/* lanes where the pixel is just copied */
+		const uint16x8_t copy = vorrq_u16(vceqq_u16(B, H), vceqq_u16(D, F));
+
+		uint16x8x2_t e;
+		e.val[0] = vbslq_u16(vbicq_u16(vceqq_u16(D, B), copy), B, E);
+		e.val[1] = vbslq_u16(vbicq_u16(vceqq_u16(F, B), copy), B, E);
+		vst2q_u16(dst0 + 2 * i, e);
+		e.val[0] = vbslq_u16(vbicq_u16(vceqq_u16(D, H), copy), H, E);
+		e.val[1] = vbslq_u16(vbicq_u16(vceqq_u16(F, H), copy), H, E);
+		vst2q_u16(dst1 + 2 * i, e);
+	}
+
+	if (i < count)
+		scale2x_16_def(dst0 + 2 * i, dst1 + 2 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+/***************************************************************************/
+/* Scale3x NEON implementation */
+
+/**
+ * Scale by a factor of 3 a row of pixels of 16 bits.
+ * This function operates like scale3x_16_def(), eight pixels at a time.
+ */
+void scale3x_16_neon(scale3x_uint16* dst0, scale3x_uint16* dst1, scale3x_uint16* dst2, const scale3x_uint16* src0, const scale3x_uint16* src1, const scale3x_uint16* src2, unsigned count) {
+	unsigned i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const uint16x8_t A = vld1q_u16(src0 + i - 1);
+		const uint16x8_t B = vld1q_u16(src0 + i);
+		const uint16x8_t C = vld1q_u16(src0 + i + 1);
+		const uint16x8_t D = vld1q_u16(src1 + i - 1);
+		const uint16x8_t E = vld1q_u16(src1 + i);
+		const uint16x8_t F = vld1q_u16(src1 + i + 1);
+		const uint16x8_t G = vld1q_u16(src2 + i - 1);
+		const uint16x8_t H = vld1q_u16(src2 + i);
+		const uint16x8_t I = vld1q_u16(src2 + i + 1);
+
+		/* lanes where the pixel is just copied */
+		const uint16x8_t copy = vorrq_u16(vceqq_u16(B, H), vceqq_u16(D, F));
+
+		const uint16x8_t DB = vbicq_u16(vceqq_u16(D, B), copy);
+		const uint16x8_t FB = vbicq_u16(vceqq_u16(F, B), copy);
+		const uint16x8_t DH = vbicq_u16(vceqq_u16(D, H), copy);
+		const uint16x8_t FH = vbicq_u16(vceqq_u16(F, H), copy);
+		const uint16x8_t EA = vceqq_u16(E, A);
+		const uint16x8_t EC = vceqq_u16(E, C);
+		const uint16x8_t EG = vceqq_u16(E, G);
+		const uint16x8_t EI = vceqq_u16(E, I);
+
+		uint16x8x3_t e;
+		e.val[0] = vbslq_u16(DB, D, E);
+		e.val[1] = vbslq_u16(vorrq_u16(vbicq_u16(DB, EC), vbicq_u16(FB, EA)), B, E);
+		e.val[2] = vbslq_u16(FB, F, E);
+		vst3q_u16(dst0 + 3 * i, e);
+		e.val[0] = vbslq_u16(vorrq_u16(vbicq_u16(DB, EG), vbicq_u16(DH, EA)), D, E);
+		e.val[1] = E;
+		e.val[2] = vbslq_u16(vorrq_u16(vbicq_u16(FB, EI), vbicq_u16(FH, EC)), F, E);
+		vst3q_u16(dst1 + 3 * i, e);
+		e.val[0] = vbslq_u16(DH, D, E);
+		e.val[1] = vbslq_u16(vorrq_u16(vbicq_u16(DH, EI), vbicq_u16(FH, EG)), H, E);
+		e.val[2] = vbslq_u16(FH, F, E);
+		vst3q_u16(dst2 + 3 * i, e);
+	}
+
+	if (i < count)
+		scale3x_16_def(dst0 + 3 * i, dst1 + 3 * i, dst2 + 3 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
@@ -0,0 +1,116 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/scaler/scale2x.h"
+#include "graphics/scaler/scale3x.h"
+#include "graphics/scaler/scalebit_sse2.h"
+
+#define LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define STORE(p, x) _mm_storeu_si128((__m128i *)(p), x)
+
+/***************************************************************************/
+/* Scale2x SSE2 implementation */
+
+/**
+ * Scale by a factor of 2 a row of pixels of 16 bits.
+ * This function operates like scale2x_16_def(), eight pixels at a time.
+ */
+void scale2x_16_sse2(scale2x_uint16* dst0, scale2x_uint16* dst1, const scale2x_uint16* src0, const scale2x_uint16* src1, const scale2x_uint16* src2, unsigned count) {
+	unsigned i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i B = LOAD(src0 + i);
+		const __m128i D = LOAD(src1 + i - 1);
+		const __m128i E = LOAD(src1 + i);
+		const __m128i F = LOAD(src1 + i + 1);
+		const __m128i H = LOAD(src2 + i);
+
+		/* lanes where the pixel is just copied */
+		const __m128i copy = _mm_or_si128(_mm_cmpeq_epi16(B, H), _mm_cmpeq_epi16(D, F));
+
+		const __m128i e0 = scale_select_sse2(_mm_andnot_si128(copy, _mm_cmpeq_epi16(D, B)), B, E);
+		const __m128i e1 = scale_select_sse2(_mm_andnot_si128(copy, _mm_cmpeq_epi16(F, B)), B, E);
+		const __m128i e2 = scale_select_sse2(_mm_andnot_si128(copy, _mm_cmpeq_epi16(D, H)), H, E);
+		const __m128i e3 = scale_select_sse2(_mm_andnot_si128(copy, _mm_cmpeq_epi16(F, H)), H, E);
+
+		STORE(dst0 + 2 * i, _mm_unpacklo_epi16(e0, e1));
+		STORE(dst0 + 2 * i + 8, _mm_unpackhi_epi16(e0, e1));
+		STORE(dst1 + 2 * i, _mm_unpacklo_epi16(e2, e3));
+		STORE(dst1 + 2 * i + 8, _mm_unpackhi_epi16(e2, e3));
+	}
+
+	if (i < count)
+		scale2x_16_def(dst0 + 2 * i, dst1 + 2 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
+
+/***************************************************************************/
+/* Scale3x SSE2 implementation */
+
+/**
+ * Scale by a factor of 3 a row of pixels of 16 bits.
+ * This function operates like scale3x_16_def(), eight pixels at a time.
+ */
+void scale3x_16_sse2(scale3x_uint16* dst0, scale3x_uint16* dst1, scale3x_uint16* dst2, const scale3x_uint16* src0, const scale3x_uint16* src1, const scale3x_uint16* src2, unsigned count) {
+	unsigned i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i A = LOAD(src0 + i - 1);
+		const __m128i B = LOAD(src0 + i);
+		const __m128i C = LOAD(src0 + i + 1);
+		const __m128i D = LOAD(src1 + i - 1);
+		const __m128i E = LOAD(src1 + i);
+		const __m128i F = LOAD(src1 + i + 1);
+		const __m128i G = LOAD(src2 + i - 1);
+		const __m128i H = LOAD(src2 + i);
+		const __m128i I = LOAD(src2 + i + 1);
+
+		/* lanes where the pixel is just copied */
+		const __m128i copy = _mm_or_si128(_mm_cmpeq_epi16(B, H), _mm_cmpeq_epi16(D, F));
+
+		const __m128i DB = _mm_andnot_si128(copy, _mm_cmpeq_epi16(D, B));
+		const __m128i FB = _mm_andnot_si128(copy, _mm_cmpeq_epi16(F, B));
+		const __m128i DH = _mm_andnot_si128(copy, _mm_cmpeq_epi16(D, H));
+		const __m128i FH = _mm_andnot_si128(copy, _mm_cmpeq_epi16(F, H));
+		const __m128i EA = _mm_cmpeq_epi16(E, A);
+		const __m128i EC = _mm_cmpeq_epi16(E, C);
+		const __m128i EG = _mm_cmpeq_epi16(E, G);
+		const __m128i EI = _mm_cmpeq_epi16(E, I);
+
+		scale_store3_16_sse2(dst0 + 3 * i,
+			scale_select_sse2(DB, D, E),
+			scale_select_sse2(_mm_or_si128(_mm_andnot_si128(EC, DB), _mm_andnot_si128(EA, FB)), B, E),
+			scale_select_sse2(FB, F, E));
+		scale_store3_16_sse2(dst1 + 3 * i,
+			scale_select_sse2(_mm_or_si128(_mm_andnot_si128(EG, DB), _mm_andnot_si128(EA, DH)), D, E),
+			E,
+			scale_select_sse2(_mm_or_si128(_mm_andnot_si128(EI, FB), _mm_andnot_si128(EC, FH)), F, E));
+		scale_store3_16_sse2(dst2 + 3 * i,
+			scale_select_sse2(DH, D, E),
+			scale_select_sse2(_mm_or_si128(_mm_andnot_si128(EI, DH), _mm_andnot_si128(EG, FH)), H, E),
+			scale_select_sse2(FH, F, E));
+	}
+
+	if (i < count)
+		scale3x_16_def(dst0 + 3 * i, dst1 + 3 * i, dst2 + 3 * i, src0 + i, src1 + i, src2 + i, count - i);
+}
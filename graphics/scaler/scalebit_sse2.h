@@ -0,0 +1,69 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCALER_SCALEBIT_SSE2_H
+#define SCALER_SCALEBIT_SSE2_H
+
+#include <emmintrin.h>
+
+/*
+ * Helpers shared by the SSE2 and AVX2 scalers. They are static so that
+ * each of them gets compiled with the instruction set of its user.
+ */
+
+/**
+ * Select the lanes of x where mask is set, and those of y elsewhere.
+ */
+static inline __m128i scale_select_sse2(__m128i mask, __m128i x, __m128i y) {
+	return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+}
+
+/**
+ * Store the 16 bit lanes of a, b and c interleaved, that is
+ * a0 b0 c0 a1 b1 c1 ... a7 b7 c7, as 24 pixels at dst.
+ */
+static inline void scale_store3_16_sse2(unsigned short* dst, __m128i a, __m128i b, __m128i c) {
+	const __m128i m0 = _mm_set_epi16(0, -1, 0, 0, -1, 0, 0, -1);
+	const __m128i m1 = _mm_set_epi16(-1, 0, 0, -1, 0, 0, -1, 0);
+	const __m128i m2 = _mm_set_epi16(0, 0, -1, 0, 0, -1, 0, 0);
+	__m128i x, y, z;
+
+	/* a0 b0 c0 a1 b1 c1 a2 b2 */
+	x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(a, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(1, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	y = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(2, 0, 0, 1));
+	z = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(c, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(1, 1, 1, 1));
+	_mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_or_si128(_mm_and_si128(x, m0), _mm_and_si128(y, m1)), _mm_and_si128(z, m2)));
+
+	/* c2 a3 b3 c3 a4 b4 c4 a5 */
+	x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(c, _MM_SHUFFLE(2, 2, 1, 1)), _MM_SHUFFLE(1, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+	y = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(a, _MM_SHUFFLE(2, 2, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(1, 0, 0, 0));
+	z = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(b, _MM_SHUFFLE(2, 2, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(0, 0, 0, 0));
+	_mm_storeu_si128((__m128i *)(dst + 8), _mm_or_si128(_mm_or_si128(_mm_and_si128(x, m0), _mm_and_si128(y, m1)), _mm_and_si128(z, m2)));
+
+	/* b5 c5 a6 b6 c6 a7 b7 c7 */
+	x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(b, _MM_SHUFFLE(3, 3, 3, 2)), _MM_SHUFFLE(2, 1, 1, 1)), _MM_SHUFFLE(1, 1, 1, 1));
+	y = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(c, _MM_SHUFFLE(3, 3, 2, 2)), _MM_SHUFFLE(1, 1, 1, 1)), _MM_SHUFFLE(1, 0, 0, 0));
+	z = _mm_shufflehi_epi16(_mm_shufflelo_epi16(_mm_shuffle_epi32(a, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(1, 1, 1, 1));
+	_mm_storeu_si128((__m128i *)(dst + 16), _mm_or_si128(_mm_or_si128(_mm_and_si128(x, m0), _mm_and_si128(y, m1)), _mm_and_si128(z, m2)));
+}
+
+#endif
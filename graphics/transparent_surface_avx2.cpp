@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/transparent_surface_intern.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * Load eight source pixels, in the order they are blitted.
+ */
+template<bool flipped>
+inline __m256i loadPixelsAVX2(const byte *in) {
+	if (flipped)
+		return _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(in - 28)), _mm256_set_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	else
+		return _mm256_loadu_si256((const __m256i *)in);
+}
+
+/**
+ * Copy the alpha of each of the four pixels in 16 bit lanes to the lanes
+ * of its other channels.
+ */
+inline __m256i broadcastAlphaAVX2(__m256i pixels) {
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+inline __m256i alphaBlendAVX2(__m256i src, __m256i dst) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i full = _mm256_set1_epi16(255);
+
+	const __m256i srcLo = _mm256_unpacklo_epi8(src, zero);
+	const __m256i srcHi = _mm256_unpackhi_epi8(src, zero);
+	const __m256i aLo = broadcastAlphaAVX2(srcLo);
+	const __m256i aHi = broadcastAlphaAVX2(srcHi);
+
+	const __m256i outLo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(srcLo, aLo), _mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), _mm256_sub_epi16(full, aLo))), 8);
+	const __m256i outHi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(srcHi, aHi), _mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), _mm256_sub_epi16(full, aHi))), 8);
+	const __m256i out = _mm256_or_si256(_mm256_and_si256(_mm256_packus_epi16(outLo, outHi), _mm256_set1_epi32(0xFFFFFF00)), _mm256_set1_epi32(0xFF));
+
+	// Fully transparent pixels leave the destination untouched
+	const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(src, _mm256_set1_epi32(0xFF)), zero);
+	return _mm256_or_si256(_mm256_and_si256(transparent, dst), _mm256_andnot_si256(transparent, out));
+}
+
+inline __m256i alphaBlendColorModAVX2(__m256i src, __m256i dst, __m256i modAlpha, __m256i modColor) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i full = _mm256_set1_epi16(255);
+
+	const __m256i srcLo = _mm256_unpacklo_epi8(src, zero);
+	const __m256i srcHi = _mm256_unpackhi_epi8(src, zero);
+	const __m256i aLo = _mm256_srli_epi16(_mm256_mullo_epi16(broadcastAlphaAVX2(srcLo), modAlpha), 8);
+	const __m256i aHi = _mm256_srli_epi16(_mm256_mullo_epi16(broadcastAlphaAVX2(srcHi), modAlpha), 8);
+
+	__m256i outLo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), _mm256_sub_epi16(full, aLo)), 8);
+	__m256i outHi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), _mm256_sub_epi16(full, aHi)), 8);
+	outLo = _mm256_add_epi16(outLo, _mm256_mulhi_epu16(_mm256_mullo_epi16(srcLo, aLo), modColor));
+	outHi = _mm256_add_epi16(outHi, _mm256_mulhi_epu16(_mm256_mullo_epi16(srcHi, aHi), modColor));
+	return _mm256_or_si256(_mm256_and_si256(_mm256_packus_epi16(outLo, outHi), _mm256_set1_epi32(0xFFFFFF00)), _mm256_set1_epi32(0xFF));
+}
+
+inline __m256i additiveBlendAVX2(__m256i src, __m256i dst) {
+	const __m256i zero = _mm256_setzero_si256();
+
+	const __m256i srcLo = _mm256_unpacklo_epi8(src, zero);
+	const __m256i srcHi = _mm256_unpackhi_epi8(src, zero);
+	const __m256i addLo = _mm256_srli_epi16(_mm256_mullo_epi16(srcLo, broadcastAlphaAVX2(srcLo)), 8);
+	const __m256i addHi = _mm256_srli_epi16(_mm256_mullo_epi16(srcHi, broadcastAlphaAVX2(srcHi)), 8);
+
+	// The destination alpha is kept
+	const __m256i add = _mm256_and_si256(_mm256_packus_epi16(addLo, addHi), _mm256_set1_epi32(0xFFFFFF00));
+	return _mm256_adds_epu8(dst, add);
+}
+
+template<bool flipped>
+void alphaBlendRowAVX2(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -32 : 32;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+		_mm256_storeu_si256((__m256i *)out, alphaBlendAVX2(loadPixelsAVX2<flipped>(in), dst));
+		in += inStep;
+		out += 32;
+	}
+	blitRow<BlitAlphaBlend<false>, flipped>(out, in, width - j, mod);
+}
+
+template<bool flipped>
+void alphaBlendColorModRowAVX2(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const __m256i modAlpha = _mm256_set1_epi16(mod.a);
+	const __m256i modColor = _mm256_set1_epi64x(((int64)mod.r << 48) | ((int64)mod.g << 32) | ((int64)mod.b << 16));
+	const int inStep = flipped ? -32 : 32;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+		_mm256_storeu_si256((__m256i *)out, alphaBlendColorModAVX2(loadPixelsAVX2<flipped>(in), dst, modAlpha, modColor));
+		in += inStep;
+		out += 32;
+	}
+	blitRow<BlitAlphaBlend<true>, flipped>(out, in, width - j, mod);
+}
+
+template<bool flipped>
+void additiveBlendRowAVX2(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -32 : 32;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const __m256i dst = _mm256_loadu_si256((const __m256i *)out);
+		_mm256_storeu_si256((__m256i *)out, additiveBlendAVX2(loadPixelsAVX2<flipped>(in), dst));
+		in += inStep;
+		out += 32;
+	}
+	blitRow<BlitAdditiveBlend<false>, flipped>(out, in, width - j, mod);
+}
+
+} // End of anonymous namespace
+
+void blitAlphaBlendRowAVX2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		alphaBlendRowAVX2<true>(out, in, width, mod);
+	else
+		alphaBlendRowAVX2<false>(out, in, width, mod);
+}
+
+void blitAlphaBlendColorModRowAVX2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		alphaBlendColorModRowAVX2<true>(out, in, width, mod);
+	else
+		alphaBlendColorModRowAVX2<false>(out, in, width, mod);
+}
+
+void blitAdditiveBlendRowAVX2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		additiveBlendRowAVX2<true>(out, in, width, mod);
+	else
+		additiveBlendRowAVX2<false>(out, in, width, mod);
+}
+
+} // End of namespace Graphics
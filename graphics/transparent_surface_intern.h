@@ -0,0 +1,224 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_TRANSPARENTSURFACE_INTERN_H
+#define GRAPHICS_TRANSPARENTSURFACE_INTERN_H
+
+#include "common/scummsys.h"
+#include "common/util.h"
+
+namespace Graphics {
+
+#ifdef SCUMM_LITTLE_ENDIAN
+static const int kAIndex = 0;
+static const int kBIndex = 1;
+static const int kGIndex = 2;
+static const int kRIndex = 3;
+
+#else
+static const int kAIndex = 3;
+static const int kBIndex = 2;
+static const int kGIndex = 1;
+static const int kRIndex = 0;
+#endif
+
+/**
+ * The components of the color modulation of a blit.
+ */
+struct BlitColorMod {
+	BlitColorMod(uint32 color) : a(color >> 24), r(color >> 16), g(color >> 8), b(color) {}
+
+	byte a, r, g, b;
+};
+
+/**
+ * The pixel operations of the blits, one per blend mode and alpha type.
+ * The colorMod parameter selects the variant applying the color
+ * modulation, which otherwise is assumed to be 0xFFFFFFFF.
+ */
+struct BlitOpaque {
+	static inline void blendPixel(byte *out, const byte *in, const BlitColorMod &mod) {
+		*(uint32 *)out = *(const uint32 *)in;
+		out[kAIndex] = 0xFF;
+	}
+};
+
+struct BlitBinary {
+	static inline void blendPixel(byte *out, const byte *in, const BlitColorMod &mod) {
+		// Any value not exactly 0 is opaque here
+		if (in[kAIndex] != 0) {
+			*(uint32 *)out = *(const uint32 *)in;
+			out[kAIndex] = 0xFF;
+		}
+	}
+};
+
+template<bool colorMod>
+struct BlitAlphaBlend {
+	static inline void blendPixel(byte *out, const byte *in, const BlitColorMod &mod) {
+		if (!colorMod) {
+			if (in[kAIndex] != 0) {
+				out[kAIndex] = 255;
+				out[kRIndex] = ((in[kRIndex] * in[kAIndex]) + out[kRIndex] * (255 - in[kAIndex])) >> 8;
+				out[kGIndex] = ((in[kGIndex] * in[kAIndex]) + out[kGIndex] * (255 - in[kAIndex])) >> 8;
+				out[kBIndex] = ((in[kBIndex] * in[kAIndex]) + out[kBIndex] * (255 - in[kAIndex])) >> 8;
+			}
+		} else {
+			uint32 ina = in[kAIndex] * mod.a >> 8;
+			out[kAIndex] = 255;
+			out[kBIndex] = (out[kBIndex] * (255 - ina) >> 8);
+			out[kGIndex] = (out[kGIndex] * (255 - ina) >> 8);
+			out[kRIndex] = (out[kRIndex] * (255 - ina) >> 8);
+
+			out[kBIndex] = out[kBIndex] + (in[kBIndex] * ina * mod.b >> 16);
+			out[kGIndex] = out[kGIndex] + (in[kGIndex] * ina * mod.g >> 16);
+			out[kRIndex] = out[kRIndex] + (in[kRIndex] * ina * mod.r >> 16);
+		}
+	}
+};
+
+template<bool colorMod>
+struct BlitAdditiveBlend {
+	static inline byte blendChannel(byte out, byte in, uint32 ina, byte mod) {
+		if (mod != 255)
+			return MIN<uint>(out + ((in * mod * ina) >> 16), 255u);
+		else
+			return MIN<uint>(out + (in * ina >> 8), 255u);
+	}
+
+	static inline void blendPixel(byte *out, const byte *in, const BlitColorMod &mod) {
+		if (!colorMod) {
+			if (in[kAIndex] != 0) {
+				out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) + out[kRIndex], 255);
+				out[kGIndex] = MIN((in[kGIndex] * in[kAIndex] >> 8) + out[kGIndex], 255);
+				out[kBIndex] = MIN((in[kBIndex] * in[kAIndex] >> 8) + out[kBIndex], 255);
+			}
+		} else {
+			uint32 ina = in[kAIndex] * mod.a >> 8;
+			out[kBIndex] = blendChannel(out[kBIndex], in[kBIndex], ina, mod.b);
+			out[kGIndex] = blendChannel(out[kGIndex], in[kGIndex], ina, mod.g);
+			out[kRIndex] = blendChannel(out[kRIndex], in[kRIndex], ina, mod.r);
+		}
+	}
+};
+
+template<bool colorMod>
+struct BlitSubtractiveBlend {
+	static inline byte blendChannel(byte out, byte in, byte a, byte mod) {
+		if (mod != 255)
+			return MAX(out - ((in * mod * out * a) >> 24), 0);
+		else
+			return MAX(out - (in * out * a >> 16), 0);
+	}
+
+	static inline void blendPixel(byte *out, const byte *in, const BlitColorMod &mod) {
+		if (!colorMod) {
+			if (in[kAIndex] != 0) {
+				out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * out[kRIndex]) * in[kAIndex] >> 16), 0);
+				out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * out[kGIndex]) * in[kAIndex] >> 16), 0);
+				out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * out[kBIndex]) * in[kAIndex] >> 16), 0);
+			}
+		} else {
+			out[kAIndex] = 255;
+			out[kBIndex] = blendChannel(out[kBIndex], in[kBIndex], in[kAIndex], mod.b);
+			out[kGIndex] = blendChannel(out[kGIndex], in[kGIndex], in[kAIndex], mod.g);
+			out[kRIndex] = blendChannel(out[kRIndex], in[kRIndex], in[kAIndex], mod.r);
+		}
+	}
+};
+
+template<bool colorMod>
+struct BlitMultiplyBlend {
+	static inline byte blendChannel(byte out, byte in, uint32 ina, byte mod) {
+		if (mod != 255)
+			return MIN<uint>(out * ((in * mod * ina) >> 16) >> 8, 255u);
+		else
+			return MIN<uint>(out * (in * ina >> 8) >> 8, 255u);
+	}
+
+	static inline void blendPixel(byte *out, const byte *in, const BlitColorMod &mod) {
+		if (!colorMod) {
+			if (in[kAIndex] != 0) {
+				out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) * out[kRIndex] >> 8, 255);
+				out[kGIndex] = MIN((in[kGIndex] * in[kAIndex] >> 8) * out[kGIndex] >> 8, 255);
+				out[kBIndex] = MIN((in[kBIndex] * in[kAIndex] >> 8) * out[kBIndex] >> 8, 255);
+			}
+		} else {
+			uint32 ina = in[kAIndex] * mod.a >> 8;
+			out[kBIndex] = blendChannel(out[kBIndex], in[kBIndex], ina, mod.b);
+			out[kGIndex] = blendChannel(out[kGIndex], in[kGIndex], ina, mod.g);
+			out[kRIndex] = blendChannel(out[kRIndex], in[kRIndex], ina, mod.r);
+		}
+	}
+};
+
+/**
+ * Blend a row of pixels with one of the pixel operations. The source
+ * pixels are read from right to left when flipped.
+ */
+template<class Blender, bool flipped>
+inline void blitRow(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -4 : 4;
+	for (uint32 j = 0; j < width; j++) {
+		Blender::blendPixel(out, in, mod);
+		in += inStep;
+		out += 4;
+	}
+}
+
+/**
+ * Blend a row of width pixels. When flipped, in points to the rightmost
+ * source pixel.
+ */
+typedef void (*BlitRowProc)(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+
+/**
+ * The SIMD row kernels, the blend modes without one use the generic code.
+ */
+struct BlitRowProcs {
+	BlitRowProc alphaBlend;
+	BlitRowProc alphaBlendColorMod;
+	BlitRowProc additiveBlend;
+};
+
+#ifdef SCUMMVM_SSE2
+void blitAlphaBlendRowSSE2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+void blitAlphaBlendColorModRowSSE2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+void blitAdditiveBlendRowSSE2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+#endif
+
+#ifdef SCUMMVM_AVX2
+void blitAlphaBlendRowAVX2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+void blitAlphaBlendColorModRowAVX2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+void blitAdditiveBlendRowAVX2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+#endif
+
+#ifdef SCUMMVM_NEON
+void blitAlphaBlendRowNEON(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+void blitAlphaBlendColorModRowNEON(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+void blitAdditiveBlendRowNEON(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod);
+#endif
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,164 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/transparent_surface_intern.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * Load eight source pixels, in the order they are blitted, with each
+ * channel in its own vector.
+ */
+template<bool flipped>
+inline uint8x8x4_t loadPixelsNEON(const byte *in) {
+	if (!flipped)
+		return vld4_u8(in);
+
+	uint8x8x4_t pixels = vld4_u8(in - 28);
+	for (int c = 0; c < 4; ++c)
+		pixels.val[c] = vrev64_u8(pixels.val[c]);
+	return pixels;
+}
+
+/**
+ * Compute (x * y) >> 8 for eight pairs of bytes.
+ */
+inline uint8x8_t mulShiftNEON(uint8x8_t x, uint8x8_t y) {
+	return vshrn_n_u16(vmull_u8(x, y), 8);
+}
+
+inline void alphaBlendNEON(const uint8x8x4_t &src, uint8x8x4_t &dst) {
+	const uint8x8_t a = src.val[kAIndex];
+	const uint8x8_t invA = vmvn_u8(a);
+	// Fully transparent pixels leave the destination untouched
+	const uint8x8_t transparent = vceq_u8(a, vdup_n_u8(0));
+
+	for (int c = 0; c < 4; ++c) {
+		if (c == kAIndex)
+			continue;
+		const uint8x8_t out = vshrn_n_u16(vmlal_u8(vmull_u8(src.val[c], a), dst.val[c], invA), 8);
+		dst.val[c] = vbsl_u8(transparent, dst.val[c], out);
+	}
+	dst.val[kAIndex] = vbsl_u8(transparent, dst.val[kAIndex], vdup_n_u8(255));
+}
+
+inline void alphaBlendColorModNEON(const uint8x8x4_t &src, uint8x8x4_t &dst, const BlitColorMod &mod) {
+	const uint8x8_t a = mulShiftNEON(src.val[kAIndex], vdup_n_u8(mod.a));
+	const uint8x8_t invA = vmvn_u8(a);
+	const byte modColor[4] = {
+		kAIndex == 0 ? (byte)0 : kBIndex == 0 ? mod.b : kGIndex == 0 ? mod.g : mod.r,
+		kAIndex == 1 ? (byte)0 : kBIndex == 1 ? mod.b : kGIndex == 1 ? mod.g : mod.r,
+		kAIndex == 2 ? (byte)0 : kBIndex == 2 ? mod.b : kGIndex == 2 ? mod.g : mod.r,
+		kAIndex == 3 ? (byte)0 : kBIndex == 3 ? mod.b : kGIndex == 3 ? mod.g : mod.r
+	};
+
+	for (int c = 0; c < 4; ++c) {
+		if (c == kAIndex)
+			continue;
+		// (in * a * mod) >> 16, with the first product in 16 bits
+		const uint16x8_t product = vmull_u8(src.val[c], a);
+		const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(product), vdup_n_u16(modColor[c])), 16);
+		const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(product), vdup_n_u16(modColor[c])), 16);
+		dst.val[c] = vadd_u8(mulShiftNEON(dst.val[c], invA), vmovn_u16(vcombine_u16(lo, hi)));
+	}
+	dst.val[kAIndex] = vdup_n_u8(255);
+}
+
+inline void additiveBlendNEON(const uint8x8x4_t &src, uint8x8x4_t &dst) {
+	// The destination alpha is kept
+	for (int c = 0; c < 4; ++c) {
+		if (c != kAIndex)
+			dst.val[c] = vqadd_u8(dst.val[c], mulShiftNEON(src.val[c], src.val[kAIndex]));
+	}
+}
+
+template<bool flipped>
+void alphaBlendRowNEON(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -32 : 32;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		uint8x8x4_t dst = vld4_u8(out);
+		alphaBlendNEON(loadPixelsNEON<flipped>(in), dst);
+		vst4_u8(out, dst);
+		in += inStep;
+		out += 32;
+	}
+	blitRow<BlitAlphaBlend<false>, flipped>(out, in, width - j, mod);
+}
+
+template<bool flipped>
+void alphaBlendColorModRowNEON(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -32 : 32;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		uint8x8x4_t dst = vld4_u8(out);
+		alphaBlendColorModNEON(loadPixelsNEON<flipped>(in), dst, mod);
+		vst4_u8(out, dst);
+		in += inStep;
+		out += 32;
+	}
+	blitRow<BlitAlphaBlend<true>, flipped>(out, in, width - j, mod);
+}
+
+template<bool flipped>
+void additiveBlendRowNEON(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -32 : 32;
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		uint8x8x4_t dst = vld4_u8(out);
+		additiveBlendNEON(loadPixelsNEON<flipped>(in), dst);
+		vst4_u8(out, dst);
+		in += inStep;
+		out += 32;
+	}
+	blitRow<BlitAdditiveBlend<false>, flipped>(out, in, width - j, mod);
+}
+
+} // End of anonymous namespace
+
+void blitAlphaBlendRowNEON(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		alphaBlendRowNEON<true>(out, in, width, mod);
+	else
+		alphaBlendRowNEON<false>(out, in, width, mod);
+}
+
+void blitAlphaBlendColorModRowNEON(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		alphaBlendColorModRowNEON<true>(out, in, width, mod);
+	else
+		alphaBlendColorModRowNEON<false>(out, in, width, mod);
+}
+
+void blitAdditiveBlendRowNEON(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		additiveBlendRowNEON<true>(out, in, width, mod);
+	else
+		additiveBlendRowNEON<false>(out, in, width, mod);
+}
+
+} // End of namespace Graphics
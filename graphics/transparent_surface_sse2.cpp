@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/transparent_surface_intern.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * Load four source pixels, in the order they are blitted.
+ */
+template<bool flipped>
+inline __m128i loadPixelsSSE2(const byte *in) {
+	if (flipped)
+		return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+	else
+		return _mm_loadu_si128((const __m128i *)in);
+}
+
+/**
+ * Copy the alpha of each of the two pixels in 16 bit lanes to the lanes
+ * of its other channels.
+ */
+inline __m128i broadcastAlphaSSE2(__m128i pixels) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+inline __m128i alphaBlendSSE2(__m128i src, __m128i dst) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(255);
+
+	const __m128i srcLo = _mm_unpacklo_epi8(src, zero);
+	const __m128i srcHi = _mm_unpackhi_epi8(src, zero);
+	const __m128i aLo = broadcastAlphaSSE2(srcLo);
+	const __m128i aHi = broadcastAlphaSSE2(srcHi);
+
+	const __m128i outLo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(srcLo, aLo), _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, aLo))), 8);
+	const __m128i outHi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(srcHi, aHi), _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, aHi))), 8);
+	const __m128i out = _mm_or_si128(_mm_and_si128(_mm_packus_epi16(outLo, outHi), _mm_set1_epi32(0xFFFFFF00)), _mm_set1_epi32(0xFF));
+
+	// Fully transparent pixels leave the destination untouched
+	const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(src, _mm_set1_epi32(0xFF)), zero);
+	return _mm_or_si128(_mm_and_si128(transparent, dst), _mm_andnot_si128(transparent, out));
+}
+
+inline __m128i alphaBlendColorModSSE2(__m128i src, __m128i dst, __m128i modAlpha, __m128i modColor) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(255);
+
+	const __m128i srcLo = _mm_unpacklo_epi8(src, zero);
+	const __m128i srcHi = _mm_unpackhi_epi8(src, zero);
+	const __m128i aLo = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(srcLo), modAlpha), 8);
+	const __m128i aHi = _mm_srli_epi16(_mm_mullo_epi16(broadcastAlphaSSE2(srcHi), modAlpha), 8);
+
+	__m128i outLo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, aLo)), 8);
+	__m128i outHi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, aHi)), 8);
+	outLo = _mm_add_epi16(outLo, _mm_mulhi_epu16(_mm_mullo_epi16(srcLo, aLo), modColor));
+	outHi = _mm_add_epi16(outHi, _mm_mulhi_epu16(_mm_mullo_epi16(srcHi, aHi), modColor));
+	return _mm_or_si128(_mm_and_si128(_mm_packus_epi16(outLo, outHi), _mm_set1_epi32(0xFFFFFF00)), _mm_set1_epi32(0xFF));
+}
+
+inline __m128i additiveBlendSSE2(__m128i src, __m128i dst) {
+	const __m128i zero = _mm_setzero_si128();
+
+	const __m128i srcLo = _mm_unpacklo_epi8(src, zero);
+	const __m128i srcHi = _mm_unpackhi_epi8(src, zero);
+	const __m128i addLo = _mm_srli_epi16(_mm_mullo_epi16(srcLo, broadcastAlphaSSE2(srcLo)), 8);
+	const __m128i addHi = _mm_srli_epi16(_mm_mullo_epi16(srcHi, broadcastAlphaSSE2(srcHi)), 8);
+
+	// The destination alpha is kept
+	const __m128i add = _mm_and_si128(_mm_packus_epi16(addLo, addHi), _mm_set1_epi32(0xFFFFFF00));
+	return _mm_adds_epu8(dst, add);
+}
+
+template<bool flipped>
+void alphaBlendRowSSE2(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -16 : 16;
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+		_mm_storeu_si128((__m128i *)out, alphaBlendSSE2(loadPixelsSSE2<flipped>(in), dst));
+		in += inStep;
+		out += 16;
+	}
+	blitRow<BlitAlphaBlend<false>, flipped>(out, in, width - j, mod);
+}
+
+template<bool flipped>
+void alphaBlendColorModRowSSE2(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const __m128i modAlpha = _mm_set1_epi16(mod.a);
+	const __m128i modColor = _mm_set_epi16(mod.r, mod.g, mod.b, 0, mod.r, mod.g, mod.b, 0);
+	const int inStep = flipped ? -16 : 16;
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+		_mm_storeu_si128((__m128i *)out, alphaBlendColorModSSE2(loadPixelsSSE2<flipped>(in), dst, modAlpha, modColor));
+		in += inStep;
+		out += 16;
+	}
+	blitRow<BlitAlphaBlend<true>, flipped>(out, in, width - j, mod);
+}
+
+template<bool flipped>
+void additiveBlendRowSSE2(byte *out, const byte *in, uint32 width, const BlitColorMod &mod) {
+	const int inStep = flipped ? -16 : 16;
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		const __m128i dst = _mm_loadu_si128((const __m128i *)out);
+		_mm_storeu_si128((__m128i *)out, additiveBlendSSE2(loadPixelsSSE2<flipped>(in), dst));
+		in += inStep;
+		out += 16;
+	}
+	blitRow<BlitAdditiveBlend<false>, flipped>(out, in, width - j, mod);
+}
+
+} // End of anonymous namespace
+
+void blitAlphaBlendRowSSE2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		alphaBlendRowSSE2<true>(out, in, width, mod);
+	else
+		alphaBlendRowSSE2<false>(out, in, width, mod);
+}
+
+void blitAlphaBlendColorModRowSSE2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		alphaBlendColorModRowSSE2<true>(out, in, width, mod);
+	else
+		alphaBlendColorModRowSSE2<false>(out, in, width, mod);
+}
+
+void blitAdditiveBlendRowSSE2(byte *out, const byte *in, uint32 width, bool flipped, const BlitColorMod &mod) {
+	if (flipped)
+		additiveBlendRowSSE2<true>(out, in, width, mod);
+	else
+		additiveBlendRowSSE2<false>(out, in, width, mod);
+}
+
+} // End of namespace Graphics
@@ -85,6 +85,9 @@
 
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include "common/system.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -192,6 +195,133 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+YUVToRGBParams makeYUVToRGBParams(const PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+	YUVToRGBParams params;
+	params.scaleITU = (scale == YUVToRGBManager::kScaleITU);
+	params.loss[0] = format.rLoss;
+	params.loss[1] = format.gLoss;
+	params.loss[2] = format.bLoss;
+	params.shift[0] = format.rShift;
+	params.shift[1] = format.gShift;
+	params.shift[2] = format.bShift;
+	params.fill = format.ARGBToColor(0xFF, 0, 0, 0);
+	return params;
+}
+
+/**
+ * Convert a row of any width with a row kernel. The pixels beyond the last
+ * full block are converted through a scratch buffer.
+ */
+static void convertYUVToRGBRow(YUVToRGBRowProc proc, byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+                               int width, int chromaShift, uint bytesPerPixel, const YUVToRGBParams &params) {
+	const uint full = width & ~(kYUVToRGBBlockSize - 1);
+	proc(dst, ySrc, uSrc, vSrc, full, params);
+
+	const uint rest = width - full;
+	if (rest == 0)
+		return;
+
+	byte y[kYUVToRGBBlockSize], u[kYUVToRGBBlockSize], v[kYUVToRGBBlockSize];
+	byte out[kYUVToRGBBlockSize * 4];
+	memset(y, 0, sizeof(y));
+	memset(u, 128, sizeof(u));
+	memset(v, 128, sizeof(v));
+	memcpy(y, ySrc + full, rest);
+	memcpy(u, uSrc + (full >> chromaShift), (rest + (1 << chromaShift) - 1) >> chromaShift);
+	memcpy(v, vSrc + (full >> chromaShift), (rest + (1 << chromaShift) - 1) >> chromaShift);
+
+	proc(out, y, u, v, kYUVToRGBBlockSize, params);
+	memcpy(dst + full * bytesPerPixel, out, rest * bytesPerPixel);
+}
+
+/**
+ * Interpolate the chroma of a YUV410 image for each pixel of a row, like
+ * convertYUV410ToRGB() does.
+ */
+static void upsampleYUV410Row(byte *dst, const byte *src, int y, int yWidth, int uvPitch) {
+	const int yDiff = y & 3;
+	src += (y >> 2) * uvPitch;
+
+	for (int x = 0; x < (yWidth >> 2); x++) {
+		const int left = src[x] * (4 - yDiff) + src[x + uvPitch] * yDiff;
+		const int right = src[x + 1] * (4 - yDiff) + src[x + uvPitch + 1] * yDiff;
+		for (int xDiff = 0; xDiff < 4; xDiff++)
+			*dst++ = (left * (4 - xDiff) + right * xDiff) >> 4;
+	}
+}
+
+void convertYUVToRGBRows(const YUVToRGBRowProcs &procs, Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, int chromaShift,
+                         const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const YUVToRGBParams params = makeYUVToRGBParams(dst->format, scale);
+	const uint bytesPerPixel = dst->format.bytesPerPixel;
+	const bool is16 = (bytesPerPixel == 2);
+
+	if (chromaShift == 2) {
+		// The chroma is interpolated first, then converted as YUV444
+		const YUVToRGBRowProc proc = is16 ? procs.convert444To16 : procs.convert444To32;
+		byte *uRow = new byte[yWidth];
+		byte *vRow = new byte[yWidth];
+
+		for (int y = 0; y < yHeight; y++) {
+			upsampleYUV410Row(uRow, uSrc, y, yWidth, uvPitch);
+			upsampleYUV410Row(vRow, vSrc, y, yWidth, uvPitch);
+			convertYUVToRGBRow(proc, (byte *)dst->getBasePtr(0, y), ySrc + y * yPitch, uRow, vRow, yWidth, 0, bytesPerPixel, params);
+		}
+
+		delete[] uRow;
+		delete[] vRow;
+		return;
+	}
+
+	YUVToRGBRowProc proc;
+	if (chromaShift == 1)
+		proc = is16 ? procs.convert420To16 : procs.convert420To32;
+	else
+		proc = is16 ? procs.convert444To16 : procs.convert444To32;
+
+	for (int y = 0; y < yHeight; y++) {
+		const int uvOffset = (y >> chromaShift) * uvPitch;
+		convertYUVToRGBRow(proc, (byte *)dst->getBasePtr(0, y), ySrc + y * yPitch, uSrc + uvOffset, vSrc + uvOffset,
+		                   yWidth, chromaShift, bytesPerPixel, params);
+	}
+}
+
+/**
+ * Return the row kernels for the host CPU, or 0 if it has none.
+ */
+static const YUVToRGBRowProcs *getYUVToRGBRowProcs() {
+#ifdef SCUMMVM_NEON
+	static const YUVToRGBRowProcs procsNEON = {
+		&convertYUV444To16NEON, &convertYUV444To32NEON, &convertYUV420To16NEON, &convertYUV420To32NEON
+	};
+#endif
+#ifdef SCUMMVM_SSE2
+	static const YUVToRGBRowProcs procsSSE2 = {
+		&convertYUV444To16SSE2, &convertYUV444To32SSE2, &convertYUV420To16SSE2, &convertYUV420To32SSE2
+	};
+#endif
+#ifdef SCUMMVM_AVX2
+	static const YUVToRGBRowProcs procsAVX2 = {
+		&convertYUV444To16AVX2, &convertYUV444To32AVX2, &convertYUV420To16AVX2, &convertYUV420To32AVX2
+	};
+#endif
+
+	const OSystem::CpuExtension cpuExtension = OSystem::getCpuExtension();
+#ifdef SCUMMVM_AVX2
+	if (cpuExtension >= OSystem::kCpuExtensionAVX2)
+		return &procsAVX2;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (cpuExtension >= OSystem::kCpuExtensionSSE2)
+		return &procsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (cpuExtension == OSystem::kCpuExtensionNEON)
+		return &procsNEON;
+#endif
+	return 0;
+}
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -233,6 +363,12 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
 	assert(ySrc && uSrc && vSrc);
 
+	const YUVToRGBRowProcs *procs = getYUVToRGBRowProcs();
+	if (procs) {
+		convertYUVToRGBRows(*procs, dst, scale, 0, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -289,6 +425,12 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 1) == 0);
 	assert((yHeight & 1) == 0);
 
+	const YUVToRGBRowProcs *procs = getYUVToRGBRowProcs();
+	if (procs) {
+		convertYUVToRGBRows(*procs, dst, scale, 1, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
@@ -374,6 +516,12 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yWidth & 3) == 0);
 	assert((yHeight & 3) == 0);
 
+	const YUVToRGBRowProcs *procs = getYUVToRGBRowProcs();
+	if (procs) {
+		convertYUVToRGBRows(*procs, dst, scale, 2, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
 	// Use a templated function to avoid an if check on every pixel
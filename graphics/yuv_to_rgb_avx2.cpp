@@ -0,0 +1,145 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * The parameters of the conversion, loaded into registers once per row.
+ */
+struct YUVToRGBStateAVX2 {
+	YUVToRGBStateAVX2(const YUVToRGBParams &params) : scaleITU(params.scaleITU != 0) {
+		minValue = _mm256_set1_epi16(scaleITU ? 16 : 0);
+		maxValue = _mm256_set1_epi16(scaleITU ? 235 : 255);
+		for (int c = 0; c < 3; ++c) {
+			loss[c] = _mm_cvtsi32_si128(params.loss[c]);
+			shift[c] = _mm_cvtsi32_si128(params.shift[c]);
+		}
+		fill16 = _mm256_set1_epi16((int16)params.fill);
+		fill32 = _mm256_set1_epi32(params.fill);
+	}
+
+	bool scaleITU;
+	__m256i minValue, maxValue;
+	__m128i loss[3], shift[3];
+	__m256i fill16, fill32;
+};
+
+/**
+ * Multiply sixteen absolute chroma values by a factor, and give the
+ * products the signs of the chroma values.
+ */
+template<int shift, int factor>
+inline __m256i mulChromaAVX2(__m256i absChroma, __m256i sign) {
+	const __m256i product = _mm256_mulhi_epu16(_mm256_slli_epi16(absChroma, shift), _mm256_set1_epi16(factor));
+	return _mm256_sub_epi16(_mm256_xor_si256(product, sign), sign);
+}
+
+inline __m256i clampAVX2(__m256i value, const YUVToRGBStateAVX2 &state) {
+	value = _mm256_max_epi16(_mm256_min_epi16(value, state.maxValue), state.minValue);
+	if (state.scaleITU)
+		value = _mm256_mulhi_epu16(_mm256_slli_epi16(_mm256_sub_epi16(value, state.minValue), kYUVITUShift), _mm256_set1_epi16(kYUVITUFactor));
+	return value;
+}
+
+inline __m256i packChannelsAVX2(__m128i r, __m128i g, __m128i b, const YUVToRGBStateAVX2 &state) {
+	__m256i out = _mm256_or_si256(state.fill32, _mm256_sll_epi32(_mm256_cvtepu16_epi32(r), state.shift[0]));
+	out = _mm256_or_si256(out, _mm256_sll_epi32(_mm256_cvtepu16_epi32(g), state.shift[1]));
+	return _mm256_or_si256(out, _mm256_sll_epi32(_mm256_cvtepu16_epi32(b), state.shift[2]));
+}
+
+inline void storeBlockAVX2(uint16 *dst, __m256i r, __m256i g, __m256i b, const YUVToRGBStateAVX2 &state) {
+	__m256i out = _mm256_or_si256(state.fill16, _mm256_sll_epi16(r, state.shift[0]));
+	out = _mm256_or_si256(out, _mm256_sll_epi16(g, state.shift[1]));
+	out = _mm256_or_si256(out, _mm256_sll_epi16(b, state.shift[2]));
+	_mm256_storeu_si256((__m256i *)dst, out);
+}
+
+inline void storeBlockAVX2(uint32 *dst, __m256i r, __m256i g, __m256i b, const YUVToRGBStateAVX2 &state) {
+	const __m256i lo = packChannelsAVX2(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g), _mm256_castsi256_si128(b), state);
+	const __m256i hi = packChannelsAVX2(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1), _mm256_extracti128_si256(b, 1), state);
+	_mm256_storeu_si256((__m256i *)dst, lo);
+	_mm256_storeu_si256((__m256i *)(dst + 8), hi);
+}
+
+template<bool halfChroma, typename PixelInt>
+void convertRowAVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	const YUVToRGBStateAVX2 state(params);
+	PixelInt *out = (PixelInt *)dst;
+
+	for (uint i = 0; i < count; i += kYUVToRGBBlockSize) {
+		__m128i u8, v8;
+		if (halfChroma) {
+			// Each chroma value is used for two neighboring pixels
+			u8 = _mm_loadl_epi64((const __m128i *)(uSrc + i / 2));
+			v8 = _mm_loadl_epi64((const __m128i *)(vSrc + i / 2));
+			u8 = _mm_unpacklo_epi8(u8, u8);
+			v8 = _mm_unpacklo_epi8(v8, v8);
+		} else {
+			u8 = _mm_loadu_si128((const __m128i *)(uSrc + i));
+			v8 = _mm_loadu_si128((const __m128i *)(vSrc + i));
+		}
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(ySrc + i)));
+		const __m256i cr = _mm256_sub_epi16(_mm256_cvtepu8_epi16(v8), _mm256_set1_epi16(128));
+		const __m256i cb = _mm256_sub_epi16(_mm256_cvtepu8_epi16(u8), _mm256_set1_epi16(128));
+		const __m256i crSign = _mm256_srai_epi16(cr, 15);
+		const __m256i cbSign = _mm256_srai_epi16(cb, 15);
+		const __m256i crAbs = _mm256_abs_epi16(cr);
+		const __m256i cbAbs = _mm256_abs_epi16(cb);
+
+		__m256i r = _mm256_add_epi16(y, mulChromaAVX2<kYUVCrRShift, kYUVCrRFactor>(crAbs, crSign));
+		__m256i g = _mm256_sub_epi16(y, mulChromaAVX2<kYUVCrGShift, kYUVCrGFactor>(crAbs, crSign));
+		g = _mm256_sub_epi16(g, mulChromaAVX2<kYUVCbGShift, kYUVCbGFactor>(cbAbs, cbSign));
+		__m256i b = _mm256_add_epi16(y, mulChromaAVX2<kYUVCbBShift, kYUVCbBFactor>(cbAbs, cbSign));
+
+		r = _mm256_srl_epi16(clampAVX2(r, state), state.loss[0]);
+		g = _mm256_srl_epi16(clampAVX2(g, state), state.loss[1]);
+		b = _mm256_srl_epi16(clampAVX2(b, state), state.loss[2]);
+		storeBlockAVX2(out + i, r, g, b, state);
+	}
+}
+
+} // End of anonymous namespace
+
+void convertYUV444To16AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowAVX2<false, uint16>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV444To32AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowAVX2<false, uint32>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV420To16AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowAVX2<true, uint16>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV420To32AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowAVX2<true, uint32>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+} // End of namespace Graphics
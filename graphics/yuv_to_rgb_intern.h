@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef GRAPHICS_YUV_TO_RGB_INTERN_H
+#define GRAPHICS_YUV_TO_RGB_INTERN_H
+
+#include "common/scummsys.h"
+#include "graphics/yuv_to_rgb.h"
+
+namespace Graphics {
+
+/**
+ * Fixed point versions of the chroma factors of the lookup tables.
+ *
+ * The tables hold the products of the factors with the chroma, truncated
+ * towards zero. The same value is obtained from the absolute chroma value
+ * shifted left by the given amount, multiplied by the factor and divided
+ * by 65536. The constants are exact for every chroma value.
+ */
+enum {
+	kYUVCrRShift = 7,
+	kYUVCrRFactor = 717,
+	kYUVCrGShift = 6,
+	kYUVCrGFactor = 731,
+	kYUVCbGShift = 3,
+	kYUVCbGFactor = 2821,
+	kYUVCbBShift = 2,
+	kYUVCbBFactor = 29055,
+
+	/** Scales luminance values from [0, 219] to [0, 255] like (x * 255 / 219). */
+	kYUVITUShift = 3,
+	kYUVITUFactor = 9539
+};
+
+/**
+ * The number of pixels the row kernels convert at once.
+ */
+enum {
+	kYUVToRGBBlockSize = 16
+};
+
+/**
+ * Describes the destination format and the luminance scale for the row
+ * kernels.
+ */
+struct YUVToRGBParams {
+	/** Non-zero when the luminance values range from [16, 235]. */
+	uint32 scaleITU;
+	/** Bits dropped from the 8 bit red, green and blue values. */
+	uint32 loss[3];
+	/** Bit offsets of red, green and blue in the destination color. */
+	uint32 shift[3];
+	/** Bits set in every destination color, the opaque alpha. */
+	uint32 fill;
+};
+
+YUVToRGBParams makeYUVToRGBParams(const PixelFormat &format, YUVToRGBManager::LuminanceScale scale);
+
+/**
+ * Convert count pixels of one row, count being a multiple of
+ * kYUVToRGBBlockSize.
+ *
+ * The 444 kernels read count chroma values, the 420 kernels read count / 2
+ * chroma values, each one used for two pixels.
+ */
+typedef void (*YUVToRGBRowProc)(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+
+struct YUVToRGBRowProcs {
+	YUVToRGBRowProc convert444To16;
+	YUVToRGBRowProc convert444To32;
+	YUVToRGBRowProc convert420To16;
+	YUVToRGBRowProc convert420To32;
+};
+
+/**
+ * Convert a whole image with the row kernels. The result is identical to
+ * the one of the lookup tables of YUVToRGBManager.
+ *
+ * @param chromaShift	1 for YUV420 images, 2 for YUV410 images and 0 otherwise
+ */
+void convertYUVToRGBRows(const YUVToRGBRowProcs &procs, Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, int chromaShift,
+                         const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+#ifdef SCUMMVM_SSE2
+void convertYUV444To16SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV444To32SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV420To16SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV420To32SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+#endif
+
+#ifdef SCUMMVM_AVX2
+void convertYUV444To16AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV444To32AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV420To16AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV420To32AVX2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+#endif
+
+#ifdef SCUMMVM_NEON
+void convertYUV444To16NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV444To32NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV420To16NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+void convertYUV420To32NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params);
+#endif
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,178 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * The parameters of the conversion, loaded into registers once per row.
+ * Negative shifts shift right.
+ */
+struct YUVToRGBStateNEON {
+	YUVToRGBStateNEON(const YUVToRGBParams &params) : scaleITU(params.scaleITU != 0) {
+		minValue = vdupq_n_s16(scaleITU ? 16 : 0);
+		maxValue = vdupq_n_s16(scaleITU ? 235 : 255);
+		for (int c = 0; c < 3; ++c) {
+			loss[c] = vdupq_n_s16(-(int16)params.loss[c]);
+			shift16[c] = vdupq_n_s16(params.shift[c]);
+			shift32[c] = vdupq_n_s32(params.shift[c]);
+		}
+		fill16 = vdupq_n_u16(params.fill);
+		fill32 = vdupq_n_u32(params.fill);
+	}
+
+	bool scaleITU;
+	int16x8_t minValue, maxValue;
+	int16x8_t loss[3], shift16[3];
+	int32x4_t shift32[3];
+	uint16x8_t fill16;
+	uint32x4_t fill32;
+};
+
+/**
+ * Multiply unsigned values by a factor, and divide them by 65536.
+ */
+template<int shift, int factor>
+inline uint16x8_t mulHighNEON(uint16x8_t value) {
+	value = vshlq_n_u16(value, shift);
+	const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(value), vdup_n_u16(factor)), 16);
+	const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(value), vdup_n_u16(factor)), 16);
+	return vcombine_u16(lo, hi);
+}
+
+/**
+ * Multiply eight chroma values by a factor, truncating the products
+ * towards zero.
+ */
+template<int shift, int factor>
+inline int16x8_t mulChromaNEON(uint16x8_t absChroma, uint16x8_t negative) {
+	const int16x8_t product = vreinterpretq_s16_u16(mulHighNEON<shift, factor>(absChroma));
+	return vbslq_s16(negative, vnegq_s16(product), product);
+}
+
+inline uint16x8_t clampNEON(int16x8_t value, const YUVToRGBStateNEON &state, int16x8_t loss) {
+	value = vmaxq_s16(vminq_s16(value, state.maxValue), state.minValue);
+	uint16x8_t result = vreinterpretq_u16_s16(value);
+	if (state.scaleITU)
+		result = mulHighNEON<kYUVITUShift, kYUVITUFactor>(vreinterpretq_u16_s16(vsubq_s16(value, state.minValue)));
+	return vshlq_u16(result, loss);
+}
+
+/**
+ * Compute the red, green and blue values of eight pixels, in 16 bit lanes.
+ */
+inline void convertBlockNEON(uint8x8_t y, uint8x8_t u, uint8x8_t v, const YUVToRGBStateNEON &state, uint16x8_t &r, uint16x8_t &g, uint16x8_t &b) {
+	const int16x8_t luma = vreinterpretq_s16_u16(vmovl_u8(y));
+	const int16x8_t cr = vreinterpretq_s16_u16(vsubl_u8(v, vdup_n_u8(128)));
+	const int16x8_t cb = vreinterpretq_s16_u16(vsubl_u8(u, vdup_n_u8(128)));
+	const uint16x8_t crNegative = vcltq_s16(cr, vdupq_n_s16(0));
+	const uint16x8_t cbNegative = vcltq_s16(cb, vdupq_n_s16(0));
+	const uint16x8_t crAbs = vreinterpretq_u16_s16(vabsq_s16(cr));
+	const uint16x8_t cbAbs = vreinterpretq_u16_s16(vabsq_s16(cb));
+
+	const int16x8_t red = vaddq_s16(luma, mulChromaNEON<kYUVCrRShift, kYUVCrRFactor>(crAbs, crNegative));
+	int16x8_t green = vsubq_s16(luma, mulChromaNEON<kYUVCrGShift, kYUVCrGFactor>(crAbs, crNegative));
+	green = vsubq_s16(green, mulChromaNEON<kYUVCbGShift, kYUVCbGFactor>(cbAbs, cbNegative));
+	const int16x8_t blue = vaddq_s16(luma, mulChromaNEON<kYUVCbBShift, kYUVCbBFactor>(cbAbs, cbNegative));
+
+	r = clampNEON(red, state, state.loss[0]);
+	g = clampNEON(green, state, state.loss[1]);
+	b = clampNEON(blue, state, state.loss[2]);
+}
+
+inline void storeBlockNEON(uint16 *dst, uint16x8_t r, uint16x8_t g, uint16x8_t b, const YUVToRGBStateNEON &state) {
+	uint16x8_t out = vorrq_u16(state.fill16, vshlq_u16(r, state.shift16[0]));
+	out = vorrq_u16(out, vshlq_u16(g, state.shift16[1]));
+	out = vorrq_u16(out, vshlq_u16(b, state.shift16[2]));
+	vst1q_u16(dst, out);
+}
+
+inline void storeBlockNEON(uint32 *dst, uint16x8_t r, uint16x8_t g, uint16x8_t b, const YUVToRGBStateNEON &state) {
+	uint32x4_t lo = vorrq_u32(state.fill32, vshlq_u32(vmovl_u16(vget_low_u16(r)), state.shift32[0]));
+	lo = vorrq_u32(lo, vshlq_u32(vmovl_u16(vget_low_u16(g)), state.shift32[1]));
+	lo = vorrq_u32(lo, vshlq_u32(vmovl_u16(vget_low_u16(b)), state.shift32[2]));
+	uint32x4_t hi = vorrq_u32(state.fill32, vshlq_u32(vmovl_u16(vget_high_u16(r)), state.shift32[0]));
+	hi = vorrq_u32(hi, vshlq_u32(vmovl_u16(vget_high_u16(g)), state.shift32[1]));
+	hi = vorrq_u32(hi, vshlq_u32(vmovl_u16(vget_high_u16(b)), state.shift32[2]));
+
+	vst1q_u32(dst, lo);
+	vst1q_u32(dst + 4, hi);
+}
+
+template<bool halfChroma, typename PixelInt>
+void convertRowNEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	const YUVToRGBStateNEON state(params);
+	PixelInt *out = (PixelInt *)dst;
+
+	for (uint i = 0; i < count; i += kYUVToRGBBlockSize) {
+		uint8x8_t uLo, uHi, vLo, vHi;
+		if (halfChroma) {
+			// Each chroma value is used for two neighboring pixels
+			const uint8x8x2_t u = vzip_u8(vld1_u8(uSrc + i / 2), vld1_u8(uSrc + i / 2));
+			const uint8x8x2_t v = vzip_u8(vld1_u8(vSrc + i / 2), vld1_u8(vSrc + i / 2));
+			uLo = u.val[0];
+			uHi = u.val[1];
+			vLo = v.val[0];
+			vHi = v.val[1];
+		} else {
+			const uint8x16_t u = vld1q_u8(uSrc + i);
+			const uint8x16_t v = vld1q_u8(vSrc + i);
+			uLo = vget_low_u8(u);
+			uHi = vget_high_u8(u);
+			vLo = vget_low_u8(v);
+			vHi = vget_high_u8(v);
+		}
+		const uint8x16_t y = vld1q_u8(ySrc + i);
+
+		uint16x8_t r, g, b;
+		convertBlockNEON(vget_low_u8(y), uLo, vLo, state, r, g, b);
+		storeBlockNEON(out + i, r, g, b, state);
+		convertBlockNEON(vget_high_u8(y), uHi, vHi, state, r, g, b);
+		storeBlockNEON(out + i + 8, r, g, b, state);
+	}
+}
+
+} // End of anonymous namespace
+
+void convertYUV444To16NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowNEON<false, uint16>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV444To32NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowNEON<false, uint32>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV420To16NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowNEON<true, uint16>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV420To32NEON(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowNEON<true, uint32>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+} // End of namespace Graphics
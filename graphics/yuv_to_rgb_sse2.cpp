@@ -0,0 +1,158 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/yuv_to_rgb_intern.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * The parameters of the conversion, loaded into registers once per row.
+ */
+struct YUVToRGBStateSSE2 {
+	YUVToRGBStateSSE2(const YUVToRGBParams &params) : scaleITU(params.scaleITU != 0) {
+		minValue = _mm_set1_epi16(scaleITU ? 16 : 0);
+		maxValue = _mm_set1_epi16(scaleITU ? 235 : 255);
+		for (int c = 0; c < 3; ++c) {
+			loss[c] = _mm_cvtsi32_si128(params.loss[c]);
+			shift[c] = _mm_cvtsi32_si128(params.shift[c]);
+		}
+		fill16 = _mm_set1_epi16((int16)params.fill);
+		fill32 = _mm_set1_epi32(params.fill);
+	}
+
+	bool scaleITU;
+	__m128i minValue, maxValue;
+	__m128i loss[3], shift[3];
+	__m128i fill16, fill32;
+};
+
+/**
+ * Multiply eight absolute chroma values by a factor, and give the products
+ * the signs of the chroma values.
+ */
+template<int shift, int factor>
+inline __m128i mulChromaSSE2(__m128i absChroma, __m128i sign) {
+	const __m128i product = _mm_mulhi_epu16(_mm_slli_epi16(absChroma, shift), _mm_set1_epi16(factor));
+	return _mm_sub_epi16(_mm_xor_si128(product, sign), sign);
+}
+
+inline __m128i clampSSE2(__m128i value, const YUVToRGBStateSSE2 &state) {
+	value = _mm_max_epi16(_mm_min_epi16(value, state.maxValue), state.minValue);
+	if (state.scaleITU)
+		value = _mm_mulhi_epu16(_mm_slli_epi16(_mm_sub_epi16(value, state.minValue), kYUVITUShift), _mm_set1_epi16(kYUVITUFactor));
+	return value;
+}
+
+/**
+ * Compute the red, green and blue values of eight pixels, in 16 bit lanes.
+ */
+inline void convertBlockSSE2(__m128i y, __m128i u, __m128i v, const YUVToRGBStateSSE2 &state, __m128i &r, __m128i &g, __m128i &b) {
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i crSign = _mm_srai_epi16(cr, 15);
+	const __m128i cbSign = _mm_srai_epi16(cb, 15);
+	const __m128i crAbs = _mm_sub_epi16(_mm_xor_si128(cr, crSign), crSign);
+	const __m128i cbAbs = _mm_sub_epi16(_mm_xor_si128(cb, cbSign), cbSign);
+
+	r = _mm_add_epi16(y, mulChromaSSE2<kYUVCrRShift, kYUVCrRFactor>(crAbs, crSign));
+	g = _mm_sub_epi16(y, mulChromaSSE2<kYUVCrGShift, kYUVCrGFactor>(crAbs, crSign));
+	g = _mm_sub_epi16(g, mulChromaSSE2<kYUVCbGShift, kYUVCbGFactor>(cbAbs, cbSign));
+	b = _mm_add_epi16(y, mulChromaSSE2<kYUVCbBShift, kYUVCbBFactor>(cbAbs, cbSign));
+
+	r = _mm_srl_epi16(clampSSE2(r, state), state.loss[0]);
+	g = _mm_srl_epi16(clampSSE2(g, state), state.loss[1]);
+	b = _mm_srl_epi16(clampSSE2(b, state), state.loss[2]);
+}
+
+inline void storeBlockSSE2(uint16 *dst, __m128i r, __m128i g, __m128i b, const YUVToRGBStateSSE2 &state) {
+	__m128i out = _mm_or_si128(state.fill16, _mm_sll_epi16(r, state.shift[0]));
+	out = _mm_or_si128(out, _mm_sll_epi16(g, state.shift[1]));
+	out = _mm_or_si128(out, _mm_sll_epi16(b, state.shift[2]));
+	_mm_storeu_si128((__m128i *)dst, out);
+}
+
+inline void storeBlockSSE2(uint32 *dst, __m128i r, __m128i g, __m128i b, const YUVToRGBStateSSE2 &state) {
+	const __m128i zero = _mm_setzero_si128();
+
+	__m128i lo = _mm_or_si128(state.fill32, _mm_sll_epi32(_mm_unpacklo_epi16(r, zero), state.shift[0]));
+	lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), state.shift[1]));
+	lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), state.shift[2]));
+	__m128i hi = _mm_or_si128(state.fill32, _mm_sll_epi32(_mm_unpackhi_epi16(r, zero), state.shift[0]));
+	hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), state.shift[1]));
+	hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), state.shift[2]));
+
+	_mm_storeu_si128((__m128i *)dst, lo);
+	_mm_storeu_si128((__m128i *)(dst + 4), hi);
+}
+
+template<bool halfChroma, typename PixelInt>
+void convertRowSSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	const YUVToRGBStateSSE2 state(params);
+	const __m128i zero = _mm_setzero_si128();
+	PixelInt *out = (PixelInt *)dst;
+
+	for (uint i = 0; i < count; i += kYUVToRGBBlockSize) {
+		__m128i u, v;
+		if (halfChroma) {
+			// Each chroma value is used for two neighboring pixels
+			u = _mm_loadl_epi64((const __m128i *)(uSrc + i / 2));
+			v = _mm_loadl_epi64((const __m128i *)(vSrc + i / 2));
+			u = _mm_unpacklo_epi8(u, u);
+			v = _mm_unpacklo_epi8(v, v);
+		} else {
+			u = _mm_loadu_si128((const __m128i *)(uSrc + i));
+			v = _mm_loadu_si128((const __m128i *)(vSrc + i));
+		}
+		const __m128i y = _mm_loadu_si128((const __m128i *)(ySrc + i));
+
+		__m128i r, g, b;
+		convertBlockSSE2(_mm_unpacklo_epi8(y, zero), _mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), state, r, g, b);
+		storeBlockSSE2(out + i, r, g, b, state);
+		convertBlockSSE2(_mm_unpackhi_epi8(y, zero), _mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero), state, r, g, b);
+		storeBlockSSE2(out + i + 8, r, g, b, state);
+	}
+}
+
+} // End of anonymous namespace
+
+void convertYUV444To16SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowSSE2<false, uint16>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV444To32SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowSSE2<false, uint32>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV420To16SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowSSE2<true, uint16>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+void convertYUV420To32SSE2(byte *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, uint count, const YUVToRGBParams &params) {
+	convertRowSSE2<true, uint32>(dst, ySrc, uSrc, vSrc, count, params);
+}
+
+} // End of namespace Graphics
@@ -24,6 +24,8 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/memstream.h"
 #include "common/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -91,6 +93,13 @@ struct WidgetDrawData {
 
 	bool _buffer;
 
+	/** Whether renderings of this item may be cached. */
+	bool _cacheable;
+
+	/** Colors taken from previous drawings, bit i standing for the i-th color
+	    returned by VectorRenderer::getColors() */
+	uint8 _inheritedColors;
+
 
 	/**
 	 * Calculates the background threshold offset of a given DrawData item.
@@ -100,6 +109,55 @@ struct WidgetDrawData {
 	 * value will be added when restoring the background of the widget.
 	 */
 	void calcBackgroundOffset();
+
+	/**
+	 * Calculates whether the renderings of a given DrawData item may be cached.
+	 * Items which may draw outside of their extended area or blit images are
+	 * not cached. Like calcBackgroundOffset(), it must be called after loading all
+	 * the DrawSteps of the item.
+	 */
+	void calcCacheInfo();
+};
+
+/**
+ * A rendering of a DrawData item, together with everything the rendering
+ * depends on besides the draw steps themselves.
+ */
+struct DrawDataCacheEntry {
+	const WidgetDrawData *data;
+	uint32 dynamicData;
+	int16 width, height;
+
+	/** Cached zone and clipping area, relative to the drawn area */
+	Common::Rect region;
+	Common::Rect clip;
+	bool clipped;
+
+	/** Parity of the position of the drawn area, the gradient dithering depends on it */
+	uint8 parity;
+	bool shadows;
+	uint32 colors[5];
+
+	/** Pixels of the cached zone before and after drawing */
+	byte *before;
+	byte *after;
+	uint32 size;
+
+	DrawDataCacheEntry() : data(0), dynamicData(0), width(0), height(0), clipped(false), parity(0), shadows(false),
+		before(0), after(0), size(0) {
+		memset(colors, 0, sizeof(colors));
+	}
+
+	~DrawDataCacheEntry() {
+		delete[] before;
+		delete[] after;
+	}
+
+	bool matches(const DrawDataCacheEntry &key) const {
+		return data == key.data && dynamicData == key.dynamicData && width == key.width && height == key.height &&
+		       region == key.region && clip == key.clip && clipped == key.clipped && parity == key.parity &&
+		       shadows == key.shadows && !memcmp(colors, key.colors, sizeof(colors));
+	}
 };
 
 class ThemeItem {
@@ -280,11 +338,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawDrawData(_data, _area, 0, _dynamicData, extendedRect);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -301,12 +356,8 @@ void ThemeItemDrawDataClip::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step) {
-			_engine->renderer()->drawStepClip(_area, _clip, *step, _dynamicData);
-		}
-	}
+	if (draw)
+		_engine->drawDrawData(_data, _area, &_clip, _dynamicData, extendedRect);
 
 	extendedRect.clip(_clip);
 
@@ -375,7 +426,7 @@ void ThemeItemBitmapClip::drawSelf(bool draw, bool restore) {
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system(0), _vectorRenderer(0),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
-	_font(0), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
+	_font(0), _drawDataCacheSize(0), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
 	_cursor(0) {
 
 	_system = g_system;
@@ -648,6 +699,10 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
 
+	// The cached renderings were made by the old renderer and may have a
+	// different pixel format.
+	clearDrawDataCache();
+
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
@@ -670,11 +725,161 @@ void WidgetDrawData::calcBackgroundOffset() {
 	_shadowOffset = maxShadow;
 }
 
+void WidgetDrawData::calcCacheInfo() {
+	_cacheable = !_steps.empty();
+	_inheritedColors = 0;
+
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_FILLSURFACE ||
+		    step->drawingCall == &Graphics::VectorRenderer::drawCallback_BITMAP ||
+		    step->drawingCall == &Graphics::VectorRenderer::drawCallback_ALPHABITMAP)
+			_cacheable = false;
+
+		// calcBackgroundOffset() ignores these shadows, they may fall outside
+		// of the extended area
+		if (!step->autoWidth && !step->autoHeight && step->shadow)
+			_cacheable = false;
+	}
+
+	if (_steps.empty())
+		return;
+
+	// Every color set by the first step is set before any step draws
+	const Graphics::DrawStep &first = _steps.front();
+	if (!first.fgColor.set)
+		_inheritedColors |= 1 << 0;
+	if (!first.bgColor.set)
+		_inheritedColors |= 1 << 1;
+	if (!first.bevelColor.set)
+		_inheritedColors |= 1 << 2;
+	if (!first.gradColor1.set || !first.gradColor2.set)
+		_inheritedColors |= (1 << 3) | (1 << 4);
+}
+
 void ThemeEngine::restoreBackground(Common::Rect r) {
 	r.clip(_screen.w, _screen.h);
 	_vectorRenderer->blitSurface(&_backBuffer, r);
 }
 
+static void readDrawDataRegion(const Graphics::Surface *surface, const Common::Rect &r, byte *dst) {
+	const uint32 lineSize = r.width() * surface->format.bytesPerPixel;
+	for (int y = r.top; y < r.bottom; ++y, dst += lineSize)
+		memcpy(dst, surface->getBasePtr(r.left, y), lineSize);
+}
+
+static void writeDrawDataRegion(Graphics::Surface *surface, const Common::Rect &r, const byte *src) {
+	const uint32 lineSize = r.width() * surface->format.bytesPerPixel;
+	for (int y = r.top; y < r.bottom; ++y, src += lineSize)
+		memcpy(surface->getBasePtr(r.left, y), src, lineSize);
+}
+
+static bool compareDrawDataRegion(const Graphics::Surface *surface, const Common::Rect &r, const byte *src) {
+	const uint32 lineSize = r.width() * surface->format.bytesPerPixel;
+	for (int y = r.top; y < r.bottom; ++y, src += lineSize) {
+		if (memcmp(surface->getBasePtr(r.left, y), src, lineSize))
+			return false;
+	}
+	return true;
+}
+
+static void drawDrawDataSteps(Graphics::VectorRenderer *renderer, const WidgetDrawData *data, const Common::Rect &area, const Common::Rect *clip, uint32 dynamic) {
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step) {
+		if (clip)
+			renderer->drawStepClip(area, *clip, *step, dynamic);
+		else
+			renderer->drawStep(area, *step, dynamic);
+	}
+}
+
+void ThemeEngine::drawDrawData(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect *clip, uint32 dynamic, const Common::Rect &extendedRect) {
+	Graphics::TransparentSurface *surface = _vectorRenderer->getSurface();
+
+	Common::Rect region = extendedRect;
+	region.clip(surface->w, surface->h);
+	if (clip && !clip->isEmpty())
+		region.clip(*clip);
+
+	const uint32 size = region.isEmpty() ? 0 : region.width() * region.height() * surface->format.bytesPerPixel;
+
+	if (!data->_cacheable || size == 0 || size > kDrawDataCacheSize / 2) {
+		drawDrawDataSteps(_vectorRenderer, data, area, clip, dynamic);
+		return;
+	}
+
+	// The result of drawing depends on the settings left by previous
+	// drawings too, namely the colors the steps do not set themselves and
+	// whether shadows are enabled.
+	DrawDataCacheEntry key;
+	key.data = data;
+	key.dynamicData = dynamic;
+	key.width = area.width();
+	key.height = area.height();
+	key.region = region;
+	key.region.translate(-area.left, -area.top);
+	if (clip) {
+		key.clip = *clip;
+		key.clip.translate(-area.left, -area.top);
+		key.clipped = true;
+	}
+	key.parity = (area.left & 1) | ((area.top & 1) << 1);
+	key.shadows = _vectorRenderer->shadowsEnabled();
+
+	uint32 colors[5];
+	_vectorRenderer->getColors(colors);
+	for (int i = 0; i < 5; ++i) {
+		if (data->_inheritedColors & (1 << i))
+			key.colors[i] = colors[i];
+	}
+
+	// The background is part of the rendering as well, shadows and
+	// anti-aliased edges are blended with it.
+	for (Common::List<DrawDataCacheEntry *>::iterator i = _drawDataCache.begin(); i != _drawDataCache.end(); ++i) {
+		DrawDataCacheEntry *entry = *i;
+		if (!entry->matches(key) || !compareDrawDataRegion(surface, region, entry->before))
+			continue;
+
+		// Leave the renderer in the same state drawing the steps would
+		Common::List<Graphics::DrawStep>::const_iterator step;
+		for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+			_vectorRenderer->setupStep(*step, dynamic);
+
+		writeDrawDataRegion(surface, region, entry->after);
+
+		_drawDataCache.erase(i);
+		_drawDataCache.push_front(entry);
+		return;
+	}
+
+	DrawDataCacheEntry *entry = new DrawDataCacheEntry(key);
+	entry->size = size;
+	entry->before = new byte[size];
+	entry->after = new byte[size];
+
+	readDrawDataRegion(surface, region, entry->before);
+	drawDrawDataSteps(_vectorRenderer, data, area, clip, dynamic);
+	readDrawDataRegion(surface, region, entry->after);
+
+	_drawDataCache.push_front(entry);
+	_drawDataCacheSize += 2 * size;
+
+	while (_drawDataCacheSize > kDrawDataCacheSize) {
+		DrawDataCacheEntry *last = _drawDataCache.back();
+		_drawDataCacheSize -= 2 * last->size;
+		_drawDataCache.pop_back();
+		delete last;
+	}
+}
+
+void ThemeEngine::clearDrawDataCache() {
+	for (Common::List<DrawDataCacheEntry *>::iterator i = _drawDataCache.begin(); i != _drawDataCache.end(); ++i)
+		delete *i;
+
+	_drawDataCache.clear();
+	_drawDataCacheSize = 0;
+}
+
 
 
 /**********************************************************
@@ -873,6 +1078,8 @@ bool ThemeEngine::addDrawData(const Common::String &data, bool cached) {
 	_widgets[id] = new WidgetDrawData;
 	_widgets[id]->_buffer = kDrawDataDefaults[id].buffer;
 	_widgets[id]->_textDataId = kTextDataNone;
+	_widgets[id]->_cacheable = false;
+	_widgets[id]->_inheritedColors = 0;
 
 	return true;
 }
@@ -903,14 +1110,22 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->calcCacheInfo();
 		}
 	}
 }
 
 void ThemeEngine::unloadTheme() {
+	clearDrawDataCache();
+
 	if (!_themeOk)
 		return;
 
+	clearThemeData();
+	_themeOk = false;
+}
+
+void ThemeEngine::clearThemeData() {
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -927,7 +1142,6 @@ void ThemeEngine::unloadTheme() {
 	}
 
 	_themeEval->reset();
-	_themeOk = false;
 }
 
 bool ThemeEngine::loadDefaultXML() {
@@ -949,22 +1163,17 @@ bool ThemeEngine::loadDefaultXML() {
 	for (int i = 0; i < ARRAYSIZE(defaultXML); i++)
 		strncat((char *)tmpXML, defaultXML[i], xmllen);
 
-	if (!_parser->loadBuffer(tmpXML, xmllen)) {
-		free(tmpXML);
+	Common::StringArray names, contents;
+	names.push_back("default.inc");
+	contents.push_back(Common::String((const char *)tmpXML, xmllen));
 
-		return false;
-	}
+	free(tmpXML);
 
 	_themeName = "ScummVM Classic Theme (Builtin Version)";
 	_themeId = "builtin";
 	_themeFile.clear();
 
-	bool result = _parser->parse();
-	_parser->close();
-
-	free(tmpXML);
-
-	return result;
+	return parseThemeFiles(names, contents);
 #else
 	warning("The built-in theme is not enabled in the current build. Please load an external theme");
 	return false;
@@ -1001,19 +1210,125 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 	}
 
 	//
-	// Loop over all STX files, load and parse them
+	// Loop over all STX files and load them
 	//
+	Common::StringArray names, contents;
 	for (Common::ArchiveMemberList::iterator i = members.begin(); i != members.end(); ++i) {
 		assert((*i)->getName().hasSuffix(".stx"));
 
-		if (_parser->loadStream((*i)->createReadStream()) == false) {
+		Common::SeekableReadStream *stream = (*i)->createReadStream();
+		if (!stream) {
+			warning("Failed to load STX file '%s'", (*i)->getDisplayName().c_str());
+			return false;
+		}
+
+		const uint32 size = stream->size();
+		char *data = new char[size];
+		const bool ok = stream->read(data, size) == size;
+		delete stream;
+
+		if (!ok) {
+			delete[] data;
 			warning("Failed to load STX file '%s'", (*i)->getDisplayName().c_str());
-			_parser->close();
 			return false;
 		}
 
+		names.push_back((*i)->getDisplayName());
+		contents.push_back(Common::String(data, size));
+		delete[] data;
+	}
+
+	if (!parseThemeFiles(names, contents))
+		return false;
+
+	assert(!_themeName.empty());
+	return true;
+}
+
+/** Identifies the files written by ThemeEngine::parseThemeFiles() */
+static const uint32 kCompiledThemeTag = MKTAG('S', 'T', 'X', 'C');
+static const uint32 kCompiledThemeVersion = 1;
+
+static Common::String getCompiledThemeName(const Common::String &themeId) {
+	Common::MemoryReadStream id((const byte *)themeId.c_str(), themeId.size());
+	return "theme-" + Common::computeStreamMD5AsString(id) + ".stxc";
+}
+
+/**
+ * Returns the directory holding the compiled themes. They are kept out of
+ * the save directory, whose files may be synced to the cloud.
+ */
+static Common::FSNode getCompiledThemeDirectory() {
+	const Common::String path = g_system->getDefaultCachePath();
+	if (path.empty())
+		return Common::FSNode();
+
+	Common::FSNode dir(path);
+	if (!dir.isDirectory())
+		return Common::FSNode();
+
+	return dir;
+}
+
+bool ThemeEngine::parseThemeFiles(const Common::StringArray &names, const Common::StringArray &contents) {
+	assert(names.size() == contents.size());
+
+	Common::String data;
+	for (uint i = 0; i < names.size(); ++i)
+		data += Common::String::format("%s:%u:", names[i].c_str(), contents[i].size()) + contents[i];
+
+	uint8 digest[16];
+	Common::MemoryReadStream dataStream((const byte *)data.c_str(), data.size());
+	Common::computeStreamMD5(dataStream, digest);
+
+	const Common::FSNode compiledDir = getCompiledThemeDirectory();
+	const Common::String compiledName = getCompiledThemeName(_themeId);
+	const Common::FSNode compiledFile = compiledDir.getChild(compiledName);
+
+	//
+	// Parse the keys stored by a previous run when the files did not change
+	//
+	Common::SeekableReadStream *in = compiledFile.exists() ? compiledFile.createReadStream() : 0;
+	if (in) {
+		uint8 compiledDigest[16];
+		const bool valid = in->readUint32BE() == kCompiledThemeTag && in->readUint32LE() == kCompiledThemeVersion &&
+		                   in->read(compiledDigest, sizeof(compiledDigest)) == sizeof(compiledDigest) &&
+		                   !memcmp(digest, compiledDigest, sizeof(digest)) && in->readUint32LE() == names.size() &&
+		                   !in->err() && !in->eos();
+
+		if (valid) {
+			debug(6, "Loading compiled theme %s", compiledName.c_str());
+
+			bool ok = true;
+			_parser->loadStream(in);
+			for (uint i = 0; i < names.size() && ok; ++i)
+				ok = _parser->parseCompiled();
+			_parser->close();
+
+			if (ok)
+				return true;
+
+			// The XML data is at hand, so a corrupt compiled file only
+			// costs the time to parse it and to write a new one
+			warning("Failed to parse compiled theme '%s', parsing the STX files", compiledName.c_str());
+			clearThemeData();
+		} else {
+			delete in;
+		}
+	}
+
+	//
+	// Parse the XML data, recording the parsed keys for the next run
+	//
+	Common::MemoryWriteStreamDynamic compiled(DisposeAfterUse::YES);
+	_parser->setCompiledStream(&compiled);
+
+	for (uint i = 0; i < names.size(); ++i) {
+		_parser->loadBuffer((const byte *)contents[i].c_str(), contents[i].size());
+
 		if (_parser->parse() == false) {
-			warning("Failed to parse STX file '%s'", (*i)->getDisplayName().c_str());
+			warning("Failed to parse STX file '%s'", names[i].c_str());
+			_parser->setCompiledStream(0);
 			_parser->close();
 			return false;
 		}
@@ -1021,10 +1336,40 @@ bool ThemeEngine::loadThemeXML(const Common::String &themeId) {
 		_parser->close();
 	}
 
-	assert(!_themeName.empty());
+	_parser->setCompiledStream(0);
+
+	Common::WriteStream *out = compiledFile.createWriteStream();
+	if (out) {
+		out->writeUint32BE(kCompiledThemeTag);
+		out->writeUint32LE(kCompiledThemeVersion);
+		out->write(digest, sizeof(digest));
+		out->writeUint32LE(names.size());
+		out->write(compiled.getData(), compiled.size());
+		out->finalize();
+
+		// A partially written file fails the checks on the next run
+		if (out->err())
+			warning("Failed to write compiled theme '%s'", compiledName.c_str());
+		delete out;
+	}
+
 	return true;
 }
 
+void ThemeEngine::invalidateCompiledThemes() {
+	const Common::FSNode compiledDir = getCompiledThemeDirectory();
+
+	Common::FSList files;
+	if (!compiledDir.isDirectory() || !compiledDir.getChildren(files, Common::FSNode::kListFilesOnly))
+		return;
+
+	// There is no way to remove files, so they are emptied
+	for (Common::FSList::const_iterator i = files.begin(); i != files.end(); ++i) {
+		if (i->getName().matchString("theme-*.stxc"))
+			delete i->createWriteStream();
+	}
+}
+
 
 
 /**********************************************************
@@ -29,6 +29,7 @@
 #include "common/hashmap.h"
 #include "common/list.h"
 #include "common/str.h"
+#include "common/str-array.h"
 #include "common/rect.h"
 
 #include "graphics/surface.h"
@@ -49,6 +50,7 @@ class VectorRenderer;
 namespace GUI {
 
 struct WidgetDrawData;
+struct DrawDataCacheEntry;
 struct TextDrawData;
 struct TextColorData;
 class Dialog;
@@ -269,6 +271,9 @@ public:
 	/** Constant value to expand dirty rectangles, to make sure they are fully copied */
 	static const int kDirtyRectangleThreshold = 1;
 
+	/** Maximum amount of memory used by the cached renderings of DrawData items, in bytes */
+	static const uint32 kDrawDataCacheSize = 6 * 1024 * 1024;
+
 	struct Renderer {
 		const char *name;
 		const char *shortname;
@@ -581,6 +586,19 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws all the steps of a DrawData item on the active surface.
+	 * When the same item was drawn before with the same size, settings and
+	 * background, the cached result of that drawing is copied instead.
+	 *
+	 * @param data Item to draw.
+	 * @param area Zone to paint on.
+	 * @param clip Clipping area, or 0 to draw without clipping.
+	 * @param dynamic Dynamic data of the item.
+	 * @param extendedRect Area covering everything the steps may draw.
+	 */
+	void drawDrawData(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect *clip, uint32 dynamic, const Common::Rect &extendedRect);
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -611,12 +629,39 @@ protected:
 	 */
 	bool loadDefaultXML();
 
+	/**
+	 * Parses the STX files of a theme.
+	 *
+	 * The parsed keys are also stored in a compiled form in the cache directory.
+	 * When the files did not change, the keys are parsed from the compiled
+	 * form on the next run, which is a lot faster than parsing the XML data.
+	 * All the resolution dependent keys are stored, so the compiled form is
+	 * valid for every resolution. Should the compiled form fail to parse, the
+	 * XML data is parsed and compiled again.
+	 *
+	 * @param names Names of the files.
+	 * @param contents XML data of the files.
+	 * @returns true if all the files were successfully parsed.
+	 */
+	bool parseThemeFiles(const Common::StringArray &names, const Common::StringArray &contents);
+
 	/**
 	 * Unloads the currently loaded theme so another one can
 	 * be loaded.
 	 */
 	void unloadTheme();
 
+	/**
+	 * Deletes the data added by parsing the theme files.
+	 */
+	void clearThemeData();
+
+	/**
+	 * Drops all the cached renderings of DrawData items. Must be called
+	 * whenever the items or the drawing surfaces change.
+	 */
+	void clearDrawDataCache();
+
 	const Graphics::Font *loadScalableFont(const Common::String &filename, const Common::String &charset, const int pointsize, Common::String &name);
 	const Graphics::Font *loadFont(const Common::String &filename, Common::String &name);
 	Common::String genCacheFilename(const Common::String &filename) const;
@@ -667,6 +712,12 @@ public:
 	 * Lists all theme files useable.
 	 */
 	static void listUsableThemes(Common::List<ThemeDescriptor> &list);
+
+	/**
+	 * Invalidates the compiled forms of the theme files stored by all the
+	 * themes, forcing them to parse their XML data on the next load.
+	 */
+	static void invalidateCompiledThemes();
 private:
 	static bool themeConfigUsable(const Common::FSNode &node, Common::String &themeName);
 	static bool themeConfigUsable(const Common::ArchiveMember &member, Common::String &themeName);
@@ -737,6 +788,12 @@ protected:
 	/** Queue with all the drawing that must be done to the screen */
 	Common::List<ThemeItem *> _screenQueue;
 
+	/** Cached renderings of DrawData items, the most recently used first */
+	Common::List<DrawDataCacheEntry *> _drawDataCache;
+
+	/** Memory used by the pixels of the cached renderings, in bytes */
+	uint32 _drawDataCacheSize;
+
 	bool _initOk;  ///< Class and renderer properly initialized
 	bool _themeOk; ///< Theme data successfully loaded.
 	bool _enabled; ///< Whether the Theme is currently shown on the overlay
@@ -22,6 +22,7 @@
 
 #include "base/version.h"
 
+#include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/events.h"
 #include "common/fs.h"
@@ -244,8 +245,27 @@ void LauncherDialog::close() {
 	Dialog::close();
 }
 
+namespace {
+
+struct LauncherEntry {
+	Common::String key;
+	Common::String description;
+
+	LauncherEntry(const Common::String &k, const Common::String &d) : key(k), description(d) {}
+};
+
+struct LauncherEntryComparator {
+	bool operator()(const LauncherEntry &x, const LauncherEntry &y) const {
+		const int result = scumm_stricmp(x.description.c_str(), y.description.c_str());
+		return result < 0 || (result == 0 && x.key < y.key);
+	}
+};
+
+} // end of anonymous namespace
+
 void LauncherDialog::updateListing() {
 	StringArray l;
+	Common::Array<LauncherEntry> entries;
 
 	// Retrieve a list of all games defined in the config file
 	_domains.clear();
@@ -275,15 +295,19 @@ void LauncherDialog::updateListing() {
 			description = Common::String::format("Unknown (target %s, gameid %s)", iter->_key.c_str(), gameid.c_str());
 		}
 
-		if (!gameid.empty() && !description.empty()) {
-			// Insert the game into the launcher list
-			int pos = 0, size = l.size();
+		if (!gameid.empty() && !description.empty())
+			entries.push_back(LauncherEntry(iter->_key, description));
+	}
 
-			while (pos < size && (scumm_stricmp(description.c_str(), l[pos].c_str()) > 0))
-				pos++;
-			l.insert_at(pos, description);
-			_domains.insert_at(pos, iter->_key);
-		}
+	// Sort the games by description. Sorting once instead of inserting each
+	// game at its place keeps this fast with thousands of games.
+	Common::sort(entries.begin(), entries.end(), LauncherEntryComparator());
+
+	l.reserve(entries.size());
+	_domains.reserve(entries.size());
+	for (Common::Array<LauncherEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+		l.push_back(i->description);
+		_domains.push_back(i->key);
 	}
 
 	const int oldSel = _list->getSelected();
@@ -20,6 +20,7 @@
  *
  */
 
+#include "engines/massDetector.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
@@ -60,6 +61,7 @@ enum {
 
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
+	_detector(0),
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
@@ -70,7 +72,7 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	StringArray l;
 
 	// The dir we start our scan at
-	_scanStack.push(startDir);
+	_detector = new MassDetector(startDir, true);
 
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
@@ -119,6 +121,10 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	}
 }
 
+MassAddDialog::~MassAddDialog() {
+	delete _detector;
+}
+
 struct GameTargetLess {
 	bool operator()(const GameDescriptor &x, const GameDescriptor &y) const {
 		return x.preferredtarget().compareToIgnoreCase(y.preferredtarget()) < 0;
@@ -172,23 +178,16 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 }
 
 void MassAddDialog::handleTickle() {
-	if (_scanStack.empty())
+	if (!_detector)
 		return;	// We have finished scanning
 
 	uint32 t = g_system->getMillis();
 
-	// Perform a breadth-first scan of the filesystem.
-	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
-
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
-		}
-
-		// Run the detector on the dir
-		GameList candidates(EngineMan.detectGames(files));
-
+	// Run the detectors on the directories listed so far. The detector
+	// performs a breadth-first scan of the filesystem.
+	Common::FSNode dir;
+	GameList candidates;
+	while ((g_system->getMillis() - t) < kMaxScanTime && _detector->detectNext(dir, candidates)) {
 		// Just add all detected games / game variants. If we get more than one,
 		// that either means the directory contains multiple games, or the detector
 		// could not fully determine which game variant it was seeing. In either
@@ -231,16 +230,8 @@ void MassAddDialog::handleTickle() {
 		}
 
 
-		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			if (file->isDirectory()) {
-				_scanStack.push(*file);
-
-				_dirTotal++;
-			}
-		}
-
-		_dirsScanned++;
+		_dirsScanned = _detector->getDirsScanned();
+		_dirTotal = _detector->getDirsFound();
 
 #if defined(USE_TASKBAR)
 		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
@@ -252,7 +243,10 @@ void MassAddDialog::handleTickle() {
 	// Update the dialog
 	Common::String buf;
 
-	if (_scanStack.empty()) {
+	if (_detector->isFinished()) {
+		delete _detector;
+		_detector = 0;
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -160,6 +160,7 @@ void ListWidget::setList(const StringArray &list, const ColorList *colors) {
 	// Copy everything
 	_dataList = list;
 	_list = list;
+	_lowercaseDataList.clear();
 	_filter.clear();
 	_listIndex.clear();
 	_listColors.clear();
@@ -196,6 +197,12 @@ void ListWidget::append(const String &s, ThemeEngine::FontColor color) {
 	_dataList.push_back(s);
 	_list.push_back(s);
 
+	if (_lowercaseDataList.size() + 1 == _dataList.size()) {
+		String lowercase = s;
+		lowercase.toLowercase();
+		_lowercaseDataList.push_back(lowercase);
+	}
+
 	setFilter(_filter, false);
 
 	scrollBarRecalc();
@@ -665,6 +672,23 @@ void ListWidget::reflowLayout() {
 	}
 }
 
+bool ListWidget::isNarrowerFilter(const String &filter, const String &narrowerFilter) {
+	Common::StringTokenizer tok(filter);
+	while (!tok.empty()) {
+		const String word = tok.nextToken();
+
+		bool found = false;
+		Common::StringTokenizer narrowerTok(narrowerFilter);
+		while (!narrowerTok.empty() && !found)
+			found = narrowerTok.nextToken().contains(word);
+
+		if (!found)
+			return false;
+	}
+
+	return true;
+}
+
 void ListWidget::setFilter(const String &filter, bool redraw) {
 	// FIXME: This method does not deal correctly with edit mode!
 	// Until we fix that, let's make sure it isn't called while editing takes place
@@ -676,6 +700,11 @@ void ListWidget::setFilter(const String &filter, bool redraw) {
 	if (_filter == filt) // Filter was not changed
 		return;
 
+	// When every word of the old filter is part of a word of the new one,
+	// e.g. when one more character was typed, only the items matching the
+	// old filter can match the new one.
+	const bool narrowed = !_filter.empty() && _listIndex.size() == _list.size() && isNarrowerFilter(_filter, filt);
+
 	_filter = filt;
 
 	if (_filter.empty()) {
@@ -686,27 +715,39 @@ void ListWidget::setFilter(const String &filter, bool redraw) {
 		// Restrict the list to everything which contains all words in _filter
 		// as substrings, ignoring case.
 
+		if (_lowercaseDataList.size() != _dataList.size()) {
+			_lowercaseDataList = _dataList;
+			for (StringArray::iterator i = _lowercaseDataList.begin(); i != _lowercaseDataList.end(); ++i)
+				i->toLowercase();
+		}
+
+		StringArray words;
 		Common::StringTokenizer tok(_filter);
-		String tmp;
-		int n = 0;
+		while (!tok.empty())
+			words.push_back(tok.nextToken());
+
+		Common::Array<int> candidates;
+		if (narrowed)
+			candidates = _listIndex;
+
+		const int count = narrowed ? candidates.size() : _dataList.size();
 
 		_list.clear();
 		_listIndex.clear();
 
-		for (StringArray::iterator i = _dataList.begin(); i != _dataList.end(); ++i, ++n) {
-			tmp = *i;
-			tmp.toLowercase();
+		for (int c = 0; c < count; ++c) {
+			const int n = narrowed ? candidates[c] : c;
+			const String &tmp = _lowercaseDataList[n];
 			bool matches = true;
-			tok.reset();
-			while (!tok.empty()) {
-				if (!tmp.contains(tok.nextToken())) {
+			for (StringArray::const_iterator word = words.begin(); word != words.end(); ++word) {
+				if (!tmp.contains(*word)) {
 					matches = false;
 					break;
 				}
 			}
 
 			if (matches) {
-				_list.push_back(*i);
+				_list.push_back(_dataList[n]);
 				_listIndex.push_back(n);
 			}
 		}
@@ -55,6 +55,7 @@ public:
 protected:
 	StringArray		_list;
 	StringArray		_dataList;
+	StringArray		_lowercaseDataList;
 	ColorList		_listColors;
 	Common::Array<int>		_listIndex;
 	bool			_editable;
@@ -148,6 +149,9 @@ protected:
 	void lostFocusWidget();
 	void checkBounds();
 	void scrollToCurrent();
+
+	/// Returns whether every item matching narrowerFilter matches filter too.
+	static bool isNarrowerFilter(const String &filter, const String &narrowerFilter);
 };
 
 } // End of namespace GUI
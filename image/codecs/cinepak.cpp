@@ -608,6 +608,22 @@ void CinepakDecoder::decodeVectors(Common::SeekableReadStream &stream, uint16 st
 	}
 }
 
+bool CinepakDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (format == _pixelFormat)
+		return true;
+
+	if (_bitsPerPixel == 8 || _ditherPalette || (format.bytesPerPixel != 2 && format.bytesPerPixel != 4))
+		return false;
+
+	_pixelFormat = format;
+
+	// Keep the previous frame, which the next one is drawn on
+	if (_curFrame.surface)
+		_curFrame.surface->convertToInPlace(format);
+
+	return true;
+}
+
 bool CinepakDecoder::canDither(DitherType type) const {
 	return (type == kDitherTypeVFW || type == kDitherTypeQT) && _bitsPerPixel == 24;
 }
@@ -195,6 +195,19 @@ byte *Codec::createQuickTimeDitherTable(const byte *palette, uint colorCount) {
 	return buf;
 }
 
+uint32 *Codec::createRGB555ConversionTable(const Graphics::PixelFormat &format) {
+	const Graphics::PixelFormat rgb555(2, 5, 5, 5, 0, 10, 5, 0, 0);
+	uint32 *table = new uint32[0x8000];
+
+	for (uint32 color = 0; color < 0x8000; color++) {
+		byte r, g, b;
+		rgb555.colorToRGB(color, r, g, b);
+		table[color] = format.RGBToColor(r, g, b);
+	}
+
+	return table;
+}
+
 Codec *createBitmapCodec(uint32 tag, int width, int height, int bitsPerPixel) {
 	switch (tag) {
 	case SWAP_CONSTANT_32(0):
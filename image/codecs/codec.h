@@ -111,10 +111,28 @@ public:
 	 */
 	virtual void setDither(DitherType type, const byte *palette) {}
 
+	/**
+	 * Decode directly into the given format, so the caller does not have
+	 * to convert every frame itself.
+	 *
+	 * This has to be called before the first frame is decoded. Codecs
+	 * which cannot decode into the format keep their current one.
+	 *
+	 * @return true if getPixelFormat() now returns the format
+	 */
+	virtual bool setOutputPixelFormat(const Graphics::PixelFormat &format) { return format == getPixelFormat(); }
+
 	/**
 	 * Create a dither table, as used by QuickTime codecs.
 	 */
 	static byte *createQuickTimeDitherTable(const byte *palette, uint colorCount);
+
+	/**
+	 * Create a table converting the 32768 RGB555 colors to the given
+	 * format, as used by the 16 bit codecs. The colors are identical to the
+	 * ones of Graphics::Surface::convertTo().
+	 */
+	static uint32 *createRGB555ConversionTable(const Graphics::PixelFormat &format);
 };
 
 /**
@@ -1002,8 +1002,8 @@ int IndeoDecoderBase::processEmptyTile(IVIBandDesc *band,
 
 	if (band->_inheritMv && needMc) { // apply motion compensation if there is at least one non-zero motion vector
 		int numBlocks = (band->_mbSize != band->_blkSize) ? 4 : 1; // number of blocks per mb
-		IviMCFunc mcNoDeltaFunc = (band->_blkSize == 8) ? IndeoDSP::ffIviMc8x8NoDelta
-			: IndeoDSP::ffIviMc4x4NoDelta;
+		IviMCFunc mcNoDeltaFunc = IndeoDSP::getMc((band->_blkSize == 8) ? IndeoDSP::ffIviMc8x8NoDelta
+			: IndeoDSP::ffIviMc4x4NoDelta);
 
 		int mbn;
 		for (mbn = 0, mb = tile->_mbs; mbn < tile->_numMBs; mb++, mbn++) {
@@ -1081,6 +1081,11 @@ int IndeoDecoderBase::decodeBlocks(GetBits *_gb, IVIBandDesc *band, IVITile *til
 		mcAvgNoDeltaFunc   = IndeoDSP::ffIviMcAvg4x4NoDelta;
 	}
 
+	mcWithDeltaFunc    = IndeoDSP::getMc(mcWithDeltaFunc);
+	mcNoDeltaFunc      = IndeoDSP::getMc(mcNoDeltaFunc);
+	mcAvgWithDeltaFunc = IndeoDSP::getMcAvg(mcAvgWithDeltaFunc);
+	mcAvgNoDeltaFunc   = IndeoDSP::getMcAvg(mcAvgNoDeltaFunc);
+
 	int mbn;
 	IVIMbInfo *mb;
 
@@ -26,7 +26,10 @@
  * written, produced, and directed by Alan Smithee
  */
 
+#include "common/system.h"
+
 #include "image/codecs/indeo/indeo_dsp.h"
+#include "image/codecs/indeo/indeo_dsp_intern.h"
 
 namespace Image {
 namespace Indeo {
@@ -602,5 +605,70 @@ IVI_MC_AVG_TEMPLATE(8, Delta,   OP_ADD)
 IVI_MC_AVG_TEMPLATE(4, NoDelta, OP_PUT)
 IVI_MC_AVG_TEMPLATE(4, Delta,   OP_ADD)
 
+#define IVI_SELECT(name, suffix) \
+	if (func == name) \
+		return name ## suffix;
+
+InvTransformPtr *IndeoDSP::getInvTransform(InvTransformPtr *func) {
+#ifdef SCUMMVM_NEON
+	if (OSystem::getCpuExtension() == OSystem::kCpuExtensionNEON) {
+		IVI_SELECT(ffIviInverseHaar8x8, NEON)
+		IVI_SELECT(ffIviInverseSlant8x8, NEON)
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (OSystem::getCpuExtension() >= OSystem::kCpuExtensionSSE2) {
+		IVI_SELECT(ffIviInverseHaar8x8, SSE2)
+		IVI_SELECT(ffIviInverseSlant8x8, SSE2)
+	}
+#endif
+
+	return func;
+}
+
+IviMCFunc IndeoDSP::getMc(IviMCFunc func) {
+#ifdef SCUMMVM_NEON
+	if (OSystem::getCpuExtension() == OSystem::kCpuExtensionNEON) {
+		IVI_SELECT(ffIviMc8x8Delta, NEON)
+		IVI_SELECT(ffIviMc8x8NoDelta, NEON)
+		IVI_SELECT(ffIviMc4x4Delta, NEON)
+		IVI_SELECT(ffIviMc4x4NoDelta, NEON)
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (OSystem::getCpuExtension() >= OSystem::kCpuExtensionSSE2) {
+		IVI_SELECT(ffIviMc8x8Delta, SSE2)
+		IVI_SELECT(ffIviMc8x8NoDelta, SSE2)
+		IVI_SELECT(ffIviMc4x4Delta, SSE2)
+		IVI_SELECT(ffIviMc4x4NoDelta, SSE2)
+	}
+#endif
+
+	return func;
+}
+
+IviMCAvgFunc IndeoDSP::getMcAvg(IviMCAvgFunc func) {
+#ifdef SCUMMVM_NEON
+	if (OSystem::getCpuExtension() == OSystem::kCpuExtensionNEON) {
+		IVI_SELECT(ffIviMcAvg8x8Delta, NEON)
+		IVI_SELECT(ffIviMcAvg8x8NoDelta, NEON)
+		IVI_SELECT(ffIviMcAvg4x4Delta, NEON)
+		IVI_SELECT(ffIviMcAvg4x4NoDelta, NEON)
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (OSystem::getCpuExtension() >= OSystem::kCpuExtensionSSE2) {
+		IVI_SELECT(ffIviMcAvg8x8Delta, SSE2)
+		IVI_SELECT(ffIviMcAvg8x8NoDelta, SSE2)
+		IVI_SELECT(ffIviMcAvg4x4Delta, SSE2)
+		IVI_SELECT(ffIviMcAvg4x4NoDelta, SSE2)
+	}
+#endif
+
+	return func;
+}
+
+#undef IVI_SELECT
+
 } // End of namespace Indeo
 } // End of namespace Image
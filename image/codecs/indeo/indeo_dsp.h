@@ -38,6 +38,23 @@ namespace Indeo {
 
 class IndeoDSP {
 public:
+	/**
+	 *  Return the fastest version of an inverse transform for the host CPU.
+	 *  Its results are identical to the ones of the given function.
+	 *
+	 *  @param[in]  func	One of the inverse transforms of this class
+	 */
+	static InvTransformPtr *getInvTransform(InvTransformPtr *func);
+
+	/**
+	 *  Return the fastest version of a motion compensation function for the
+	 *  host CPU. Its results are identical to the ones of the given function.
+	 *
+	 *  @param[in]  func	One of the motion compensation functions of this class
+	 */
+	static IviMCFunc getMc(IviMCFunc func);
+	static IviMCAvgFunc getMcAvg(IviMCAvgFunc func);
+
 	/**
 	 *  two-dimensional inverse Haar 8x8 transform for Indeo 4
 	 *
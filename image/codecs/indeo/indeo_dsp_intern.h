@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef IMAGE_CODECS_INDEO_INDEO_DSP_INTERN_H
+#define IMAGE_CODECS_INDEO_INDEO_DSP_INTERN_H
+
+#include "image/codecs/indeo/indeo_dsp.h"
+
+namespace Image {
+namespace Indeo {
+
+/*
+ * SIMD versions of the most used functions of IndeoDSP. Their results are
+ * identical to the ones of the plain C versions.
+ */
+
+#ifdef SCUMMVM_SSE2
+void ffIviInverseHaar8x8SSE2(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags);
+void ffIviInverseSlant8x8SSE2(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags);
+void ffIviMc8x8DeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMc8x8NoDeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMc4x4DeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMc4x4NoDeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMcAvg8x8DeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+void ffIviMcAvg8x8NoDeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+void ffIviMcAvg4x4DeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+void ffIviMcAvg4x4NoDeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+#endif
+
+#ifdef SCUMMVM_NEON
+void ffIviInverseHaar8x8NEON(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags);
+void ffIviInverseSlant8x8NEON(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags);
+void ffIviMc8x8DeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMc8x8NoDeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMc4x4DeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMc4x4NoDeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+void ffIviMcAvg8x8DeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+void ffIviMcAvg8x8NoDeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+void ffIviMcAvg4x4DeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+void ffIviMcAvg4x4NoDeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+#endif
+
+} // End of namespace Indeo
+} // End of namespace Image
+
+#endif
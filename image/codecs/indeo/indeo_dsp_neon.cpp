@@ -0,0 +1,352 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "image/codecs/indeo/indeo_dsp_intern.h"
+
+#include <arm_neon.h>
+
+namespace Image {
+namespace Indeo {
+
+namespace {
+
+/**
+ * Butterfly operation for the inverse Haar transform.
+ */
+inline void haarButterflyNEON(int32x4_t s1, int32x4_t s2, int32x4_t &o1, int32x4_t &o2) {
+	o1 = vshrq_n_s32(vaddq_s32(s1, s2), 1);
+	o2 = vshrq_n_s32(vsubq_s32(s1, s2), 1);
+}
+
+/**
+ * Inverse 8-point Haar transform of four columns at once, v[k] holding the
+ * k-th value of each column.
+ */
+inline void invHaar8NEON(int32x4_t *v) {
+	// The values in the order of the arguments of INV_HAAR8
+	const int32x4_t s1 = v[0], s5 = v[1], s3 = v[2], s7 = v[3];
+	const int32x4_t s2 = v[4], s4 = v[5], s6 = v[6], s8 = v[7];
+	int32x4_t t1, t2, t3, t4, t5, t6, t7, t8;
+
+	haarButterflyNEON(vshlq_n_s32(s1, 1), vshlq_n_s32(s5, 1), t1, t5);
+	haarButterflyNEON(t1, s3, t1, t3);
+	haarButterflyNEON(t5, s7, t5, t7);
+	haarButterflyNEON(t1, s2, t1, t2);
+	haarButterflyNEON(t3, s4, t3, t4);
+	haarButterflyNEON(t5, s6, t5, t6);
+	haarButterflyNEON(t7, s8, t7, t8);
+
+	v[0] = t1; v[1] = t2; v[2] = t3; v[3] = t4;
+	v[4] = t5; v[5] = t6; v[6] = t7; v[7] = t8;
+}
+
+/**
+ * Butterfly operation for the inverse slant transform.
+ */
+inline void slantButterflyNEON(int32x4_t s1, int32x4_t s2, int32x4_t &o1, int32x4_t &o2) {
+	o1 = vaddq_s32(s1, s2);
+	o2 = vsubq_s32(s1, s2);
+}
+
+/**
+ * Reflection a,b = 1/2, 5/4 for the inverse slant transform.
+ */
+inline void slantReflectNEON(int32x4_t s1, int32x4_t s2, int32x4_t &o1, int32x4_t &o2) {
+	const int32x4_t two = vdupq_n_s32(2);
+	o1 = vaddq_s32(vshrq_n_s32(vaddq_s32(vaddq_s32(s1, vshlq_n_s32(s2, 1)), two), 2), s1);
+	o2 = vsubq_s32(vshrq_n_s32(vaddq_s32(vsubq_s32(vshlq_n_s32(s1, 1), s2), two), 2), s2);
+}
+
+/**
+ * Reflection a,b = 1/2, 7/8 for the inverse slant transform.
+ */
+inline void slantPart4NEON(int32x4_t s1, int32x4_t s2, int32x4_t &o1, int32x4_t &o2) {
+	const int32x4_t four = vdupq_n_s32(4);
+	o1 = vaddq_s32(s2, vshrq_n_s32(vaddq_s32(vsubq_s32(vshlq_n_s32(s1, 2), s2), four), 3));
+	o2 = vaddq_s32(s1, vshrq_n_s32(vaddq_s32(vsubq_s32(vnegq_s32(s1), vshlq_n_s32(s2, 2)), four), 3));
+}
+
+/**
+ * Inverse 8-point slant transform of four columns at once, v[k] holding the
+ * k-th value of each column. The row pass rounds the results to half.
+ */
+template<bool compensate>
+inline void invSlant8NEON(int32x4_t *v) {
+	// The values in the order of the arguments of IVI_INV_SLANT8
+	const int32x4_t s1 = v[0], s4 = v[1], s8 = v[2], s5 = v[3];
+	const int32x4_t s2 = v[4], s6 = v[5], s3 = v[6], s7 = v[7];
+	int32x4_t t1, t2, t3, t4, t5, t6, t7, t8;
+
+	slantPart4NEON(s4, s5, t4, t5);
+
+	slantButterflyNEON(s1, t5, t1, t5); slantButterflyNEON(s2, s6, t2, t6);
+	slantButterflyNEON(s7, s3, t7, t3); slantButterflyNEON(t4, s8, t4, t8);
+
+	slantButterflyNEON(t1, t2, t1, t2); slantReflectNEON(t4, t3, t4, t3);
+	slantButterflyNEON(t5, t6, t5, t6); slantReflectNEON(t8, t7, t8, t7);
+	slantButterflyNEON(t1, t4, t1, t4); slantButterflyNEON(t2, t3, t2, t3);
+	slantButterflyNEON(t5, t8, t5, t8); slantButterflyNEON(t6, t7, t6, t7);
+
+	v[0] = t1; v[1] = t2; v[2] = t3; v[3] = t4;
+	v[4] = t5; v[5] = t6; v[6] = t7; v[7] = t8;
+
+	if (compensate) {
+		const int32x4_t one = vdupq_n_s32(1);
+		for (int i = 0; i < 8; i++)
+			v[i] = vshrq_n_s32(vaddq_s32(v[i], one), 1);
+	}
+}
+
+inline void invSlant8ColNEON(int32x4_t *v) {
+	invSlant8NEON<false>(v);
+}
+
+inline void invSlant8RowNEON(int32x4_t *v) {
+	invSlant8NEON<true>(v);
+}
+
+/**
+ * Transpose the 4x4 matrix of 32 bit values in src into dst.
+ */
+inline void transpose4x4NEON(const int32x4_t *src, int32x4_t *dst) {
+	const int32x4x2_t a01 = vtrnq_s32(src[0], src[1]);
+	const int32x4x2_t a23 = vtrnq_s32(src[2], src[3]);
+
+	dst[0] = vcombine_s32(vget_low_s32(a01.val[0]), vget_low_s32(a23.val[0]));
+	dst[1] = vcombine_s32(vget_low_s32(a01.val[1]), vget_low_s32(a23.val[1]));
+	dst[2] = vcombine_s32(vget_high_s32(a01.val[0]), vget_high_s32(a23.val[0]));
+	dst[3] = vcombine_s32(vget_high_s32(a01.val[1]), vget_high_s32(a23.val[1]));
+}
+
+/**
+ * Two-dimensional 8x8 inverse transform: the columns are transformed first,
+ * then the rows.
+ *
+ * The C code skips the columns without coefficients according to the flags,
+ * and all rows without values. Transforming zeros gives zeros, so only the
+ * columns have to be masked here.
+ *
+ * @param preScale	double the first four values of the first four columns
+ *					before transforming them, as the Haar transform does
+ */
+template<void (*colTransform)(int32x4_t *), void (*rowTransform)(int32x4_t *), bool preScale>
+inline void inverse8x8NEON(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags) {
+	// All bits set for the columns with coefficients
+	const int8x8_t used8 = vreinterpret_s8_u8(vtst_u8(vld1_u8(flags), vdup_n_u8(0xFF)));
+	const int16x8_t used16 = vmovl_s8(used8);
+	const int32x4_t usedLeft = vmovl_s16(vget_low_s16(used16));
+	const int32x4_t usedRight = vmovl_s16(vget_high_s16(used16));
+
+	int32x4_t left[8], right[8];
+	for (int i = 0; i < 8; i++) {
+		left[i] = vandq_s32(usedLeft, vld1q_s32(in + i * 8));
+		right[i] = vandq_s32(usedRight, vld1q_s32(in + i * 8 + 4));
+	}
+
+	if (preScale) {
+		for (int i = 0; i < 4; i++)
+			left[i] = vshlq_n_s32(left[i], 1);
+	}
+
+	colTransform(left);
+	colTransform(right);
+
+	// Transpose so the rows are transformed as columns. top[k] and bottom[k]
+	// hold the k-th value of the rows 0 to 3 and 4 to 7.
+	int32x4_t top[8], bottom[8];
+	transpose4x4NEON(left, top);
+	transpose4x4NEON(right, top + 4);
+	transpose4x4NEON(left + 4, bottom);
+	transpose4x4NEON(right + 4, bottom + 4);
+
+	rowTransform(top);
+	rowTransform(bottom);
+
+	for (int half = 0; half < 2; half++) {
+		const int32x4_t *src = half ? bottom : top;
+		int32x4_t rowsLeft[4], rowsRight[4];
+		transpose4x4NEON(src, rowsLeft);
+		transpose4x4NEON(src + 4, rowsRight);
+
+		// vmovn keeps the low 16 bits, like the conversion of the C code
+		for (int i = 0; i < 4; i++, out += pitch)
+			vst1q_s16(out, vcombine_s16(vmovn_s32(rowsLeft[i]), vmovn_s32(rowsRight[i])));
+	}
+}
+
+template<int size>
+inline int16x8_t loadRowNEON(const int16 *src) {
+	if (size == 8)
+		return vld1q_s16(src);
+	else
+		return vcombine_s16(vld1_s16(src), vdup_n_s16(0));
+}
+
+template<int size>
+inline void storeRowNEON(int16 *dst, int16x8_t row) {
+	if (size == 8)
+		vst1q_s16(dst, row);
+	else
+		vst1_s16(dst, vget_low_s16(row));
+}
+
+/**
+ * (a + b) >> 1 without overflowing 16 bits.
+ */
+inline int16x8_t average2NEON(int16x8_t a, int16x8_t b) {
+	return vhaddq_s16(a, b);
+}
+
+/**
+ * (a + b + c + d) >> 2 without overflowing 16 bits.
+ */
+inline int16x8_t average4NEON(int16x8_t a, int16x8_t b, int16x8_t c, int16x8_t d) {
+	const int16x8_t three = vdupq_n_s16(3);
+	const int16x8_t high = vaddq_s16(vaddq_s16(vshrq_n_s16(a, 2), vshrq_n_s16(b, 2)),
+	                                 vaddq_s16(vshrq_n_s16(c, 2), vshrq_n_s16(d, 2)));
+	const int16x8_t low = vaddq_s16(vaddq_s16(vandq_s16(a, three), vandq_s16(b, three)),
+	                                vaddq_s16(vandq_s16(c, three), vandq_s16(d, three)));
+	return vaddq_s16(high, vshrq_n_s16(low, 2));
+}
+
+/**
+ * Interpolate the rows of a block from the reference frame.
+ *
+ * @return	false for unknown interpolation types, which the C code ignores
+ */
+template<int size>
+inline bool predictNEON(int16x8_t *rows, const int16 *refBuf, uint32 pitch, int mcType) {
+	switch (mcType) {
+	case 0: // fullpel (no interpolation)
+		for (int i = 0; i < size; i++, refBuf += pitch)
+			rows[i] = loadRowNEON<size>(refBuf);
+		return true;
+	case 1: // horizontal halfpel interpolation
+		for (int i = 0; i < size; i++, refBuf += pitch)
+			rows[i] = average2NEON(loadRowNEON<size>(refBuf), loadRowNEON<size>(refBuf + 1));
+		return true;
+	case 2: { // vertical halfpel interpolation
+		int16x8_t above = loadRowNEON<size>(refBuf);
+		for (int i = 0; i < size; i++) {
+			refBuf += pitch;
+			const int16x8_t below = loadRowNEON<size>(refBuf);
+			rows[i] = average2NEON(above, below);
+			above = below;
+		}
+		return true;
+	}
+	case 3: { // vertical and horizontal halfpel interpolation
+		int16x8_t above = loadRowNEON<size>(refBuf);
+		int16x8_t aboveNext = loadRowNEON<size>(refBuf + 1);
+		for (int i = 0; i < size; i++) {
+			refBuf += pitch;
+			const int16x8_t below = loadRowNEON<size>(refBuf);
+			const int16x8_t belowNext = loadRowNEON<size>(refBuf + 1);
+			rows[i] = average4NEON(above, aboveNext, below, belowNext);
+			above = below;
+			aboveNext = belowNext;
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+template<int size, bool delta>
+inline void applyNEON(int16 *buf, uint32 pitch, const int16x8_t *rows) {
+	for (int i = 0; i < size; i++, buf += pitch) {
+		if (delta)
+			storeRowNEON<size>(buf, vaddq_s16(loadRowNEON<size>(buf), rows[i]));
+		else
+			storeRowNEON<size>(buf, rows[i]);
+	}
+}
+
+template<int size, bool delta>
+inline void mcNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	int16x8_t rows[size];
+	if (predictNEON<size>(rows, refBuf, pitch, mcType))
+		applyNEON<size, delta>(buf, pitch, rows);
+}
+
+template<int size, bool delta>
+inline void mcAvgNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	int16x8_t rows[size], rows2[size];
+	if (!predictNEON<size>(rows, refBuf, pitch, mcType))
+		return;
+	if (!predictNEON<size>(rows2, refBuf2, pitch, mcType2)) {
+		// The C code adds nothing for an unknown second interpolation type
+		for (int i = 0; i < size; i++)
+			rows2[i] = vdupq_n_s16(0);
+	}
+
+	// The sum is stored in 16 bits by the C code before halving it
+	for (int i = 0; i < size; i++)
+		rows[i] = vshrq_n_s16(vaddq_s16(rows[i], rows2[i]), 1);
+	applyNEON<size, delta>(buf, pitch, rows);
+}
+
+} // End of anonymous namespace
+
+void ffIviInverseHaar8x8NEON(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags) {
+	inverse8x8NEON<invHaar8NEON, invHaar8NEON, true>(in, out, pitch, flags);
+}
+
+void ffIviInverseSlant8x8NEON(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags) {
+	inverse8x8NEON<invSlant8ColNEON, invSlant8RowNEON, false>(in, out, pitch, flags);
+}
+
+void ffIviMc8x8DeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcNEON<8, true>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMc8x8NoDeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcNEON<8, false>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMc4x4DeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcNEON<4, true>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMc4x4NoDeltaNEON(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcNEON<4, false>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMcAvg8x8DeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgNEON<8, true>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+void ffIviMcAvg8x8NoDeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgNEON<8, false>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+void ffIviMcAvg4x4DeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgNEON<4, true>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+void ffIviMcAvg4x4NoDeltaNEON(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgNEON<4, false>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+} // End of namespace Indeo
+} // End of namespace Image
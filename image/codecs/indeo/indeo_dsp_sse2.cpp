@@ -0,0 +1,362 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "image/codecs/indeo/indeo_dsp_intern.h"
+
+#include <emmintrin.h>
+
+namespace Image {
+namespace Indeo {
+
+namespace {
+
+/**
+ * Butterfly operation for the inverse Haar transform.
+ */
+inline void haarButterflySSE2(__m128i s1, __m128i s2, __m128i &o1, __m128i &o2) {
+	o1 = _mm_srai_epi32(_mm_add_epi32(s1, s2), 1);
+	o2 = _mm_srai_epi32(_mm_sub_epi32(s1, s2), 1);
+}
+
+/**
+ * Inverse 8-point Haar transform of four columns at once, v[k] holding the
+ * k-th value of each column.
+ */
+inline void invHaar8SSE2(__m128i *v) {
+	// The values in the order of the arguments of INV_HAAR8
+	const __m128i s1 = v[0], s5 = v[1], s3 = v[2], s7 = v[3];
+	const __m128i s2 = v[4], s4 = v[5], s6 = v[6], s8 = v[7];
+	__m128i t1, t2, t3, t4, t5, t6, t7, t8;
+
+	haarButterflySSE2(_mm_slli_epi32(s1, 1), _mm_slli_epi32(s5, 1), t1, t5);
+	haarButterflySSE2(t1, s3, t1, t3);
+	haarButterflySSE2(t5, s7, t5, t7);
+	haarButterflySSE2(t1, s2, t1, t2);
+	haarButterflySSE2(t3, s4, t3, t4);
+	haarButterflySSE2(t5, s6, t5, t6);
+	haarButterflySSE2(t7, s8, t7, t8);
+
+	v[0] = t1; v[1] = t2; v[2] = t3; v[3] = t4;
+	v[4] = t5; v[5] = t6; v[6] = t7; v[7] = t8;
+}
+
+/**
+ * Butterfly operation for the inverse slant transform.
+ */
+inline void slantButterflySSE2(__m128i s1, __m128i s2, __m128i &o1, __m128i &o2) {
+	o1 = _mm_add_epi32(s1, s2);
+	o2 = _mm_sub_epi32(s1, s2);
+}
+
+/**
+ * Reflection a,b = 1/2, 5/4 for the inverse slant transform.
+ */
+inline void slantReflectSSE2(__m128i s1, __m128i s2, __m128i &o1, __m128i &o2) {
+	const __m128i two = _mm_set1_epi32(2);
+	o1 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(s1, _mm_slli_epi32(s2, 1)), two), 2), s1);
+	o2 = _mm_sub_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(s1, 1), s2), two), 2), s2);
+}
+
+/**
+ * Reflection a,b = 1/2, 7/8 for the inverse slant transform.
+ */
+inline void slantPart4SSE2(__m128i s1, __m128i s2, __m128i &o1, __m128i &o2) {
+	const __m128i four = _mm_set1_epi32(4);
+	o1 = _mm_add_epi32(s2, _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(s1, 2), s2), four), 3));
+	o2 = _mm_add_epi32(s1, _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_sub_epi32(_mm_setzero_si128(), s1), _mm_slli_epi32(s2, 2)), four), 3));
+}
+
+/**
+ * Inverse 8-point slant transform of four columns at once, v[k] holding the
+ * k-th value of each column. The row pass rounds the results to half.
+ */
+template<bool compensate>
+inline void invSlant8SSE2(__m128i *v) {
+	// The values in the order of the arguments of IVI_INV_SLANT8
+	const __m128i s1 = v[0], s4 = v[1], s8 = v[2], s5 = v[3];
+	const __m128i s2 = v[4], s6 = v[5], s3 = v[6], s7 = v[7];
+	__m128i t1, t2, t3, t4, t5, t6, t7, t8;
+
+	slantPart4SSE2(s4, s5, t4, t5);
+
+	slantButterflySSE2(s1, t5, t1, t5); slantButterflySSE2(s2, s6, t2, t6);
+	slantButterflySSE2(s7, s3, t7, t3); slantButterflySSE2(t4, s8, t4, t8);
+
+	slantButterflySSE2(t1, t2, t1, t2); slantReflectSSE2(t4, t3, t4, t3);
+	slantButterflySSE2(t5, t6, t5, t6); slantReflectSSE2(t8, t7, t8, t7);
+	slantButterflySSE2(t1, t4, t1, t4); slantButterflySSE2(t2, t3, t2, t3);
+	slantButterflySSE2(t5, t8, t5, t8); slantButterflySSE2(t6, t7, t6, t7);
+
+	v[0] = t1; v[1] = t2; v[2] = t3; v[3] = t4;
+	v[4] = t5; v[5] = t6; v[6] = t7; v[7] = t8;
+
+	if (compensate) {
+		const __m128i one = _mm_set1_epi32(1);
+		for (int i = 0; i < 8; i++)
+			v[i] = _mm_srai_epi32(_mm_add_epi32(v[i], one), 1);
+	}
+}
+
+inline void invSlant8ColSSE2(__m128i *v) {
+	invSlant8SSE2<false>(v);
+}
+
+inline void invSlant8RowSSE2(__m128i *v) {
+	invSlant8SSE2<true>(v);
+}
+
+/**
+ * Transpose the 4x4 matrix of 32 bit values in src into dst.
+ */
+inline void transpose4x4SSE2(const __m128i *src, __m128i *dst) {
+	const __m128i a0 = _mm_unpacklo_epi32(src[0], src[1]);
+	const __m128i a1 = _mm_unpacklo_epi32(src[2], src[3]);
+	const __m128i a2 = _mm_unpackhi_epi32(src[0], src[1]);
+	const __m128i a3 = _mm_unpackhi_epi32(src[2], src[3]);
+
+	dst[0] = _mm_unpacklo_epi64(a0, a1);
+	dst[1] = _mm_unpackhi_epi64(a0, a1);
+	dst[2] = _mm_unpacklo_epi64(a2, a3);
+	dst[3] = _mm_unpackhi_epi64(a2, a3);
+}
+
+/**
+ * Truncate 32 bit values to 16 bits, and sign extend them again.
+ */
+inline __m128i truncateSSE2(__m128i value) {
+	return _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+}
+
+/**
+ * Two-dimensional 8x8 inverse transform: the columns are transformed first,
+ * then the rows.
+ *
+ * The C code skips the columns without coefficients according to the flags,
+ * and all rows without values. Transforming zeros gives zeros, so only the
+ * columns have to be masked here.
+ *
+ * @param preScale	double the first four values of the first four columns
+ *					before transforming them, as the Haar transform does
+ */
+template<void (*colTransform)(__m128i *), void (*rowTransform)(__m128i *), bool preScale>
+inline void inverse8x8SSE2(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i empty8 = _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i *)flags), zero);
+	const __m128i empty16 = _mm_unpacklo_epi8(empty8, empty8);
+	const __m128i emptyLeft = _mm_unpacklo_epi16(empty16, empty16);
+	const __m128i emptyRight = _mm_unpackhi_epi16(empty16, empty16);
+
+	__m128i left[8], right[8];
+	for (int i = 0; i < 8; i++) {
+		left[i] = _mm_andnot_si128(emptyLeft, _mm_loadu_si128((const __m128i *)(in + i * 8)));
+		right[i] = _mm_andnot_si128(emptyRight, _mm_loadu_si128((const __m128i *)(in + i * 8 + 4)));
+	}
+
+	if (preScale) {
+		for (int i = 0; i < 4; i++)
+			left[i] = _mm_slli_epi32(left[i], 1);
+	}
+
+	colTransform(left);
+	colTransform(right);
+
+	// Transpose so the rows are transformed as columns. top[k] and bottom[k]
+	// hold the k-th value of the rows 0 to 3 and 4 to 7.
+	__m128i top[8], bottom[8];
+	transpose4x4SSE2(left, top);
+	transpose4x4SSE2(right, top + 4);
+	transpose4x4SSE2(left + 4, bottom);
+	transpose4x4SSE2(right + 4, bottom + 4);
+
+	rowTransform(top);
+	rowTransform(bottom);
+
+	for (int half = 0; half < 2; half++) {
+		const __m128i *src = half ? bottom : top;
+		__m128i rowsLeft[4], rowsRight[4];
+		transpose4x4SSE2(src, rowsLeft);
+		transpose4x4SSE2(src + 4, rowsRight);
+
+		for (int i = 0; i < 4; i++, out += pitch) {
+			const __m128i row = _mm_packs_epi32(truncateSSE2(rowsLeft[i]), truncateSSE2(rowsRight[i]));
+			_mm_storeu_si128((__m128i *)out, row);
+		}
+	}
+}
+
+template<int size>
+inline __m128i loadRowSSE2(const int16 *src) {
+	if (size == 8)
+		return _mm_loadu_si128((const __m128i *)src);
+	else
+		return _mm_loadl_epi64((const __m128i *)src);
+}
+
+template<int size>
+inline void storeRowSSE2(int16 *dst, __m128i row) {
+	if (size == 8)
+		_mm_storeu_si128((__m128i *)dst, row);
+	else
+		_mm_storel_epi64((__m128i *)dst, row);
+}
+
+/**
+ * (a + b) >> 1 without overflowing 16 bits.
+ */
+inline __m128i average2SSE2(__m128i a, __m128i b) {
+	const __m128i carry = _mm_and_si128(_mm_and_si128(a, b), _mm_set1_epi16(1));
+	return _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(a, 1), _mm_srai_epi16(b, 1)), carry);
+}
+
+/**
+ * (a + b + c + d) >> 2 without overflowing 16 bits.
+ */
+inline __m128i average4SSE2(__m128i a, __m128i b, __m128i c, __m128i d) {
+	const __m128i three = _mm_set1_epi16(3);
+	const __m128i high = _mm_add_epi16(_mm_add_epi16(_mm_srai_epi16(a, 2), _mm_srai_epi16(b, 2)),
+	                                   _mm_add_epi16(_mm_srai_epi16(c, 2), _mm_srai_epi16(d, 2)));
+	const __m128i low = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a, three), _mm_and_si128(b, three)),
+	                                  _mm_add_epi16(_mm_and_si128(c, three), _mm_and_si128(d, three)));
+	return _mm_add_epi16(high, _mm_srli_epi16(low, 2));
+}
+
+/**
+ * Interpolate the rows of a block from the reference frame.
+ *
+ * @return	false for unknown interpolation types, which the C code ignores
+ */
+template<int size>
+inline bool predictSSE2(__m128i *rows, const int16 *refBuf, uint32 pitch, int mcType) {
+	switch (mcType) {
+	case 0: // fullpel (no interpolation)
+		for (int i = 0; i < size; i++, refBuf += pitch)
+			rows[i] = loadRowSSE2<size>(refBuf);
+		return true;
+	case 1: // horizontal halfpel interpolation
+		for (int i = 0; i < size; i++, refBuf += pitch)
+			rows[i] = average2SSE2(loadRowSSE2<size>(refBuf), loadRowSSE2<size>(refBuf + 1));
+		return true;
+	case 2: { // vertical halfpel interpolation
+		__m128i above = loadRowSSE2<size>(refBuf);
+		for (int i = 0; i < size; i++) {
+			refBuf += pitch;
+			const __m128i below = loadRowSSE2<size>(refBuf);
+			rows[i] = average2SSE2(above, below);
+			above = below;
+		}
+		return true;
+	}
+	case 3: { // vertical and horizontal halfpel interpolation
+		__m128i above = loadRowSSE2<size>(refBuf);
+		__m128i aboveNext = loadRowSSE2<size>(refBuf + 1);
+		for (int i = 0; i < size; i++) {
+			refBuf += pitch;
+			const __m128i below = loadRowSSE2<size>(refBuf);
+			const __m128i belowNext = loadRowSSE2<size>(refBuf + 1);
+			rows[i] = average4SSE2(above, aboveNext, below, belowNext);
+			above = below;
+			aboveNext = belowNext;
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+template<int size, bool delta>
+inline void applySSE2(int16 *buf, uint32 pitch, const __m128i *rows) {
+	for (int i = 0; i < size; i++, buf += pitch) {
+		if (delta)
+			storeRowSSE2<size>(buf, _mm_add_epi16(loadRowSSE2<size>(buf), rows[i]));
+		else
+			storeRowSSE2<size>(buf, rows[i]);
+	}
+}
+
+template<int size, bool delta>
+inline void mcSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	__m128i rows[size];
+	if (predictSSE2<size>(rows, refBuf, pitch, mcType))
+		applySSE2<size, delta>(buf, pitch, rows);
+}
+
+template<int size, bool delta>
+inline void mcAvgSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	__m128i rows[size], rows2[size];
+	if (!predictSSE2<size>(rows, refBuf, pitch, mcType))
+		return;
+	if (!predictSSE2<size>(rows2, refBuf2, pitch, mcType2)) {
+		// The C code adds nothing for an unknown second interpolation type
+		for (int i = 0; i < size; i++)
+			rows2[i] = _mm_setzero_si128();
+	}
+
+	for (int i = 0; i < size; i++)
+		rows[i] = _mm_srai_epi16(_mm_add_epi16(rows[i], rows2[i]), 1);
+	applySSE2<size, delta>(buf, pitch, rows);
+}
+
+} // End of anonymous namespace
+
+void ffIviInverseHaar8x8SSE2(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags) {
+	inverse8x8SSE2<invHaar8SSE2, invHaar8SSE2, true>(in, out, pitch, flags);
+}
+
+void ffIviInverseSlant8x8SSE2(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags) {
+	inverse8x8SSE2<invSlant8ColSSE2, invSlant8RowSSE2, false>(in, out, pitch, flags);
+}
+
+void ffIviMc8x8DeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcSSE2<8, true>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMc8x8NoDeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcSSE2<8, false>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMc4x4DeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcSSE2<4, true>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMc4x4NoDeltaSSE2(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType) {
+	mcSSE2<4, false>(buf, refBuf, pitch, mcType);
+}
+
+void ffIviMcAvg8x8DeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgSSE2<8, true>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+void ffIviMcAvg8x8NoDeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgSSE2<8, false>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+void ffIviMcAvg4x4DeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgSSE2<4, true>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+void ffIviMcAvg4x4NoDeltaSSE2(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2) {
+	mcAvgSSE2<4, false>(buf, refBuf, refBuf2, pitch, mcType, mcType2);
+}
+
+} // End of namespace Indeo
+} // End of namespace Image
@@ -517,6 +517,7 @@ int Indeo5Decoder::decode_gop_header() {
 
 			band->_is2dTrans = band->_invTransform == IndeoDSP::ffIviInverseSlant8x8 ||
 				band->_invTransform == IndeoDSP::ffIviInverseSlant4x4;
+			band->_invTransform = IndeoDSP::getInvTransform(band->_invTransform);
 
 			if (band->_transformSize != band->_blkSize) {
 				warning("transform and block size mismatch (%d != %d)", band->_transformSize, band->_blkSize);
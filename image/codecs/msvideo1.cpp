@@ -40,11 +40,14 @@ MSVideo1Decoder::MSVideo1Decoder(uint16 width, uint16 height, byte bitsPerPixel)
                                                           Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
 
 	_bitsPerPixel = bitsPerPixel;
+	_colorTable = 0;
 }
 
 MSVideo1Decoder::~MSVideo1Decoder() {
 	_surface->free();
 	delete _surface;
+
+	delete[] _colorTable;
 }
 
 void MSVideo1Decoder::decode8(Common::SeekableReadStream &stream) {
@@ -126,10 +129,11 @@ void MSVideo1Decoder::decode8(Common::SeekableReadStream &stream) {
     }
 }
 
+template<typename PixelInt>
 void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
     /* decoding parameters */
-    uint16 colors[8];
-    uint16 *pixels = (uint16 *)_surface->getPixels();
+    PixelInt colors[8];
+    PixelInt *pixels = (PixelInt *)_surface->getPixels();
     int32 stride = _surface->w;
 
     int32 skip_blocks = 0;
@@ -168,18 +172,15 @@ void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
                 uint16 flags = (byte_b << 8) | byte_a;
 
                 CHECK_STREAM_PTR(4);
-                colors[0] = stream.readUint16LE();
-                colors[1] = stream.readUint16LE();
+                uint16 color0 = stream.readUint16LE();
+                colors[0] = convertColor<PixelInt>(color0);
+                colors[1] = convertColor<PixelInt>(stream.readUint16LE());
 
-                if (colors[0] & 0x8000) {
+                if (color0 & 0x8000) {
                     /* 8-color encoding */
                     CHECK_STREAM_PTR(12);
-                    colors[2] = stream.readUint16LE();
-                    colors[3] = stream.readUint16LE();
-                    colors[4] = stream.readUint16LE();
-                    colors[5] = stream.readUint16LE();
-                    colors[6] = stream.readUint16LE();
-                    colors[7] = stream.readUint16LE();
+                    for (int i = 2; i < 8; i++)
+                        colors[i] = convertColor<PixelInt>(stream.readUint16LE());
 
                     for (int pixel_y = 0; pixel_y < 4; pixel_y++) {
                         for (int pixel_x = 0; pixel_x < 4; pixel_x++, flags >>= 1)
@@ -198,7 +199,7 @@ void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
                 }
             } else {
                 /* otherwise, it's a 1-color block */
-                colors[0] = (byte_b << 8) | byte_a;
+                colors[0] = convertColor<PixelInt>((byte_b << 8) | byte_a);
 
                 for (int pixel_y = 0; pixel_y < 4; pixel_y++) {
                     for (int pixel_x = 0; pixel_x < 4; pixel_x++)
@@ -216,10 +217,30 @@ void MSVideo1Decoder::decode16(Common::SeekableReadStream &stream) {
 const Graphics::Surface *MSVideo1Decoder::decodeFrame(Common::SeekableReadStream &stream) {
 	if (_bitsPerPixel == 8)
 		decode8(stream);
+	else if (_surface->format.bytesPerPixel == 2)
+		decode16<uint16>(stream);
 	else
-        decode16(stream);
+		decode16<uint32>(stream);
+
+	return _surface;
+}
+
+bool MSVideo1Decoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (format == _surface->format)
+		return true;
+
+	if (_bitsPerPixel == 8 || (format.bytesPerPixel != 2 && format.bytesPerPixel != 4))
+		return false;
+
+	delete[] _colorTable;
+	_colorTable = 0;
+
+	if (format != Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0))
+		_colorTable = createRGB555ConversionTable(format);
 
-    return _surface;
+	// Keep the previous frame, which the next one is drawn on
+	_surface->convertToInPlace(format);
+	return true;
 }
 
 } // End of namespace Image
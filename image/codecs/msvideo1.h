@@ -39,13 +39,21 @@ public:
 
 	const Graphics::Surface *decodeFrame(Common::SeekableReadStream &stream);
 	Graphics::PixelFormat getPixelFormat() const { return _surface->format; }
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
 private:
 	byte _bitsPerPixel;
 
 	Graphics::Surface *_surface;
+	uint32 *_colorTable;
+
+	template<typename PixelInt>
+	inline PixelInt convertColor(uint16 color) const {
+		return _colorTable ? _colorTable[color & 0x7FFF] : color;
+	}
 
 	void decode8(Common::SeekableReadStream &stream);
+	template<typename PixelInt>
 	void decode16(Common::SeekableReadStream &stream);
 };
 
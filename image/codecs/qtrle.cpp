@@ -43,6 +43,7 @@ QTRLEDecoder::QTRLEDecoder(uint16 width, uint16 height, byte bitsPerPixel) : Cod
 	_surface = 0;
 	_dirtyPalette = false;
 	_colorMap = 0;
+	_colorTable = 0;
 
 	// We need to ensure the width is a multiple of 4
 	_paddedWidth = width;
@@ -59,6 +60,7 @@ QTRLEDecoder::~QTRLEDecoder() {
 
 	delete[] _colorMap;
 	delete[] _ditherPalette;
+	delete[] _colorTable;
 }
 
 #define CHECK_STREAM_PTR(n) \
@@ -226,9 +228,10 @@ void QTRLEDecoder::decode8(Common::SeekableReadStream &stream, uint32 rowPtr, ui
 	}
 }
 
+template<typename PixelInt>
 void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange) {
 	uint32 pixelPtr = 0;
-	uint16 *rgb = (uint16 *)_surface->getPixels();
+	PixelInt *rgb = (PixelInt *)_surface->getPixels();
 
 	while (linesToChange--) {
 		CHECK_STREAM_PTR(2);
@@ -245,18 +248,24 @@ void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, u
 				CHECK_STREAM_PTR(2);
 
 				uint16 rgb16 = stream.readUint16BE();
+				PixelInt color = _colorTable ? _colorTable[rgb16 & 0x7FFF] : rgb16;
 
 				CHECK_PIXEL_PTR(rleCode);
 
 				while (rleCode--)
-					rgb[pixelPtr++] = rgb16;
+					rgb[pixelPtr++] = color;
 			} else {
 				CHECK_STREAM_PTR(rleCode * 2);
 				CHECK_PIXEL_PTR(rleCode);
 
 				// copy pixels directly to output
-				while (rleCode--)
-					rgb[pixelPtr++] = stream.readUint16BE();
+				if (_colorTable) {
+					while (rleCode--)
+						rgb[pixelPtr++] = _colorTable[stream.readUint16BE() & 0x7FFF];
+				} else {
+					while (rleCode--)
+						rgb[pixelPtr++] = stream.readUint16BE();
+				}
 			}
 		}
 
@@ -264,9 +273,10 @@ void QTRLEDecoder::decode16(Common::SeekableReadStream &stream, uint32 rowPtr, u
 	}
 }
 
+template<typename PixelInt>
 void QTRLEDecoder::decode24(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange) {
 	uint32 pixelPtr = 0;
-	uint32 *rgb = (uint32 *)_surface->getPixels();
+	PixelInt *rgb = (PixelInt *)_surface->getPixels();
 
 	while (linesToChange--) {
 		CHECK_STREAM_PTR(2);
@@ -286,7 +296,7 @@ void QTRLEDecoder::decode24(Common::SeekableReadStream &stream, uint32 rowPtr, u
 				byte r = stream.readByte();
 				byte g = stream.readByte();
 				byte b = stream.readByte();
-				uint32 color = _surface->format.RGBToColor(r, g, b);
+				PixelInt color = _surface->format.RGBToColor(r, g, b);
 
 				CHECK_PIXEL_PTR(rleCode);
 
@@ -375,9 +385,10 @@ void QTRLEDecoder::dither24(Common::SeekableReadStream &stream, uint32 rowPtr, u
 	}
 }
 
+template<typename PixelInt>
 void QTRLEDecoder::decode32(Common::SeekableReadStream &stream, uint32 rowPtr, uint32 linesToChange) {
 	uint32 pixelPtr = 0;
-	uint32 *rgb = (uint32 *)_surface->getPixels();
+	PixelInt *rgb = (PixelInt *)_surface->getPixels();
 
 	while (linesToChange--) {
 		CHECK_STREAM_PTR(2);
@@ -398,7 +409,7 @@ void QTRLEDecoder::decode32(Common::SeekableReadStream &stream, uint32 rowPtr, u
 				byte r = stream.readByte();
 				byte g = stream.readByte();
 				byte b = stream.readByte();
-				uint32 color = _surface->format.ARGBToColor(a, r, g, b);
+				PixelInt color = _surface->format.ARGBToColor(a, r, g, b);
 
 				CHECK_PIXEL_PTR(rleCode);
 
@@ -471,16 +482,24 @@ const Graphics::Surface *QTRLEDecoder::decodeFrame(Common::SeekableReadStream &s
 		decode8(stream, rowPtr, height);
 		break;
 	case 16:
-		decode16(stream, rowPtr, height);
+		if (_surface->format.bytesPerPixel == 2)
+			decode16<uint16>(stream, rowPtr, height);
+		else
+			decode16<uint32>(stream, rowPtr, height);
 		break;
 	case 24:
 		if (_ditherPalette)
 			dither24(stream, rowPtr, height);
+		else if (_surface->format.bytesPerPixel == 2)
+			decode24<uint16>(stream, rowPtr, height);
 		else
-			decode24(stream, rowPtr, height);
+			decode24<uint32>(stream, rowPtr, height);
 		break;
 	case 32:
-		decode32(stream, rowPtr, height);
+		if (_surface->format.bytesPerPixel == 2)
+			decode32<uint16>(stream, rowPtr, height);
+		else
+			decode32<uint32>(stream, rowPtr, height);
 		break;
 	default:
 		error("Unsupported QTRLE bits per pixel %d", _bitsPerPixel);
@@ -504,9 +523,13 @@ Graphics::PixelFormat QTRLEDecoder::getPixelFormat() const {
 	case 40:
 		return Graphics::PixelFormat::createFormatCLUT8();
 	case 16:
+		if (_outputFormat.bytesPerPixel != 0)
+			return _outputFormat;
 		return Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
 	case 24:
 	case 32:
+		if (_outputFormat.bytesPerPixel != 0)
+			return _outputFormat;
 		return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
 	default:
 		error("Unsupported QTRLE bits per pixel %d", _bitsPerPixel);
@@ -515,6 +538,29 @@ Graphics::PixelFormat QTRLEDecoder::getPixelFormat() const {
 	return Graphics::PixelFormat();
 }
 
+bool QTRLEDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (format == getPixelFormat())
+		return true;
+
+	// Only the high color depths can be converted, and only until
+	// decoding started
+	if (_surface || _ditherPalette || (format.bytesPerPixel != 2 && format.bytesPerPixel != 4))
+		return false;
+
+	if (_bitsPerPixel != 16 && _bitsPerPixel != 24 && _bitsPerPixel != 32)
+		return false;
+
+	_outputFormat = format;
+
+	delete[] _colorTable;
+	_colorTable = 0;
+
+	if (_bitsPerPixel == 16 && format != Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0))
+		_colorTable = createRGB555ConversionTable(format);
+
+	return true;
+}
+
 bool QTRLEDecoder::canDither(DitherType type) const {
 	// Only 24-bit dithering is implemented at the moment
 	return type == kDitherTypeQT && _bitsPerPixel == 24;
@@ -36,6 +36,7 @@ RPZADecoder::RPZADecoder(uint16 width, uint16 height) : Codec() {
 	_ditherPalette = 0;
 	_dirtyPalette = false;
 	_colorMap = 0;
+	_colorTable = 0;
 	_width = width;
 	_height = height;
 	_blockWidth = (width + 3) / 4;
@@ -51,6 +52,7 @@ RPZADecoder::~RPZADecoder() {
 
 	delete[] _ditherPalette;
 	delete[] _colorMap;
+	delete[] _colorTable;
 }
 
 #define ADVANCE_BLOCK() \
@@ -131,6 +133,50 @@ struct BlockDecoderRaw {
 	}
 };
 
+/**
+ * Converts the RGB555 colors with a table, which is passed instead of the
+ * dither color map.
+ */
+template<typename PixelInt>
+struct BlockDecoderConvert {
+	static inline void drawFillBlock(PixelInt *blockPtr, uint16 pitch, uint16 color, const byte *colorMap) {
+		const PixelInt pixel = ((const uint32 *)colorMap)[color & 0x7FFF];
+
+		for (int y = 0; y < 4; y++, blockPtr += pitch) {
+			blockPtr[0] = pixel;
+			blockPtr[1] = pixel;
+			blockPtr[2] = pixel;
+			blockPtr[3] = pixel;
+		}
+	}
+
+	static inline void drawRawBlock(PixelInt *blockPtr, uint16 pitch, const uint16 (&colors)[16], const byte *colorMap) {
+		const uint32 *colorTable = (const uint32 *)colorMap;
+
+		for (int y = 0; y < 4; y++, blockPtr += pitch) {
+			blockPtr[0] = colorTable[colors[y * 4 + 0] & 0x7FFF];
+			blockPtr[1] = colorTable[colors[y * 4 + 1] & 0x7FFF];
+			blockPtr[2] = colorTable[colors[y * 4 + 2] & 0x7FFF];
+			blockPtr[3] = colorTable[colors[y * 4 + 3] & 0x7FFF];
+		}
+	}
+
+	static inline void drawBlendBlock(PixelInt *blockPtr, uint16 pitch, const uint16 (&colors)[4], const byte (&indexes)[4], const byte *colorMap) {
+		const uint32 *colorTable = (const uint32 *)colorMap;
+		const PixelInt pixels[4] = {
+			(PixelInt)colorTable[colors[0]], (PixelInt)colorTable[colors[1]],
+			(PixelInt)colorTable[colors[2]], (PixelInt)colorTable[colors[3]]
+		};
+
+		for (int y = 0; y < 4; y++, blockPtr += pitch) {
+			blockPtr[0] = pixels[(indexes[y] >> 6) & 0x03];
+			blockPtr[1] = pixels[(indexes[y] >> 4) & 0x03];
+			blockPtr[2] = pixels[(indexes[y] >> 2) & 0x03];
+			blockPtr[3] = pixels[(indexes[y] >> 0) & 0x03];
+		}
+	}
+};
+
 struct BlockDecoderDither {
 	static inline void drawFillBlock(byte *blockPtr, uint16 pitch, uint16 color, const byte *colorMap) {
 		const byte *mapOffset = colorMap + (color >> 1);
@@ -341,12 +387,35 @@ const Graphics::Surface *RPZADecoder::decodeFrame(Common::SeekableReadStream &st
 
 	if (_colorMap)
 		decodeFrameTmpl<byte, BlockDecoderDither>(stream, (byte *)_surface->getPixels(), _surface->pitch, _blockWidth, _blockHeight, _colorMap);
-	else
+	else if (!_colorTable)
 		decodeFrameTmpl<uint16, BlockDecoderRaw>(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, _colorMap);
+	else if (_format.bytesPerPixel == 2)
+		decodeFrameTmpl<uint16, BlockDecoderConvert<uint16> >(stream, (uint16 *)_surface->getPixels(), _surface->pitch / 2, _blockWidth, _blockHeight, (const byte *)_colorTable);
+	else
+		decodeFrameTmpl<uint32, BlockDecoderConvert<uint32> >(stream, (uint32 *)_surface->getPixels(), _surface->pitch / 4, _blockWidth, _blockHeight, (const byte *)_colorTable);
 
 	return _surface;
 }
 
+bool RPZADecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (format == _format)
+		return true;
+
+	// The format cannot be changed anymore once decoding started
+	if (_surface || _colorMap || (format.bytesPerPixel != 2 && format.bytesPerPixel != 4))
+		return false;
+
+	_format = format;
+
+	delete[] _colorTable;
+	_colorTable = 0;
+
+	if (format != Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0))
+		_colorTable = createRGB555ConversionTable(format);
+
+	return true;
+}
+
 bool RPZADecoder::canDither(DitherType type) const {
 	return type == kDitherTypeQT;
 }
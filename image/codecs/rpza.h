@@ -40,6 +40,7 @@ public:
 
 	const Graphics::Surface *decodeFrame(Common::SeekableReadStream &stream);
 	Graphics::PixelFormat getPixelFormat() const { return _format; }
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
 	bool containsPalette() const { return _ditherPalette != 0; }
 	const byte *getPalette() { _dirtyPalette = false; return _ditherPalette; }
@@ -53,6 +54,7 @@ private:
 	byte *_ditherPalette;
 	bool _dirtyPalette;
 	byte *_colorMap;
+	uint32 *_colorTable;
 	uint16 _width, _height;
 	uint16 _blockWidth, _blockHeight;
 };
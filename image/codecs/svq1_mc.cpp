@@ -0,0 +1,148 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Sorenson Video 1 Codec
+// Based off FFmpeg's SVQ1 decoder (written by Arpi and Nick Kurshev)
+
+#include "common/endian.h"
+#include "common/system.h"
+
+#include "image/codecs/svq1_mc_intern.h"
+
+namespace Image {
+
+void svq1PutPixels8(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++) {
+		*((uint32 *)block) = READ_UINT32(pixels);
+		*((uint32 *)(block + 4)) = READ_UINT32(pixels + 4);
+		pixels += lineSize;
+		block += lineSize;
+	}
+}
+
+static inline uint32 rndAvg32(uint32 a, uint32 b) {
+	return (a | b) - (((a ^ b) & ~0x01010101) >> 1);
+}
+
+static void putPixels8L2(byte *dst, const byte *src1, const byte *src2,
+		int dstStride, int srcStride1, int srcStride2, int h) {
+	for (int i = 0; i < h; i++) {
+		uint32 a = READ_UINT32(&src1[srcStride1 * i]);
+		uint32 b = READ_UINT32(&src2[srcStride2 * i]);
+		*((uint32 *)&dst[dstStride * i]) = rndAvg32(a, b);
+		a = READ_UINT32(&src1[srcStride1 * i + 4]);
+		b = READ_UINT32(&src2[srcStride2 * i + 4]);
+		*((uint32 *)&dst[dstStride * i + 4]) = rndAvg32(a, b);
+	}
+}
+
+void svq1PutPixels8X2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels8L2(block, pixels, pixels + 1, lineSize, lineSize, lineSize, h);
+}
+
+void svq1PutPixels8Y2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels8L2(block, pixels, pixels + lineSize, lineSize, lineSize, lineSize, h);
+}
+
+void svq1PutPixels8XY2(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int j = 0; j < 2; j++) {
+		uint32 a = READ_UINT32(pixels);
+		uint32 b = READ_UINT32(pixels + 1);
+		uint32 l0 = (a & 0x03030303UL) + (b & 0x03030303UL) + 0x02020202UL;
+		uint32 h0 = ((a & 0xFCFCFCFCUL) >> 2) + ((b & 0xFCFCFCFCUL) >> 2);
+
+		pixels += lineSize;
+
+		for (int i = 0; i < h; i += 2) {
+			a = READ_UINT32(pixels);
+			b = READ_UINT32(pixels + 1);
+			uint32 l1 = (a & 0x03030303UL) + (b & 0x03030303UL);
+			uint32 h1 = ((a & 0xFCFCFCFCUL) >> 2) + ((b & 0xFCFCFCFCUL) >> 2);
+			*((uint32 *)block) = h0 + h1 + (((l0 + l1) >> 2) & 0x0F0F0F0FUL);
+			pixels += lineSize;
+			block += lineSize;
+			a = READ_UINT32(pixels);
+			b = READ_UINT32(pixels + 1);
+			l0 = (a & 0x03030303UL) + (b & 0x03030303UL) + 0x02020202UL;
+			h0 = ((a & 0xFCFCFCFCUL) >> 2) + ((b & 0xFCFCFCFCUL) >> 2);
+			*((uint32 *)block) = h0 + h1 + (((l0 + l1) >> 2) & 0x0F0F0F0FUL);
+			pixels += lineSize;
+			block += lineSize;
+		}
+
+		pixels += 4 - lineSize * (h + 1);
+		block += 4 - lineSize * h;
+	}
+}
+
+void svq1PutPixels16(byte *block, const byte *pixels, int lineSize, int h) {
+	svq1PutPixels8(block, pixels, lineSize, h);
+	svq1PutPixels8(block + 8, pixels + 8, lineSize, h);
+}
+
+void svq1PutPixels16X2(byte *block, const byte *pixels, int lineSize, int h) {
+	svq1PutPixels8X2(block, pixels, lineSize, h);
+	svq1PutPixels8X2(block + 8, pixels + 8, lineSize, h);
+}
+
+void svq1PutPixels16Y2(byte *block, const byte *pixels, int lineSize, int h) {
+	svq1PutPixels8Y2(block, pixels, lineSize, h);
+	svq1PutPixels8Y2(block + 8, pixels + 8, lineSize, h);
+}
+
+void svq1PutPixels16XY2(byte *block, const byte *pixels, int lineSize, int h) {
+	svq1PutPixels8XY2(block, pixels, lineSize, h);
+	svq1PutPixels8XY2(block + 8, pixels + 8, lineSize, h);
+}
+
+#define SVQ1_PROCS(suffix) { \
+		{ &svq1PutPixels8 ## suffix, &svq1PutPixels8X2 ## suffix, &svq1PutPixels8Y2 ## suffix, &svq1PutPixels8XY2 ## suffix }, \
+		{ &svq1PutPixels16 ## suffix, &svq1PutPixels16X2 ## suffix, &svq1PutPixels16Y2 ## suffix, &svq1PutPixels16XY2 ## suffix } \
+	}
+
+const SVQ1MotionProcs &getSVQ1MotionProcs() {
+	static const SVQ1MotionProcs procsC = {
+		{ &svq1PutPixels8, &svq1PutPixels8X2, &svq1PutPixels8Y2, &svq1PutPixels8XY2 },
+		{ &svq1PutPixels16, &svq1PutPixels16X2, &svq1PutPixels16Y2, &svq1PutPixels16XY2 }
+	};
+#ifdef SCUMMVM_NEON
+	static const SVQ1MotionProcs procsNEON = SVQ1_PROCS(NEON);
+#endif
+#ifdef SCUMMVM_SSE2
+	static const SVQ1MotionProcs procsSSE2 = SVQ1_PROCS(SSE2);
+#endif
+
+	const OSystem::CpuExtension cpuExtension = OSystem::getCpuExtension();
+#ifdef SCUMMVM_SSE2
+	if (cpuExtension >= OSystem::kCpuExtensionSSE2)
+		return procsSSE2;
+#endif
+#ifdef SCUMMVM_NEON
+	if (cpuExtension == OSystem::kCpuExtensionNEON)
+		return procsNEON;
+#endif
+	return procsC;
+}
+
+#undef SVQ1_PROCS
+
+} // End of namespace Image
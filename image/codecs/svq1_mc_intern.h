@@ -0,0 +1,91 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef IMAGE_CODECS_SVQ1_MC_INTERN_H
+#define IMAGE_CODECS_SVQ1_MC_INTERN_H
+
+#include "common/scummsys.h"
+
+namespace Image {
+
+/**
+ * Copy a block of h rows from pixels to block, both using the same pitch,
+ * with halfpel interpolation rounding like (a + b + 1) >> 1.
+ *
+ * The horizontal variants read one pixel more per row, the vertical ones
+ * one row more than they write.
+ */
+typedef void (*SVQ1PutPixelsProc)(byte *block, const byte *pixels, int lineSize, int h);
+
+/**
+ * The motion compensation functions of SVQ1, indexed by the halfpel
+ * position ((mv.y & 1) << 1) + (mv.x & 1).
+ *
+ * The results of the kernels are identical to the ones of the plain C
+ * versions.
+ */
+struct SVQ1MotionProcs {
+	/** Functions for blocks 8 pixels wide. */
+	SVQ1PutPixelsProc put8[4];
+	/** Functions for blocks 16 pixels wide. */
+	SVQ1PutPixelsProc put16[4];
+};
+
+/**
+ * Return the fastest kernels for the host CPU.
+ */
+const SVQ1MotionProcs &getSVQ1MotionProcs();
+
+void svq1PutPixels8(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8X2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8Y2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8XY2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16X2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16Y2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16XY2(byte *block, const byte *pixels, int lineSize, int h);
+
+#ifdef SCUMMVM_SSE2
+void svq1PutPixels8SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8X2SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8Y2SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8XY2SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16X2SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16Y2SSE2(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16XY2SSE2(byte *block, const byte *pixels, int lineSize, int h);
+#endif
+
+#ifdef SCUMMVM_NEON
+void svq1PutPixels8NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8X2NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8Y2NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels8XY2NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16X2NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16Y2NEON(byte *block, const byte *pixels, int lineSize, int h);
+void svq1PutPixels16XY2NEON(byte *block, const byte *pixels, int lineSize, int h);
+#endif
+
+} // End of namespace Image
+
+#endif
@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "image/codecs/svq1_mc_intern.h"
+
+#include <arm_neon.h>
+
+namespace Image {
+
+namespace {
+
+inline void putPixels8NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++, block += lineSize, pixels += lineSize)
+		vst1_u8(block, vld1_u8(pixels));
+}
+
+inline void putPixels16NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++, block += lineSize, pixels += lineSize)
+		vst1q_u8(block, vld1q_u8(pixels));
+}
+
+inline void putPixels8X2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++, block += lineSize, pixels += lineSize)
+		vst1_u8(block, vrhadd_u8(vld1_u8(pixels), vld1_u8(pixels + 1)));
+}
+
+inline void putPixels16X2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++, block += lineSize, pixels += lineSize)
+		vst1q_u8(block, vrhaddq_u8(vld1q_u8(pixels), vld1q_u8(pixels + 1)));
+}
+
+inline void putPixels8Y2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	uint8x8_t above = vld1_u8(pixels);
+	for (int i = 0; i < h; i++, block += lineSize) {
+		pixels += lineSize;
+		const uint8x8_t below = vld1_u8(pixels);
+		vst1_u8(block, vrhadd_u8(above, below));
+		above = below;
+	}
+}
+
+inline void putPixels16Y2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	uint8x16_t above = vld1q_u8(pixels);
+	for (int i = 0; i < h; i++, block += lineSize) {
+		pixels += lineSize;
+		const uint8x16_t below = vld1q_u8(pixels);
+		vst1q_u8(block, vrhaddq_u8(above, below));
+		above = below;
+	}
+}
+
+inline void putPixels8XY2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	uint16x8_t above = vaddl_u8(vld1_u8(pixels), vld1_u8(pixels + 1));
+	for (int i = 0; i < h; i++, block += lineSize) {
+		pixels += lineSize;
+		const uint16x8_t below = vaddl_u8(vld1_u8(pixels), vld1_u8(pixels + 1));
+		// vrshrn rounds by adding 2 before shifting
+		vst1_u8(block, vrshrn_n_u16(vaddq_u16(above, below), 2));
+		above = below;
+	}
+}
+
+inline void putPixels16XY2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	uint8x16_t a = vld1q_u8(pixels);
+	uint8x16_t b = vld1q_u8(pixels + 1);
+	uint16x8_t aboveLo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+	uint16x8_t aboveHi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+
+	for (int i = 0; i < h; i++, block += lineSize) {
+		pixels += lineSize;
+		a = vld1q_u8(pixels);
+		b = vld1q_u8(pixels + 1);
+		const uint16x8_t belowLo = vaddl_u8(vget_low_u8(a), vget_low_u8(b));
+		const uint16x8_t belowHi = vaddl_u8(vget_high_u8(a), vget_high_u8(b));
+
+		vst1q_u8(block, vcombine_u8(vrshrn_n_u16(vaddq_u16(aboveLo, belowLo), 2),
+		                            vrshrn_n_u16(vaddq_u16(aboveHi, belowHi), 2)));
+		aboveLo = belowLo;
+		aboveHi = belowHi;
+	}
+}
+
+} // End of anonymous namespace
+
+void svq1PutPixels8NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels8NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels8X2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels8X2NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels8Y2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels8Y2NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels8XY2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels8XY2NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels16NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16X2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels16X2NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16Y2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels16Y2NEON(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16XY2NEON(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixels16XY2NEON(block, pixels, lineSize, h);
+}
+
+} // End of namespace Image
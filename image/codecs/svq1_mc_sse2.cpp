@@ -0,0 +1,133 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "image/codecs/svq1_mc_intern.h"
+
+#include <emmintrin.h>
+
+namespace Image {
+
+namespace {
+
+template<int width>
+inline __m128i loadSSE2(const byte *src) {
+	if (width == 16)
+		return _mm_loadu_si128((const __m128i *)src);
+	else
+		return _mm_loadl_epi64((const __m128i *)src);
+}
+
+template<int width>
+inline void storeSSE2(byte *dst, __m128i value) {
+	if (width == 16)
+		_mm_storeu_si128((__m128i *)dst, value);
+	else
+		_mm_storel_epi64((__m128i *)dst, value);
+}
+
+template<int width>
+inline void putPixelsSSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++, block += lineSize, pixels += lineSize)
+		storeSSE2<width>(block, loadSSE2<width>(pixels));
+}
+
+template<int width>
+inline void putPixelsX2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	for (int i = 0; i < h; i++, block += lineSize, pixels += lineSize)
+		storeSSE2<width>(block, _mm_avg_epu8(loadSSE2<width>(pixels), loadSSE2<width>(pixels + 1)));
+}
+
+template<int width>
+inline void putPixelsY2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	__m128i above = loadSSE2<width>(pixels);
+	for (int i = 0; i < h; i++, block += lineSize) {
+		pixels += lineSize;
+		const __m128i below = loadSSE2<width>(pixels);
+		storeSSE2<width>(block, _mm_avg_epu8(above, below));
+		above = below;
+	}
+}
+
+/**
+ * Sum of the horizontally neighboring pixels, widened to 16 bits.
+ */
+inline void sumPairSSE2(const __m128i &a, const __m128i &b, __m128i &lo, __m128i &hi) {
+	const __m128i zero = _mm_setzero_si128();
+	lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+	hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+}
+
+template<int width>
+inline void putPixelsXY2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	const __m128i two = _mm_set1_epi16(2);
+	__m128i aboveLo, aboveHi;
+	sumPairSSE2(loadSSE2<width>(pixels), loadSSE2<width>(pixels + 1), aboveLo, aboveHi);
+
+	for (int i = 0; i < h; i++, block += lineSize) {
+		pixels += lineSize;
+		__m128i belowLo, belowHi;
+		sumPairSSE2(loadSSE2<width>(pixels), loadSSE2<width>(pixels + 1), belowLo, belowHi);
+
+		const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(aboveLo, belowLo), two), 2);
+		const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(aboveHi, belowHi), two), 2);
+		storeSSE2<width>(block, _mm_packus_epi16(lo, hi));
+
+		aboveLo = belowLo;
+		aboveHi = belowHi;
+	}
+}
+
+} // End of anonymous namespace
+
+void svq1PutPixels8SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsSSE2<8>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels8X2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsX2SSE2<8>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels8Y2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsY2SSE2<8>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels8XY2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsXY2SSE2<8>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsSSE2<16>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16X2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsX2SSE2<16>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16Y2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsY2SSE2<16>(block, pixels, lineSize, h);
+}
+
+void svq1PutPixels16XY2SSE2(byte *block, const byte *pixels, int lineSize, int h) {
+	putPixelsXY2SSE2<16>(block, pixels, lineSize, h);
+}
+
+} // End of namespace Image
@@ -23,12 +23,27 @@ MODULE_OBJS := \
 	codecs/rpza.o \
 	codecs/smc.o \
 	codecs/svq1.o \
+	codecs/svq1_mc.o \
 	codecs/truemotion1.o \
 	codecs/indeo/indeo.o \
 	codecs/indeo/indeo_dsp.o \
 	codecs/indeo/mem.o \
 	codecs/indeo/vlc.o
 
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	codecs/svq1_mc_sse2.o \
+	codecs/indeo/indeo_dsp_sse2.o
+$(MODULE)/codecs/svq1_mc_sse2.o: CXXFLAGS += -msse2
+$(MODULE)/codecs/indeo/indeo_dsp_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	codecs/svq1_mc_neon.o \
+	codecs/indeo/indeo_dsp_neon.o
+endif
+
 ifdef USE_MPEG2
 MODULE_OBJS += \
 	codecs/mpeg.o
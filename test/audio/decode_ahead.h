@@ -0,0 +1,81 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decode_ahead.h"
+
+#include "helper.h"
+
+class DecodeAheadTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_decode_ahead_mono() {
+		checkDecodeAhead(11025, false);
+	}
+
+	void test_decode_ahead_stereo() {
+		checkDecodeAhead(22050, true);
+	}
+
+	void test_seek() {
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(22050, 2, &sine, true, true);
+		Audio::DecodeAheadAudioStream *stream = Audio::makeDecodeAheadStream(s, 100);
+		int16 buffer[1000];
+
+		stream->decodeAhead();
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, 1000), 1000);
+
+		// Seeking drops the buffered samples
+		TS_ASSERT(stream->seek(Audio::Timestamp(1000, 1000)));
+		TS_ASSERT_EQUALS(stream->getBufferedSamples(), (uint32)0);
+		stream->decodeAhead();
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, 1000), 1000);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine + 22050 * 2, 1000 * sizeof(int16)), 0);
+
+		TS_ASSERT(stream->rewind());
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, 1000), 1000);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine, 1000 * sizeof(int16)), 0);
+		TS_ASSERT_EQUALS(stream->getLength(), s->getLength());
+
+		delete stream;
+		delete[] sine;
+	}
+
+private:
+	void checkDecodeAhead(const int sampleRate, const bool isStereo) {
+		const int samples = sampleRate * 3 * (isStereo ? 2 : 1);
+
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(sampleRate, 3, &sine, false, isStereo);
+		Audio::DecodeAheadAudioStream *stream = Audio::makeDecodeAheadStream(s, 250);
+
+		TS_ASSERT_EQUALS(stream->isStereo(), isStereo);
+		TS_ASSERT_EQUALS(stream->getRate(), sampleRate);
+		TS_ASSERT_EQUALS(stream->endOfData(), false);
+
+		int16 *buffer = new int16[samples];
+		int pos = 0;
+
+		// Alternate between decoding ahead and reading, with reads both
+		// smaller and larger than the buffer, so the buffer wraps around and
+		// runs dry.
+		for (uint i = 0; pos < samples; i++) {
+			if (i % 3 != 2) {
+				stream->decodeAhead();
+				TS_ASSERT(stream->getBufferedSamples() > 0);
+				TS_ASSERT(stream->getBufferedSamples() <= (uint32)(samples - pos));
+			}
+
+			const int count = MIN(samples - pos, (i % 4 == 3) ? sampleRate : 1234);
+			TS_ASSERT_EQUALS(stream->readBuffer(buffer + pos, count), count);
+			pos += count;
+		}
+
+		TS_ASSERT_EQUALS(memcmp(buffer, sine, samples * sizeof(int16)), 0);
+		TS_ASSERT_EQUALS(stream->endOfData(), true);
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, 100), 0);
+
+		delete[] buffer;
+		delete stream;
+		delete[] sine;
+	}
+};
@@ -0,0 +1,251 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "audio/rate_intern.h"
+
+#include "helper.h"
+#include "test/simd_helper.h"
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+private:
+	TestRandom _rnd;
+
+	int16 nextSample() {
+		const uint32 r = _rnd.next();
+		// Favour extreme values to exercise clamping
+		switch ((r >> 24) & 7) {
+		case 0:
+			return 32767;
+		case 1:
+			return -32768;
+		default:
+			return (int16)r;
+		}
+	}
+
+	void checkMixBufferProc(Audio::MixBufferProc proc, bool stereo, bool reverseStereo) {
+		Audio::MixBufferProc ref = Audio::getMixBufferProcC(stereo, reverseStereo);
+		const Audio::st_volume_t volumes[] = { 0, 1, 127, 255, Audio::Mixer::kMaxMixerVolume };
+
+		for (uint frames = 0; frames < 70; frames += 3) {
+			for (uint v = 0; v < ARRAYSIZE(volumes); ++v) {
+				int16 in[140], out[140], expected[140];
+				for (uint i = 0; i < ARRAYSIZE(in); ++i) {
+					in[i] = nextSample();
+					out[i] = expected[i] = nextSample();
+				}
+
+				const Audio::st_volume_t volL = volumes[v];
+				const Audio::st_volume_t volR = volumes[ARRAYSIZE(volumes) - 1 - v];
+				ref(expected, in, frames, volL, volR);
+				proc(out, in, frames, volL, volR);
+				TS_ASSERT_EQUALS(memcmp(out, expected, sizeof(out)), 0);
+			}
+		}
+	}
+
+	void checkMixBufferProcs(Audio::MixBufferProc (*getProc)(bool, bool)) {
+		_rnd.setSeed(1);
+		checkMixBufferProc(getProc(false, false), false, false);
+		checkMixBufferProc(getProc(true, false), true, false);
+		checkMixBufferProc(getProc(true, true), true, true);
+	}
+
+	void linearConverterTestTemplate(const int inRate, const int outRate, const bool isStereo, const uint chunkFrames) {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, &sine, false, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo);
+
+		const int channels = isStereo ? 2 : 1;
+		const int inFrames = inRate;
+		const int outFrames = (int)(((int64)inFrames * outRate) / inRate) - 2;
+		int16 *buffer = new int16[outFrames * 2];
+		memset(buffer, 0, outFrames * 2 * sizeof(int16));
+
+		int16 *ptr = buffer;
+		int left = outFrames;
+		while (left > 0) {
+			const int frames = converter->flow(*s, ptr, MIN<int>(chunkFrames, left), Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume / 2);
+			TS_ASSERT(frames > 0);
+			if (frames <= 0)
+				break;
+			ptr += frames * 2;
+			left -= frames;
+		}
+
+		// Reference linear interpolation, with 15 fractional bits
+		int pos = 1 << 15;
+		const int inc = (inRate << 15) / outRate;
+		int last0 = 0, last1 = 0, cur0 = 0, cur1 = 0;
+		const int16 *in = sine;
+		for (int i = 0; i < outFrames; ++i) {
+			while (pos >= (1 << 15)) {
+				last0 = cur0;
+				cur0 = *in++;
+				if (isStereo) {
+					last1 = cur1;
+					cur1 = *in++;
+				}
+				pos -= 1 << 15;
+			}
+
+			const int16 out0 = (int16)(last0 + (((cur0 - last0) * pos + (1 << 14)) >> 15));
+			const int16 out1 = isStereo ? (int16)(last1 + (((cur1 - last1) * pos + (1 << 14)) >> 15)) : out0;
+			TS_ASSERT_EQUALS(buffer[i * 2 + 0], out0);
+			TS_ASSERT_EQUALS(buffer[i * 2 + 1], out1 / 2);
+			if (buffer[i * 2 + 0] != out0 || buffer[i * 2 + 1] != out1 / 2)
+				break;
+
+			pos += inc;
+		}
+
+		TS_ASSERT(in <= sine + inFrames * channels);
+
+		delete converter;
+		delete[] buffer;
+		delete[] sine;
+		delete s;
+	}
+
+	/**
+	 * Resample one second of a mono sine tone and return the level of the
+	 * strongest image of it (at inRate - freq), relative to the tone
+	 * itself, in dB.
+	 */
+	double measureImageLevel(Audio::RateConverterQuality quality, const int inRate, const int outRate, const double freq) {
+		int16 *tone = (int16 *)malloc(inRate * sizeof(int16));
+		for (int i = 0; i < inRate; ++i)
+			WRITE_LE_UINT16(&tone[i], (int16)(sin(2 * M_PI * freq * i / inRate) * 16000));
+
+		Common::SeekableReadStream *data = new Common::MemoryReadStream((const byte *)tone, inRate * sizeof(int16), DisposeAfterUse::YES);
+		Audio::SeekableAudioStream *s = Audio::makeRawStream(data, inRate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, quality);
+
+		const int outFrames = outRate / 2;
+		int16 *buffer = new int16[outFrames * 2];
+		memset(buffer, 0, outFrames * 2 * sizeof(int16));
+		TS_ASSERT_EQUALS(converter->flow(*s, buffer, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outFrames);
+
+		const double tone0 = goertzel(buffer, outFrames, freq, outRate);
+		const double image = goertzel(buffer, outFrames, inRate - freq, outRate);
+
+		delete converter;
+		delete[] buffer;
+		delete s;
+
+		return 20 * log10(image / tone0);
+	}
+
+	/** Magnitude of the given frequency in the left channel of a stereo buffer */
+	double goertzel(const int16 *buffer, int frames, double freq, int rate) {
+		const double coeff = 2 * cos(2 * M_PI * freq / rate);
+		double s1 = 0, s2 = 0;
+		// Skip the start, where the filters are still filling up
+		for (int i = 256; i < frames; ++i) {
+			const double s0 = buffer[i * 2] + coeff * s1 - s2;
+			s2 = s1;
+			s1 = s0;
+		}
+		return sqrt(s1 * s1 + s2 * s2 - coeff * s1 * s2);
+	}
+
+public:
+	void test_mix_buffer_c() {
+		// The optimized variants use the C version for the remaining
+		// frames, so this only checks the volume rounding.
+		int16 in[2] = { -1000, 1000 };
+		int16 out[2] = { 0, 0 };
+		Audio::getMixBufferProcC(true, false)(out, in, 1, 255, 255);
+		TS_ASSERT_EQUALS(out[0], (-1000 * 255) / 256);
+		TS_ASSERT_EQUALS(out[1], (1000 * 255) / 256);
+	}
+
+	void test_mix_buffer_sse2() {
+#ifdef SCUMMVM_SSE2
+		checkMixBufferProcs(&Audio::getMixBufferProcSSE2);
+#endif
+	}
+
+	void test_mix_buffer_avx2() {
+#ifdef SCUMMVM_AVX2
+		if (!hostHasAVX2())
+			return;
+		checkMixBufferProcs(&Audio::getMixBufferProcAVX2);
+#endif
+	}
+
+	void test_mix_buffer_neon() {
+#ifdef SCUMMVM_NEON
+		checkMixBufferProcs(&Audio::getMixBufferProcNEON);
+#endif
+	}
+
+	void test_dot_product() {
+		_rnd.setSeed(1);
+		int16 a[64], b[64];
+		for (uint i = 0; i < ARRAYSIZE(a); ++i) {
+			a[i] = nextSample();
+			// Filter coefficients are at most 1.0 in 2.14 fixed point
+			b[i] = nextSample() / 2;
+		}
+
+		const int32 expected = Audio::dotProductC(a, b, 32);
+#ifdef SCUMMVM_SSE2
+		TS_ASSERT_EQUALS(Audio::dotProductSSE2(a, b, 32), expected);
+		TS_ASSERT_EQUALS(Audio::dotProductSSE2(a + 16, b + 16, 16), Audio::dotProductC(a + 16, b + 16, 16));
+#endif
+#ifdef SCUMMVM_AVX2
+		if (hostHasAVX2())
+			TS_ASSERT_EQUALS(Audio::dotProductAVX2(a, b, 32), expected);
+#endif
+#ifdef SCUMMVM_NEON
+		TS_ASSERT_EQUALS(Audio::dotProductNEON(a, b, 32), expected);
+#endif
+	}
+
+	void test_polyphase_converter_dc() {
+		const int inRate = 11025, outRate = 48000;
+		int16 *dc = (int16 *)malloc(inRate * sizeof(int16));
+		for (int i = 0; i < inRate; ++i)
+			WRITE_LE_UINT16(&dc[i], 10000);
+
+		Common::SeekableReadStream *data = new Common::MemoryReadStream((const byte *)dc, inRate * sizeof(int16), DisposeAfterUse::YES);
+		Audio::SeekableAudioStream *s = Audio::makeRawStream(data, inRate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, false, false, Audio::kRateConverterQualityHigh);
+
+		int16 buffer[4000 * 2];
+		memset(buffer, 0, sizeof(buffer));
+		TS_ASSERT_EQUALS(converter->flow(*s, buffer, 4000, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 4000);
+		// Once the filter is filled, the signal passes at unity gain
+		for (int i = 300 * 2; i < 4000 * 2; ++i)
+			TS_ASSERT_DELTA(buffer[i], 10000, 2);
+
+		delete converter;
+		delete s;
+	}
+
+	void test_polyphase_converter_aliasing() {
+		// A 4 kHz tone at 11025 Hz has an image at 7025 Hz after upsampling,
+		// which the linear interpolation only attenuates partially.
+		const double linear = measureImageLevel(Audio::kRateConverterQualityLow, 11025, 44100, 4000);
+		const double medium = measureImageLevel(Audio::kRateConverterQualityMedium, 11025, 44100, 4000);
+		const double high = measureImageLevel(Audio::kRateConverterQualityHigh, 11025, 48000, 4000);
+
+		TS_ASSERT_LESS_THAN(linear, -5.0);
+		TS_ASSERT_LESS_THAN(medium, -40.0);
+		TS_ASSERT_LESS_THAN(high, -60.0);
+		TS_ASSERT_LESS_THAN(medium, linear - 30.0);
+	}
+
+	void test_linear_converter_mono() {
+		linearConverterTestTemplate(11025, 44100, false, 1024);
+		linearConverterTestTemplate(22050, 48000, false, 333);
+	}
+
+	void test_linear_converter_stereo() {
+		linearConverterTestTemplate(11025, 44100, true, 1024);
+		linearConverterTestTemplate(22050, 48000, true, 333);
+	}
+};
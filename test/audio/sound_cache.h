@@ -0,0 +1,106 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/sound_cache.h"
+
+#include "helper.h"
+
+class DecodedSoundCacheTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_cached_sound() {
+		Audio::DecodedSoundCache cache(1024 * 1024);
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, false, true);
+
+		TS_ASSERT(!cache.get("sine"));
+
+		Audio::SeekableAudioStream *first = cache.add("sine", s);
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)11025 * 2 * 2);
+		checkStream(first, sine, 11025 * 2);
+
+		// Streams of the same sound play independently
+		Audio::SeekableAudioStream *second = cache.get("sine");
+		TS_ASSERT(second);
+		TS_ASSERT_EQUALS(second->isStereo(), true);
+		TS_ASSERT_EQUALS(second->getRate(), 11025);
+		TS_ASSERT_EQUALS(second->getLength(), Audio::Timestamp(0, 11025, 11025));
+
+		TS_ASSERT(second->seek(Audio::Timestamp(500, 1000)));
+		int16 buffer[100];
+		TS_ASSERT_EQUALS(second->readBuffer(buffer, 100), 100);
+		TS_ASSERT_EQUALS(memcmp(buffer, sine + 11024, 100 * sizeof(int16)), 0);
+		TS_ASSERT(second->rewind());
+		checkStream(second, sine, 11025 * 2);
+
+		delete first;
+
+		// The streams keep the samples after they left the cache
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)0);
+		TS_ASSERT(!cache.get("sine"));
+		TS_ASSERT(second->rewind());
+		checkStream(second, sine, 11025 * 2);
+
+		delete second;
+		delete[] sine;
+	}
+
+	void test_lru() {
+		// Room for two sounds of one second
+		Audio::DecodedSoundCache cache(2 * 8000 * 2);
+		int16 *sines[3];
+		static const char *const names[] = { "a", "b", "c" };
+
+		for (int i = 0; i < 3; i++) {
+			Audio::SeekableAudioStream *s = createSineStream<int16>(8000, 1, &sines[i], false, false);
+			delete cache.add(names[i], s);
+
+			// Using "a" makes "b" the least recently used one
+			if (i == 1)
+				delete cache.get("a");
+		}
+
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)2 * 8000 * 2);
+		Audio::SeekableAudioStream *a = cache.get("a");
+		Audio::SeekableAudioStream *b = cache.get("b");
+		Audio::SeekableAudioStream *c = cache.get("c");
+		TS_ASSERT(a);
+		TS_ASSERT(!b);
+		TS_ASSERT(c);
+		checkStream(c, sines[2], 8000);
+
+		cache.remove("a");
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)8000 * 2);
+
+		delete a;
+		delete b;
+		delete c;
+		for (int i = 0; i < 3; i++)
+			delete[] sines[i];
+	}
+
+	void test_too_large() {
+		Audio::DecodedSoundCache cache(1000);
+		int16 *sine = 0;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(8000, 1, &sine, false, false);
+
+		// The stream is returned as is, from the start
+		Audio::SeekableAudioStream *stream = cache.add("sine", s);
+		TS_ASSERT_EQUALS(stream, s);
+		TS_ASSERT_EQUALS(cache.getSize(), (uint32)0);
+		TS_ASSERT(!cache.get("sine"));
+		checkStream(stream, sine, 8000);
+
+		delete stream;
+		delete[] sine;
+	}
+
+private:
+	void checkStream(Audio::SeekableAudioStream *stream, const int16 *samples, int numSamples) {
+		int16 *buffer = new int16[numSamples + 100];
+		TS_ASSERT_EQUALS(stream->readBuffer(buffer, numSamples + 100), numSamples);
+		TS_ASSERT_EQUALS(memcmp(buffer, samples, numSamples * sizeof(int16)), 0);
+		TS_ASSERT_EQUALS(stream->endOfData(), true);
+		delete[] buffer;
+	}
+};
@@ -0,0 +1,77 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/config-manager.h"
+#include "common/memstream.h"
+
+class ConfigManagerTestSuite : public CxxTest::TestSuite {
+public:
+	void loadString(const char *config) {
+		Common::MemoryReadStream stream((const byte *)config, strlen(config));
+		ConfMan.loadFromStream(stream);
+	}
+
+	void checkDomains() {
+		TS_ASSERT_EQUALS(ConfMan.get("language", "scummvm"), "en");
+		TS_ASSERT_EQUALS(ConfMan.get("gfx_mode", "scummvm"), "2x");
+		TS_ASSERT_EQUALS(ConfMan.get("gameid", "monkey"), "monkey");
+		TS_ASSERT_EQUALS(ConfMan.get("description", "monkey"), "The Secret of Monkey Island");
+		TS_ASSERT_EQUALS(ConfMan.get("path", "monkey"), "/games/monkey = 1");
+		TS_ASSERT_EQUALS(ConfMan.get("gameid", "sky"), "sky");
+		TS_ASSERT(ConfMan.hasGameDomain("monkey"));
+		TS_ASSERT(ConfMan.hasGameDomain("sky"));
+		TS_ASSERT(ConfMan.hasMiscDomain("misc-domain"));
+		TS_ASSERT_EQUALS(ConfMan.get("value", "misc-domain"), "");
+
+		const Common::ConfigManager::Domain *monkey = ConfMan.getDomain("monkey");
+		TS_ASSERT(monkey);
+		TS_ASSERT_EQUALS(monkey->getDomainComment(), "# Games\n");
+		TS_ASSERT_EQUALS(monkey->getKVComment("path"), "# The path\n# Second line\n");
+		TS_ASSERT(!monkey->hasKVComment("gameid"));
+
+		// Comments of one domain must not show up in the next one
+		const Common::ConfigManager::Domain *sky = ConfMan.getDomain("sky");
+		TS_ASSERT(sky);
+		TS_ASSERT(!sky->hasKVComment("path"));
+	}
+
+	void test_load_save() {
+		// Mixed line breaks, spaces around keys and values, comments
+		loadString(
+			"[scummvm]\r\n"
+			"language=en\r\n"
+			"  gfx_mode =  2x \r"
+			"\n"
+			"[misc-domain]\n"
+			"value=\n"
+			"other=1\n"
+			"# Games\n"
+			"[monkey]\n"
+			"gameid=monkey\n"
+			"description=The Secret of Monkey Island\n"
+			"# The path\n"
+			"# Second line\n"
+			"path=/games/monkey = 1\n"
+			"\n"
+			"   \n"
+			"[sky]\n"
+			"gameid=sky\n"
+			"path=/games/sky");
+
+		checkDomains();
+
+		// The saved configuration must load back to the same one
+		Common::MemoryWriteStreamDynamic saved(DisposeAfterUse::YES);
+		ConfMan.saveToStream(saved);
+		saved.writeByte(0);
+
+		Common::String config((const char *)saved.getData());
+		loadString(config.c_str());
+
+		checkDomains();
+
+		// Games are saved in the order they were loaded in
+		TS_ASSERT_LESS_THAN(strstr(config.c_str(), "[monkey]"), strstr(config.c_str(), "[sky]"));
+
+		loadString("");
+	}
+};
@@ -0,0 +1,191 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+/**
+ * An archive with members of a single byte, holding the archive's id.
+ * Counts the hasFile() calls, and can refuse to be indexed.
+ */
+class TestArchive : public Common::Archive {
+public:
+	TestArchive(byte id, bool indexable) : _hasFileCalls(0), _id(id), _indexable(indexable) {}
+
+	void addFile(const char *name) { _files.push_back(name); }
+
+	void removeFile(const char *name) {
+		for (Common::StringArray::iterator i = _files.begin(); i != _files.end(); ++i) {
+			if (i->equalsIgnoreCase(name)) {
+				_files.erase(i);
+				return;
+			}
+		}
+	}
+
+	virtual bool hasFile(const Common::String &name) const {
+		_hasFileCalls++;
+		for (Common::StringArray::const_iterator i = _files.begin(); i != _files.end(); ++i) {
+			if (i->equalsIgnoreCase(name))
+				return true;
+		}
+		return false;
+	}
+
+	virtual int listMembers(Common::ArchiveMemberList &list) const {
+		for (Common::StringArray::const_iterator i = _files.begin(); i != _files.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(*i, this)));
+		return _files.size();
+	}
+
+	virtual bool listMemberNames(Common::StringArray &names) const {
+		if (!_indexable)
+			return false;
+		for (Common::StringArray::const_iterator i = _files.begin(); i != _files.end(); ++i)
+			names.push_back(*i);
+		return true;
+	}
+
+	virtual const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+	}
+
+	virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+		if (!hasFile(name))
+			return 0;
+		byte *data = (byte *)malloc(1);
+		*data = _id;
+		return new Common::MemoryReadStream(data, 1, DisposeAfterUse::YES);
+	}
+
+	mutable int _hasFileCalls;
+
+private:
+	byte _id;
+	bool _indexable;
+	Common::StringArray _files;
+};
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+	// Returns the id of the archive serving name, or 0
+	static int lookup(const Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return 0;
+		const int id = stream->readByte();
+		delete stream;
+		return id;
+	}
+
+public:
+	void test_priorities() {
+		Common::SearchSet set;
+		set.setIndexed(true);
+
+		TestArchive *low = new TestArchive(1, true);
+		low->addFile("a.dat");
+		low->addFile("b.dat");
+		TestArchive *high = new TestArchive(2, true);
+		high->addFile("A.DAT");
+		TestArchive *equal = new TestArchive(3, true);
+		equal->addFile("b.dat");
+
+		set.add("low", low, 0);
+		set.add("high", high, 5);
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 2);
+		TS_ASSERT_EQUALS(lookup(set, "B.dat"), 1);
+		TS_ASSERT_EQUALS(lookup(set, "c.dat"), 0);
+		TS_ASSERT(set.hasFile("a.DAT"));
+		TS_ASSERT(!set.hasFile("c.dat"));
+
+		// Added to a built index, insertion order prevails
+		set.add("equal", equal, 0);
+		TS_ASSERT_EQUALS(lookup(set, "b.dat"), 1);
+
+		set.setPriority("equal", 1);
+		TS_ASSERT_EQUALS(lookup(set, "b.dat"), 3);
+
+		set.setPriority("high", -1);
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 1);
+
+		set.remove("low");
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 2);
+		TS_ASSERT_EQUALS(lookup(set, "b.dat"), 3);
+
+		set.clear();
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 0);
+	}
+
+	void test_single_lookup() {
+		Common::SearchSet set;
+		set.setIndexed(true);
+
+		TestArchive *archives[20];
+		for (int i = 0; i < 20; i++) {
+			archives[i] = new TestArchive(i + 1, true);
+			archives[i]->addFile(Common::String::format("file%d", i).c_str());
+			set.add(Common::String::format("archive%d", i), archives[i], i % 3);
+		}
+
+		TS_ASSERT_EQUALS(lookup(set, "file7"), 8);
+		for (int i = 0; i < 20; i++)
+			archives[i]->_hasFileCalls = 0;
+
+		TS_ASSERT(set.hasFile("FILE12"));
+		TS_ASSERT(!set.hasFile("missing"));
+
+		// Only the archive the index points to was asked
+		int calls = 0;
+		for (int i = 0; i < 20; i++)
+			calls += archives[i]->_hasFileCalls;
+		TS_ASSERT_EQUALS(calls, 1);
+		TS_ASSERT_EQUALS(archives[12]->_hasFileCalls, 1);
+	}
+
+	void test_unindexed_archives() {
+		Common::SearchSet set;
+		set.setIndexed(true);
+
+		TestArchive *indexed = new TestArchive(1, true);
+		indexed->addFile("a.dat");
+		indexed->addFile("b.dat");
+		TestArchive *unindexed = new TestArchive(2, false);
+		unindexed->addFile("a.dat");
+		unindexed->addFile("c.dat");
+		TestArchive *lowest = new TestArchive(3, false);
+		lowest->addFile("b.dat");
+
+		set.add("indexed", indexed, 0);
+		set.add("unindexed", unindexed, 1);
+		set.add("lowest", lowest, -1);
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 2);
+		TS_ASSERT_EQUALS(lookup(set, "b.dat"), 1);
+		TS_ASSERT_EQUALS(lookup(set, "c.dat"), 2);
+
+		// Archives with a lower priority than the index hit are not asked
+		TS_ASSERT_EQUALS(lowest->_hasFileCalls, 0);
+		TS_ASSERT(!set.hasFile("d.dat"));
+		TS_ASSERT_EQUALS(lowest->_hasFileCalls, 1);
+	}
+
+	void test_disappearing_member() {
+		Common::SearchSet set;
+		set.setIndexed(true);
+
+		TestArchive *high = new TestArchive(1, true);
+		high->addFile("a.dat");
+		TestArchive *low = new TestArchive(2, true);
+		low->addFile("a.dat");
+
+		set.add("high", high, 1);
+		set.add("low", low, 0);
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 1);
+
+		high->removeFile("a.dat");
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 2);
+		TS_ASSERT(set.getMember("a.dat"));
+
+		low->removeFile("a.dat");
+		TS_ASSERT_EQUALS(lookup(set, "a.dat"), 0);
+		TS_ASSERT(!set.getMember("a.dat"));
+	}
+};
@@ -0,0 +1,97 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/xmlparser.h"
+
+/**
+ * A parser logging all the keys it is handed.
+ * Keys with the property skip="yes" are ignored along with their children.
+ */
+class LogParser : public Common::XMLParser {
+public:
+	Common::String _log;
+
+protected:
+	CUSTOM_XML_PARSER(LogParser) {
+		XML_KEY(menu)
+			XML_PROP(name, true)
+			XML_KEY(item)
+				XML_PROP(id, true)
+				XML_PROP(label, false)
+				XML_PROP(skip, false)
+				XML_KEY_RECURSIVE(item)
+			KEY_END()
+		KEY_END()
+	} PARSER_END()
+
+	bool parserCallback_menu(ParserNode *node) {
+		_log += "<menu " + node->values["name"] + ">";
+		return true;
+	}
+
+	bool parserCallback_item(ParserNode *node) {
+		if (node->values.contains("skip")) {
+			node->ignore = true;
+			return true;
+		}
+
+		_log += "<item " + node->values["id"];
+		if (node->values.contains("label"))
+			_log += " '" + node->values["label"] + "'";
+		_log += ">";
+		return true;
+	}
+
+	bool closedKeyCallback(ParserNode *node) {
+		_log += "</" + node->name + ">";
+		return true;
+	}
+};
+
+class XMLParserTestSuite : public CxxTest::TestSuite {
+public:
+	void test_parseCompiled() {
+		static const char *const xml[] = {
+			"<?xml version = '1.0'?>\n"
+			"<menu name = 'main'>\n"
+			"	<!-- A comment -->\n"
+			"	<item id = 'open' label = 'Open...'/>\n"
+			"	<item id = \"recent\">\n"
+			"		<item id = 'first' label = ''/>\n"
+			"		<item id = 'second' skip = 'yes'>\n"
+			"			<item id = 'hidden'/>\n"
+			"		</item>\n"
+			"	</item>\n"
+			"</menu>\n",
+
+			"<?xml version = '1.0'?>\n"
+			"<menu name = 'empty'/>\n"
+		};
+
+		LogParser parser;
+		Common::MemoryWriteStreamDynamic compiled(DisposeAfterUse::YES);
+		parser.setCompiledStream(&compiled);
+
+		Common::String expected;
+		for (int i = 0; i < ARRAYSIZE(xml); ++i) {
+			TS_ASSERT(parser.loadBuffer((const byte *)xml[i], strlen(xml[i])));
+			TS_ASSERT(parser.parse());
+			parser.close();
+		}
+
+		parser.setCompiledStream(0);
+		expected = parser._log;
+		TS_ASSERT_EQUALS(expected,
+			"</xml><menu main><item open 'Open...'></item><item recent><item first ''></item></item></menu>"
+			"</xml><menu empty></menu>");
+
+		// Both recordings are read back in turn from the same stream
+		parser._log.clear();
+		TS_ASSERT(parser.loadBuffer(compiled.getData(), compiled.size()));
+		for (int i = 0; i < ARRAYSIZE(xml); ++i)
+			TS_ASSERT(parser.parseCompiled());
+		parser.close();
+
+		TS_ASSERT_EQUALS(parser._log, expected);
+	}
+};
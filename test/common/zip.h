@@ -0,0 +1,265 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+/**
+ * Builds ZIP archives in memory. The members are deflated by stripping the
+ * gzip framing from the output of wrapCompressedWriteStream(), whose
+ * trailer also provides the CRC.
+ */
+class ZipBuilder {
+public:
+	ZipBuilder() : _zip(DisposeAfterUse::YES), _central(DisposeAfterUse::YES), _entries(0) {}
+
+	void addMember(const char *name, const byte *data, uint32 size, bool deflate) {
+		Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(gzip);
+		compressor->write(data, size);
+		compressor->finalize();
+
+		// A 10 byte header, the raw deflate data, and the CRC and size
+		const byte *gzipData = gzip->getData();
+		const uint32 gzipSize = gzip->size();
+		const uint32 crc = READ_LE_UINT32(gzipData + gzipSize - 8);
+		const byte *payload = deflate ? gzipData + 10 : data;
+		const uint32 payloadSize = deflate ? gzipSize - 18 : size;
+		const uint16 method = deflate ? 8 : 0;
+		const uint32 nameLength = strlen(name);
+		const uint32 offset = _zip.pos();
+
+		_zip.writeUint32LE(0x04034b50);
+		_zip.writeUint16LE(20);
+		_zip.writeUint16LE(0);
+		_zip.writeUint16LE(method);
+		_zip.writeUint32LE(0);
+		_zip.writeUint32LE(crc);
+		_zip.writeUint32LE(payloadSize);
+		_zip.writeUint32LE(size);
+		_zip.writeUint16LE(nameLength);
+		_zip.writeUint16LE(0);
+		_zip.write(name, nameLength);
+		_zip.write(payload, payloadSize);
+
+		_central.writeUint32LE(0x02014b50);
+		_central.writeUint16LE(20);
+		_central.writeUint16LE(20);
+		_central.writeUint16LE(0);
+		_central.writeUint16LE(method);
+		_central.writeUint32LE(0);
+		_central.writeUint32LE(crc);
+		_central.writeUint32LE(payloadSize);
+		_central.writeUint32LE(size);
+		_central.writeUint16LE(nameLength);
+		_central.writeUint16LE(0);
+		_central.writeUint16LE(0);
+		_central.writeUint16LE(0);
+		_central.writeUint16LE(0);
+		_central.writeUint32LE(0);
+		_central.writeUint32LE(offset);
+		_central.write(name, nameLength);
+
+		_entries++;
+		delete compressor;
+	}
+
+	Common::Archive *makeArchive() {
+		const uint32 centralOffset = _zip.pos();
+		_zip.write(_central.getData(), _central.size());
+		_zip.writeUint32LE(0x06054b50);
+		_zip.writeUint16LE(0);
+		_zip.writeUint16LE(0);
+		_zip.writeUint16LE(_entries);
+		_zip.writeUint16LE(_entries);
+		_zip.writeUint32LE(_central.size());
+		_zip.writeUint32LE(centralOffset);
+		_zip.writeUint16LE(0);
+
+		byte *data = (byte *)malloc(_zip.size());
+		memcpy(data, _zip.getData(), _zip.size());
+		return Common::makeZipArchive(new Common::MemoryReadStream(data, _zip.size(), DisposeAfterUse::YES));
+	}
+
+private:
+	Common::MemoryWriteStreamDynamic _zip;
+	Common::MemoryWriteStreamDynamic _central;
+	uint16 _entries;
+};
+
+class ZipArchiveTestSuite : public CxxTest::TestSuite {
+	enum {
+		// Large enough for the member to be streamed, with a few checkpoints
+		kLargeSize = 3 * 1024 * 1024 + 123,
+		kSmallSize = 1000
+	};
+
+	byte *_large;
+	byte *_small;
+
+	static byte *makeData(uint32 size, uint32 seed) {
+		// Compressible, but not trivially so
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (byte)(((seed >> 24) & 0x0F) | ((i >> 12) & 0xF0));
+		}
+		return data;
+	}
+
+	Common::Archive *makeArchive() {
+		ZipBuilder builder;
+		builder.addMember("stored.bin", _large, kLargeSize, false);
+		builder.addMember("deflated.bin", _large, kLargeSize, true);
+		builder.addMember("small.bin", _small, kSmallSize, true);
+		return builder.makeArchive();
+	}
+
+	bool checkRange(Common::SeekableReadStream *stream, uint32 pos, uint32 length, const byte *expected) {
+		byte *buffer = new byte[length];
+		const bool ok = stream->seek(pos) && stream->pos() == (int32)pos &&
+		                stream->read(buffer, length) == length && !memcmp(buffer, expected + pos, length);
+		delete[] buffer;
+		return ok;
+	}
+
+public:
+	void setUp() {
+		_large = makeData(kLargeSize, 1);
+		_small = makeData(kSmallSize, 2);
+	}
+
+	void tearDown() {
+		delete[] _large;
+		delete[] _small;
+	}
+
+	void test_sequential_read() {
+#ifdef USE_ZLIB
+		Common::Archive *archive = makeArchive();
+		TS_ASSERT(archive);
+
+		const char *const names[] = { "stored.bin", "deflated.bin", "small.bin" };
+		const byte *const contents[] = { _large, _large, _small };
+		const uint32 sizes[] = { kLargeSize, kLargeSize, kSmallSize };
+
+		for (int i = 0; i < 3; i++) {
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(names[i]);
+			TS_ASSERT(stream);
+			TS_ASSERT_EQUALS(stream->size(), (int32)sizes[i]);
+
+			// Odd sized reads, crossing the internal buffer boundaries
+			byte buffer[4099];
+			uint32 pos = 0;
+			bool same = true;
+			while (pos < sizes[i]) {
+				const uint32 count = stream->read(buffer, sizeof(buffer));
+				if (!count || memcmp(buffer, contents[i] + pos, count))
+					same = false;
+				if (!count)
+					break;
+				pos += count;
+			}
+			TS_ASSERT(same);
+			TS_ASSERT_EQUALS(pos, sizes[i]);
+			TS_ASSERT_EQUALS(stream->read(buffer, 1), (uint32)0);
+			TS_ASSERT(stream->eos());
+			TS_ASSERT(!stream->err());
+			delete stream;
+		}
+
+		delete archive;
+#endif
+	}
+
+	void test_seek() {
+#ifdef USE_ZLIB
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("deflated.bin");
+		TS_ASSERT(stream);
+
+		// Forward, backward within and beyond the window, and across
+		// checkpoints
+		uint32 seed = 7;
+		bool ok = true;
+		for (int i = 0; i < 50; i++) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 pos = (seed >> 8) % (kLargeSize - 5000);
+			ok = ok && checkRange(stream, pos, 5000, _large);
+			ok = ok && checkRange(stream, pos - MIN<uint32>(pos, 20000), 100, _large);
+		}
+		TS_ASSERT(ok);
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)kLargeSize - 10);
+		TS_ASSERT(stream->seek(-100, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->readByte(), _large[kLargeSize - 110]);
+		TS_ASSERT(checkRange(stream, 0, 16, _large));
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete archive;
+#endif
+	}
+
+	void test_seek_out_of_range() {
+#ifdef USE_ZLIB
+		Common::Archive *archive = makeArchive();
+		const char *const names[] = { "stored.bin", "deflated.bin" };
+
+		for (int i = 0; i < 2; i++) {
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(names[i]);
+			TS_ASSERT(stream);
+			TS_ASSERT(stream->seek(100));
+			TS_ASSERT(!stream->seek(-1));
+			TS_ASSERT(!stream->seek(1, SEEK_END));
+			TS_ASSERT_EQUALS(stream->pos(), 100);
+			TS_ASSERT(stream->seek(0, SEEK_END));
+			TS_ASSERT_EQUALS(stream->pos(), (int32)kLargeSize);
+			delete stream;
+		}
+
+		delete archive;
+#endif
+	}
+
+	void test_concurrent_members() {
+#ifdef USE_ZLIB
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *streams[3];
+		streams[0] = archive->createReadStreamForMember("stored.bin");
+		streams[1] = archive->createReadStreamForMember("deflated.bin");
+		streams[2] = archive->createReadStreamForMember("deflated.bin");
+
+		// The member streams keep the archive data alive
+		delete archive;
+
+		streams[2]->seek(kLargeSize / 2);
+		bool ok = true;
+		for (uint32 pos = 0; pos + 65536 < kLargeSize / 2; pos += 65536) {
+			for (int i = 0; i < 3; i++) {
+				const uint32 start = (i == 2 ? kLargeSize / 2 : 0) + pos;
+				byte buffer[1000];
+				const uint32 count = streams[i]->read(buffer, sizeof(buffer));
+				ok = ok && count == sizeof(buffer) && !memcmp(buffer, _large + start, count);
+				streams[i]->skip(65536 - sizeof(buffer));
+			}
+		}
+		TS_ASSERT(ok);
+
+		for (int i = 0; i < 3; i++)
+			delete streams[i];
+#endif
+	}
+
+	void test_missing_member() {
+#ifdef USE_ZLIB
+		Common::Archive *archive = makeArchive();
+		TS_ASSERT(archive->hasFile("DEFLATED.BIN"));
+		TS_ASSERT(!archive->hasFile("missing.bin"));
+		TS_ASSERT(!archive->createReadStreamForMember("missing.bin"));
+		delete archive;
+#endif
+	}
+};
@@ -0,0 +1,200 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/conversion.h"
+#include "graphics/conversion_intern.h"
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "test/simd_helper.h"
+
+class ConversionTestSuite : public CxxTest::TestSuite {
+	enum {
+		kMaxCount = 67,
+		kNumFormats = 7
+	};
+
+	TestRandom _rnd;
+
+	static Graphics::PixelFormat getFormat(int i) {
+		switch (i) {
+		case 0:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);  // RGB565
+		case 1:
+			return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);  // XRGB8888
+		case 2:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24); // ARGB8888
+		case 3:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0); // RGBA8888
+		case 4:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24); // ABGR8888
+		case 5:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0); // BGRA8888
+		default:
+			return Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0);  // XBGR8888
+		}
+	}
+
+	/** Convert a color the way the generic crossBlit() code does. */
+	static uint32 convertColor(uint32 color, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		byte a, r, g, b;
+		srcFmt.colorToARGB(color, a, r, g, b);
+		return dstFmt.ARGBToColor(a, r, g, b);
+	}
+
+	static uint32 readColor(const byte *p, uint bytesPerPixel) {
+		return bytesPerPixel == 2 ? *(const uint16 *)p : *(const uint32 *)p;
+	}
+
+	template<typename SrcColor, typename DstColor, typename Proc>
+	void checkKernel(Proc proc, const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		const Graphics::ChannelSwizzle swizzle = Graphics::makeChannelSwizzle(dstFmt, srcFmt);
+		for (uint count = 0; count <= kMaxCount; ++count) {
+			SrcColor src[kMaxCount];
+			DstColor dst[kMaxCount + 1];
+			_rnd.fill(src, sizeof(src));
+			dst[count] = 0x1234;
+
+			proc(dst, src, count, swizzle);
+
+			bool same = true;
+			for (uint i = 0; i < count; ++i)
+				same = same && dst[i] == convertColor(src[i], dstFmt, srcFmt);
+			TS_ASSERT(same);
+			TS_ASSERT_EQUALS(dst[count], (DstColor)0x1234);
+		}
+	}
+
+	void checkInPlace(Graphics::Convert565To8888Proc proc, const Graphics::PixelFormat &dstFmt) {
+		const Graphics::PixelFormat srcFmt = getFormat(0);
+		const Graphics::ChannelSwizzle swizzle = Graphics::makeChannelSwizzle(dstFmt, srcFmt);
+		for (uint count = 0; count <= kMaxCount; ++count) {
+			uint32 buffer[kMaxCount];
+			uint16 *src = (uint16 *)buffer;
+			_rnd.fill(src, count * sizeof(uint16));
+
+			uint32 expected[kMaxCount];
+			for (uint i = 0; i < count; ++i)
+				expected[i] = convertColor(src[i], dstFmt, srcFmt);
+
+			proc(buffer, src, count, swizzle);
+			TS_ASSERT_SAME_DATA(buffer, expected, count * sizeof(uint32));
+		}
+	}
+
+	void checkKernels(Graphics::Convert8888To8888Proc convert8888To8888, Graphics::Convert565To8888Proc convert565To8888,
+	                  Graphics::Convert8888To565Proc convert8888To565) {
+		_rnd.setSeed(1);
+		for (int i = 1; i < kNumFormats; ++i) {
+			checkKernel<uint16, uint32>(convert565To8888, getFormat(i), getFormat(0));
+			checkInPlace(convert565To8888, getFormat(i));
+			checkKernel<uint32, uint16>(convert8888To565, getFormat(0), getFormat(i));
+			for (int j = 1; j < kNumFormats; ++j)
+				checkKernel<uint32, uint32>(convert8888To8888, getFormat(j), getFormat(i));
+		}
+	}
+
+public:
+	void test_crossblit() {
+		// Padded rows, and a width which leaves a remainder for every kernel
+		const uint w = 37, h = 5;
+		const uint srcPitch = 4 * w + 12, dstPitch = 4 * w + 20;
+
+		_rnd.setSeed(2);
+		for (int i = 0; i < kNumFormats; ++i) {
+			for (int j = 0; j < kNumFormats; ++j) {
+				const Graphics::PixelFormat srcFmt = getFormat(i), dstFmt = getFormat(j);
+				byte src[srcPitch * h], dst[dstPitch * h];
+				_rnd.fill(src, sizeof(src));
+
+				TS_ASSERT(Graphics::crossBlit(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt));
+
+				bool same = true;
+				for (uint y = 0; y < h; ++y) {
+					for (uint x = 0; x < w; ++x) {
+						// Identical formats are copied as is, padding bits included
+						const uint32 color = readColor(src + y * srcPitch + x * srcFmt.bytesPerPixel, srcFmt.bytesPerPixel);
+						const uint32 expected = (i == j) ? color : convertColor(color, dstFmt, srcFmt);
+						same = same && readColor(dst + y * dstPitch + x * dstFmt.bytesPerPixel, dstFmt.bytesPerPixel) == expected;
+					}
+				}
+				TS_ASSERT(same);
+			}
+		}
+	}
+
+	void test_convert_in_place() {
+		_rnd.setSeed(3);
+		for (int i = 0; i < kNumFormats; ++i) {
+			for (int j = 0; j < kNumFormats; ++j) {
+				Graphics::Surface surface;
+				surface.create(41, 7, getFormat(i));
+				_rnd.fill(surface.getPixels(), surface.pitch * surface.h);
+
+				Graphics::Surface *expected = surface.convertTo(getFormat(j));
+				surface.convertToInPlace(getFormat(j));
+				TS_ASSERT_EQUALS(surface.pitch, expected->pitch);
+				TS_ASSERT_SAME_DATA(surface.getPixels(), expected->getPixels(), expected->pitch * expected->h);
+
+				expected->free();
+				delete expected;
+				surface.free();
+			}
+		}
+	}
+
+	void test_convert_paletted() {
+		// A palette shorter than 256 entries
+		const byte palette[] = { 0x00, 0x00, 0x00, 0xFF, 0x80, 0x01, 0x12, 0x34, 0x56 };
+
+		for (int i = 0; i < kNumFormats; ++i) {
+			const Graphics::PixelFormat format = getFormat(i);
+			Graphics::Surface surface;
+			surface.create(19, 3, Graphics::PixelFormat::createFormatCLUT8());
+			for (int y = 0; y < surface.h; ++y) {
+				for (int x = 0; x < surface.w; ++x)
+					*(byte *)surface.getBasePtr(x, y) = (x + y) % 3;
+			}
+
+			Graphics::Surface *converted = surface.convertTo(format, palette);
+			surface.convertToInPlace(format, palette);
+
+			bool same = true;
+			for (int y = 0; y < surface.h; ++y) {
+				for (int x = 0; x < surface.w; ++x) {
+					const byte *entry = palette + ((x + y) % 3) * 3;
+					const uint32 expected = format.RGBToColor(entry[0], entry[1], entry[2]);
+					same = same && readColor((const byte *)converted->getBasePtr(x, y), format.bytesPerPixel) == expected;
+					same = same && readColor((const byte *)surface.getBasePtr(x, y), format.bytesPerPixel) == expected;
+				}
+			}
+			TS_ASSERT(same);
+
+			converted->free();
+			delete converted;
+			surface.free();
+		}
+	}
+
+	void test_kernels_c() {
+		checkKernels(&Graphics::convert8888To8888C, &Graphics::convert565To8888C, &Graphics::convert8888To565C);
+	}
+
+	void test_kernels_sse2() {
+#ifdef SCUMMVM_SSE2
+		checkKernels(&Graphics::convert8888To8888SSE2, &Graphics::convert565To8888SSE2, &Graphics::convert8888To565SSE2);
+#endif
+	}
+
+	void test_kernels_avx2() {
+#ifdef SCUMMVM_AVX2
+		if (!hostHasAVX2())
+			return;
+		checkKernels(&Graphics::convert8888To8888AVX2, &Graphics::convert565To8888AVX2, &Graphics::convert8888To565AVX2);
+#endif
+	}
+
+	void test_kernels_neon() {
+#ifdef SCUMMVM_NEON
+		checkKernels(&Graphics::convert8888To8888NEON, &Graphics::convert565To8888NEON, &Graphics::convert8888To565NEON);
+#endif
+	}
+};
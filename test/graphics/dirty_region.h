@@ -0,0 +1,81 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_region.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite {
+	// Whether every pixel of r is covered by the region
+	static bool covers(const Graphics::DirtyRegion &region, const Common::Rect &r) {
+		for (int y = r.top; y < r.bottom; ++y) {
+			for (int x = r.left; x < r.right; ++x) {
+				bool found = false;
+				for (uint i = 0; i < region.getRects().size() && !found; ++i)
+					found = region.getRects()[i].contains(x, y);
+				if (!found)
+					return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	void test_distant_rects() {
+		Graphics::DirtyRegion region;
+		TS_ASSERT(region.isEmpty());
+
+		region.add(Common::Rect(0, 0, 10, 10));
+		region.add(Common::Rect(630, 470, 640, 480));
+		region.add(Common::Rect(5, 5, 5, 20));
+		TS_ASSERT_EQUALS(region.getRects().size(), 2u);
+		TS_ASSERT_EQUALS(region.getArea(), 200u);
+		TS_ASSERT(region.getBoundingBox() == Common::Rect(0, 0, 640, 480));
+
+		region.clear();
+		TS_ASSERT(region.isEmpty());
+		TS_ASSERT(region.getBoundingBox().isEmpty());
+	}
+
+	void test_merge() {
+		Graphics::DirtyRegion region;
+
+		// Adjacent, contained and close rectangles end up as one
+		region.add(Common::Rect(0, 0, 10, 10));
+		region.add(Common::Rect(10, 0, 20, 10));
+		region.add(Common::Rect(2, 2, 8, 8));
+		region.add(Common::Rect(0, 11, 20, 20));
+		TS_ASSERT_EQUALS(region.getRects().size(), 1u);
+		TS_ASSERT(region.getRects()[0] == Common::Rect(0, 0, 20, 20));
+
+		// A rectangle bridging two others merges all of them
+		region.clear();
+		region.add(Common::Rect(0, 0, 10, 10));
+		region.add(Common::Rect(20, 0, 30, 10));
+		TS_ASSERT_EQUALS(region.getRects().size(), 2u);
+		region.add(Common::Rect(10, 0, 20, 10));
+		TS_ASSERT_EQUALS(region.getRects().size(), 1u);
+		TS_ASSERT(region.getRects()[0] == Common::Rect(0, 0, 30, 10));
+	}
+
+	void test_merge_cost() {
+		// Adjacent rectangles add nothing, distant ones too much
+		TS_ASSERT(Graphics::DirtyRegion::isCheapToMerge(Common::Rect(0, 0, 10, 10), Common::Rect(10, 0, 20, 10)));
+		TS_ASSERT(Graphics::DirtyRegion::isCheapToMerge(Common::Rect(0, 0, 10, 10), Common::Rect(0, 11, 10, 20)));
+		TS_ASSERT(!Graphics::DirtyRegion::isCheapToMerge(Common::Rect(0, 0, 10, 10), Common::Rect(20, 20, 30, 30)));
+	}
+
+	void test_limit() {
+		Graphics::DirtyRegion region(4);
+		uint32 seed = 1;
+		Common::Rect added[50];
+
+		for (int i = 0; i < 50; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const int x = (seed >> 8) % 600, y = (seed >> 18) % 440;
+			added[i] = Common::Rect(x, y, x + 1 + (seed % 40), y + 1 + ((seed >> 4) % 40));
+			region.add(added[i]);
+			TS_ASSERT_LESS_THAN_EQUALS(region.getRects().size(), 4u);
+		}
+
+		for (int i = 0; i < 50; ++i)
+			TS_ASSERT(covers(region, added[i]));
+	}
+};
@@ -0,0 +1,99 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler/scale2x.h"
+#include "graphics/scaler/scale3x.h"
+#include "test/simd_helper.h"
+
+typedef void Scale2x16Proc(scale2x_uint16 *dst0, scale2x_uint16 *dst1, const scale2x_uint16 *src0, const scale2x_uint16 *src1, const scale2x_uint16 *src2, unsigned count);
+typedef void Scale3x16Proc(scale3x_uint16 *dst0, scale3x_uint16 *dst1, scale3x_uint16 *dst2, const scale3x_uint16 *src0, const scale3x_uint16 *src1, const scale3x_uint16 *src2, unsigned count);
+
+class ScaleBitTestSuite : public CxxTest::TestSuite {
+	enum {
+		kMaxCount = 70,
+		// One pixel of border on each side, as the scalers read it
+		kPitch = kMaxCount + 2
+	};
+
+	TestRandom _rnd;
+	scale2x_uint16 _src[3 * kPitch];
+
+	void fillSource() {
+		// Few colors, so that the neighbour comparisons often match
+		for (uint i = 0; i < ARRAYSIZE(_src); ++i) {
+			_src[i] = (scale2x_uint16)(((_rnd.next() & 0xFFFF) % 3) * 0x1111);
+		}
+	}
+
+	void checkScale2x(Scale2x16Proc *proc) {
+#ifdef USE_SCALERS
+		_rnd.setSeed(1);
+		for (unsigned count = 1; count <= kMaxCount; ++count) {
+			for (int pass = 0; pass < 20; ++pass) {
+				fillSource();
+				scale2x_uint16 expected[2][2 * kMaxCount], actual[2][2 * kMaxCount];
+				scale2x_16_def(expected[0], expected[1], _src + 1, _src + kPitch + 1, _src + 2 * kPitch + 1, count);
+				proc(actual[0], actual[1], _src + 1, _src + kPitch + 1, _src + 2 * kPitch + 1, count);
+				TS_ASSERT_SAME_DATA(expected[0], actual[0], 2 * count * sizeof(scale2x_uint16));
+				TS_ASSERT_SAME_DATA(expected[1], actual[1], 2 * count * sizeof(scale2x_uint16));
+			}
+		}
+#endif
+	}
+
+	void checkScale3x(Scale3x16Proc *proc) {
+#ifdef USE_SCALERS
+		_rnd.setSeed(2);
+		for (unsigned count = 1; count <= kMaxCount; ++count) {
+			for (int pass = 0; pass < 20; ++pass) {
+				fillSource();
+				scale3x_uint16 expected[3][3 * kMaxCount], actual[3][3 * kMaxCount];
+				scale3x_16_def(expected[0], expected[1], expected[2], _src + 1, _src + kPitch + 1, _src + 2 * kPitch + 1, count);
+				proc(actual[0], actual[1], actual[2], _src + 1, _src + kPitch + 1, _src + 2 * kPitch + 1, count);
+				for (int row = 0; row < 3; ++row)
+					TS_ASSERT_SAME_DATA(expected[row], actual[row], 3 * count * sizeof(scale3x_uint16));
+			}
+		}
+#endif
+	}
+
+public:
+	void test_scale2x_sse2() {
+#if defined(USE_SCALERS) && defined(SCUMMVM_SSE2)
+		checkScale2x(&scale2x_16_sse2);
+#endif
+	}
+
+	void test_scale2x_avx2() {
+#if defined(USE_SCALERS) && defined(SCUMMVM_AVX2)
+		if (!hostHasAVX2())
+			return;
+		checkScale2x(&scale2x_16_avx2);
+#endif
+	}
+
+	void test_scale2x_neon() {
+#if defined(USE_SCALERS) && defined(SCUMMVM_NEON)
+		checkScale2x(&scale2x_16_neon);
+#endif
+	}
+
+	void test_scale3x_sse2() {
+#if defined(USE_SCALERS) && defined(SCUMMVM_SSE2)
+		checkScale3x(&scale3x_16_sse2);
+#endif
+	}
+
+	void test_scale3x_avx2() {
+#if defined(USE_SCALERS) && defined(SCUMMVM_AVX2)
+		if (!hostHasAVX2())
+			return;
+		checkScale3x(&scale3x_16_avx2);
+#endif
+	}
+
+	void test_scale3x_neon() {
+#if defined(USE_SCALERS) && defined(SCUMMVM_NEON)
+		checkScale3x(&scale3x_16_neon);
+#endif
+	}
+};
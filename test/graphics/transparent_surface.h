@@ -0,0 +1,108 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_intern.h"
+#include "test/simd_helper.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite {
+	enum {
+		kMaxWidth = 37
+	};
+
+	TestRandom _rnd;
+
+	/** Random pixels, with many fully transparent and fully opaque ones. */
+	void fill(uint32 *pixels, uint count) {
+		for (uint i = 0; i < count; ++i) {
+			pixels[i] = _rnd.next();
+			const uint32 alpha = _rnd.next() % 4;
+			if (alpha < 2)
+				((byte *)&pixels[i])[Graphics::kAIndex] = alpha ? 0xFF : 0;
+		}
+	}
+
+	template<class Blender>
+	void checkKernel(Graphics::BlitRowProc proc, uint32 color) {
+		const Graphics::BlitColorMod mod(color);
+		for (int flipped = 0; flipped < 2; ++flipped) {
+			for (uint width = 0; width <= kMaxWidth; ++width) {
+				uint32 src[kMaxWidth], dst[kMaxWidth + 1], expected[kMaxWidth + 1];
+				fill(src, kMaxWidth);
+				fill(dst, kMaxWidth + 1);
+				memcpy(expected, dst, sizeof(dst));
+
+				const byte *in = (const byte *)(flipped ? src + width - 1 : src);
+				if (flipped)
+					Graphics::blitRow<Blender, true>((byte *)expected, in, width, mod);
+				else
+					Graphics::blitRow<Blender, false>((byte *)expected, in, width, mod);
+				proc((byte *)dst, in, width, flipped != 0, mod);
+
+				TS_ASSERT_SAME_DATA(dst, expected, sizeof(dst));
+			}
+		}
+	}
+
+	void checkKernels(const Graphics::BlitRowProcs &procs) {
+		static const uint32 colors[] = { 0xFFFFFFFF, 0x80FFFFFF, 0xFF102030, 0x01FEFDFC, 0xC0FF00FF };
+
+		_rnd.setSeed(1);
+		checkKernel<Graphics::BlitAlphaBlend<false> >(procs.alphaBlend, 0xFFFFFFFF);
+		checkKernel<Graphics::BlitAdditiveBlend<false> >(procs.additiveBlend, 0xFFFFFFFF);
+		for (uint i = 0; i < ARRAYSIZE(colors); ++i)
+			checkKernel<Graphics::BlitAlphaBlend<true> >(procs.alphaBlendColorMod, colors[i]);
+	}
+
+public:
+	void test_blit_flipped_opaque() {
+		Graphics::TransparentSurface src;
+		src.create(5, 2, Graphics::TransparentSurface::getSupportedPixelFormat());
+		src.setAlphaMode(Graphics::ALPHA_OPAQUE);
+		for (int x = 0; x < 5; ++x) {
+			*(uint32 *)src.getBasePtr(x, 0) = x * 0x01010100;
+			*(uint32 *)src.getBasePtr(x, 1) = x * 0x01010100 + 0x10000000;
+		}
+
+		Graphics::Surface dst;
+		dst.create(5, 2, Graphics::TransparentSurface::getSupportedPixelFormat());
+		src.blit(dst, 0, 0, Graphics::FLIP_HV);
+
+		for (int x = 0; x < 5; ++x) {
+			const uint32 color = *(const uint32 *)dst.getBasePtr(4 - x, 1);
+			TS_ASSERT_EQUALS(color | 0xFF, (*(const uint32 *)src.getBasePtr(x, 0)) | 0xFF);
+			TS_ASSERT_EQUALS(((const byte *)&color)[Graphics::kAIndex], 0xFF);
+		}
+
+		src.free();
+		dst.free();
+	}
+
+	void test_kernels_sse2() {
+#ifdef SCUMMVM_SSE2
+		const Graphics::BlitRowProcs procs = {
+			&Graphics::blitAlphaBlendRowSSE2, &Graphics::blitAlphaBlendColorModRowSSE2, &Graphics::blitAdditiveBlendRowSSE2
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_avx2() {
+#ifdef SCUMMVM_AVX2
+		if (!hostHasAVX2())
+			return;
+		const Graphics::BlitRowProcs procs = {
+			&Graphics::blitAlphaBlendRowAVX2, &Graphics::blitAlphaBlendColorModRowAVX2, &Graphics::blitAdditiveBlendRowAVX2
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_neon() {
+#ifdef SCUMMVM_NEON
+		const Graphics::BlitRowProcs procs = {
+			&Graphics::blitAlphaBlendRowNEON, &Graphics::blitAlphaBlendColorModRowNEON, &Graphics::blitAdditiveBlendRowNEON
+		};
+		checkKernels(procs);
+#endif
+	}
+};
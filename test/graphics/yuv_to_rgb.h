@@ -0,0 +1,126 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_intern.h"
+#include "test/simd_helper.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	enum {
+		kNumFormats = 5
+	};
+
+	TestRandom _rnd;
+
+	static Graphics::PixelFormat getFormat(int i) {
+		switch (i) {
+		case 0:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);  // RGB565
+		case 1:
+			return Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15); // ARGB1555
+		case 2:
+			return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);  // XRGB8888
+		case 3:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0); // RGBA8888
+		default:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24); // ABGR8888
+		}
+	}
+
+	/**
+	 * Convert an image with the lookup tables and with the row kernels,
+	 * and compare the results.
+	 */
+	void checkImage(const Graphics::YUVToRGBRowProcs &procs, int chromaShift, const byte *ySrc, const byte *uSrc, const byte *vSrc,
+	                int yWidth, int yHeight, int yPitch, int uvPitch) {
+		for (int i = 0; i < kNumFormats; ++i) {
+			for (int scale = 0; scale < 2; ++scale) {
+				const Graphics::YUVToRGBManager::LuminanceScale luminanceScale = scale ? Graphics::YUVToRGBManager::kScaleITU : Graphics::YUVToRGBManager::kScaleFull;
+				Graphics::Surface expected, actual;
+				expected.create(yWidth, yHeight, getFormat(i));
+				actual.create(yWidth, yHeight, getFormat(i));
+
+				// Without a backend, the manager always uses the lookup tables
+				if (chromaShift == 0)
+					YUVToRGBMan.convert444(&expected, luminanceScale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+				else if (chromaShift == 1)
+					YUVToRGBMan.convert420(&expected, luminanceScale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+				else
+					YUVToRGBMan.convert410(&expected, luminanceScale, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+				Graphics::convertYUVToRGBRows(procs, &actual, luminanceScale, chromaShift, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+				TS_ASSERT_SAME_DATA(actual.getPixels(), expected.getPixels(), expected.pitch * expected.h);
+
+				expected.free();
+				actual.free();
+			}
+		}
+	}
+
+	void checkKernels(const Graphics::YUVToRGBRowProcs &procs) {
+		// Every combination of chroma values, with varying luminance
+		{
+			const int size = 256;
+			byte *y = new byte[size * size], *u = new byte[size * size], *v = new byte[size * size];
+			for (int row = 0; row < size; ++row) {
+				for (int x = 0; x < size; ++x) {
+					y[row * size + x] = (x * 7 + row * 13) & 0xFF;
+					u[row * size + x] = x;
+					v[row * size + x] = row;
+				}
+			}
+			checkImage(procs, 0, y, u, v, size, size, size, size);
+			delete[] y;
+			delete[] u;
+			delete[] v;
+		}
+
+		// Random images of a width which leaves a partial block, with
+		// padded rows, and one extra chroma row and column for YUV410
+		_rnd.setSeed(1);
+		const int w = 52, h = 12, yPitch = w + 5, uvPitch = w + 3;
+		byte y[yPitch * h], u[uvPitch * (h + 1)], v[uvPitch * (h + 1)];
+		_rnd.fill(y, sizeof(y));
+		_rnd.fill(u, sizeof(u));
+		_rnd.fill(v, sizeof(v));
+
+		checkImage(procs, 0, y, u, v, w, h, yPitch, uvPitch);
+		checkImage(procs, 1, y, u, v, w, h, yPitch, uvPitch);
+		checkImage(procs, 2, y, u, v, w, h, yPitch, uvPitch);
+		checkImage(procs, 1, y, u, v, 6, 2, yPitch, uvPitch);
+	}
+
+public:
+	void test_kernels_sse2() {
+#ifdef SCUMMVM_SSE2
+		const Graphics::YUVToRGBRowProcs procs = {
+			&Graphics::convertYUV444To16SSE2, &Graphics::convertYUV444To32SSE2,
+			&Graphics::convertYUV420To16SSE2, &Graphics::convertYUV420To32SSE2
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_avx2() {
+#ifdef SCUMMVM_AVX2
+		if (!hostHasAVX2())
+			return;
+		const Graphics::YUVToRGBRowProcs procs = {
+			&Graphics::convertYUV444To16AVX2, &Graphics::convertYUV444To32AVX2,
+			&Graphics::convertYUV420To16AVX2, &Graphics::convertYUV420To32AVX2
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_neon() {
+#ifdef SCUMMVM_NEON
+		const Graphics::YUVToRGBRowProcs procs = {
+			&Graphics::convertYUV444To16NEON, &Graphics::convertYUV444To32NEON,
+			&Graphics::convertYUV420To16NEON, &Graphics::convertYUV420To32NEON
+		};
+		checkKernels(procs);
+#endif
+	}
+};
@@ -0,0 +1,227 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "graphics/surface.h"
+#include "image/codecs/msvideo1.h"
+#include "image/codecs/qtrle.h"
+#include "image/codecs/rpza.h"
+#include "test/simd_helper.h"
+
+/**
+ * Checks that the codecs decoding directly into another format give the
+ * same frames as converting the ones in their own format.
+ */
+class CodecOutputFormatTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 16,
+		kHeight = 16,
+		kNumFrames = 4
+	};
+
+	typedef Common::Array<byte> Data;
+
+	TestRandom _rnd;
+
+	void put8(Data &data, uint32 value) {
+		data.push_back(value & 0xFF);
+	}
+
+	void put16BE(Data &data, uint32 value) {
+		put8(data, value >> 8);
+		put8(data, value);
+	}
+
+	void put16LE(Data &data, uint32 value) {
+		put8(data, value);
+		put8(data, value >> 8);
+	}
+
+	/**
+	 * Create a frame using all block types.
+	 */
+	Data createMSVideo1Frame() {
+		Data data;
+
+		for (int i = 0; i < (kWidth / 4) * (kHeight / 4); i++) {
+			switch (_rnd.next() % 4) {
+			case 0: // 1 color
+				put16LE(data, 0x8000 | (_rnd.next() & 0x7FFF));
+				break;
+			case 1: // 2 colors
+				put16LE(data, _rnd.next() & 0x7FFF);
+				put16LE(data, _rnd.next() & 0x7FFF);
+				put16LE(data, _rnd.next());
+				break;
+			case 2: // 8 colors
+				put16LE(data, _rnd.next() & 0x7FFF);
+				put16LE(data, 0x8000 | _rnd.next());
+				for (int j = 0; j < 7; j++)
+					put16LE(data, _rnd.next());
+				break;
+			default: // skip
+				put16LE(data, 0x8401);
+				break;
+			}
+		}
+
+		return data;
+	}
+
+	Data createRPZAFrame() {
+		Data data;
+		put8(data, 0xE1);
+		put16BE(data, 0); // Size, filled in below
+		put8(data, 0);
+
+		for (int i = 0; i < (kWidth / 4) * (kHeight / 4); i++) {
+			switch (_rnd.next() % 4) {
+			case 0: // fill
+				put8(data, 0xA0);
+				put16BE(data, _rnd.next());
+				break;
+			case 1: // blend
+				put8(data, 0xC0);
+				put16BE(data, _rnd.next());
+				put16BE(data, _rnd.next());
+				for (int j = 0; j < 4; j++)
+					put8(data, _rnd.next());
+				break;
+			case 2: // 16 colors
+				for (int j = 0; j < 16; j++)
+					put16BE(data, _rnd.next() & 0x7FFF);
+				break;
+			default: // skip
+				put8(data, 0x80);
+				break;
+			}
+		}
+
+		data[1] = data.size() >> 16;
+		data[2] = data.size() >> 8;
+		data[3] = data.size();
+		return data;
+	}
+
+	void putQTRLEColor(Data &data, int bitsPerPixel) {
+		for (int i = 0; i < bitsPerPixel / 8; i++)
+			put8(data, _rnd.next());
+	}
+
+	/**
+	 * Create a frame with runs, copies and skips on each line.
+	 */
+	Data createQTRLEFrame(int bitsPerPixel) {
+		Data data;
+		put16BE(data, 0); // Size, which is not checked
+		put16BE(data, 0);
+		put16BE(data, 0); // No header
+
+		for (int y = 0; y < kHeight; y++) {
+			put8(data, 1 + _rnd.next() % 2);
+
+			// run
+			put8(data, (byte)-4);
+			putQTRLEColor(data, bitsPerPixel);
+
+			// copy
+			put8(data, 8);
+			for (int i = 0; i < 8; i++)
+				putQTRLEColor(data, bitsPerPixel);
+
+			// skip and run
+			put8(data, 0);
+			put8(data, 2);
+			put8(data, (byte)-1 - 1);
+			putQTRLEColor(data, bitsPerPixel);
+
+			put8(data, (byte)-1);
+		}
+
+		return data;
+	}
+
+	Data createFrame(uint32 tag, int bitsPerPixel) {
+		switch (tag) {
+		case MKTAG('m', 's', 'v', 'c'):
+			return createMSVideo1Frame();
+		case MKTAG('r', 'p', 'z', 'a'):
+			return createRPZAFrame();
+		default:
+			return createQTRLEFrame(bitsPerPixel);
+		}
+	}
+
+	Image::Codec *createCodec(uint32 tag, int bitsPerPixel) {
+		switch (tag) {
+		case MKTAG('m', 's', 'v', 'c'):
+			return new Image::MSVideo1Decoder(kWidth, kHeight, bitsPerPixel);
+		case MKTAG('r', 'p', 'z', 'a'):
+			return new Image::RPZADecoder(kWidth, kHeight);
+		default:
+			return new Image::QTRLEDecoder(kWidth, kHeight, bitsPerPixel);
+		}
+	}
+
+	void checkCodec(uint32 tag, int bitsPerPixel, const Graphics::PixelFormat &format) {
+		Image::Codec *reference = createCodec(tag, bitsPerPixel);
+		Image::Codec *direct = createCodec(tag, bitsPerPixel);
+
+		TS_ASSERT(direct->setOutputPixelFormat(format));
+		TS_ASSERT(direct->getPixelFormat() == format);
+
+		_rnd.setSeed(1);
+		for (int n = 0; n < kNumFrames; n++) {
+			const Data data = createFrame(tag, bitsPerPixel);
+
+			Common::MemoryReadStream referenceStream(&data[0], data.size());
+			Graphics::Surface *expected = reference->decodeFrame(referenceStream)->convertTo(format);
+
+			Common::MemoryReadStream directStream(&data[0], data.size());
+			const Graphics::Surface *actual = direct->decodeFrame(directStream);
+
+			TS_ASSERT(actual->format == format);
+			for (int y = 0; y < kHeight; y++)
+				TS_ASSERT_SAME_DATA(actual->getBasePtr(0, y), expected->getBasePtr(0, y), kWidth * format.bytesPerPixel);
+
+			expected->free();
+			delete expected;
+		}
+
+		// Formats of surfaces padded to whole blocks cannot be changed after
+		// decoding started
+		if (tag != MKTAG('m', 's', 'v', 'c') && format != reference->getPixelFormat())
+			TS_ASSERT(!direct->setOutputPixelFormat(reference->getPixelFormat()));
+
+		delete reference;
+		delete direct;
+	}
+
+	void checkFormats(uint32 tag, int bitsPerPixel) {
+		checkCodec(tag, bitsPerPixel, Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
+		checkCodec(tag, bitsPerPixel, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		checkCodec(tag, bitsPerPixel, Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0));
+		checkCodec(tag, bitsPerPixel, Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0));
+	}
+
+public:
+	void test_msvideo1() {
+		checkFormats(MKTAG('m', 's', 'v', 'c'), 16);
+	}
+
+	void test_rpza() {
+		checkFormats(MKTAG('r', 'p', 'z', 'a'), 16);
+	}
+
+	void test_qtrle() {
+		checkFormats(MKTAG('r', 'l', 'e', ' '), 16);
+		checkFormats(MKTAG('r', 'l', 'e', ' '), 24);
+		checkFormats(MKTAG('r', 'l', 'e', ' '), 32);
+	}
+
+	void test_unsupported() {
+		Image::MSVideo1Decoder decoder(kWidth, kHeight, 8);
+		TS_ASSERT(!decoder.setOutputPixelFormat(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)));
+		TS_ASSERT(decoder.getPixelFormat() == Graphics::PixelFormat::createFormatCLUT8());
+	}
+};
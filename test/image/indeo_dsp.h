@@ -0,0 +1,138 @@
+#include <cxxtest/TestSuite.h>
+
+#include "image/codecs/indeo/indeo_dsp_intern.h"
+#include "test/simd_helper.h"
+
+using Image::Indeo::IndeoDSP;
+
+class IndeoDSPTestSuite : public CxxTest::TestSuite {
+	enum {
+		kPitch = 11,
+		kNumBlocks = 2000
+	};
+
+	typedef void (*TransformProc)(const int32 *in, int16 *out, uint32 pitch, const uint8 *flags);
+	typedef void (*MCProc)(int16 *buf, const int16 *refBuf, uint32 pitch, int mcType);
+	typedef void (*MCAvgProc)(int16 *buf, const int16 *refBuf, const int16 *refBuf2, uint32 pitch, int mcType, int mcType2);
+
+	TestRandom _rnd;
+
+	/**
+	 * Fill a block with coefficients. Like real videos most blocks only have
+	 * a few small ones, the others have large values whose results do not
+	 * fit into 16 bits.
+	 */
+	void fillBlock(int32 *block, uint8 *flags, int n) {
+		memset(block, 0, 64 * sizeof(int32));
+		memset(flags, 0, 8);
+		switch (n % 3) {
+		case 0:
+			for (int i = _rnd.next() % 8; i >= 0; i--) {
+				const int pos = _rnd.next() % 64;
+				block[pos] = (int32)(_rnd.next() % 512) - 256;
+				flags[pos % 8] = 1;
+			}
+			break;
+		case 1:
+			for (int i = 0; i < 64; i++)
+				block[i] = (int32)(_rnd.next() % 8192) - 4096;
+			for (int i = 0; i < 8; i++)
+				flags[i] = _rnd.next() % 4 != 0;
+			break;
+		default:
+			for (int i = 0; i < 64; i++)
+				block[i] = (int32)(_rnd.next() % 0x100000) - 0x80000;
+			for (int i = 0; i < 8; i++)
+				flags[i] = 1;
+			break;
+		}
+	}
+
+	void fillPixels(int16 *pixels, int count) {
+		for (int i = 0; i < count; i++)
+			pixels[i] = (int16)_rnd.next();
+	}
+
+	void checkTransform(TransformProc expected, TransformProc actual) {
+		_rnd.setSeed(1);
+		for (int n = 0; n < kNumBlocks; n++) {
+			int32 coeffs[64];
+			uint8 flags[8];
+			fillBlock(coeffs, flags, n);
+
+			int16 expectedPixels[8 * kPitch], actualPixels[8 * kPitch];
+			fillPixels(expectedPixels, 8 * kPitch);
+			memcpy(actualPixels, expectedPixels, sizeof(actualPixels));
+
+			expected(coeffs, expectedPixels, kPitch, flags);
+			actual(coeffs, actualPixels, kPitch, flags);
+			TS_ASSERT_SAME_DATA(actualPixels, expectedPixels, sizeof(expectedPixels));
+		}
+	}
+
+	void checkMC(int size, MCProc expected, MCProc actual) {
+		_rnd.setSeed(1);
+		for (int n = 0; n < kNumBlocks; n++) {
+			int16 ref[9 * kPitch];
+			fillPixels(ref, 9 * kPitch);
+
+			int16 expectedPixels[8 * kPitch], actualPixels[8 * kPitch];
+			fillPixels(expectedPixels, 8 * kPitch);
+			memcpy(actualPixels, expectedPixels, sizeof(actualPixels));
+
+			const int offset = _rnd.next() % (kPitch - size);
+			expected(expectedPixels, ref + offset, kPitch, n % 4);
+			actual(actualPixels, ref + offset, kPitch, n % 4);
+			TS_ASSERT_SAME_DATA(actualPixels, expectedPixels, sizeof(expectedPixels));
+		}
+	}
+
+	void checkMCAvg(int size, MCAvgProc expected, MCAvgProc actual) {
+		_rnd.setSeed(1);
+		for (int n = 0; n < kNumBlocks; n++) {
+			int16 ref[9 * kPitch], ref2[9 * kPitch];
+			fillPixels(ref, 9 * kPitch);
+			fillPixels(ref2, 9 * kPitch);
+
+			int16 expectedPixels[8 * kPitch], actualPixels[8 * kPitch];
+			fillPixels(expectedPixels, 8 * kPitch);
+			memcpy(actualPixels, expectedPixels, sizeof(actualPixels));
+
+			const int offset = _rnd.next() % (kPitch - size);
+			expected(expectedPixels, ref + offset, ref2, kPitch, n % 4, (n / 4) % 4);
+			actual(actualPixels, ref + offset, ref2, kPitch, n % 4, (n / 4) % 4);
+			TS_ASSERT_SAME_DATA(actualPixels, expectedPixels, sizeof(expectedPixels));
+		}
+	}
+
+public:
+	void test_kernels_sse2() {
+#ifdef SCUMMVM_SSE2
+		checkTransform(&IndeoDSP::ffIviInverseHaar8x8, &Image::Indeo::ffIviInverseHaar8x8SSE2);
+		checkTransform(&IndeoDSP::ffIviInverseSlant8x8, &Image::Indeo::ffIviInverseSlant8x8SSE2);
+		checkMC(8, &IndeoDSP::ffIviMc8x8Delta, &Image::Indeo::ffIviMc8x8DeltaSSE2);
+		checkMC(8, &IndeoDSP::ffIviMc8x8NoDelta, &Image::Indeo::ffIviMc8x8NoDeltaSSE2);
+		checkMC(4, &IndeoDSP::ffIviMc4x4Delta, &Image::Indeo::ffIviMc4x4DeltaSSE2);
+		checkMC(4, &IndeoDSP::ffIviMc4x4NoDelta, &Image::Indeo::ffIviMc4x4NoDeltaSSE2);
+		checkMCAvg(8, &IndeoDSP::ffIviMcAvg8x8Delta, &Image::Indeo::ffIviMcAvg8x8DeltaSSE2);
+		checkMCAvg(8, &IndeoDSP::ffIviMcAvg8x8NoDelta, &Image::Indeo::ffIviMcAvg8x8NoDeltaSSE2);
+		checkMCAvg(4, &IndeoDSP::ffIviMcAvg4x4Delta, &Image::Indeo::ffIviMcAvg4x4DeltaSSE2);
+		checkMCAvg(4, &IndeoDSP::ffIviMcAvg4x4NoDelta, &Image::Indeo::ffIviMcAvg4x4NoDeltaSSE2);
+#endif
+	}
+
+	void test_kernels_neon() {
+#ifdef SCUMMVM_NEON
+		checkTransform(&IndeoDSP::ffIviInverseHaar8x8, &Image::Indeo::ffIviInverseHaar8x8NEON);
+		checkTransform(&IndeoDSP::ffIviInverseSlant8x8, &Image::Indeo::ffIviInverseSlant8x8NEON);
+		checkMC(8, &IndeoDSP::ffIviMc8x8Delta, &Image::Indeo::ffIviMc8x8DeltaNEON);
+		checkMC(8, &IndeoDSP::ffIviMc8x8NoDelta, &Image::Indeo::ffIviMc8x8NoDeltaNEON);
+		checkMC(4, &IndeoDSP::ffIviMc4x4Delta, &Image::Indeo::ffIviMc4x4DeltaNEON);
+		checkMC(4, &IndeoDSP::ffIviMc4x4NoDelta, &Image::Indeo::ffIviMc4x4NoDeltaNEON);
+		checkMCAvg(8, &IndeoDSP::ffIviMcAvg8x8Delta, &Image::Indeo::ffIviMcAvg8x8DeltaNEON);
+		checkMCAvg(8, &IndeoDSP::ffIviMcAvg8x8NoDelta, &Image::Indeo::ffIviMcAvg8x8NoDeltaNEON);
+		checkMCAvg(4, &IndeoDSP::ffIviMcAvg4x4Delta, &Image::Indeo::ffIviMcAvg4x4DeltaNEON);
+		checkMCAvg(4, &IndeoDSP::ffIviMcAvg4x4NoDelta, &Image::Indeo::ffIviMcAvg4x4NoDeltaNEON);
+#endif
+	}
+};
@@ -0,0 +1,64 @@
+#include <cxxtest/TestSuite.h>
+
+#include "image/codecs/svq1_mc_intern.h"
+#include "test/simd_helper.h"
+
+class SVQ1MotionTestSuite : public CxxTest::TestSuite {
+	enum {
+		kPitch = 37,
+		kNumBlocks = 500
+	};
+
+	TestRandom _rnd;
+
+	void checkKernel(int size, Image::SVQ1PutPixelsProc expected, Image::SVQ1PutPixelsProc actual) {
+		_rnd.setSeed(1);
+		for (int n = 0; n < kNumBlocks; n++) {
+			byte ref[17 * kPitch];
+			for (int i = 0; i < ARRAYSIZE(ref); i++)
+				ref[i] = (byte)_rnd.next();
+
+			byte expectedPixels[16 * kPitch], actualPixels[16 * kPitch];
+			for (int i = 0; i < ARRAYSIZE(expectedPixels); i++)
+				expectedPixels[i] = actualPixels[i] = (byte)_rnd.next();
+
+			const int offset = _rnd.next() % (kPitch - size);
+			expected(expectedPixels + offset, ref + offset, kPitch, size);
+			actual(actualPixels + offset, ref + offset, kPitch, size);
+			TS_ASSERT_SAME_DATA(actualPixels, expectedPixels, sizeof(expectedPixels));
+		}
+	}
+
+	void checkKernels(const Image::SVQ1MotionProcs &procs) {
+		const Image::SVQ1MotionProcs plain = {
+			{ &Image::svq1PutPixels8, &Image::svq1PutPixels8X2, &Image::svq1PutPixels8Y2, &Image::svq1PutPixels8XY2 },
+			{ &Image::svq1PutPixels16, &Image::svq1PutPixels16X2, &Image::svq1PutPixels16Y2, &Image::svq1PutPixels16XY2 }
+		};
+
+		for (int i = 0; i < 4; i++) {
+			checkKernel(8, plain.put8[i], procs.put8[i]);
+			checkKernel(16, plain.put16[i], procs.put16[i]);
+		}
+	}
+
+public:
+	void test_kernels_sse2() {
+#ifdef SCUMMVM_SSE2
+		const Image::SVQ1MotionProcs procs = {
+			{ &Image::svq1PutPixels8SSE2, &Image::svq1PutPixels8X2SSE2, &Image::svq1PutPixels8Y2SSE2, &Image::svq1PutPixels8XY2SSE2 },
+			{ &Image::svq1PutPixels16SSE2, &Image::svq1PutPixels16X2SSE2, &Image::svq1PutPixels16Y2SSE2, &Image::svq1PutPixels16XY2SSE2 }
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_neon() {
+#ifdef SCUMMVM_NEON
+		const Image::SVQ1MotionProcs procs = {
+			{ &Image::svq1PutPixels8NEON, &Image::svq1PutPixels8X2NEON, &Image::svq1PutPixels8Y2NEON, &Image::svq1PutPixels8XY2NEON },
+			{ &Image::svq1PutPixels16NEON, &Image::svq1PutPixels16X2NEON, &Image::svq1PutPixels16Y2NEON, &Image::svq1PutPixels16XY2NEON }
+		};
+		checkKernels(procs);
+#endif
+	}
+};
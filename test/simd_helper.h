@@ -0,0 +1,48 @@
+#ifndef TEST_SIMD_HELPER_H
+#define TEST_SIMD_HELPER_H
+
+#include "common/scummsys.h"
+
+/**
+ * Pseudo-random numbers to feed the SIMD kernels and their plain C
+ * versions with. Each check sets a fixed seed, so that failures can be
+ * reproduced.
+ */
+class TestRandom {
+public:
+	explicit TestRandom(uint32 seed = 1) : _seed(seed) {}
+
+	void setSeed(uint32 seed) { _seed = seed; }
+
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		// The low bits of the state have short periods, so swap the halves
+		return (_seed >> 16) | (_seed << 16);
+	}
+
+	/** Fill a buffer with random bytes. */
+	void fill(void *data, uint size) {
+		byte *bytes = (byte *)data;
+		for (uint i = 0; i < size; ++i)
+			bytes[i] = (byte)next();
+	}
+
+private:
+	uint32 _seed;
+};
+
+#ifdef SCUMMVM_AVX2
+/**
+ * Return whether the host CPU can run the AVX2 kernels. The SSE2 and NEON
+ * ones are only built for architectures which always have them.
+ */
+inline bool hostHasAVX2() {
+#ifdef __GNUC__
+	return __builtin_cpu_supports("avx2");
+#else
+	return true;
+#endif
+}
+#endif
+
+#endif
@@ -0,0 +1,99 @@
+#include <cxxtest/TestSuite.h>
+
+#include "video/bink_idct_intern.h"
+#include "test/simd_helper.h"
+
+class BinkIDCTTestSuite : public CxxTest::TestSuite {
+	enum {
+		kPitch = 13,
+		kNumBlocks = 2000
+	};
+
+	TestRandom _rnd;
+
+	/**
+	 * Fill a block with coefficients. Most blocks only have a few small
+	 * ones like real videos, the others use the whole 16 bit range to check
+	 * the wraparound.
+	 */
+	void fillBlock(int16 *block, int n) {
+		memset(block, 0, 64 * sizeof(int16));
+		switch (n % 4) {
+		case 0:
+			block[0] = (int16)_rnd.next();
+			break;
+		case 1:
+			for (int i = _rnd.next() % 8; i >= 0; i--)
+				block[_rnd.next() % 64] = (int16)(_rnd.next() % 1024) - 512;
+			break;
+		case 2:
+			for (int i = 0; i < 64; i++)
+				block[i] = (int16)(_rnd.next() % 4096) - 2048;
+			break;
+		default:
+			for (int i = 0; i < 64; i++)
+				block[i] = (int16)_rnd.next();
+			break;
+		}
+	}
+
+#ifdef USE_BINK
+	void checkKernels(const Video::BinkIDCTProcs &procs) {
+		_rnd.setSeed(1);
+		for (int n = 0; n < kNumBlocks; n++) {
+			int16 coeffs[64], expected[64], actual[64];
+			fillBlock(coeffs, n);
+
+			memcpy(expected, coeffs, sizeof(coeffs));
+			memcpy(actual, coeffs, sizeof(coeffs));
+			Video::binkIDCT(expected);
+			procs.idct(actual);
+			TS_ASSERT_SAME_DATA(actual, expected, sizeof(expected));
+
+			byte expectedPixels[8 * kPitch], actualPixels[8 * kPitch];
+			for (int i = 0; i < 8 * kPitch; i++)
+				expectedPixels[i] = actualPixels[i] = (byte)_rnd.next();
+
+			Video::binkIDCTPut(expectedPixels, kPitch, coeffs);
+			procs.idctPut(actualPixels, kPitch, coeffs);
+			TS_ASSERT_SAME_DATA(actualPixels, expectedPixels, sizeof(expectedPixels));
+
+			memcpy(expected, coeffs, sizeof(coeffs));
+			memcpy(actual, coeffs, sizeof(coeffs));
+			Video::binkIDCTAdd(expectedPixels, kPitch, expected);
+			procs.idctAdd(actualPixels, kPitch, actual);
+			TS_ASSERT_SAME_DATA(actualPixels, expectedPixels, sizeof(expectedPixels));
+		}
+	}
+#endif
+
+public:
+	void test_kernels_sse2() {
+#if defined(USE_BINK) && defined(SCUMMVM_SSE2)
+		const Video::BinkIDCTProcs procs = {
+			&Video::binkIDCTSSE2, &Video::binkIDCTPutSSE2, &Video::binkIDCTAddSSE2
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_avx2() {
+#if defined(USE_BINK) && defined(SCUMMVM_AVX2)
+		if (!hostHasAVX2())
+			return;
+		const Video::BinkIDCTProcs procs = {
+			&Video::binkIDCTAVX2, &Video::binkIDCTPutAVX2, &Video::binkIDCTAddAVX2
+		};
+		checkKernels(procs);
+#endif
+	}
+
+	void test_kernels_neon() {
+#if defined(USE_BINK) && defined(SCUMMVM_NEON)
+		const Video::BinkIDCTProcs procs = {
+			&Video::binkIDCTNEON, &Video::binkIDCTPutNEON, &Video::binkIDCTAddNEON
+		};
+		checkKernels(procs);
+#endif
+	}
+};
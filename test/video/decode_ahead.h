@@ -0,0 +1,199 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+
+/**
+ * An OSystem with nothing but a clock, which only advances when told to.
+ */
+class DecodeAheadTestSystem : public OSystem {
+public:
+	DecodeAheadTestSystem() : _millis(1000) {}
+
+	void advance(uint32 msecs) { _millis += msecs; }
+
+	uint32 getMillis(bool skipRecord = false) { return _millis; }
+	void delayMillis(uint msecs) { _millis += msecs; }
+	void getTimeAndDate(TimeDate &t) const { memset(&t, 0, sizeof(t)); }
+
+	Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	Audio::Mixer *getMixer() { return 0; }
+
+	const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return false; }
+	int getGraphicsMode() const { return 0; }
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col) {}
+	void updateScreen() {}
+	void setShakePos(int shakeOffset) {}
+	void showOverlay() {}
+	void hideOverlay() {}
+	Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	void clearOverlay() {}
+	void grabOverlay(void *buf, int pitch) {}
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+	bool showMouse(bool visible) { return false; }
+	void warpMouse(int x, int y) {}
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale = false, const Graphics::PixelFormat *format = NULL) {}
+	MutexRef createMutex() { return 0; }
+	void lockMutex(MutexRef mutex) {}
+	void unlockMutex(MutexRef mutex) {}
+	void deleteMutex(MutexRef mutex) {}
+	void quit() {}
+	void displayMessageOnOSD(const char *msg) {}
+	void displayActivityIconOnOSD(const Graphics::Surface *icon) {}
+	void logMessage(LogMessageType::Type type, const char *message) {}
+
+private:
+	uint32 _millis;
+};
+
+/**
+ * A 10 fps video whose frames hold their number. Every tenth frame takes
+ * 80ms to decode.
+ */
+class DecodeAheadTestDecoder : public Video::VideoDecoder {
+public:
+	DecodeAheadTestDecoder(DecodeAheadTestSystem *system) {
+		addTrack(new Track(system));
+	}
+
+	bool loadStream(Common::SeekableReadStream *stream) { return false; }
+
+private:
+	class Track : public FixedRateVideoTrack {
+	public:
+		Track(DecodeAheadTestSystem *system) : _system(system), _curFrame(-1) {
+			_surface.create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+		}
+		~Track() { _surface.free(); }
+
+		uint16 getWidth() const { return 4; }
+		uint16 getHeight() const { return 4; }
+		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
+		int getCurFrame() const { return _curFrame; }
+		int getFrameCount() const { return 50; }
+		bool isSeekable() const { return true; }
+
+		bool seek(const Audio::Timestamp &time) {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		const Graphics::Surface *decodeNextFrame() {
+			_curFrame++;
+			if (_curFrame % 10 == 9)
+				_system->advance(80);
+
+			memset(_surface.getPixels(), _curFrame, 16);
+			return &_surface;
+		}
+
+	protected:
+		Common::Rational getFrameRate() const { return 10; }
+
+	private:
+		DecodeAheadTestSystem *_system;
+		Graphics::Surface _surface;
+		int _curFrame;
+	};
+};
+
+class VideoDecodeAheadTestSuite : public CxxTest::TestSuite {
+	DecodeAheadTestSystem *_system;
+
+	/**
+	 * Play the video the way engines do, checking the frames, and return
+	 * how late the latest frame was.
+	 */
+	uint32 play(DecodeAheadTestDecoder &decoder, int lastFrame, bool &inOrder) {
+		uint32 worstLateness = 0;
+		int expected = decoder.getCurFrame() + 1;
+		inOrder = true;
+
+		while (!decoder.endOfVideo() && expected <= lastFrame) {
+			if (decoder.needsUpdate()) {
+				const uint32 due = (uint32)expected * 100;
+				const Graphics::Surface *frame = decoder.decodeNextFrame();
+
+				if (!frame || *(const byte *)frame->getPixels() != expected || decoder.getCurFrame() != expected)
+					inOrder = false;
+				worstLateness = MAX(worstLateness, decoder.getTime() - due);
+				expected++;
+			}
+
+			decoder.decodeAhead();
+			_system->delayMillis(1);
+		}
+
+		return worstLateness;
+	}
+
+public:
+	void setUp() {
+		_system = new DecodeAheadTestSystem();
+		g_system = _system;
+	}
+
+	void tearDown() {
+		g_system = 0;
+		delete _system;
+	}
+
+	void test_without_decode_ahead() {
+		DecodeAheadTestDecoder decoder(_system);
+		decoder.start();
+
+		bool inOrder;
+		TS_ASSERT_EQUALS(play(decoder, 49, inOrder), 80u);
+		TS_ASSERT(inOrder);
+	}
+
+	void test_decode_ahead() {
+		DecodeAheadTestDecoder decoder(_system);
+		TS_ASSERT(decoder.setDecodeAhead(4));
+		TS_ASSERT_EQUALS(decoder.getDecodeAhead(), 4u);
+		decoder.start();
+
+		bool inOrder;
+		TS_ASSERT_EQUALS(play(decoder, 49, inOrder), 0u);
+		TS_ASSERT(inOrder);
+		TS_ASSERT(decoder.endOfVideo());
+	}
+
+	void test_seek() {
+		DecodeAheadTestDecoder decoder(_system);
+		decoder.setDecodeAhead(4);
+		decoder.start();
+
+		bool inOrder;
+		play(decoder, 5, inOrder);
+		TS_ASSERT(inOrder);
+
+		// The frames decoded ahead are dropped
+		TS_ASSERT(decoder.seekToFrame(30));
+		const Graphics::Surface *frame = decoder.decodeNextFrame();
+		TS_ASSERT(frame);
+		TS_ASSERT_EQUALS(*(const byte *)frame->getPixels(), 30);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 30);
+
+		// Decoding ahead is only allowed to change with no frames queued
+		decoder.decodeAhead();
+		TS_ASSERT(!decoder.setDecodeAhead(0));
+
+		play(decoder, 49, inOrder);
+		TS_ASSERT(inOrder);
+		TS_ASSERT(decoder.setDecodeAhead(0));
+	}
+};
@@ -223,6 +223,7 @@ protected:
 		void useInitialPalette();
 		bool canDither() const;
 		void setDither(const byte *palette);
+		bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
 		bool isTruemotion1() const;
 		void forceDimensions(uint16 width, uint16 height);
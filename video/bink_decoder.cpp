@@ -45,6 +45,7 @@
 
 #include "video/binkdata.h"
 #include "video/bink_decoder.h"
+#include "video/bink_idct_intern.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
 static const uint32 kBIKgID = MKTAG('B', 'I', 'K', 'g');
@@ -59,6 +60,11 @@ static const uint16 kAudioFlagStereo = 0x2000;
 // Number of bits used to store first DC value in bundle
 static const uint32 kDCStartBits = 11;
 
+// Number of block rows reconstructed by one job. 16x16 blocks span two
+// rows starting on an even one, so this has to be even for the bands not
+// to overlap.
+static const uint32 kBandRows = 8;
+
 namespace Video {
 
 BinkDecoder::BinkDecoder() {
@@ -245,6 +251,7 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
 		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
 	_curFrame = -1;
+	_idct = &getBinkIDCTProcs();
 
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
@@ -312,6 +319,22 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_oldPlanes[2],   0, _uvBlockWidth * 8 * _uvBlockHeight * 8);
 	memset(_oldPlanes[3], 255, _yBlockWidth  * 8 * _yBlockHeight  * 8);
 
+	// Each block is parsed into at most one operation
+	_blockOps[0] = new BlockOp[_yBlockWidth  * _yBlockHeight ];
+	_blockOps[1] = new BlockOp[_uvBlockWidth * _uvBlockHeight];
+	_blockOps[2] = new BlockOp[_uvBlockWidth * _uvBlockHeight];
+	_blockOps[3] = new BlockOp[_yBlockWidth  * _yBlockHeight ];
+
+	uint32 yBands  = (_yBlockHeight  + kBandRows - 1) / kBandRows;
+	uint32 uvBands = (_uvBlockHeight + kBandRows - 1) / kBandRows;
+
+	_bandJobs.resize(2 * yBands + 2 * uvBands);
+	_bandJobPtrs.resize(_bandJobs.size());
+	for (uint i = 0; i < _bandJobs.size(); i++)
+		_bandJobPtrs[i] = &_bandJobs[i];
+
+	_numBandJobs = 0;
+
 	initBundles();
 	initHuffman();
 }
@@ -320,6 +343,7 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
+		delete[] _blockOps[i];  _blockOps[i]  = 0;
 	}
 
 	deinitBundles();
@@ -335,6 +359,8 @@ BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
 void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	assert(frame.bits);
 
+	_numBandJobs = 0;
+
 	if (_hasAlpha) {
 		if (_id == kBIKiID)
 			frame.bits->skip(32);
@@ -354,6 +380,12 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 			break;
 	}
 
+	// The planes are parsed one after the other, as each one starts where
+	// the previous one ends in the bitstream. Reconstructing them only
+	// reads the previous frame and writes to the band's own rows, though,
+	// so the bands of all planes are reconstructed in parallel.
+	g_system->runJobs(reconstructBand, _bandJobPtrs.begin(), _numBandJobs);
+
 	// Convert the YUV data we have to our format
 	// We're ignoring alpha for now
 	// The width used here is the surface-width, and not the video-width
@@ -384,15 +416,7 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 	ctx.prevStart = _oldPlanes[planeIdx];
 	ctx.prevEnd   = _oldPlanes[planeIdx] + width * height;
 	ctx.pitch     = width;
-
-	for (int i = 0; i < 64; i++) {
-		ctx.coordMap[i] = (i & 7) + (i >> 3) * ctx.pitch;
-
-		ctx.coordScaledMap1[i] = ((i & 7) * 2 + 0) + (((i >> 3) * 2 + 0) * ctx.pitch);
-		ctx.coordScaledMap2[i] = ((i & 7) * 2 + 1) + (((i >> 3) * 2 + 0) * ctx.pitch);
-		ctx.coordScaledMap3[i] = ((i & 7) * 2 + 0) + (((i >> 3) * 2 + 1) * ctx.pitch);
-		ctx.coordScaledMap4[i] = ((i & 7) * 2 + 1) + (((i >> 3) * 2 + 1) * ctx.pitch);
-	}
+	ctx.op        = _blockOps[planeIdx];
 
 	for (int i = 0; i < kSourceMAX; i++) {
 		_bundles[i].countLength = _bundles[i].countLengths[isChroma ? 1 : 0];
@@ -400,7 +424,19 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 		readBundle(video, (Source) i);
 	}
 
+	BandJob *band = 0;
+
 	for (ctx.blockY = 0; ctx.blockY < blockHeight; ctx.blockY++) {
+		if ((ctx.blockY % kBandRows) == 0) {
+			band = &_bandJobs[_numBandJobs++];
+
+			band->track    = this;
+			band->opsStart = ctx.op;
+			band->dest     = ctx.destStart;
+			band->prev     = ctx.prevStart;
+			band->pitch    = ctx.pitch;
+		}
+
 		readBlockTypes  (video, _bundles[kSourceBlockTypes]);
 		readBlockTypes  (video, _bundles[kSourceSubBlockTypes]);
 		readColors      (video, _bundles[kSourceColors]);
@@ -462,6 +498,7 @@ void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, b
 
 		}
 
+		band->opsEnd = ctx.op;
 	}
 
 	if (video.bits->pos() & 0x1F) // next plane data starts at 32-bit boundary
@@ -626,160 +663,71 @@ uint32 BinkDecoder::BinkVideoTrack::readBundleCount(VideoFrame &video, Bundle &b
 	return n;
 }
 
-void BinkDecoder::BinkVideoTrack::blockSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
-}
+BinkDecoder::BinkVideoTrack::BlockOp &BinkDecoder::BinkVideoTrack::addBlockOp(DecodeContext &ctx, BlockOpType type) {
+	BlockOp &op = *ctx.op++;
 
-void BinkDecoder::BinkVideoTrack::blockScaledSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
+	op.type   = type;
+	op.scaled = false;
+	op.xOff   = 0;
+	op.yOff   = 0;
+	op.offset = ctx.dest - ctx.destStart;
 
-	for (int j = 0; j < 16; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 16);
+	return op;
 }
 
-void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
-	const uint8 *scan = binkPatterns[ctx.video->bits->getBits(4)];
-
-	int i = 0;
-	do {
-		int run = getBundleValue(kSourceRun) + 1;
+void BinkDecoder::BinkVideoTrack::readMotion(DecodeContext &ctx, BlockOp &op) {
+	op.xOff = getBundleValue(kSourceXOff);
+	op.yOff = getBundleValue(kSourceYOff);
 
-		i += run;
-		if (i > 64)
-			error("Run went out of bounds");
-
-		if (ctx.video->bits->getBit()) {
-
-			byte v = getBundleValue(kSourceColors);
-			for (int j = 0; j < run; j++, scan++)
-				ctx.dest[ctx.coordScaledMap1[*scan]] =
-				ctx.dest[ctx.coordScaledMap2[*scan]] =
-				ctx.dest[ctx.coordScaledMap3[*scan]] =
-				ctx.dest[ctx.coordScaledMap4[*scan]] = v;
-
-		} else
-			for (int j = 0; j < run; j++, scan++)
-				ctx.dest[ctx.coordScaledMap1[*scan]] =
-				ctx.dest[ctx.coordScaledMap2[*scan]] =
-				ctx.dest[ctx.coordScaledMap3[*scan]] =
-				ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
-
-	} while (i < 63);
-
-	if (i == 63)
-		ctx.dest[ctx.coordScaledMap1[*scan]] =
-		ctx.dest[ctx.coordScaledMap2[*scan]] =
-		ctx.dest[ctx.coordScaledMap3[*scan]] =
-		ctx.dest[ctx.coordScaledMap4[*scan]] = getBundleValue(kSourceColors);
-}
-
-void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
-
-	block[0] = getBundleValue(kSourceIntraDC);
-
-	readDCTCoeffs(*ctx.video, block, true);
-
-	IDCT(block);
-
-	int16 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
-
-	byte *dest = ctx.dest;
-	for (int i = 0; i < 16; i++, dest += ctx.pitch)
-		memset(dest, v, 16);
-}
-
-void BinkDecoder::BinkVideoTrack::blockScaledPattern(DecodeContext &ctx) {
-	byte col[2];
-
-	for (int i = 0; i < 2; i++)
-		col[i] = getBundleValue(kSourceColors);
-
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		byte v = getBundleValue(kSourcePattern);
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2, v >>= 1)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = col[v & 1];
-	}
+	byte *prev = ctx.prev + op.yOff * ((int32) ctx.pitch) + op.xOff;
+	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
+		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + op.xOff, ctx.blockY * 8 + op.yOff);
 }
 
-void BinkDecoder::BinkVideoTrack::blockScaledRaw(DecodeContext &ctx) {
-	byte row[8];
-
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		memcpy(row, _bundles[kSourceColors].curPtr, 8);
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = row[i];
-
-		_bundles[kSourceColors].curPtr += 8;
-	}
+void BinkDecoder::BinkVideoTrack::blockSkip(DecodeContext &ctx) {
+	addBlockOp(ctx, kBlockOpCopy);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
 	BlockType blockType = (BlockType) getBundleValue(kSourceSubBlockTypes);
 
+	// The 16x16 blocks are read like the 8x8 ones, and only stored doubled
 	switch (blockType) {
 	case kBlockRun:
-		blockScaledRun(ctx);
+		blockRun(ctx);
 		break;
 	case kBlockIntra:
-		blockScaledIntra(ctx);
+		blockIntra(ctx);
 		break;
 	case kBlockFill:
-		blockScaledFill(ctx);
+		blockFill(ctx);
 		break;
 	case kBlockPattern:
-		blockScaledPattern(ctx);
+		blockPattern(ctx);
 		break;
 	case kBlockRaw:
-		blockScaledRaw(ctx);
+		blockRaw(ctx);
 		break;
 	default:
 		error("Invalid 16x16 block type: %d", blockType);
 	}
 
+	ctx.op[-1].scaled = true;
+
 	ctx.blockX += 1;
 	ctx.dest   += 8;
 	ctx.prev   += 8;
 }
 
 void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
-	int8 xOff = getBundleValue(kSourceXOff);
-	int8 yOff = getBundleValue(kSourceYOff);
+	BlockOp &op = addBlockOp(ctx, kBlockOpCopy);
 
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
-	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
-		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
-
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	readMotion(ctx, op);
 }
 
 void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
+	BlockOp &op = addBlockOp(ctx, kBlockOpPixels);
+
 	const uint8 *scan = binkPatterns[ctx.video->bits->getBits(4)];
 
 	int i = 0;
@@ -794,75 +742,68 @@ void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
 
 			byte v = getBundleValue(kSourceColors);
 			for (int j = 0; j < run; j++)
-				ctx.dest[ctx.coordMap[*scan++]] = v;
+				op.pixels[*scan++] = v;
 
 		} else
 			for (int j = 0; j < run; j++)
-				ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+				op.pixels[*scan++] = getBundleValue(kSourceColors);
 
 	} while (i < 63);
 
 	if (i == 63)
-		ctx.dest[ctx.coordMap[*scan++]] = getBundleValue(kSourceColors);
+		op.pixels[*scan++] = getBundleValue(kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
-	blockMotion(ctx);
+	BlockOp &op = addBlockOp(ctx, kBlockOpResidue);
 
-	byte v = ctx.video->bits->getBits(7);
+	readMotion(ctx, op);
 
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
+	byte v = ctx.video->bits->getBits(7);
 
-	readResidue(*ctx.video, block, v);
+	memset(op.coeffs, 0, 64 * sizeof(int16));
 
-	byte  *dst = ctx.dest;
-	int16 *src = block;
-	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
-		for (int j = 0; j < 8; j++)
-			dst[j] += src[j];
+	readResidue(*ctx.video, op.coeffs, v);
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
+	BlockOp &op = addBlockOp(ctx, kBlockOpIntra);
 
-	block[0] = getBundleValue(kSourceIntraDC);
+	memset(op.coeffs, 0, 64 * sizeof(int16));
 
-	readDCTCoeffs(*ctx.video, block, true);
+	op.coeffs[0] = getBundleValue(kSourceIntraDC);
 
-	IDCTPut(ctx, block);
+	readDCTCoeffs(*ctx.video, op.coeffs, true);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
-	byte v = getBundleValue(kSourceColors);
+	BlockOp &op = addBlockOp(ctx, kBlockOpFill);
 
-	byte *dest = ctx.dest;
-	for (int i = 0; i < 8; i++, dest += ctx.pitch)
-		memset(dest, v, 8);
+	op.pixels[0] = getBundleValue(kSourceColors);
 }
 
 void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
-	blockMotion(ctx);
+	BlockOp &op = addBlockOp(ctx, kBlockOpInter);
 
-	int16 block[64];
-	memset(block, 0, 64 * sizeof(int16));
+	readMotion(ctx, op);
 
-	block[0] = getBundleValue(kSourceInterDC);
+	memset(op.coeffs, 0, 64 * sizeof(int16));
 
-	readDCTCoeffs(*ctx.video, block, false);
+	op.coeffs[0] = getBundleValue(kSourceInterDC);
 
-	IDCTAdd(ctx, block);
+	readDCTCoeffs(*ctx.video, op.coeffs, false);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
+	BlockOp &op = addBlockOp(ctx, kBlockOpPixels);
+
 	byte col[2];
 
 	for (int i = 0; i < 2; i++)
 		col[i] = getBundleValue(kSourceColors);
 
-	byte *dest = ctx.dest;
-	for (int i = 0; i < 8; i++, dest += ctx.pitch - 8) {
+	byte *dest = op.pixels;
+	for (int i = 0; i < 8; i++) {
 		byte v = getBundleValue(kSourcePattern);
 
 		for (int j = 0; j < 8; j++, v >>= 1)
@@ -871,14 +812,77 @@ void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockRaw(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *data = _bundles[kSourceColors].curPtr;
-	for (int i = 0; i < 8; i++, dest += ctx.pitch, data += 8)
-		memcpy(dest, data, 8);
+	BlockOp &op = addBlockOp(ctx, kBlockOpPixels);
+
+	memcpy(op.pixels, _bundles[kSourceColors].curPtr, 64);
 
 	_bundles[kSourceColors].curPtr += 64;
 }
 
+void BinkDecoder::BinkVideoTrack::reconstructBand(void *job) {
+	const BandJob &band = *(const BandJob *)job;
+
+	for (BlockOp *op = band.opsStart; op != band.opsEnd; ++op)
+		band.track->reconstructBlock(*op, band.dest + op->offset, band.prev + op->offset, band.pitch);
+}
+
+/** Store the values of an 8x8 block as a 16x16 block, doubling each one. */
+template<typename T>
+static void putScaled(byte *dest, int pitch, const T *src) {
+	byte *dest1 = dest;
+	byte *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, src += 8)
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
+}
+
+void BinkDecoder::BinkVideoTrack::reconstructBlock(BlockOp &op, byte *dest, const byte *prev, int pitch) const {
+	const int size = op.scaled ? 16 : 8;
+
+	if ((op.type == kBlockOpCopy) || (op.type == kBlockOpInter) || (op.type == kBlockOpResidue)) {
+		prev += op.yOff * pitch + op.xOff;
+
+		for (int j = 0; j < size; j++)
+			memcpy(dest + j * pitch, prev + j * pitch, size);
+	}
+
+	switch (op.type) {
+	case kBlockOpFill:
+		for (int j = 0; j < size; j++)
+			memset(dest + j * pitch, op.pixels[0], size);
+		break;
+
+	case kBlockOpPixels:
+		if (op.scaled)
+			putScaled(dest, pitch, op.pixels);
+		else
+			for (int j = 0; j < 8; j++)
+				memcpy(dest + j * pitch, op.pixels + j * 8, 8);
+		break;
+
+	case kBlockOpIntra:
+		if (op.scaled) {
+			_idct->idct(op.coeffs);
+			putScaled(dest, pitch, op.coeffs);
+		} else
+			_idct->idctPut(dest, pitch, op.coeffs);
+		break;
+
+	case kBlockOpInter:
+		_idct->idctAdd(dest, pitch, op.coeffs);
+		break;
+
+	case kBlockOpResidue:
+		for (int j = 0; j < 8; j++)
+			for (int i = 0; i < 8; i++)
+				dest[j * pitch + i] += op.coeffs[j * 8 + i];
+		break;
+
+	default:
+		break;
+	}
+}
+
 void BinkDecoder::BinkVideoTrack::readRuns(VideoFrame &video, Bundle &bundle) {
 	uint32 n = readBundleCount(video, bundle);
 	if (n == 0)
@@ -1272,88 +1276,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-    const int a0 = (src)[s0] + (src)[s4]; \
-    const int a1 = (src)[s0] - (src)[s4]; \
-    const int a2 = (src)[s2] + (src)[s6]; \
-    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-    const int a4 = (src)[s5] + (src)[s3]; \
-    const int a5 = (src)[s5] - (src)[s3]; \
-    const int a6 = (src)[s1] + (src)[s7]; \
-    const int a7 = (src)[s1] - (src)[s7]; \
-    const int b0 = a4 + a6; \
-    const int b1 = (A3*(a5 + a7)) >> 11; \
-    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-    (dest)[d0] = munge(a0+a2   +b0); \
-    (dest)[d1] = munge(a1+a3-a2+b2); \
-    (dest)[d2] = munge(a1-a3+a2+b3); \
-    (dest)[d3] = munge(a0-a2   -b4); \
-    (dest)[d4] = munge(a0-a2   +b4); \
-    (dest)[d5] = munge(a1-a3+a2-b3); \
-    (dest)[d6] = munge(a1+a3-a2-b2); \
-    (dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int16 *dest, const int16 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
-	int i;
-	int16 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
-	int i;
-	int16 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio, Audio::Mixer::SoundType soundType) :
 		AudioTrack(soundType),
 		_audioInfo(&audio) {
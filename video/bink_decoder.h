@@ -58,6 +58,8 @@ struct Surface;
 
 namespace Video {
 
+struct BinkIDCTProcs;
+
 /**
  * Decoder for Bink videos.
  *
@@ -158,30 +160,6 @@ private:
 		Common::Rational getFrameRate() const { return _frameRate; }
 
 	private:
-		/** A decoder state. */
-		struct DecodeContext {
-			VideoFrame *video;
-
-			uint32 planeIdx;
-
-			uint32 blockX;
-			uint32 blockY;
-
-			byte *dest;
-			byte *prev;
-
-			byte *destStart, *destEnd;
-			byte *prevStart, *prevEnd;
-
-			uint32 pitch;
-
-			int coordMap[64];
-			int coordScaledMap1[64];
-			int coordScaledMap2[64];
-			int coordScaledMap3[64];
-			int coordScaledMap4[64];
-		};
-
 		/** IDs for different data types used in Bink video codec. */
 		enum Source {
 			kSourceBlockTypes    = 0, ///< 8x8 block types.
@@ -211,6 +189,65 @@ private:
 			kBlockRaw           ///< Uncoded 8x8 block.
 		};
 
+		/** The ways to reconstruct a parsed block. */
+		enum BlockOpType {
+			kBlockOpCopy    = 0, ///< Copy the block from the previous frame.
+			kBlockOpFill       , ///< Fill the block with a single color.
+			kBlockOpPixels     , ///< Store the 8x8 pixel values.
+			kBlockOpIntra      , ///< Store the IDCT of the coefficients.
+			kBlockOpInter      , ///< Copy the block from the previous frame and add the IDCT of the coefficients.
+			kBlockOpResidue      ///< Copy the block from the previous frame and add the coefficients.
+		};
+
+		/**
+		 * A block parsed out of the bitstream, which still has to be
+		 * reconstructed into its plane.
+		 */
+		struct BlockOp {
+			byte type;     ///< The BlockOpType.
+			bool scaled;   ///< Does the block cover 16x16 pixels, each value being doubled?
+			int8 xOff;     ///< X component of the motion value.
+			int8 yOff;     ///< Y component of the motion value.
+			uint32 offset; ///< Offset of the block's top left pixel in the plane.
+
+			union {
+				byte  pixels[64]; ///< Pixel values, or a single color for kBlockOpFill.
+				int16 coeffs[64]; ///< DCT coefficients or residue.
+			};
+		};
+
+		/** A band of block rows of a plane, reconstructed by one job. */
+		struct BandJob {
+			const BinkVideoTrack *track;
+
+			BlockOp *opsStart, *opsEnd;
+
+			byte *dest;
+			const byte *prev;
+
+			uint32 pitch;
+		};
+
+		/** A decoder state. */
+		struct DecodeContext {
+			VideoFrame *video;
+
+			uint32 planeIdx;
+
+			uint32 blockX;
+			uint32 blockY;
+
+			byte *dest;
+			byte *prev;
+
+			byte *destStart, *destEnd;
+			byte *prevStart, *prevEnd;
+
+			uint32 pitch;
+
+			BlockOp *op; ///< Where to store the next parsed block.
+		};
+
 		/** Data structure for decoding and tranlating Huffman'd data. */
 		struct Huffman {
 			int  index;       ///< Index of the Huffman codebook to use.
@@ -262,6 +299,14 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		BlockOp *_blockOps[4]; ///< The parsed blocks of the 4 color planes, current frame.
+
+		Common::Array<BandJob> _bandJobs;   ///< The bands of the planes, current frame.
+		Common::Array<void *> _bandJobPtrs; ///< Pointers to _bandJobs, as passed to OSystem::runJobs().
+		uint32 _numBandJobs;                ///< The number of bands used by the current frame.
+
+		const BinkIDCTProcs *_idct; ///< The IDCT kernels for the host CPU.
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -270,9 +315,14 @@ private:
 		/** Initialize the Huffman decoders. */
 		void initHuffman();
 
-		/** Decode a plane. */
+		/** Parse a plane into its bands. */
 		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
 
+		/** Reconstruct the blocks of a band. Run by OSystem::runJobs(). */
+		static void reconstructBand(void *job);
+		/** Reconstruct a parsed block. */
+		void reconstructBlock(BlockOp &op, byte *dest, const byte *prev, int pitch) const;
+
 		/** Read/Initialize a bundle for decoding a plane. */
 		void readBundle(VideoFrame &video, Source source);
 
@@ -289,23 +339,22 @@ private:
 		/** Read a count value out of a bundle. */
 		uint32 readBundleCount(VideoFrame &video, Bundle &bundle);
 
+		/** Start the parsed block at the current position. */
+		BlockOp &addBlockOp(DecodeContext &ctx, BlockOpType type);
+		/** Read the motion value of a parsed block. */
+		void readMotion(DecodeContext &ctx, BlockOp &op);
+
 		// Handle the block types
-		void blockSkip         (DecodeContext &ctx);
-		void blockScaledSkip   (DecodeContext &ctx);
-		void blockScaledRun    (DecodeContext &ctx);
-		void blockScaledIntra  (DecodeContext &ctx);
-		void blockScaledFill   (DecodeContext &ctx);
-		void blockScaledPattern(DecodeContext &ctx);
-		void blockScaledRaw    (DecodeContext &ctx);
-		void blockScaled       (DecodeContext &ctx);
-		void blockMotion       (DecodeContext &ctx);
-		void blockRun          (DecodeContext &ctx);
-		void blockResidue      (DecodeContext &ctx);
-		void blockIntra        (DecodeContext &ctx);
-		void blockFill         (DecodeContext &ctx);
-		void blockInter        (DecodeContext &ctx);
-		void blockPattern      (DecodeContext &ctx);
-		void blockRaw          (DecodeContext &ctx);
+		void blockSkip   (DecodeContext &ctx);
+		void blockScaled (DecodeContext &ctx);
+		void blockMotion (DecodeContext &ctx);
+		void blockRun    (DecodeContext &ctx);
+		void blockResidue(DecodeContext &ctx);
+		void blockIntra  (DecodeContext &ctx);
+		void blockFill   (DecodeContext &ctx);
+		void blockInter  (DecodeContext &ctx);
+		void blockPattern(DecodeContext &ctx);
+		void blockRaw    (DecodeContext &ctx);
 
 		// Read the bundles
 		void readRuns        (VideoFrame &video, Bundle &bundle);
@@ -317,10 +366,6 @@ private:
 		void readDCTCoeffs   (VideoFrame &video, int16 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
 
-		// Bink video IDCT
-		void IDCT(int16 *block);
-		void IDCTPut(DecodeContext &ctx, int16 *block);
-		void IDCTAdd(DecodeContext &ctx, int16 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
@@ -0,0 +1,228 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "video/bink_idct_intern.h"
+
+#include <immintrin.h>
+
+namespace Video {
+
+namespace {
+
+enum {
+	kA1 = 2896,
+	kA2 = 2217,
+	kA3 = 3784,
+	kA4 = -5352
+};
+
+template<int factor>
+inline __m256i mulAVX2(__m256i value) {
+	return _mm256_srai_epi32(_mm256_mullo_epi32(value, _mm256_set1_epi32(factor)), 11);
+}
+
+/**
+ * One dimensional transform of eight columns at once, s[k] holding the k-th
+ * value of each column.
+ */
+template<bool round>
+inline void transformAVX2(__m256i *s) {
+	const __m256i a0 = _mm256_add_epi32(s[0], s[4]);
+	const __m256i a1 = _mm256_sub_epi32(s[0], s[4]);
+	const __m256i a2 = _mm256_add_epi32(s[2], s[6]);
+	const __m256i a3 = mulAVX2<kA1>(_mm256_sub_epi32(s[2], s[6]));
+	const __m256i a4 = _mm256_add_epi32(s[5], s[3]);
+	const __m256i a5 = _mm256_sub_epi32(s[5], s[3]);
+	const __m256i a6 = _mm256_add_epi32(s[1], s[7]);
+	const __m256i a7 = _mm256_sub_epi32(s[1], s[7]);
+	const __m256i b0 = _mm256_add_epi32(a4, a6);
+	const __m256i b1 = mulAVX2<kA3>(_mm256_add_epi32(a5, a7));
+	const __m256i b2 = _mm256_add_epi32(_mm256_sub_epi32(mulAVX2<kA4>(a5), b0), b1);
+	const __m256i b3 = _mm256_sub_epi32(mulAVX2<kA1>(_mm256_sub_epi32(a6, a4)), b2);
+	const __m256i b4 = _mm256_sub_epi32(_mm256_add_epi32(mulAVX2<kA2>(a7), b3), b1);
+
+	const __m256i c0 = _mm256_add_epi32(a0, a2);
+	const __m256i c1 = _mm256_sub_epi32(_mm256_add_epi32(a1, a3), a2);
+	const __m256i c2 = _mm256_add_epi32(_mm256_sub_epi32(a1, a3), a2);
+	const __m256i c3 = _mm256_sub_epi32(a0, a2);
+
+	s[0] = _mm256_add_epi32(c0, b0);
+	s[1] = _mm256_add_epi32(c1, b2);
+	s[2] = _mm256_add_epi32(c2, b3);
+	s[3] = _mm256_sub_epi32(c3, b4);
+	s[4] = _mm256_add_epi32(c3, b4);
+	s[5] = _mm256_sub_epi32(c2, b3);
+	s[6] = _mm256_sub_epi32(c1, b2);
+	s[7] = _mm256_sub_epi32(c0, b0);
+
+	if (round) {
+		for (int i = 0; i < 8; i++)
+			s[i] = _mm256_srai_epi32(_mm256_add_epi32(s[i], _mm256_set1_epi32(0x7F)), 8);
+	}
+}
+
+inline __m256i truncateAVX2(__m256i value) {
+	return _mm256_srai_epi32(_mm256_slli_epi32(value, 16), 16);
+}
+
+inline void transposeAVX2(__m256i *v) {
+	const __m256i a0 = _mm256_unpacklo_epi32(v[0], v[1]);
+	const __m256i a1 = _mm256_unpackhi_epi32(v[0], v[1]);
+	const __m256i a2 = _mm256_unpacklo_epi32(v[2], v[3]);
+	const __m256i a3 = _mm256_unpackhi_epi32(v[2], v[3]);
+	const __m256i a4 = _mm256_unpacklo_epi32(v[4], v[5]);
+	const __m256i a5 = _mm256_unpackhi_epi32(v[4], v[5]);
+	const __m256i a6 = _mm256_unpacklo_epi32(v[6], v[7]);
+	const __m256i a7 = _mm256_unpackhi_epi32(v[6], v[7]);
+
+	const __m256i b0 = _mm256_unpacklo_epi64(a0, a2);
+	const __m256i b1 = _mm256_unpackhi_epi64(a0, a2);
+	const __m256i b2 = _mm256_unpacklo_epi64(a1, a3);
+	const __m256i b3 = _mm256_unpackhi_epi64(a1, a3);
+	const __m256i b4 = _mm256_unpacklo_epi64(a4, a6);
+	const __m256i b5 = _mm256_unpackhi_epi64(a4, a6);
+	const __m256i b6 = _mm256_unpacklo_epi64(a5, a7);
+	const __m256i b7 = _mm256_unpackhi_epi64(a5, a7);
+
+	v[0] = _mm256_permute2x128_si256(b0, b4, 0x20);
+	v[1] = _mm256_permute2x128_si256(b1, b5, 0x20);
+	v[2] = _mm256_permute2x128_si256(b2, b6, 0x20);
+	v[3] = _mm256_permute2x128_si256(b3, b7, 0x20);
+	v[4] = _mm256_permute2x128_si256(b0, b4, 0x31);
+	v[5] = _mm256_permute2x128_si256(b1, b5, 0x31);
+	v[6] = _mm256_permute2x128_si256(b2, b6, 0x31);
+	v[7] = _mm256_permute2x128_si256(b3, b7, 0x31);
+}
+
+/**
+ * Compute the results of the inverse DCT as 32 bit values, row by row.
+ *
+ * The columns are transformed first, as in the C code. Transposing the
+ * intermediate values makes the second pass a column transform as well.
+ */
+inline void idctAVX2(const int16 *block, __m256i *rows) {
+	for (int i = 0; i < 8; i++)
+		rows[i] = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(block + i * 8)));
+
+	transformAVX2<false>(rows);
+
+	// The C code stores the intermediate values as 16 bit integers
+	for (int i = 0; i < 8; i++)
+		rows[i] = truncateAVX2(rows[i]);
+
+	transposeAVX2(rows);
+	transformAVX2<true>(rows);
+	transposeAVX2(rows);
+}
+
+/**
+ * Pack two rows of results into 16 bit values, keeping their order.
+ */
+inline __m256i packRowsAVX2(__m256i first, __m256i second) {
+	return _mm256_permute4x64_epi64(_mm256_packs_epi32(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/**
+ * Store two rows of 16 bit values as bytes.
+ */
+inline void storeRowsAVX2(byte *dest, int pitch, __m256i pixels) {
+	const __m256i packed = _mm256_packus_epi16(pixels, pixels);
+	_mm_storel_epi64((__m128i *)dest, _mm256_castsi256_si128(packed));
+	_mm_storel_epi64((__m128i *)(dest + pitch), _mm256_extracti128_si256(packed, 1));
+}
+
+inline __m256i loadRowsAVX2(const byte *dest, int pitch) {
+	const __m128i first = _mm_loadl_epi64((const __m128i *)dest);
+	const __m128i second = _mm_loadl_epi64((const __m128i *)(dest + pitch));
+	return _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(first, second));
+}
+
+/**
+ * Check whether a block only has a DC coefficient. All results are the same
+ * then.
+ */
+inline bool isDCOnlyAVX2(const int16 *block) {
+	const __m256i dcMask = _mm256_set_epi16(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0);
+	__m256i any = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)block), dcMask);
+	for (int i = 1; i < 4; i++)
+		any = _mm256_or_si256(any, _mm256_loadu_si256((const __m256i *)(block + i * 16)));
+	return _mm256_testz_si256(any, any) != 0;
+}
+
+} // End of anonymous namespace
+
+void binkIDCTAVX2(int16 *block) {
+	if (isDCOnlyAVX2(block)) {
+		const __m256i value = _mm256_set1_epi16((int16)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 4; i++)
+			_mm256_storeu_si256((__m256i *)(block + i * 16), value);
+		return;
+	}
+
+	__m256i rows[8];
+	idctAVX2(block, rows);
+
+	// Truncate the results to 16 bits, as the C code does
+	for (int i = 0; i < 8; i += 2) {
+		const __m256i packed = packRowsAVX2(truncateAVX2(rows[i]), truncateAVX2(rows[i + 1]));
+		_mm256_storeu_si256((__m256i *)(block + i * 8), packed);
+	}
+}
+
+void binkIDCTPutAVX2(byte *dest, int pitch, const int16 *block) {
+	if (isDCOnlyAVX2(block)) {
+		const __m128i value = _mm_set1_epi8((char)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++, dest += pitch)
+			_mm_storel_epi64((__m128i *)dest, value);
+		return;
+	}
+
+	__m256i rows[8];
+	idctAVX2(block, rows);
+
+	// Only the low 8 bits of the results are stored
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+		storeRowsAVX2(dest, pitch, packRowsAVX2(_mm256_and_si256(rows[i], mask), _mm256_and_si256(rows[i + 1], mask)));
+}
+
+void binkIDCTAddAVX2(byte *dest, int pitch, int16 *block) {
+	const __m256i mask = _mm256_set1_epi16(0xFF);
+
+	if (isDCOnlyAVX2(block)) {
+		const __m256i value = _mm256_set1_epi16((int16)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+			storeRowsAVX2(dest, pitch, _mm256_and_si256(_mm256_add_epi16(loadRowsAVX2(dest, pitch), value), mask));
+		return;
+	}
+
+	__m256i rows[8];
+	idctAVX2(block, rows);
+
+	const __m256i lowBytes = _mm256_set1_epi32(0xFF);
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2) {
+		const __m256i pixels = packRowsAVX2(_mm256_and_si256(rows[i], lowBytes), _mm256_and_si256(rows[i + 1], lowBytes));
+		storeRowsAVX2(dest, pitch, _mm256_and_si256(_mm256_add_epi16(loadRowsAVX2(dest, pitch), pixels), mask));
+	}
+}
+
+} // End of namespace Video
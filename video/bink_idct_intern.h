@@ -0,0 +1,76 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef VIDEO_BINK_IDCT_INTERN_H
+#define VIDEO_BINK_IDCT_INTERN_H
+
+#include "common/scummsys.h"
+
+namespace Video {
+
+/**
+ * The inverse DCT of Bink video, for one 8x8 block of coefficients stored
+ * row by row.
+ *
+ * The results of the kernels are identical to the ones of the plain C
+ * versions, including the wraparound of values that do not fit into the
+ * destination pixels.
+ */
+struct BinkIDCTProcs {
+	/** Transform the block in place. */
+	void (*idct)(int16 *block);
+	/** Transform the block and store the result into dest. */
+	void (*idctPut)(byte *dest, int pitch, const int16 *block);
+	/** Transform the block and add the result to dest. The block is clobbered. */
+	void (*idctAdd)(byte *dest, int pitch, int16 *block);
+};
+
+/**
+ * Return the fastest kernels for the host CPU.
+ */
+const BinkIDCTProcs &getBinkIDCTProcs();
+
+void binkIDCT(int16 *block);
+void binkIDCTPut(byte *dest, int pitch, const int16 *block);
+void binkIDCTAdd(byte *dest, int pitch, int16 *block);
+
+#ifdef SCUMMVM_SSE2
+void binkIDCTSSE2(int16 *block);
+void binkIDCTPutSSE2(byte *dest, int pitch, const int16 *block);
+void binkIDCTAddSSE2(byte *dest, int pitch, int16 *block);
+#endif
+
+#ifdef SCUMMVM_AVX2
+void binkIDCTAVX2(int16 *block);
+void binkIDCTPutAVX2(byte *dest, int pitch, const int16 *block);
+void binkIDCTAddAVX2(byte *dest, int pitch, int16 *block);
+#endif
+
+#ifdef SCUMMVM_NEON
+void binkIDCTNEON(int16 *block);
+void binkIDCTPutNEON(byte *dest, int pitch, const int16 *block);
+void binkIDCTAddNEON(byte *dest, int pitch, int16 *block);
+#endif
+
+} // End of namespace Video
+
+#endif
@@ -0,0 +1,196 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "video/bink_idct_intern.h"
+
+#include <arm_neon.h>
+
+namespace Video {
+
+namespace {
+
+enum {
+	kA1 = 2896,
+	kA2 = 2217,
+	kA3 = 3784,
+	kA4 = -5352
+};
+
+template<int factor>
+inline int32x4_t mulNEON(int32x4_t value) {
+	return vshrq_n_s32(vmulq_n_s32(value, factor), 11);
+}
+
+/**
+ * One dimensional transform of four columns at once, s[k] holding the k-th
+ * value of each column.
+ */
+template<bool round>
+inline void transformNEON(int32x4_t *s) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = mulNEON<kA1>(vsubq_s32(s[2], s[6]));
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = mulNEON<kA3>(vaddq_s32(a5, a7));
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(mulNEON<kA4>(a5), b0), b1);
+	const int32x4_t b3 = vsubq_s32(mulNEON<kA1>(vsubq_s32(a6, a4)), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(mulNEON<kA2>(a7), b3), b1);
+
+	const int32x4_t c0 = vaddq_s32(a0, a2);
+	const int32x4_t c1 = vsubq_s32(vaddq_s32(a1, a3), a2);
+	const int32x4_t c2 = vaddq_s32(vsubq_s32(a1, a3), a2);
+	const int32x4_t c3 = vsubq_s32(a0, a2);
+
+	s[0] = vaddq_s32(c0, b0);
+	s[1] = vaddq_s32(c1, b2);
+	s[2] = vaddq_s32(c2, b3);
+	s[3] = vsubq_s32(c3, b4);
+	s[4] = vaddq_s32(c3, b4);
+	s[5] = vsubq_s32(c2, b3);
+	s[6] = vsubq_s32(c1, b2);
+	s[7] = vsubq_s32(c0, b0);
+
+	if (round) {
+		for (int i = 0; i < 8; i++)
+			s[i] = vshrq_n_s32(vaddq_s32(s[i], vdupq_n_s32(0x7F)), 8);
+	}
+}
+
+/**
+ * Transform the eight columns of eight rows of 16 bit values, and truncate
+ * the results to 16 bits.
+ */
+template<bool round>
+inline void transformRowsNEON(int16x8_t *rows) {
+	int32x4_t left[8], right[8];
+	for (int i = 0; i < 8; i++) {
+		left[i] = vmovl_s16(vget_low_s16(rows[i]));
+		right[i] = vmovl_s16(vget_high_s16(rows[i]));
+	}
+
+	transformNEON<round>(left);
+	transformNEON<round>(right);
+
+	for (int i = 0; i < 8; i++)
+		rows[i] = vcombine_s16(vmovn_s32(left[i]), vmovn_s32(right[i]));
+}
+
+inline void transposeNEON(int16x8_t *v) {
+	const int16x8x2_t t01 = vtrnq_s16(v[0], v[1]);
+	const int16x8x2_t t23 = vtrnq_s16(v[2], v[3]);
+	const int16x8x2_t t45 = vtrnq_s16(v[4], v[5]);
+	const int16x8x2_t t67 = vtrnq_s16(v[6], v[7]);
+
+	// Columns 0 and 4, 2 and 6, 1 and 5, 3 and 7 of four rows each
+	const int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[0]), vreinterpretq_s32_s16(t23.val[0]));
+	const int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[1]), vreinterpretq_s32_s16(t23.val[1]));
+	const int32x4x2_t u4 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[0]), vreinterpretq_s32_s16(t67.val[0]));
+	const int32x4x2_t u5 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[1]), vreinterpretq_s32_s16(t67.val[1]));
+
+	v[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[0]), vget_low_s32(u4.val[0])));
+	v[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[0]), vget_low_s32(u5.val[0])));
+	v[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[1]), vget_low_s32(u4.val[1])));
+	v[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[1]), vget_low_s32(u5.val[1])));
+	v[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[0]), vget_high_s32(u4.val[0])));
+	v[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[0]), vget_high_s32(u5.val[0])));
+	v[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[1]), vget_high_s32(u4.val[1])));
+	v[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[1]), vget_high_s32(u5.val[1])));
+}
+
+/**
+ * Compute the 16 bit results of the inverse DCT, row by row.
+ */
+inline void idctNEON(const int16 *block, int16x8_t *rows) {
+	for (int i = 0; i < 8; i++)
+		rows[i] = vld1q_s16(block + i * 8);
+
+	transformRowsNEON<false>(rows);
+	transposeNEON(rows);
+	transformRowsNEON<true>(rows);
+	transposeNEON(rows);
+}
+
+/**
+ * Check whether a block only has a DC coefficient. All results are the same
+ * then.
+ */
+inline bool isDCOnlyNEON(const int16 *block) {
+	int16x8_t any = vsetq_lane_s16(0, vld1q_s16(block), 0);
+	for (int i = 1; i < 8; i++)
+		any = vorrq_s16(any, vld1q_s16(block + i * 8));
+	const int16x4_t folded = vorr_s16(vget_low_s16(any), vget_high_s16(any));
+	return vget_lane_u64(vreinterpret_u64_s16(folded), 0) == 0;
+}
+
+} // End of anonymous namespace
+
+void binkIDCTNEON(int16 *block) {
+	if (isDCOnlyNEON(block)) {
+		const int16x8_t value = vdupq_n_s16((int16)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++)
+			vst1q_s16(block + i * 8, value);
+		return;
+	}
+
+	int16x8_t rows[8];
+	idctNEON(block, rows);
+
+	for (int i = 0; i < 8; i++)
+		vst1q_s16(block + i * 8, rows[i]);
+}
+
+void binkIDCTPutNEON(byte *dest, int pitch, const int16 *block) {
+	if (isDCOnlyNEON(block)) {
+		const uint8x8_t value = vdup_n_u8((byte)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++, dest += pitch)
+			vst1_u8(dest, value);
+		return;
+	}
+
+	int16x8_t rows[8];
+	idctNEON(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vmovn_u16(vreinterpretq_u16_s16(rows[i])));
+}
+
+void binkIDCTAddNEON(byte *dest, int pitch, int16 *block) {
+	if (isDCOnlyNEON(block)) {
+		const uint8x8_t value = vdup_n_u8((byte)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++, dest += pitch)
+			vst1_u8(dest, vadd_u8(vld1_u8(dest), value));
+		return;
+	}
+
+	int16x8_t rows[8];
+	idctNEON(block, rows);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, vadd_u8(vld1_u8(dest), vmovn_u16(vreinterpretq_u16_s16(rows[i]))));
+}
+
+} // End of namespace Video
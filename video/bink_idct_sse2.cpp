@@ -0,0 +1,245 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "video/bink_idct_intern.h"
+
+#include <emmintrin.h>
+
+namespace Video {
+
+namespace {
+
+enum {
+	kA1 = 2896,
+	kA2 = 2217,
+	kA3 = 3784,
+	kA4 = -5352
+};
+
+/**
+ * Multiply four 32 bit values by a positive 16 bit constant, keeping the low
+ * 32 bits of the products like the C code does.
+ */
+template<int factor>
+inline __m128i mulSSE2(__m128i value) {
+	const __m128i f = _mm_set1_epi16(factor);
+	// The low halves times the factor, plus the high halves times the
+	// factor shifted by 16 bits
+	const __m128i low = _mm_mullo_epi16(value, f);
+	const __m128i high = _mm_mulhi_epu16(value, f);
+	return _mm_add_epi32(low, _mm_slli_epi32(high, 16));
+}
+
+/**
+ * One dimensional transform of four columns at once, s[k] holding the k-th
+ * value of each column.
+ */
+template<bool round>
+inline void transformSSE2(__m128i *s) {
+	const __m128i a0 = _mm_add_epi32(s[0], s[4]);
+	const __m128i a1 = _mm_sub_epi32(s[0], s[4]);
+	const __m128i a2 = _mm_add_epi32(s[2], s[6]);
+	const __m128i a3 = _mm_srai_epi32(mulSSE2<kA1>(_mm_sub_epi32(s[2], s[6])), 11);
+	const __m128i a4 = _mm_add_epi32(s[5], s[3]);
+	const __m128i a5 = _mm_sub_epi32(s[5], s[3]);
+	const __m128i a6 = _mm_add_epi32(s[1], s[7]);
+	const __m128i a7 = _mm_sub_epi32(s[1], s[7]);
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = _mm_srai_epi32(mulSSE2<kA3>(_mm_add_epi32(a5, a7)), 11);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(_mm_sub_epi32(_mm_setzero_si128(), mulSSE2<-kA4>(a5)), 11), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(_mm_srai_epi32(mulSSE2<kA1>(_mm_sub_epi32(a6, a4)), 11), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(_mm_srai_epi32(mulSSE2<kA2>(a7), 11), b3), b1);
+
+	const __m128i c0 = _mm_add_epi32(a0, a2);
+	const __m128i c1 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2);
+	const __m128i c2 = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+	const __m128i c3 = _mm_sub_epi32(a0, a2);
+
+	s[0] = _mm_add_epi32(c0, b0);
+	s[1] = _mm_add_epi32(c1, b2);
+	s[2] = _mm_add_epi32(c2, b3);
+	s[3] = _mm_sub_epi32(c3, b4);
+	s[4] = _mm_add_epi32(c3, b4);
+	s[5] = _mm_sub_epi32(c2, b3);
+	s[6] = _mm_sub_epi32(c1, b2);
+	s[7] = _mm_sub_epi32(c0, b0);
+
+	if (round) {
+		for (int i = 0; i < 8; i++)
+			s[i] = _mm_srai_epi32(_mm_add_epi32(s[i], _mm_set1_epi32(0x7F)), 8);
+	}
+}
+
+/**
+ * Truncate 32 bit values to 16 bits, and sign extend them again.
+ */
+inline __m128i truncateSSE2(__m128i value) {
+	return _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+}
+
+/**
+ * Transpose the 4x4 matrix of 32 bit values in src into dst.
+ */
+inline void transpose4x4SSE2(const __m128i *src, __m128i *dst) {
+	const __m128i a0 = _mm_unpacklo_epi32(src[0], src[1]);
+	const __m128i a1 = _mm_unpacklo_epi32(src[2], src[3]);
+	const __m128i a2 = _mm_unpackhi_epi32(src[0], src[1]);
+	const __m128i a3 = _mm_unpackhi_epi32(src[2], src[3]);
+
+	dst[0] = _mm_unpacklo_epi64(a0, a1);
+	dst[1] = _mm_unpackhi_epi64(a0, a1);
+	dst[2] = _mm_unpacklo_epi64(a2, a3);
+	dst[3] = _mm_unpackhi_epi64(a2, a3);
+}
+
+/**
+ * Compute the results of the inverse DCT as 32 bit values. top[k] and
+ * bottom[k] hold the k-th value of the rows 0 to 3 and 4 to 7.
+ *
+ * The columns are transformed first, as in the C code. Transposing the
+ * intermediate values makes the second pass a column transform as well.
+ */
+inline void idctSSE2(const int16 *block, __m128i *top, __m128i *bottom) {
+	__m128i left[8], right[8];
+	for (int i = 0; i < 8; i++) {
+		const __m128i row = _mm_loadu_si128((const __m128i *)(block + i * 8));
+		left[i] = _mm_srai_epi32(_mm_unpacklo_epi16(row, row), 16);
+		right[i] = _mm_srai_epi32(_mm_unpackhi_epi16(row, row), 16);
+	}
+
+	transformSSE2<false>(left);
+	transformSSE2<false>(right);
+
+	// The C code stores the intermediate values as 16 bit integers
+	for (int i = 0; i < 8; i++) {
+		left[i] = truncateSSE2(left[i]);
+		right[i] = truncateSSE2(right[i]);
+	}
+
+	transpose4x4SSE2(left, top);
+	transpose4x4SSE2(right, top + 4);
+	transpose4x4SSE2(left + 4, bottom);
+	transpose4x4SSE2(right + 4, bottom + 4);
+
+	transformSSE2<true>(top);
+	transformSSE2<true>(bottom);
+}
+
+/**
+ * Gather the rows of the results of idctSSE2() as 16 bit values, with each
+ * result masked.
+ */
+inline void getRowsSSE2(const __m128i *top, const __m128i *bottom, __m128i mask, __m128i *rows) {
+	__m128i left[4], right[4];
+
+	transpose4x4SSE2(top, left);
+	transpose4x4SSE2(top + 4, right);
+	for (int i = 0; i < 4; i++)
+		rows[i] = _mm_packs_epi32(_mm_and_si128(left[i], mask), _mm_and_si128(right[i], mask));
+
+	transpose4x4SSE2(bottom, left);
+	transpose4x4SSE2(bottom + 4, right);
+	for (int i = 0; i < 4; i++)
+		rows[i + 4] = _mm_packs_epi32(_mm_and_si128(left[i], mask), _mm_and_si128(right[i], mask));
+}
+
+/**
+ * Check whether a block only has a DC coefficient. All results are the same
+ * then.
+ */
+inline bool isDCOnlySSE2(const int16 *block) {
+	__m128i any = _mm_and_si128(_mm_loadu_si128((const __m128i *)block), _mm_set_epi16(-1, -1, -1, -1, -1, -1, -1, 0));
+	for (int i = 1; i < 8; i++)
+		any = _mm_or_si128(any, _mm_loadu_si128((const __m128i *)(block + i * 8)));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) == 0xFFFF;
+}
+
+} // End of anonymous namespace
+
+void binkIDCTSSE2(int16 *block) {
+	if (isDCOnlySSE2(block)) {
+		const __m128i value = _mm_set1_epi16((int16)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++)
+			_mm_storeu_si128((__m128i *)(block + i * 8), value);
+		return;
+	}
+
+	__m128i top[8], bottom[8];
+	idctSSE2(block, top, bottom);
+
+	// Truncate the results to 16 bits, as the C code does
+	for (int i = 0; i < 8; i++) {
+		top[i] = truncateSSE2(top[i]);
+		bottom[i] = truncateSSE2(bottom[i]);
+	}
+
+	__m128i rows[8];
+	getRowsSSE2(top, bottom, _mm_set1_epi32(-1), rows);
+	for (int i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i *)(block + i * 8), rows[i]);
+}
+
+void binkIDCTPutSSE2(byte *dest, int pitch, const int16 *block) {
+	if (isDCOnlySSE2(block)) {
+		const __m128i value = _mm_set1_epi8((char)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++, dest += pitch)
+			_mm_storel_epi64((__m128i *)dest, value);
+		return;
+	}
+
+	__m128i top[8], bottom[8];
+	idctSSE2(block, top, bottom);
+
+	// Only the low 8 bits of the results are stored
+	__m128i rows[8];
+	getRowsSSE2(top, bottom, _mm_set1_epi32(0xFF), rows);
+	for (int i = 0; i < 8; i++, dest += pitch)
+		_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(rows[i], rows[i]));
+}
+
+void binkIDCTAddSSE2(byte *dest, int pitch, int16 *block) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi16(0xFF);
+
+	if (isDCOnlySSE2(block)) {
+		const __m128i value = _mm_set1_epi16((int16)((block[0] + 0x7F) >> 8));
+		for (int i = 0; i < 8; i++, dest += pitch) {
+			const __m128i old = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dest), zero);
+			const __m128i pixels = _mm_and_si128(_mm_add_epi16(old, value), mask);
+			_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(pixels, pixels));
+		}
+		return;
+	}
+
+	__m128i top[8], bottom[8];
+	idctSSE2(block, top, bottom);
+
+	__m128i rows[8];
+	getRowsSSE2(top, bottom, _mm_set1_epi32(0xFF), rows);
+	for (int i = 0; i < 8; i++, dest += pitch) {
+		const __m128i old = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dest), zero);
+		const __m128i pixels = _mm_and_si128(_mm_add_epi16(old, rows[i]), mask);
+		_mm_storel_epi64((__m128i *)dest, _mm_packus_epi16(pixels, pixels));
+	}
+}
+
+} // End of namespace Video
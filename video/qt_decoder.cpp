@@ -808,6 +808,32 @@ void QuickTimeDecoder::VideoTrackHandler::setDither(const byte *palette) {
 	}
 }
 
+bool QuickTimeDecoder::VideoTrackHandler::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	if (_forcedDitherPalette)
+		return false;
+
+	Common::Array<Graphics::PixelFormat> oldFormats;
+
+	for (uint i = 0; i < _parent->sampleDescs.size(); i++) {
+		VideoSampleDesc *desc = (VideoSampleDesc *)_parent->sampleDescs[i];
+
+		if (desc && desc->_videoCodec) {
+			oldFormats.push_back(desc->_videoCodec->getPixelFormat());
+
+			if (desc->_videoCodec->setOutputPixelFormat(format))
+				continue;
+		}
+
+		// Go back to the previous formats, so all codecs agree
+		for (uint j = 0; j < oldFormats.size(); j++)
+			((VideoSampleDesc *)_parent->sampleDescs[j])->_videoCodec->setOutputPixelFormat(oldFormats[j]);
+
+		return false;
+	}
+
+	return true;
+}
+
 namespace {
 
 // Return a pixel in RGB554
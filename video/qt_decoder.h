@@ -142,6 +142,7 @@ private:
 		bool isReversed() const { return _reversed; }
 		bool canDither() const;
 		void setDither(const byte *palette);
+		bool setOutputPixelFormat(const Graphics::PixelFormat &format);
 
 		Common::Rational getScaledWidth() const;
 		Common::Rational getScaledHeight() const;
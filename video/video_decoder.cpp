@@ -30,9 +30,18 @@
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+struct VideoDecoder::DecodedFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	uint32 startTime;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,6 +58,9 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodedFrameStart = 0;
+	_decodedFrameCount = 0;
+	_decodeAheadTime = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -57,6 +69,11 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	discardDecodedFrames();
+	setDecodeAhead(0);
+}
+
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
@@ -80,6 +97,8 @@ void VideoDecoder::close() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	discardDecodedFrames();
+	_decodeAheadTime = 0;
 }
 
 bool VideoDecoder::loadFile(const Common::String &filename) {
@@ -185,6 +204,23 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (!_decodedFrames.empty()) {
+		if (_decodedFrameCount == 0 && !decodeAheadFrame())
+			return 0;
+
+		DecodedFrame *frame = _decodedFrames[_decodedFrameStart];
+		_decodedFrameStart = (_decodedFrameStart + 1) % _decodedFrames.size();
+		_decodedFrameCount--;
+
+		if (frame->dirtyPalette) {
+			memcpy(_decodedPalette, frame->palette, sizeof(_decodedPalette));
+			_palette = _decodedPalette;
+			_dirtyPalette = true;
+		}
+
+		return frame->hasSurface ? &frame->surface : 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -213,6 +249,10 @@ bool VideoDecoder::setReverse(bool reverse) {
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
+			// The tracks are already past the frames decoded ahead
+			if (_decodedFrameCount != 0)
+				return false;
+
 			if (!((VideoTrack *)*it)->setReverse(reverse))
 				return false;
 
@@ -236,7 +276,7 @@ int VideoDecoder::getCurFrame() const {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
 			frame += ((VideoTrack *)*it)->getCurFrame() + 1;
 
-	return frame;
+	return frame - _decodedFrameCount;
 }
 
 uint32 VideoDecoder::getFrameCount() const {
@@ -271,10 +311,22 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate)
 		return 0;
 
 	uint32 currentTime = getTime();
+
+	if (_decodedFrameCount != 0) {
+		uint32 nextFrameStartTime = _decodedFrames[_decodedFrameStart]->startTime;
+		if (nextFrameStartTime <= currentTime)
+			return 0;
+
+		return nextFrameStartTime - currentTime;
+	}
+
+	if (!_nextVideoTrack)
+		return 0;
+
 	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
 
 	if (_nextVideoTrack->isReversed()) {
@@ -293,6 +345,9 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	if (_decodedFrameCount != 0)
+		return false;
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
@@ -324,6 +379,8 @@ bool VideoDecoder::rewind() {
 	if (isPlaying())
 		stopAudio();
 
+	discardDecodedFrames();
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if (!(*it)->rewind())
 			return false;
@@ -358,6 +415,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (isPlaying())
 		stopAudio();
 
+	discardDecodedFrames();
+
 	// Do the actual seeking
 	if (!seekIntern(time))
 		return false;
@@ -523,6 +582,25 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+bool VideoDecoder::setOutputPixelFormat(const Graphics::PixelFormat &format) {
+	// If a frame was already decoded, we can't set it now.
+	if (!_canSetDither)
+		return false;
+
+	bool result = false;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			if (!((VideoTrack *)*it)->setOutputPixelFormat(format))
+				return false;
+
+			result = true;
+		}
+	}
+
+	return result;
+}
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -808,6 +886,10 @@ void VideoDecoder::setEndTime(const Audio::Timestamp &endTime) {
 	_endTime = endTime;
 	_endTimeSet = true;
 
+	// Frames decoded ahead past the end will not be shown
+	while (_decodedFrameCount != 0 && _decodedFrames[(_decodedFrameStart + _decodedFrameCount - 1) % _decodedFrames.size()]->startTime >= (uint)_endTime.msecs())
+		_decodedFrameCount--;
+
 	if (startTime > endTime)
 		return;
 
@@ -912,6 +994,10 @@ void VideoDecoder::startAudioLimit(const Audio::Timestamp &limit) {
 }
 
 bool VideoDecoder::hasFramesLeft() const {
+	return _decodedFrameCount != 0 || hasFramesLeftToDecode();
+}
+
+bool VideoDecoder::hasFramesLeftToDecode() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
@@ -938,6 +1024,94 @@ bool VideoDecoder::hasAudio() const {
 	return false;
 }
 
+bool VideoDecoder::setDecodeAhead(uint frameCount) {
+	if (_decodedFrameCount != 0)
+		return false;
+
+	for (uint i = 0; i < _decodedFrames.size(); i++) {
+		_decodedFrames[i]->surface.free();
+		delete _decodedFrames[i];
+	}
+
+	_decodedFrames.clear();
+	_decodedFrameStart = 0;
+
+	if (frameCount != 0) {
+		for (uint i = 0; i <= frameCount; i++) {
+			DecodedFrame *frame = new DecodedFrame();
+			frame->hasSurface = false;
+			frame->startTime = 0;
+			frame->dirtyPalette = false;
+			_decodedFrames.push_back(frame);
+		}
+	}
+
+	return true;
+}
+
+bool VideoDecoder::decodeAheadFrame() {
+	readNextPacket();
+
+	if (!_nextVideoTrack)
+		return false;
+
+	DecodedFrame *frame = _decodedFrames[(_decodedFrameStart + _decodedFrameCount) % _decodedFrames.size()];
+	frame->startTime = _nextVideoTrack->getNextFrameStartTime();
+
+	const uint32 startTime = g_system->getMillis();
+	const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+
+	frame->hasSurface = (surface != 0);
+	if (surface) {
+		Graphics::Surface &dst = frame->surface;
+		if (dst.w != surface->w || dst.h != surface->h || dst.format != surface->format) {
+			dst.free();
+			dst.create(surface->w, surface->h, surface->format);
+		}
+
+		for (int y = 0; y < surface->h; y++)
+			memcpy(dst.getBasePtr(0, y), surface->getBasePtr(0, y), surface->w * surface->format.bytesPerPixel);
+	}
+
+	frame->dirtyPalette = _nextVideoTrack->hasDirtyPalette();
+	if (frame->dirtyPalette)
+		memcpy(frame->palette, _nextVideoTrack->getPalette(), sizeof(frame->palette));
+
+	// Remember how long decoding takes, slowly forgetting the spikes
+	const uint32 decodeTime = g_system->getMillis() - startTime;
+	_decodeAheadTime = MAX(decodeTime, _decodeAheadTime - _decodeAheadTime / 8);
+
+	_decodedFrameCount++;
+
+	// Look for the next video track here for the next decode.
+	findNextVideoTrack();
+
+	return true;
+}
+
+void VideoDecoder::decodeAhead() {
+	if (!isPlaying() || isPaused())
+		return;
+
+	if (_decodedFrameCount + 1 >= _decodedFrames.size())
+		return;
+
+	if (!hasFramesLeftToDecode() || !_nextVideoTrack || _nextVideoTrack->isReversed())
+		return;
+
+	// Decode a frame only when it does not delay the next one
+	if (_decodedFrameCount != 0 && getTimeToNextFrame() <= _decodeAheadTime)
+		return;
+
+	_canSetDither = false;
+	decodeAheadFrame();
+}
+
+void VideoDecoder::discardDecodedFrames() {
+	// Keep the start, the frame before it may still be shown
+	_decodedFrameCount = 0;
+}
+
 void VideoDecoder::eraseTrack(Track *track) {
 	for (uint idx = 0; idx < _externalTracks.size(); ++idx) {
 		if (_externalTracks[idx] == track)
@@ -52,7 +52,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -355,6 +355,44 @@ public:
 	 */
 	virtual const Graphics::Surface *decodeNextFrame();
 
+	/**
+	 * Decode frames ahead of time, so that frames which take longer to
+	 * decode than the time between two frames do not make playback late.
+	 *
+	 * The frames are decoded by decodeAhead(), up to frameCount frames in
+	 * advance. They are copied into surfaces owned by the VideoDecoder, and
+	 * decodeNextFrame() returns them in order. Seeking and rewinding discard
+	 * them.
+	 *
+	 * Decoding ahead is disabled by default. It does not support reverse
+	 * playback.
+	 *
+	 * This setting remains until it is changed, even when another video is
+	 * loaded.
+	 *
+	 * @param frameCount The number of frames to decode ahead, 0 to disable
+	 * @return true on success, false if frames have already been decoded ahead
+	 */
+	bool setDecodeAhead(uint frameCount);
+
+	/**
+	 * Get the number of frames decoded ahead of time.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	uint getDecodeAhead() const { return _decodedFrames.size() ? _decodedFrames.size() - 1 : 0; }
+
+	/**
+	 * Decode a frame ahead of time, if decoding ahead is enabled and there
+	 * is enough time left before the next frame is due.
+	 *
+	 * Engines call this while waiting for the next frame, in place of
+	 * sleeping for a part of that time.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	void decodeAhead();
+
 	/**
 	 * Set the default high color format for videos that convert from YUV.
 	 *
@@ -396,6 +434,21 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Tell the video to decode its frames into the given format.
+	 *
+	 * For codecs that support it, the frames are decoded directly into the
+	 * format, such as the screen format, which saves converting each frame
+	 * afterwards. Check getPixelFormat() to see whether it succeeded.
+	 *
+	 * This should be called after loadStream(), but before a decodeNextFrame()
+	 * call. This is enforced.
+	 *
+	 * @param format The format of the decoded frames
+	 * @return true if all video tracks now decode into the format, false otherwise
+	 */
+	bool setOutputPixelFormat(const Graphics::PixelFormat &format);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -645,6 +698,13 @@ protected:
 		 * Activate dithering mode with a palette
 		 */
 		virtual void setDither(const byte *palette) {}
+
+		/**
+		 * Decode the frames into the given format
+		 *
+		 * @return true if getPixelFormat() now returns the format
+		 */
+		virtual bool setOutputPixelFormat(const Graphics::PixelFormat &format) { return format == getPixelFormat(); }
 	};
 
 	/**
@@ -949,11 +1009,22 @@ private:
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 
+	// Frames decoded ahead of time. The ring holds one more frame than
+	// is decoded ahead, the one last returned by decodeNextFrame().
+	struct DecodedFrame;
+	Common::Array<DecodedFrame *> _decodedFrames;
+	uint _decodedFrameStart, _decodedFrameCount;
+	uint32 _decodeAheadTime;
+	byte _decodedPalette[256 * 3];
+
 	// Internal helper functions
 	void stopAudio();
 	void startAudio();
 	void startAudioLimit(const Audio::Timestamp &limit);
 	bool hasFramesLeft() const;
+	bool hasFramesLeftToDecode() const;
+	bool decodeAheadFrame();
+	void discardDecodedFrames();
 	bool hasAudio() const;
 
 	int32 _startTime;